@@ -102,6 +102,10 @@
 #define CK_CC_UNLIKELY(x) x
 #endif
 
+#ifndef CK_CC_PREFETCH
+#define CK_CC_PREFETCH(x) ((void)(x))
+#endif
+
 #ifndef CK_CC_TYPEOF
 #define CK_CC_TYPEOF(X, DEFAULT) (DEFAULT)
 #endif
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_DEQUE_H
+#define CK_DEQUE_H
+
+#include <ck_cc.h>
+#include <ck_malloc.h>
+#include <ck_md.h>
+#include <ck_pr.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+
+/*
+ * A work-stealing deque, after Chase and Lev with the memory ordering of
+ * Le, Pop, Cohen and Zappa Nardelli. A single owner pushes and pops
+ * entries at the bottom, while any number of thieves steal entries from
+ * the top. The circular array doubles in size when full.
+ *
+ * A thief loads the array pointer before it reads the slot at top, so it
+ * may still read from an array the owner has just replaced with a larger
+ * copy. The entry it reads there is unchanged, since the copy preserves
+ * every entry between top and bottom, but the old array must stay mapped
+ * until the steal completes. ck_deque_grow hands the old array to the
+ * allocator with the defer flag set for that reason.
+ */
+struct ck_deque_array {
+	unsigned int mask;
+	void *slots[];
+};
+
+struct ck_deque {
+	unsigned int top;
+	char pad[CK_MD_CACHELINE - sizeof(unsigned int)];
+	unsigned int bottom;
+	struct ck_deque_array *array;
+	struct ck_malloc *m;
+};
+typedef struct ck_deque ck_deque_t;
+
+bool ck_deque_init(ck_deque_t *, struct ck_malloc *, unsigned int);
+void ck_deque_deinit(ck_deque_t *);
+bool ck_deque_grow(ck_deque_t *);
+
+/*
+ * Returns the number of entries in the deque. The value is only a
+ * snapshot if the deque is being operated on concurrently.
+ */
+CK_CC_INLINE static unsigned int
+ck_deque_size(const struct ck_deque *deque)
+{
+	unsigned int top, bottom;
+
+	top = ck_pr_load_uint(&deque->top);
+	bottom = ck_pr_load_uint(&deque->bottom);
+	return (int)(bottom - top) > 0 ? bottom - top : 0;
+}
+
+CK_CC_INLINE static unsigned int
+ck_deque_capacity(const struct ck_deque *deque)
+{
+	const struct ck_deque_array *array;
+
+	array = ck_pr_load_ptr(&deque->array);
+	return array->mask + 1;
+}
+
+/*
+ * Pushes entry onto the bottom of the deque, growing it if it is full.
+ * Returns false if the deque could not be grown. Only the owner may push.
+ */
+CK_CC_INLINE static bool
+ck_deque_push(struct ck_deque *deque, void *entry)
+{
+	struct ck_deque_array *array = deque->array;
+	unsigned int bottom = deque->bottom;
+	unsigned int top;
+
+	top = ck_pr_load_uint(&deque->top);
+	if (CK_CC_UNLIKELY(bottom - top > array->mask)) {
+		if (ck_deque_grow(deque) == false)
+			return false;
+
+		array = deque->array;
+	}
+
+	/*
+	 * A thief reads a slot before advancing the top counter, so the
+	 * slot must not be overwritten before that read completes.
+	 */
+	ck_pr_fence_load_store();
+	ck_pr_store_ptr(&array->slots[bottom & array->mask], entry);
+
+	/*
+	 * Make sure to update slot value before indicating
+	 * that the slot is available for stealing.
+	 */
+	ck_pr_fence_store();
+	ck_pr_store_uint(&deque->bottom, bottom + 1);
+	return true;
+}
+
+/*
+ * Pops the most recently pushed entry into the pointer pointed to by
+ * entry. Returns false if the deque is empty. Only the owner may pop.
+ */
+CK_CC_INLINE static bool
+ck_deque_pop(struct ck_deque *deque, void *entry)
+{
+	struct ck_deque_array *array = deque->array;
+	unsigned int bottom = deque->bottom - 1;
+	unsigned int top;
+	bool r = true;
+
+	/*
+	 * The reservation of the bottom entry must be visible to thieves
+	 * before the top counter is read, otherwise both the owner and a
+	 * thief may take the last entry.
+	 */
+#ifdef CK_MD_TSO
+	ck_pr_fas_uint(&deque->bottom, bottom);
+#else
+	ck_pr_store_uint(&deque->bottom, bottom);
+	ck_pr_fence_store_load();
+#endif
+	top = ck_pr_load_uint(&deque->top);
+
+	if (CK_CC_UNLIKELY((int)(bottom - top) < 0)) {
+		ck_pr_store_uint(&deque->bottom, bottom + 1);
+		return false;
+	}
+
+	*(void **)entry = array->slots[bottom & array->mask];
+	if (CK_CC_LIKELY(bottom != top))
+		return true;
+
+	/* The last entry is raced for against thieves. */
+	if (ck_pr_cas_uint(&deque->top, top, top + 1) == false)
+		r = false;
+
+	ck_pr_store_uint(&deque->bottom, bottom + 1);
+	return r;
+}
+
+/*
+ * Attempts to steal the least recently pushed entry into the pointer
+ * pointed to by entry. Returns false if the deque is empty or if another
+ * thread took the entry first. Any thread may steal.
+ */
+CK_CC_INLINE static bool
+ck_deque_trysteal(struct ck_deque *deque, void *entry)
+{
+	struct ck_deque_array *array;
+	unsigned int top, bottom;
+	void *r;
+
+	top = ck_pr_load_uint(&deque->top);
+
+	/*
+	 * Loads are not reordered with respect to other loads on TSO,
+	 * otherwise the top counter snapshot must be ordered against the
+	 * reservation in ck_deque_pop.
+	 */
+#ifdef CK_MD_TSO
+	ck_pr_fence_load();
+#else
+	ck_pr_fence_memory();
+#endif
+	bottom = ck_pr_load_uint(&deque->bottom);
+	if ((int)(bottom - top) <= 0)
+		return false;
+
+	/*
+	 * Make sure to serialize with respect to our snapshot
+	 * of the bottom counter.
+	 */
+	ck_pr_fence_load();
+	array = ck_pr_load_ptr(&deque->array);
+	ck_pr_fence_load_depends();
+	r = ck_pr_load_ptr(&array->slots[top & array->mask]);
+
+	/* The slot must be read before it is released to the owner. */
+	ck_pr_fence_load_atomic();
+	if (ck_pr_cas_uint(&deque->top, top, top + 1) == false)
+		return false;
+
+	*(void **)entry = r;
+	return true;
+}
+
+/*
+ * Steals the least recently pushed entry into the pointer pointed to by
+ * entry, retrying if other threads race for it. Returns false if the
+ * deque is empty.
+ */
+CK_CC_INLINE static bool
+ck_deque_steal(struct ck_deque *deque, void *entry)
+{
+	unsigned int top, bottom;
+
+	for (;;) {
+		if (ck_deque_trysteal(deque, entry) == true)
+			return true;
+
+		top = ck_pr_load_uint(&deque->top);
+		ck_pr_fence_load();
+		bottom = ck_pr_load_uint(&deque->bottom);
+		if ((int)(bottom - top) <= 0)
+			return false;
+
+		ck_pr_stall();
+	}
+}
+
+#endif /* CK_DEQUE_H */
@@ -53,6 +53,9 @@ struct ck_epoch_entry;
 typedef struct ck_epoch_entry ck_epoch_entry_t;
 typedef void ck_epoch_cb_t(ck_epoch_entry_t *);
 
+struct ck_epoch;
+typedef void ck_epoch_wake_cb_t(struct ck_epoch *, void *);
+
 /*
  * This should be embedded into objects you wish to be the target of
  * ck_epoch_cb_t functions (with ck_epoch_call).
@@ -82,6 +85,24 @@ struct ck_epoch_ref {
 	unsigned int count;
 };
 
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+/*
+ * Number of buckets in latency histograms. Bucket i counts latencies in
+ * [2^i, 2^(i + 1)) clock units, bucket 0 also counts latencies of 0 and
+ * the last bucket counts every larger latency.
+ */
+#ifndef CK_EPOCH_STAT_BUCKETS
+#define CK_EPOCH_STAT_BUCKETS 32
+#endif
+
+/*
+ * Returns a monotonic timestamp in arbitrary units. Latencies and ages
+ * are computed modulo 2^32, so the unit should be coarse enough for the
+ * intervals of interest to fit.
+ */
+typedef unsigned int ck_epoch_clock_t(void);
+#endif /* CK_MD_EPOCH_STAT_ENABLE */
+
 struct ck_epoch_record {
 	ck_stack_entry_t record_next;
 	struct ck_epoch *global;
@@ -96,6 +117,11 @@ struct ck_epoch_record {
 	unsigned int n_dispatch;
 	void *ct;
 	ck_stack_t pending[CK_EPOCH_LENGTH];
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+	unsigned int n_poll;
+	unsigned int n_poll_dispatch;
+	unsigned int section;
+#endif
 } CK_CC_CACHELINE;
 typedef struct ck_epoch_record ck_epoch_record_t;
 
@@ -103,14 +129,66 @@ struct ck_epoch {
 	unsigned int epoch;
 	unsigned int n_free;
 	ck_stack_t records;
+#ifdef CK_MD_EPOCH_EC_ENABLE
+	unsigned int n_waiters;
+	ck_epoch_wake_cb_t *wake;
+	void *wake_ct;
+#endif
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+	ck_epoch_clock_t *clock;
+	unsigned int n_advance;
+	unsigned int n_synchronize;
+	unsigned int synchronize[CK_EPOCH_STAT_BUCKETS];
+#endif
 };
 typedef struct ck_epoch ck_epoch_t;
 
+/*
+ * A reclaimer owns a record to which other records hand off their
+ * pending callbacks, so that polling and dispatch may be left to a
+ * dedicated thread.
+ */
+struct ck_epoch_reclaimer {
+	ck_epoch_record_t record;
+	unsigned int n_handoff;
+};
+typedef struct ck_epoch_reclaimer ck_epoch_reclaimer_t;
+
+struct ck_epoch_reclaimer_stat {
+	unsigned int n_pending;
+	unsigned int n_peak;
+	unsigned int n_dispatch;
+	unsigned int n_handoff;
+};
+
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+struct ck_epoch_stat {
+	unsigned int timestamp;
+	unsigned int epoch;
+	unsigned int n_advance;
+	unsigned int n_synchronize;
+	unsigned int synchronize[CK_EPOCH_STAT_BUCKETS];
+	unsigned int n_poll;
+	unsigned int n_poll_dispatch;
+	unsigned int n_records;
+	unsigned int n_active;
+	unsigned int n_pending;
+	unsigned int n_peak;
+	unsigned int n_dispatch;
+	ck_epoch_record_t *oldest;
+	unsigned int oldest_age;
+};
+#endif /* CK_MD_EPOCH_STAT_ENABLE */
+
 /*
  * Internal functions.
  */
 void _ck_epoch_addref(ck_epoch_record_t *, ck_epoch_section_t *);
 bool _ck_epoch_delref(ck_epoch_record_t *, ck_epoch_section_t *);
+#ifdef CK_MD_EPOCH_EC_ENABLE
+bool _ck_epoch_blocked(ck_epoch_t *, ck_epoch_record_t *);
+void _ck_epoch_wake(ck_epoch_t *);
+#endif
 
 CK_CC_FORCE_INLINE static void *
 ck_epoch_record_ct(const ck_epoch_record_t *record)
@@ -134,6 +212,11 @@ ck_epoch_begin(ck_epoch_record_t *record, ck_epoch_section_t *section)
 	if (record->active == 0) {
 		unsigned int g_epoch;
 
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+		if (epoch->clock != NULL)
+			ck_pr_store_uint(&record->section, epoch->clock());
+#endif
+
 		/*
 		 * It is possible for loads to be re-ordered before the store
 		 * is committed into the caller's epoch and active fields.
@@ -237,14 +320,88 @@ ck_epoch_observe(ck_epoch_record_t *record)
 CK_CC_FORCE_INLINE static bool
 ck_epoch_end(ck_epoch_record_t *record, ck_epoch_section_t *section)
 {
+	bool r;
 
 	ck_pr_fence_release();
 	ck_pr_store_uint(&record->active, record->active - 1);
 
 	if (section != NULL)
-		return _ck_epoch_delref(record, section);
+		r = _ck_epoch_delref(record, section);
+	else
+		r = record->active == 0;
 
-	return record->active == 0;
+#ifdef CK_MD_EPOCH_EC_ENABLE
+	/*
+	 * Wake up writers sleeping on a grace period (see ck_epoch_ec.h).
+	 * This costs the outermost section an extra load and branch. The
+	 * check is not ordered after the update above, so a wake-up may be
+	 * missed, which only delays the waiter until it times out.
+	 */
+	if (r == true &&
+	    CK_CC_UNLIKELY(ck_pr_load_uint(&record->global->n_waiters) != 0))
+		_ck_epoch_wake(record->global);
+#endif
+
+	return r;
+}
+
+/*
+ * Per-CPU records are registered with ck_epoch_register_cpu and shared by
+ * every thread running on a processor, so that the cost of a scan is
+ * bounded by the number of processors rather than the number of threads.
+ * The caller picks the record of its current processor, for example
+ * through the cpu_id field of its Linux restartable sequence area. A
+ * thread migrating within a section is harmless, since the section is
+ * ended on the record it began on.
+ *
+ * Readers count themselves into the bucket of the epoch they observed.
+ * The observation is validated after the increment is visible, so that
+ * a reader is never counted against an epoch older than its view of
+ * memory.
+ */
+CK_CC_FORCE_INLINE static void
+ck_epoch_cpu_begin(ck_epoch_record_t *record, ck_epoch_section_t *section)
+{
+	struct ck_epoch *global = record->global;
+	unsigned int epoch, i;
+
+	epoch = ck_pr_load_uint(&global->epoch);
+	for (;;) {
+		i = epoch & (CK_EPOCH_SENSE - 1);
+		ck_pr_inc_uint(&record->local.bucket[i].count);
+
+		/*
+		 * Pairs with the fence between the global epoch update and
+		 * the scan of records. Either the scan observes this
+		 * reference or the load below observes the new epoch.
+		 */
+		ck_pr_fence_atomic_load();
+		if (ck_pr_load_uint(&global->epoch) == epoch)
+			break;
+
+		ck_pr_dec_uint(&record->local.bucket[i].count);
+		epoch = ck_pr_load_uint(&global->epoch);
+	}
+
+	/* Loads within the section must not precede the validation. */
+	ck_pr_fence_load();
+	section->bucket = i;
+	return;
+}
+
+CK_CC_FORCE_INLINE static void
+ck_epoch_cpu_end(ck_epoch_record_t *record, ck_epoch_section_t *section)
+{
+
+	ck_pr_fence_release();
+	ck_pr_dec_uint(&record->local.bucket[section->bucket].count);
+
+#ifdef CK_MD_EPOCH_EC_ENABLE
+	if (CK_CC_UNLIKELY(ck_pr_load_uint(&record->global->n_waiters) != 0))
+		_ck_epoch_wake(record->global);
+#endif
+
+	return;
 }
 
 /*
@@ -336,6 +493,13 @@ ck_epoch_record_t *ck_epoch_recycle(ck_epoch_t *, void *);
  */
 void ck_epoch_register(ck_epoch_t *, ck_epoch_record_t *, void *);
 
+/*
+ * Registers a per-CPU record. Per-CPU records may only be used with
+ * ck_epoch_cpu_begin and ck_epoch_cpu_end. Deferrals to a per-CPU record
+ * must use ck_epoch_call_strict.
+ */
+void ck_epoch_register_cpu(ck_epoch_t *, ck_epoch_record_t *, void *);
+
 /*
  * Marks a record as available for re-use by a subsequent recycle operation.
  * Note that the record cannot be physically destroyed.
@@ -355,4 +519,41 @@ void ck_epoch_barrier_wait(ck_epoch_record_t *, ck_epoch_wait_cb_t *, void *);
  */
 void ck_epoch_reclaim(ck_epoch_record_t *);
 
+/*
+ * Registers the record of a reclaimer. The reclaimer record must not be
+ * used for read-side sections.
+ */
+void ck_epoch_reclaimer_init(ck_epoch_t *, ck_epoch_reclaimer_t *);
+
+/*
+ * Moves every pending callback of a record to the reclaimer and returns
+ * the number of callbacks moved. This must be called by the owner of the
+ * record, or by any thread if all deferrals to the record are performed
+ * with ck_epoch_call_strict.
+ */
+unsigned int ck_epoch_reclaimer_handoff(ck_epoch_reclaimer_t *,
+    ck_epoch_record_t *);
+
+/*
+ * Attempts to advance the epoch and dispatches the callbacks of the
+ * reclaimer that are safe to run. Returns the number of callbacks that
+ * remain pending. Only one thread may poll a reclaimer at a time.
+ */
+unsigned int ck_epoch_reclaimer_poll(ck_epoch_reclaimer_t *);
+
+void ck_epoch_reclaimer_stat(ck_epoch_reclaimer_t *,
+    struct ck_epoch_reclaimer_stat *);
+
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+/*
+ * Sets the clock used to time sections and grace periods. Timing is
+ * disabled until a clock is set, which must happen before the epoch
+ * object is used by other threads.
+ */
+void ck_epoch_stat_clock(ck_epoch_t *, ck_epoch_clock_t *);
+
+/* Aggregates the statistics of every record into a snapshot. */
+void ck_epoch_stat(ck_epoch_t *, struct ck_epoch_stat *);
+#endif /* CK_MD_EPOCH_STAT_ENABLE */
+
 #endif /* CK_EPOCH_H */
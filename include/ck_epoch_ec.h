@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_EPOCH_EC_H
+#define CK_EPOCH_EC_H
+
+#include <ck_cc.h>
+#include <ck_ec.h>
+#include <ck_epoch.h>
+#include <ck_pr.h>
+#include <ck_stdbool.h>
+#include <ck_stdint.h>
+
+#ifdef CK_MD_EPOCH_EC_ENABLE
+/*
+ * Allows writers to sleep on an event count while they wait for a grace
+ * period, rather than spinning until every record observes the epoch.
+ * A writer that finds a lagging record flags itself as a waiter, and
+ * readers only increment the event count as they end a section while a
+ * waiter is flagged. Otherwise, ending an outermost section costs one
+ * extra load and branch.
+ *
+ * Readers do not order that load after the end of their section, which
+ * would require a full fence, so a wake-up may be missed. Waiters sleep
+ * for at most CK_EPOCH_EC_TIMEOUT nanoseconds before checking again.
+ */
+#ifndef CK_EPOCH_EC_TIMEOUT
+#define CK_EPOCH_EC_TIMEOUT 1000000
+#endif
+
+struct ck_epoch_ec {
+	struct ck_ec32 ec;
+	struct ck_ec_mode mode;
+};
+typedef struct ck_epoch_ec ck_epoch_ec_t;
+
+CK_CC_INLINE static void
+ck_epoch_ec_wake(ck_epoch_t *global, void *ct)
+{
+	struct ck_epoch_ec *eec = ct;
+
+	(void)global;
+	ck_ec32_inc(&eec->ec, &eec->mode);
+	return;
+}
+
+/*
+ * Attaches an event count to the epoch object, using the blocking
+ * primitives of ops. This must be done before the epoch object is used
+ * by other threads and the event count must outlive it.
+ */
+CK_CC_INLINE static void
+ck_epoch_ec_init(ck_epoch_t *global,
+    struct ck_epoch_ec *eec,
+    const struct ck_ec_ops *ops)
+{
+
+	ck_ec32_init(&eec->ec, 0);
+	eec->mode.ops = ops;
+	eec->mode.single_producer = false;
+	global->wake_ct = eec;
+	global->wake = ck_epoch_ec_wake;
+	ck_pr_fence_store();
+	return;
+}
+
+/*
+ * A wait callback for ck_epoch_synchronize_wait and ck_epoch_barrier_wait
+ * that sleeps until the lagging record ends its section. The context
+ * pointer is the struct ck_epoch_ec attached to the epoch object.
+ */
+CK_CC_INLINE static void
+ck_epoch_ec_wait(ck_epoch_t *global, ck_epoch_record_t *cr, void *ct)
+{
+	const struct timespec timeout = { 0, CK_EPOCH_EC_TIMEOUT };
+	struct ck_epoch_ec *eec = ct;
+	struct timespec deadline;
+	uint32_t value;
+
+	ck_pr_inc_uint(&global->n_waiters);
+
+	/*
+	 * The flag must be visible before the record is checked again, so
+	 * that a reader ending its section after the check observes it.
+	 */
+	ck_pr_fence_atomic_load();
+	value = ck_ec32_value(&eec->ec);
+	if (_ck_epoch_blocked(global, cr) == true &&
+	    ck_ec_deadline(&deadline, &eec->mode, &timeout) == 0)
+		ck_ec32_wait(&eec->ec, &eec->mode, value, &deadline);
+
+	ck_pr_dec_uint(&global->n_waiters);
+	return;
+}
+
+CK_CC_INLINE static void
+ck_epoch_ec_synchronize(ck_epoch_record_t *record, struct ck_epoch_ec *eec)
+{
+
+	ck_epoch_synchronize_wait(record->global, ck_epoch_ec_wait, eec);
+	return;
+}
+
+CK_CC_INLINE static void
+ck_epoch_ec_barrier(ck_epoch_record_t *record, struct ck_epoch_ec *eec)
+{
+
+	ck_epoch_barrier_wait(record, ck_epoch_ec_wait, eec);
+	return;
+}
+#endif /* CK_MD_EPOCH_EC_ENABLE */
+
+#endif /* CK_EPOCH_EC_H */
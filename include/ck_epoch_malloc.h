@@ -0,0 +1,209 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_EPOCH_MALLOC_H
+#define CK_EPOCH_MALLOC_H
+
+#include <ck_cc.h>
+#include <ck_epoch.h>
+#include <ck_malloc.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+#include <ck_string.h>
+
+/*
+ * An adapter that implements the defer flag of struct ck_malloc on top
+ * of any allocator: memory freed with the flag set, including the old
+ * object of a deferred realloc, is handed to ck_epoch_call on a record
+ * owned by the thread performing the free and only released to the
+ * backing allocator once a grace period has elapsed. Every object is
+ * prefixed by a header holding its epoch entry, since the object itself
+ * may still be read.
+ */
+#ifndef CK_EPOCH_MALLOC_BATCH
+#define CK_EPOCH_MALLOC_BATCH 64
+#endif
+
+struct ck_epoch_malloc {
+	struct ck_malloc *m;
+	ck_epoch_record_t *record;
+	unsigned int n_deferred;
+	unsigned int batch;
+};
+typedef struct ck_epoch_malloc ck_epoch_malloc_t;
+
+struct ck_epoch_malloc_header {
+	ck_epoch_entry_t epoch_entry;
+	struct ck_malloc *m;
+	size_t size;
+};
+CK_EPOCH_CONTAINER(struct ck_epoch_malloc_header, epoch_entry,
+    ck_epoch_malloc_container)
+
+/*
+ * Deferred frees are reclaimed with ck_epoch_poll on record every batch
+ * deferrals. If batch is 0, reclamation is left to the owner of record.
+ */
+CK_CC_INLINE static void
+ck_epoch_malloc_init(struct ck_epoch_malloc *em,
+    struct ck_malloc *m,
+    ck_epoch_record_t *record,
+    unsigned int batch)
+{
+
+	em->m = m;
+	em->record = record;
+	em->n_deferred = 0;
+	em->batch = batch;
+	return;
+}
+
+CK_CC_INLINE static void *
+ck_epoch_malloc_malloc(struct ck_epoch_malloc *em, size_t size)
+{
+	struct ck_epoch_malloc_header *h;
+
+	h = em->m->malloc(sizeof *h + size);
+	if (h == NULL)
+		return NULL;
+
+	h->m = em->m;
+	h->size = size;
+	return h + 1;
+}
+
+CK_CC_INLINE static void
+ck_epoch_malloc_destroy(ck_epoch_entry_t *e)
+{
+	struct ck_epoch_malloc_header *h = ck_epoch_malloc_container(e);
+
+	h->m->free(h, sizeof *h + h->size, false);
+	return;
+}
+
+CK_CC_INLINE static void
+ck_epoch_malloc_free(struct ck_epoch_malloc *em,
+    void *p,
+    size_t size,
+    bool defer)
+{
+	struct ck_epoch_malloc_header *h;
+
+	if (p == NULL)
+		return;
+
+	h = (struct ck_epoch_malloc_header *)p - 1;
+	(void)size;
+	if (defer == false) {
+		h->m->free(h, sizeof *h + h->size, false);
+		return;
+	}
+
+	ck_epoch_call(em->record, &h->epoch_entry, ck_epoch_malloc_destroy);
+	if (em->batch != 0 && ++em->n_deferred >= em->batch) {
+		em->n_deferred = 0;
+		ck_epoch_poll(em->record);
+	}
+
+	return;
+}
+
+/*
+ * If defer is true, the contents are copied to a new object and the old
+ * object is freed with the defer flag set, rather than being resized in
+ * place by the backing allocator.
+ */
+CK_CC_INLINE static void *
+ck_epoch_malloc_realloc(struct ck_epoch_malloc *em,
+    void *p,
+    size_t old_size,
+    size_t new_size,
+    bool defer)
+{
+	struct ck_epoch_malloc_header *h;
+	void *r;
+
+	if (p != NULL && defer == false && em->m->realloc != NULL) {
+		h = (struct ck_epoch_malloc_header *)p - 1;
+		h = em->m->realloc(h, sizeof *h + h->size,
+		    sizeof *h + new_size, false);
+		if (h == NULL)
+			return NULL;
+
+		h->size = new_size;
+		return h + 1;
+	}
+
+	r = ck_epoch_malloc_malloc(em, new_size);
+	if (r == NULL)
+		return NULL;
+
+	if (p != NULL) {
+		memcpy(r, p, old_size < new_size ? old_size : new_size);
+		ck_epoch_malloc_free(em, p, old_size, defer);
+	}
+
+	return r;
+}
+
+/*
+ * Defines a struct ck_malloc named ck_epoch_malloc_allocator_<name> on
+ * top of the adapter returned by the expression em, which is evaluated
+ * on every call and must yield an adapter whose record is owned by the
+ * calling thread.
+ */
+#define CK_EPOCH_MALLOC_ALLOCATOR(name, em)				\
+static void *								\
+ck_epoch_malloc_malloc_##name(size_t size)				\
+{									\
+									\
+	return ck_epoch_malloc_malloc((em), size);			\
+}									\
+									\
+static void *								\
+ck_epoch_malloc_realloc_##name(void *p, size_t old_size,		\
+    size_t new_size, bool defer)					\
+{									\
+									\
+	return ck_epoch_malloc_realloc((em), p, old_size, new_size,	\
+	    defer);							\
+}									\
+									\
+static void								\
+ck_epoch_malloc_free_##name(void *p, size_t size, bool defer)		\
+{									\
+									\
+	ck_epoch_malloc_free((em), p, size, defer);			\
+	return;								\
+}									\
+									\
+static struct ck_malloc ck_epoch_malloc_allocator_##name CK_CC_UNUSED = { \
+	.malloc = ck_epoch_malloc_malloc_##name,			\
+	.realloc = ck_epoch_malloc_realloc_##name,			\
+	.free = ck_epoch_malloc_free_##name				\
+}
+
+#endif /* CK_EPOCH_MALLOC_H */
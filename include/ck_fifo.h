@@ -33,6 +33,7 @@
 #include <ck_pr.h>
 #include <ck_spinlock.h>
 #include <ck_stddef.h>
+#include <ck_stdint.h>
 
 #ifndef CK_F_FIFO_SPSC
 #define CK_F_FIFO_SPSC
@@ -485,4 +486,214 @@ ck_fifo_mpmc_trydequeue(struct ck_fifo_mpmc *fifo,
 #endif /* CK_F_FIFO_MPMC */
 #endif /* CK_F_PR_CAS_PTR_2 */
 
+#if defined(CK_F_PR_FAA_UINT) && defined(CK_F_PR_CAS_PTR) && \
+    defined(CK_F_PR_FAS_PTR)
+#ifndef CK_F_FIFO_FAA
+#define CK_F_FIFO_FAA
+
+/*
+ * An unbounded multi-producer, multi-consumer FIFO built out of a linked
+ * list of fixed-size array segments. Producers and consumers claim slots
+ * with a fetch-and-add on the tail and head segment respectively, so the
+ * common case costs one atomic increment and one atomic exchange rather
+ * than an allocation and a contended compare-and-swap per entry.
+ *
+ * Segments that have been drained are handed back to the dequeuing thread
+ * as garbage. Other threads may still hold references to them, so they
+ * must be retired through a safe memory reclamation scheme such as ck_epoch
+ * with every operation on the queue occurring inside of an epoch section.
+ */
+#ifndef CK_FIFO_FAA_SEGMENT_SIZE
+#define CK_FIFO_FAA_SEGMENT_SIZE 1024
+#endif
+
+/* Marks a slot as consumed, NULL and this value may not be enqueued. */
+#define CK_FIFO_FAA_TAKEN ((void *)~(uintptr_t)0)
+
+struct ck_fifo_faa_segment {
+	unsigned int c_head;
+	char pad[CK_MD_CACHELINE - sizeof(unsigned int)];
+	unsigned int p_tail;
+	struct ck_fifo_faa_segment *next;
+	void *slots[CK_FIFO_FAA_SEGMENT_SIZE];
+};
+typedef struct ck_fifo_faa_segment ck_fifo_faa_segment_t;
+
+struct ck_fifo_faa {
+	struct ck_fifo_faa_segment *head;
+	char pad[CK_MD_CACHELINE - sizeof(struct ck_fifo_faa_segment *)];
+	struct ck_fifo_faa_segment *tail;
+};
+typedef struct ck_fifo_faa ck_fifo_faa_t;
+
+CK_CC_INLINE static void
+ck_fifo_faa_segment_init(struct ck_fifo_faa_segment *segment)
+{
+	unsigned int i;
+
+	segment->c_head = segment->p_tail = 0;
+	segment->next = NULL;
+	for (i = 0; i < CK_FIFO_FAA_SEGMENT_SIZE; i++)
+		segment->slots[i] = NULL;
+
+	return;
+}
+
+CK_CC_INLINE static void
+ck_fifo_faa_init(struct ck_fifo_faa *fifo, struct ck_fifo_faa_segment *segment)
+{
+
+	ck_fifo_faa_segment_init(segment);
+	fifo->head = fifo->tail = segment;
+	return;
+}
+
+/*
+ * Returns the list of segments that were still linked into the queue,
+ * chained through their next pointers.
+ */
+CK_CC_INLINE static void
+ck_fifo_faa_deinit(struct ck_fifo_faa *fifo,
+		   struct ck_fifo_faa_segment **garbage)
+{
+
+	*garbage = fifo->head;
+	fifo->head = fifo->tail = NULL;
+	return;
+}
+
+/*
+ * Enqueues value, which must not be NULL or CK_FIFO_FAA_TAKEN. If the tail
+ * segment is full, the segment pointed to by spare is linked in and spare
+ * is set to NULL. Returns false, without enqueuing value, if a new segment
+ * is required and spare is NULL. A spare that was not consumed may be kept
+ * for future calls.
+ */
+CK_CC_INLINE static bool
+ck_fifo_faa_enqueue(struct ck_fifo_faa *fifo,
+		    struct ck_fifo_faa_segment **spare,
+		    void *value)
+{
+	struct ck_fifo_faa_segment *tail, *next, *segment;
+	unsigned int i;
+
+	/* Make sure any updates to value are visible before publishing. */
+	ck_pr_fence_store_atomic();
+
+	for (;;) {
+		tail = ck_pr_load_ptr(&fifo->tail);
+		i = ck_pr_faa_uint(&tail->p_tail, 1);
+		if (CK_CC_LIKELY(i < CK_FIFO_FAA_SEGMENT_SIZE)) {
+			/*
+			 * A consumer may have given up on this slot and
+			 * marked it as taken, in which case another slot
+			 * must be claimed.
+			 */
+			if (ck_pr_cas_ptr(&tail->slots[i], NULL, value) == true)
+				return true;
+
+			continue;
+		}
+
+		if (tail != ck_pr_load_ptr(&fifo->tail))
+			continue;
+
+		next = ck_pr_load_ptr(&tail->next);
+		if (next != NULL) {
+			/* Forward the tail past the full segment. */
+			ck_pr_cas_ptr(&fifo->tail, tail, next);
+			continue;
+		}
+
+		segment = *spare;
+		if (segment == NULL)
+			return false;
+
+		/* The new segment is published with value in its first slot. */
+		ck_fifo_faa_segment_init(segment);
+		segment->p_tail = 1;
+		segment->slots[0] = value;
+		ck_pr_fence_store_atomic();
+
+		if (ck_pr_cas_ptr(&tail->next, NULL, segment) == true) {
+			*spare = NULL;
+			ck_pr_fence_atomic();
+			ck_pr_cas_ptr(&fifo->tail, tail, segment);
+			return true;
+		}
+	}
+}
+
+/*
+ * Dequeues the oldest value into the pointer pointed to by value. Returns
+ * false if the queue was observed as empty. If this call unlinked a drained
+ * segment, it is stored in garbage and must be retired by the caller,
+ * otherwise garbage is set to NULL. In the unlikely case that another
+ * segment is drained while this call holds garbage, false is returned with
+ * garbage set and the call may be retried.
+ */
+CK_CC_INLINE static bool
+ck_fifo_faa_dequeue(struct ck_fifo_faa *fifo,
+		    void *value,
+		    struct ck_fifo_faa_segment **garbage)
+{
+	struct ck_fifo_faa_segment *head, *next;
+	unsigned int i;
+	void *r;
+
+	*garbage = NULL;
+	for (;;) {
+		head = ck_pr_load_ptr(&fifo->head);
+
+		/* Avoid write traffic on the head index of an empty queue. */
+		if (ck_pr_load_uint(&head->c_head) >=
+		    ck_pr_load_uint(&head->p_tail) &&
+		    ck_pr_load_ptr(&head->next) == NULL)
+			return false;
+
+		i = ck_pr_faa_uint(&head->c_head, 1);
+		if (CK_CC_LIKELY(i < CK_FIFO_FAA_SEGMENT_SIZE)) {
+			/*
+			 * If the producer that claimed this slot has yet to
+			 * store into it, the slot is burned and the producer
+			 * will retry elsewhere.
+			 */
+			r = ck_pr_fas_ptr(&head->slots[i], CK_FIFO_FAA_TAKEN);
+			if (r == NULL)
+				continue;
+
+			ck_pr_fence_atomic_load();
+			*(void **)value = r;
+			return true;
+		}
+
+		next = ck_pr_load_ptr(&head->next);
+		if (next == NULL)
+			return false;
+
+		if (*garbage != NULL)
+			return false;
+
+		/*
+		 * The producer that linked next may not have forwarded the
+		 * tail yet. The tail is forwarded here, before head is
+		 * unlinked, so that a retired segment is never reachable
+		 * through it.
+		 */
+		if (ck_pr_load_ptr(&fifo->tail) == head) {
+			ck_pr_cas_ptr(&fifo->tail, head, next);
+			ck_pr_fence_atomic();
+		}
+
+		if (ck_pr_cas_ptr(&fifo->head, head, next) == true)
+			*garbage = head;
+	}
+}
+
+#define CK_FIFO_FAA_ISEMPTY(f)						\
+	((f)->head->c_head >= (f)->head->p_tail && (f)->head->next == NULL)
+
+#endif /* CK_F_FIFO_FAA */
+#endif /* CK_F_PR_FAA_UINT && CK_F_PR_CAS_PTR && CK_F_PR_FAS_PTR */
+
 #endif /* CK_FIFO_H */
@@ -41,6 +41,15 @@
  */
 #define CK_HS_MODE_SPMC		1
 
+/*
+ * Indicates a many-writer many-reader workload. Writers are
+ * serialized on a set of write locks selected by hash value
+ * while readers remain lock-free. Writers must be protected by
+ * the same safe memory reclamation mechanism as readers. Mutually
+ * exclusive with CK_HS_MODE_SPMC.
+ */
+#define CK_HS_MODE_MPMC		4
+
 /*
  * Indicates that values to be stored are not pointers but
  * values. Allows for full precision. Mutually exclusive
@@ -62,8 +71,24 @@
  */
 #define CK_HS_MODE_DELETE	16
 
-/* Currently unsupported. */
-#define CK_HS_MODE_MPMC    (void)
+/*
+ * Indicates a lookup-heavy workload with a high rate of misses. A
+ * one byte hash fingerprint is maintained for every slot, so that
+ * probes skip slots and buckets that cannot hold the key at the
+ * cost of one byte of memory per slot. This is a hint and may be
+ * ignored on platforms lacking 64-bit atomic loads.
+ */
+#define CK_HS_MODE_TAG		32
+
+/*
+ * Indicates a latency-sensitive workload. When the set must grow
+ * for load, a map of twice the capacity is published immediately
+ * and the entries of the previous map are migrated by subsequent
+ * write operations, a bounded number of slots at a time. Readers
+ * consult both maps until migration completes. Mutually exclusive
+ * with CK_HS_MODE_MPMC.
+ */
+#define CK_HS_MODE_INCREMENTAL	64
 
 /*
  * Hash callback function.
@@ -75,9 +100,9 @@ typedef unsigned long ck_hs_hash_cb_t(const void *, unsigned long);
  */
 typedef bool ck_hs_compare_cb_t(const void *, const void *);
 
-#if defined(CK_MD_POINTER_PACK_ENABLE) && defined(CK_MD_VMA_BITS)
+#if CK_MD_HS_VMA_BITS != 0
 #define CK_HS_PP
-#define CK_HS_KEY_MASK ((1U << ((sizeof(void *) * 8) - CK_MD_VMA_BITS)) - 1)
+#define CK_HS_KEY_MASK ((1U << ((sizeof(void *) * 8) - CK_MD_HS_VMA_BITS)) - 1)
 #endif
 
 struct ck_hs_map;
@@ -188,6 +213,388 @@ struct ck_hs_init_options {
 
 #define CK_HS_INIT_OPTIONS_INITIALIZER { .options_size = sizeof(struct ck_hs_init_options) }
 
+/*
+ * The layout of the map and the read-side probe are exposed so that
+ * lookups may be specialized with CK_HS_PROTOTYPE. They are internal to
+ * the implementation and are not part of the interface. The parameters
+ * that determine the layout are fixed in ck_md.h when the library is
+ * configured, so that inlined lookups always agree with the library.
+ */
+#define _CK_HS_PROBE_L1_SHIFT CK_MD_HS_PROBE_L1_SHIFT
+
+#define _CK_HS_PROBE_L1 (1 << _CK_HS_PROBE_L1_SHIFT)
+#define _CK_HS_PROBE_L1_MASK (_CK_HS_PROBE_L1 - 1)
+
+#define _CK_HS_VMA_MASK ((uintptr_t)((1ULL << CK_MD_HS_VMA_BITS) - 1))
+#define _CK_HS_VMA(x)	\
+	((void *)((uintptr_t)(x) & _CK_HS_VMA_MASK))
+
+#define _CK_HS_EMPTY     NULL
+#define _CK_HS_TOMBSTONE ((void *)~(uintptr_t)0)
+#define _CK_HS_G		(2)
+#define _CK_HS_G_MASK	(_CK_HS_G - 1)
+
+#if defined(CK_F_PR_LOAD_8) && defined(CK_F_PR_STORE_8)
+#define _CK_HS_WORD         uint8_t
+#define _CK_HS_WORD_MAX	    UINT8_MAX
+#define _CK_HS_STORE(x, y)  ck_pr_store_8(x, y)
+#define _CK_HS_LOAD(x)      ck_pr_load_8(x)
+#elif defined(CK_F_PR_LOAD_16) && defined(CK_F_PR_STORE_16)
+#define _CK_HS_WORD         uint16_t
+#define _CK_HS_WORD_MAX	    UINT16_MAX
+#define _CK_HS_STORE(x, y)  ck_pr_store_16(x, y)
+#define _CK_HS_LOAD(x)      ck_pr_load_16(x)
+#elif defined(CK_F_PR_LOAD_32) && defined(CK_F_PR_STORE_32)
+#define _CK_HS_WORD         uint32_t
+#define _CK_HS_WORD_MAX	    UINT32_MAX
+#define _CK_HS_STORE(x, y)  ck_pr_store_32(x, y)
+#define _CK_HS_LOAD(x)      ck_pr_load_32(x)
+#endif
+
+#ifdef _CK_HS_WORD
+
+/*
+ * In CK_HS_MODE_TAG, every slot has a one byte tag that is either empty,
+ * a tombstone or 7 bits derived from the hash value of its entry (with
+ * the high bit set). The tags of a _CK_HS_PROBE_L1 bucket are
+ * loaded and compared as a single 64-bit word, so that buckets holding
+ * no candidate entry are skipped without touching their slots.
+ */
+#if defined(CK_F_PR_LOAD_64) && defined(CK_F_PR_STORE_8) && \
+    _CK_HS_PROBE_L1_SHIFT == 3
+#define _CK_HS_TAG
+#endif
+
+#define _CK_HS_TAG_EMPTY	0
+#define _CK_HS_TAG_TOMBSTONE	1
+#define _CK_HS_TAG_FULL		0x80
+#define _CK_HS_TAG_LSB		0x0101010101010101ULL
+#define _CK_HS_TAG_MSB		0x8080808080808080ULL
+#define _CK_HS_TAG_MIX		0x9e3779b97f4a7c15ULL
+
+/*
+ * The key offset is stored in the high bits of the mode field in
+ * ck_hs_t.  This is binary compatible with all existing clients
+ * across all architectures.
+ */
+#define _CK_HS_MODE_KEY_OFFSET_BITS 16
+
+enum _ck_hs_probe_behavior {
+	_CK_HS_PROBE = 0,	/* Default behavior. */
+	_CK_HS_PROBE_TOMBSTONE,	/* Short-circuit on tombstone. */
+	_CK_HS_PROBE_INSERT	/* Short-circuit on bound if tombstone found. */
+};
+
+struct ck_hs_lock;
+
+struct ck_hs_map {
+	unsigned int generation[_CK_HS_G];
+	unsigned int probe_maximum;
+	unsigned long mask;
+	unsigned long step;
+	unsigned int probe_limit;
+	unsigned int tombstones;
+	uintptr_t n_entries;
+	unsigned long capacity;
+	unsigned long size;
+	_CK_HS_WORD *probe_bound;
+	unsigned long lock_mask;
+	struct ck_hs_lock *locks;
+	uint8_t *tags;
+	struct ck_hs_map *drain;
+	unsigned long drained;
+	const void **entries;
+};
+
+/*
+ * Many hash functions only produce 32-bit values, which leave the high
+ * bits of an unsigned long clear on LP64. The hash value is multiplied
+ * so that the high-order bits the tag is taken from depend on every bit
+ * of the hash value.
+ */
+CK_CC_INLINE static unsigned int
+_ck_hs_tag(unsigned long h)
+{
+
+	h *= (unsigned long)_CK_HS_TAG_MIX;
+	return _CK_HS_TAG_FULL | (unsigned int)(h >> (sizeof(h) * 8 - 7));
+}
+
+#ifdef _CK_HS_TAG
+/*
+ * Returns true if no slot of the bucket may hold an entry with the
+ * specified tag, that is, if every slot is occupied by an entry with a
+ * different tag. Zero bytes are found with the usual borrow trick, which
+ * may only report false positives.
+ */
+CK_CC_INLINE static bool
+_ck_hs_tag_skip(uint64_t group, unsigned int tag)
+{
+	uint64_t match = group ^ (_CK_HS_TAG_LSB * tag);
+
+	if ((group & _CK_HS_TAG_MSB) != _CK_HS_TAG_MSB)
+		return false;
+
+	return ((match - _CK_HS_TAG_LSB) & ~match & _CK_HS_TAG_MSB) == 0;
+}
+#endif
+
+CK_CC_INLINE static unsigned long
+_ck_hs_map_probe_next(struct ck_hs_map *map,
+    unsigned long offset,
+    unsigned long h,
+    unsigned long level,
+    unsigned long probes)
+{
+	unsigned long r, stride;
+
+	r = (h >> map->step) >> level;
+	stride = (r & ~_CK_HS_PROBE_L1_MASK) << 1 | (r & _CK_HS_PROBE_L1_MASK);
+
+	return (offset + (probes >> _CK_HS_PROBE_L1_SHIFT) +
+	    (stride | _CK_HS_PROBE_L1)) & map->mask;
+}
+
+CK_CC_INLINE static unsigned int
+_ck_hs_map_bound_get(struct ck_hs_map *m, unsigned long h)
+{
+	unsigned long offset = h & m->mask;
+	unsigned int r = _CK_HS_WORD_MAX;
+
+	if (m->probe_bound != NULL) {
+		r = _CK_HS_LOAD(&m->probe_bound[offset]);
+		if (r == _CK_HS_WORD_MAX)
+			r = ck_pr_load_uint(&m->probe_maximum);
+	} else {
+		r = ck_pr_load_uint(&m->probe_maximum);
+	}
+
+	return r;
+}
+
+CK_CC_INLINE static const void *
+_ck_hs_apply_key_offset(const struct ck_hs *hs, const void *obj)
+{
+	unsigned int key_offset = hs->mode >> _CK_HS_MODE_KEY_OFFSET_BITS;
+	return (const unsigned char *)obj + key_offset;
+}
+
+CK_CC_FORCE_INLINE static const void **
+_ck_hs_map_probe(struct ck_hs *hs,
+    struct ck_hs_map *map,
+    unsigned long *n_probes,
+    const void ***priority,
+    unsigned long h,
+    const void *key,
+    const void **object,
+    unsigned long probe_limit,
+    enum _ck_hs_probe_behavior behavior,
+    ck_hs_compare_cb_t *compare)
+{
+	const void **bucket, **cursor, *val, *val_key, *compare_key;
+	const void **pr = NULL;
+	unsigned long offset, j, i, probes, opl;
+#ifdef _CK_HS_TAG
+	unsigned int tag = _ck_hs_tag(h);
+	union {
+		uint64_t word;
+		uint8_t slot[_CK_HS_PROBE_L1];
+	} group;
+#endif
+
+#ifdef CK_HS_PP
+	/* If we are storing object pointers, then we may leverage pointer packing. */
+	unsigned long hv = 0;
+
+	if (hs->mode & CK_HS_MODE_OBJECT) {
+		hv = (h >> 25) & CK_HS_KEY_MASK;
+		compare_key = _CK_HS_VMA(key);
+	} else {
+		compare_key = key;
+	}
+#else
+	compare_key = key;
+#endif
+
+	offset = h & map->mask;
+	*object = NULL;
+	i = probes = 0;
+
+	opl = probe_limit;
+	if (behavior == _CK_HS_PROBE_INSERT)
+		probe_limit = _ck_hs_map_bound_get(map, h);
+
+	for (;;) {
+		bucket = (const void **)((uintptr_t)&map->entries[offset] & ~(CK_MD_CACHELINE - 1));
+
+#ifdef _CK_HS_TAG
+		if (map->tags != NULL) {
+			group.word = ck_pr_load_64((uint64_t *)(void *)
+			    &map->tags[bucket - map->entries]);
+			ck_pr_fence_load();
+
+			/*
+			 * A bucket with no candidate, empty slot or tombstone
+			 * is skipped as a whole if doing so would not cross
+			 * the probe limit.
+			 */
+			if (_ck_hs_tag_skip(group.word, tag) == true &&
+			    probes + _CK_HS_PROBE_L1 <= probe_limit) {
+				probes += _CK_HS_PROBE_L1;
+				offset = _ck_hs_map_probe_next(map, offset, h, i++, probes);
+				continue;
+			}
+		}
+#endif
+
+		for (j = 0; j < _CK_HS_PROBE_L1; j++) {
+			cursor = bucket + ((j + offset) & (_CK_HS_PROBE_L1 - 1));
+
+			if (probes++ == probe_limit) {
+				if (probe_limit == opl || pr != NULL) {
+					val = _CK_HS_EMPTY;
+					goto leave;
+				}
+
+				/*
+				 * If no eligible slot has been found yet, continue probe
+				 * sequence with original probe limit.
+				 */
+				probe_limit = opl;
+			}
+
+#ifdef _CK_HS_TAG
+			if (map->tags != NULL) {
+				unsigned int t = group.slot[cursor - bucket];
+
+				if (t == _CK_HS_TAG_EMPTY) {
+					val = _CK_HS_EMPTY;
+					goto leave;
+				}
+
+				/* Tombstones are confirmed by the slot itself. */
+				if (t != tag && t != _CK_HS_TAG_TOMBSTONE)
+					continue;
+			}
+#endif
+
+			val = ck_pr_load_ptr(cursor);
+			if (val == _CK_HS_EMPTY)
+				goto leave;
+
+			if (val == _CK_HS_TOMBSTONE) {
+				if (pr == NULL) {
+					pr = cursor;
+					*n_probes = probes;
+
+					if (behavior ==
+					    _CK_HS_PROBE_TOMBSTONE) {
+						val = _CK_HS_EMPTY;
+						goto leave;
+					}
+				}
+
+				continue;
+			}
+
+#ifdef CK_HS_PP
+			if (hs->mode & CK_HS_MODE_OBJECT) {
+				if (((uintptr_t)val >> CK_MD_HS_VMA_BITS) != hv)
+					continue;
+
+				val = _CK_HS_VMA(val);
+			}
+#endif
+
+			val_key = _ck_hs_apply_key_offset(hs, val);
+			if (val_key == compare_key)
+				goto leave;
+
+			if (compare == NULL)
+				continue;
+
+			if (compare(val_key, key) == true)
+				goto leave;
+		}
+
+		offset = _ck_hs_map_probe_next(map, offset, h, i++, probes);
+	}
+
+leave:
+	if (probes > probe_limit) {
+		cursor = NULL;
+	} else {
+		*object = val;
+	}
+
+	if (pr == NULL)
+		*n_probes = probes;
+
+	*priority = pr;
+	return cursor;
+}
+
+/*
+ * If the map is draining another, a key that is not found in the map is
+ * looked up in the drained map. An entry is migrated by storing it into
+ * the map before removing it from the drained map, so a probe that misses
+ * both copies observes a new generation of the drained map. The generation
+ * of the drained map is read first, so that the probe bound read from the
+ * map reflects any migration it precedes. A miss on a map that has since
+ * been replaced is retried, as its entries may already have been migrated.
+ */
+CK_CC_FORCE_INLINE static void *
+_ck_hs_get(struct ck_hs *hs,
+    unsigned long h,
+    const void *key,
+    ck_hs_compare_cb_t *compare)
+{
+	const void **first, *object;
+	struct ck_hs_map *map, *drain;
+	unsigned long n_probes;
+	unsigned int g, g_p, d, d_p, probe;
+	unsigned int *generation, *drain_generation;
+
+	do {
+		map = ck_pr_load_ptr(&hs->map);
+		drain = ck_pr_load_ptr(&map->drain);
+		if (drain != NULL) {
+			drain_generation =
+			    &drain->generation[h & _CK_HS_G_MASK];
+			d = ck_pr_load_uint(drain_generation);
+			ck_pr_fence_load();
+		}
+
+		/*
+		 * We avoid a load fence here on and instead rely on the subsequent
+		 * ordered load (a stale value is benign and leads to a reprobe).
+		 */
+		generation = &map->generation[h & _CK_HS_G_MASK];
+		g = ck_pr_load_uint(generation);
+		probe  = _ck_hs_map_bound_get(map, h);
+		ck_pr_fence_load();
+
+		_ck_hs_map_probe(hs, map, &n_probes, &first, h, key, &object,
+		    probe, _CK_HS_PROBE, compare);
+		if (object == NULL && drain != NULL) {
+			_ck_hs_map_probe(hs, drain, &n_probes, &first, h, key,
+			    &object, _ck_hs_map_bound_get(drain, h),
+			    _CK_HS_PROBE, compare);
+		} else {
+			drain = NULL;
+		}
+
+		ck_pr_fence_load();
+		g_p = ck_pr_load_uint(generation);
+		if (drain != NULL)
+			d_p = ck_pr_load_uint(drain_generation);
+	} while (g != g_p || (drain != NULL && d != d_p) ||
+	    (object == NULL && ck_pr_load_ptr(&hs->map) != map));
+
+	return CK_CC_DECONST_PTR(object);
+}
+#endif /* _CK_HS_WORD */
+
 typedef void *ck_hs_apply_fn_t(void *, void *);
 bool ck_hs_apply(ck_hs_t *, unsigned long, const void *, ck_hs_apply_fn_t *, void *);
 void ck_hs_iterator_init(ck_hs_iterator_t *);
@@ -198,7 +605,13 @@ bool ck_hs_move(ck_hs_t *, ck_hs_t *, ck_hs_hash_cb_t *,
 bool ck_hs_init(ck_hs_t *, unsigned int, ck_hs_hash_cb_t *,
     ck_hs_compare_cb_t *, struct ck_malloc *, unsigned long, unsigned long);
 bool ck_hs_init_from_options(ck_hs_t *, const struct ck_hs_init_options *);
+bool ck_hs_init_snapshot(ck_hs_t *, ck_hs_hash_cb_t *, ck_hs_compare_cb_t *,
+    struct ck_malloc *, const void *, size_t);
+size_t ck_hs_snapshot_size(ck_hs_t *);
+bool ck_hs_snapshot(ck_hs_t *, void *, size_t);
 void *ck_hs_get(ck_hs_t *, unsigned long, const void *);
+void ck_hs_get_batch(ck_hs_t *, const unsigned long *, const void *const *,
+    void **, size_t);
 bool ck_hs_put(ck_hs_t *, unsigned long, const void *);
 bool ck_hs_put_unique(ck_hs_t *, unsigned long, const void *);
 bool ck_hs_set(ck_hs_t *, unsigned long, const void *, void **);
@@ -215,4 +628,124 @@ void ck_hs_deinit(ck_hs_t *);
 
 void ck_hs_destroy(ck_hs_t *) CK_CC_DEPRECATED("use ck_hs_deinit instead");
 
+#ifdef _CK_HS_WORD
+/*
+ * CK_HS_PROTOTYPE defines a type-safe interface to a set of objects of
+ * type struct type, with the hash and comparison functions inlined into
+ * lookups. The hash function is of type
+ *   unsigned long hash_fn(const struct type *, unsigned long seed);
+ * and the comparison function of type
+ *   bool cmp_fn(const struct type *, const struct type *);
+ * A set must be initialized with ck_hs_init_<name> and may then be used
+ * with both the typed and the generic interface. Lookups are specialized
+ * into a single function per prototype, while write operations call the
+ * comparison function through the set.
+ */
+#define CK_HS_PROTOTYPE(name, type, hash_fn, cmp_fn)			\
+CK_CC_INLINE static unsigned long					\
+_ck_hs_hf_##name(const void *k, unsigned long seed)			\
+{									\
+									\
+	return hash_fn((const struct type *)k, seed);			\
+}									\
+									\
+CK_CC_INLINE static bool						\
+_ck_hs_compare_##name(const void *a, const void *b)			\
+{									\
+									\
+	return cmp_fn((const struct type *)a, (const struct type *)b);	\
+}									\
+									\
+CK_CC_INLINE static bool						\
+ck_hs_init_##name(struct ck_hs *hs,					\
+    unsigned int mode,							\
+    struct ck_malloc *m,						\
+    unsigned long capacity,						\
+    unsigned long seed)							\
+{									\
+									\
+	return ck_hs_init(hs, mode, _ck_hs_hf_##name,			\
+	    _ck_hs_compare_##name, m, capacity, seed);			\
+}									\
+									\
+CK_CC_INLINE static unsigned long					\
+ck_hs_hash_##name(const struct ck_hs *hs, const struct type *key)	\
+{									\
+									\
+	return hash_fn(key, hs->seed);					\
+}									\
+									\
+CK_CC_UNUSED static struct type *					\
+ck_hs_get_##name(struct ck_hs *hs, const struct type *key)		\
+{									\
+									\
+	return _ck_hs_get(hs, hash_fn(key, hs->seed), key,		\
+	    _ck_hs_compare_##name);					\
+}									\
+									\
+CK_CC_INLINE static bool						\
+ck_hs_put_##name(struct ck_hs *hs, const struct type *key)		\
+{									\
+									\
+	return ck_hs_put(hs, hash_fn(key, hs->seed), key);		\
+}									\
+									\
+CK_CC_INLINE static bool						\
+ck_hs_put_unique_##name(struct ck_hs *hs, const struct type *key)	\
+{									\
+									\
+	return ck_hs_put_unique(hs, hash_fn(key, hs->seed), key);	\
+}									\
+									\
+CK_CC_INLINE static bool						\
+ck_hs_set_##name(struct ck_hs *hs,					\
+    const struct type *key,						\
+    struct type **previous)						\
+{									\
+	void *p;							\
+									\
+	if (ck_hs_set(hs, hash_fn(key, hs->seed), key, &p) == false)	\
+		return false;						\
+									\
+	*previous = p;							\
+	return true;							\
+}									\
+									\
+CK_CC_INLINE static bool						\
+ck_hs_fas_##name(struct ck_hs *hs,					\
+    const struct type *key,						\
+    struct type **previous)						\
+{									\
+	void *p;							\
+									\
+	if (ck_hs_fas(hs, hash_fn(key, hs->seed), key, &p) == false)	\
+		return false;						\
+									\
+	*previous = p;							\
+	return true;							\
+}									\
+									\
+CK_CC_INLINE static struct type *					\
+ck_hs_remove_##name(struct ck_hs *hs, const struct type *key)		\
+{									\
+									\
+	return ck_hs_remove(hs, hash_fn(key, hs->seed), key);		\
+}
+
+#define CK_HS_INIT(name, hs, mode, m, capacity, seed)			\
+	ck_hs_init_##name(hs, mode, m, capacity, seed)
+#define CK_HS_GET(name, hs, key)					\
+	ck_hs_get_##name(hs, key)
+#define CK_HS_PUT(name, hs, key)					\
+	ck_hs_put_##name(hs, key)
+#define CK_HS_PUT_UNIQUE(name, hs, key)					\
+	ck_hs_put_unique_##name(hs, key)
+#define CK_HS_SET(name, hs, key, previous)				\
+	ck_hs_set_##name(hs, key, previous)
+#define CK_HS_FAS(name, hs, key, previous)				\
+	ck_hs_fas_##name(hs, key, previous)
+#define CK_HS_REMOVE(name, hs, key)					\
+	ck_hs_remove_##name(hs, key)
+#endif /* _CK_HS_WORD */
+
 #endif /* CK_HS_H */
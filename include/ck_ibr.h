@@ -0,0 +1,197 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_IBR_H
+#define CK_IBR_H
+
+/*
+ * Interval-based reclamation, as described in "Interval-Based Memory
+ * Reclamation" by Wen, Izraelevitz, Cai, Beadle and Scott. Every object
+ * is stamped with the era of its allocation and of its retirement, and
+ * every read-side section reserves the interval of eras it has observed.
+ * An object is reclaimed once no reservation overlaps its lifetime, so a
+ * stalled reader only holds back objects that were alive while it was
+ * reading, rather than every object retired after it began.
+ */
+
+#include <ck_cc.h>
+#include <ck_md.h>
+#include <ck_pr.h>
+#include <ck_stack.h>
+#include <ck_stdbool.h>
+
+/* Number of retirements by a record before it advances the global era. */
+#ifndef CK_IBR_FREQUENCY
+#define CK_IBR_FREQUENCY 64
+#endif
+
+/* Number of pending objects of a record that triggers reclamation. */
+#ifndef CK_IBR_THRESHOLD
+#define CK_IBR_THRESHOLD 128
+#endif
+
+struct ck_ibr_entry;
+typedef struct ck_ibr_entry ck_ibr_entry_t;
+typedef void ck_ibr_cb_t(ck_ibr_entry_t *);
+
+struct ck_ibr_entry {
+	unsigned int birth;
+	unsigned int retire;
+	ck_ibr_cb_t *function;
+	ck_stack_entry_t stack_entry;
+};
+
+#define CK_IBR_CONTAINER(T, M, N) \
+	CK_CC_CONTAINER(struct ck_ibr_entry, T, M, N)
+
+struct ck_ibr_record {
+	ck_stack_entry_t record_next;
+	struct ck_ibr *global;
+	unsigned int state;
+	unsigned int active;
+	unsigned int lower;
+	unsigned int upper;
+	unsigned int n_retire;
+	unsigned int n_pending;
+	unsigned int n_peak;
+	unsigned int n_dispatch;
+	void *ct;
+	ck_stack_t pending;
+} CK_CC_CACHELINE;
+typedef struct ck_ibr_record ck_ibr_record_t;
+
+struct ck_ibr {
+	unsigned int era;
+	unsigned int n_free;
+	ck_stack_t records;
+};
+typedef struct ck_ibr ck_ibr_t;
+
+/*
+ * Stamps an object with its birth era. This must be called before the
+ * object is made reachable by readers.
+ */
+CK_CC_FORCE_INLINE static void
+ck_ibr_entry_init(ck_ibr_record_t *record, ck_ibr_entry_t *entry)
+{
+
+	entry->birth = ck_pr_load_uint(&record->global->era);
+	return;
+}
+
+CK_CC_FORCE_INLINE static void
+ck_ibr_begin(ck_ibr_record_t *record)
+{
+	unsigned int era;
+
+	if (record->active == 0) {
+		era = ck_pr_load_uint(&record->global->era);
+		ck_pr_store_uint(&record->lower, era);
+		ck_pr_store_uint(&record->upper, era);
+		ck_pr_fence_store();
+
+		/*
+		 * The reservation must be visible before any pointer of
+		 * the section is loaded.
+		 */
+#if defined(CK_MD_TSO)
+		ck_pr_fas_uint(&record->active, 1);
+		ck_pr_fence_atomic_load();
+#else
+		ck_pr_store_uint(&record->active, 1);
+		ck_pr_fence_memory();
+#endif
+	} else {
+		ck_pr_store_uint(&record->active, record->active + 1);
+	}
+
+	return;
+}
+
+CK_CC_FORCE_INLINE static bool
+ck_ibr_end(ck_ibr_record_t *record)
+{
+
+	ck_pr_fence_release();
+	ck_pr_store_uint(&record->active, record->active - 1);
+	return record->active == 0;
+}
+
+/*
+ * Loads a pointer to an object protected by the section, extending the
+ * reservation of the section to the current era if necessary. An object
+ * may only be dereferenced if it was loaded with this function.
+ */
+CK_CC_FORCE_INLINE static void *
+ck_ibr_read(ck_ibr_record_t *record, void *target)
+{
+	unsigned int era;
+	void *pointer;
+
+	for (;;) {
+		pointer = ck_pr_load_ptr((void **)target);
+
+		/*
+		 * The object was born no later than the era observed after
+		 * its pointer, which is then covered by the reservation.
+		 */
+		ck_pr_fence_load();
+		era = ck_pr_load_uint(&record->global->era);
+		if (CK_CC_LIKELY(era == record->upper))
+			break;
+
+		ck_pr_store_uint(&record->upper, era);
+		ck_pr_fence_store_load();
+	}
+
+	return pointer;
+}
+
+void ck_ibr_init(ck_ibr_t *);
+ck_ibr_record_t *ck_ibr_recycle(ck_ibr_t *, void *);
+void ck_ibr_register(ck_ibr_t *, ck_ibr_record_t *, void *);
+void ck_ibr_unregister(ck_ibr_record_t *);
+
+/*
+ * Retires an object that is no longer reachable by new readers. The
+ * function is called once no section may still hold a reference to it.
+ * Only the owner of the record may retire objects to it.
+ */
+void ck_ibr_retire(ck_ibr_record_t *, ck_ibr_entry_t *, ck_ibr_cb_t *);
+
+/* Reclaims every retired object of the record that is safe to reclaim. */
+unsigned int ck_ibr_reclaim(ck_ibr_record_t *);
+
+/*
+ * Waits until every section active at invocation has ended. This must
+ * not be called within a section.
+ */
+void ck_ibr_synchronize(ck_ibr_record_t *);
+
+/* Waits for a grace period and reclaims every retired object. */
+void ck_ibr_barrier(ck_ibr_record_t *);
+
+#endif /* CK_IBR_H */
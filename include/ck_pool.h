@@ -0,0 +1,215 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_POOL_H
+#define CK_POOL_H
+
+#include <ck_cc.h>
+#include <ck_epoch.h>
+#include <ck_malloc.h>
+#include <ck_md.h>
+#include <ck_pr.h>
+#include <ck_stack.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+
+/*
+ * An object allocator implementing struct ck_malloc. Objects are binned
+ * into power of 2 size classes. Every thread allocates from and frees to a
+ * private cache of free lists, which exchanges objects with the shared
+ * free lists of the pool in batches, and only the shared lists are
+ * refilled from slabs obtained from a backing allocator. Objects larger
+ * than the largest class are handed to the backing allocator directly.
+ *
+ * If the cache of a thread is bound to a ck_epoch record, frees with the
+ * defer flag set are routed through ck_epoch_call on that record and the
+ * object is returned to the pool once a grace period has elapsed.
+ */
+#define CK_POOL_CLASS_SHIFT	5
+#define CK_POOL_CLASSES		9
+#define CK_POOL_CLASS_MIN	(1UL << CK_POOL_CLASS_SHIFT)
+#define CK_POOL_CLASS_MAX	(CK_POOL_CLASS_MIN << (CK_POOL_CLASSES - 1))
+
+/* Number of bytes held by a cache per size class before it is flushed. */
+#ifndef CK_POOL_CACHE_SIZE
+#define CK_POOL_CACHE_SIZE	65536
+#endif
+
+/* Number of bytes requested from the backing allocator per slab. */
+#ifndef CK_POOL_SLAB_SIZE
+#define CK_POOL_SLAB_SIZE	65536
+#endif
+
+struct ck_pool_class {
+	ck_stack_t free;
+} CK_CC_CACHELINE;
+
+struct ck_pool {
+	struct ck_pool_class classes[CK_POOL_CLASSES];
+	ck_stack_t slabs;
+	struct ck_malloc *m;
+};
+typedef struct ck_pool ck_pool_t;
+
+struct ck_pool_list {
+	ck_stack_entry_t *head;
+	unsigned int n_entries;
+	unsigned int limit;
+};
+
+struct ck_pool_cache {
+	struct ck_pool *pool;
+	ck_epoch_record_t *record;
+	struct ck_pool_list lists[CK_POOL_CLASSES];
+};
+typedef struct ck_pool_cache ck_pool_cache_t;
+
+bool ck_pool_init(ck_pool_t *, struct ck_malloc *);
+void ck_pool_deinit(ck_pool_t *);
+void ck_pool_cache_init(ck_pool_cache_t *, ck_pool_t *, ck_epoch_record_t *);
+void ck_pool_cache_flush(ck_pool_cache_t *);
+void *ck_pool_realloc(ck_pool_cache_t *, void *, size_t, size_t, bool);
+
+/* Slow paths of ck_pool_malloc and ck_pool_free, not to be used directly. */
+void *ck_pool_refill(ck_pool_cache_t *, unsigned int);
+void ck_pool_drain(ck_pool_cache_t *, unsigned int);
+void *ck_pool_malloc_large(ck_pool_cache_t *, size_t);
+void ck_pool_free_slow(ck_pool_cache_t *, void *, size_t, bool);
+
+/* Returns the size class of an allocation no larger than the largest. */
+CK_CC_INLINE static unsigned int
+ck_pool_class(size_t size)
+{
+	unsigned int v;
+
+	if (size <= CK_POOL_CLASS_MIN)
+		return 0;
+
+	v = (unsigned int)size - 1;
+	v |= v >> 1;
+	v |= v >> 2;
+	v |= v >> 4;
+	v |= v >> 8;
+	v |= v >> 16;
+	return ck_cc_ctz(v + 1) - CK_POOL_CLASS_SHIFT;
+}
+
+/*
+ * Allocates an object of at least size bytes from the cache, which must
+ * only be used by one thread at a time.
+ */
+CK_CC_INLINE static void *
+ck_pool_malloc(struct ck_pool_cache *cache, size_t size)
+{
+	struct ck_pool_list *list;
+	ck_stack_entry_t *object;
+	unsigned int c;
+
+	if (CK_CC_UNLIKELY(size > CK_POOL_CLASS_MAX))
+		return ck_pool_malloc_large(cache, size);
+
+	c = ck_pool_class(size);
+	list = &cache->lists[c];
+	object = list->head;
+	if (CK_CC_UNLIKELY(object == NULL))
+		return ck_pool_refill(cache, c);
+
+	list->head = object->next;
+	list->n_entries--;
+	return object;
+}
+
+/*
+ * Frees an object of size bytes to the cache. The object may have been
+ * allocated from any cache of the same pool. If defer is true and the
+ * cache is bound to an epoch record, the object only becomes available
+ * for allocation once no thread may still be referencing it. Otherwise,
+ * the defer flag is only passed on to the backing allocator for objects
+ * larger than the largest class.
+ */
+CK_CC_INLINE static void
+ck_pool_free(struct ck_pool_cache *cache, void *p, size_t size, bool defer)
+{
+	struct ck_pool_list *list;
+	ck_stack_entry_t *object = p;
+	unsigned int c;
+
+	if (CK_CC_UNLIKELY(p == NULL))
+		return;
+
+	if (CK_CC_UNLIKELY(size > CK_POOL_CLASS_MAX ||
+	    (defer == true && cache->record != NULL))) {
+		ck_pool_free_slow(cache, p, size, defer);
+		return;
+	}
+
+	c = ck_pool_class(size);
+	list = &cache->lists[c];
+	object->next = list->head;
+	list->head = object;
+	if (CK_CC_UNLIKELY(++list->n_entries > list->limit))
+		ck_pool_drain(cache, c);
+
+	return;
+}
+
+/*
+ * Defines a struct ck_malloc named ck_pool_allocator_<name> on top of the
+ * cache returned by the expression cache, which is evaluated on every call
+ * and must yield the cache of the calling thread, for example through a
+ * thread-local variable.
+ */
+#define CK_POOL_ALLOCATOR(name, cache)					\
+static void *								\
+ck_pool_malloc_##name(size_t size)					\
+{									\
+									\
+	return ck_pool_malloc((cache), size);				\
+}									\
+									\
+static void *								\
+ck_pool_realloc_##name(void *p, size_t old_size, size_t new_size,	\
+    bool defer)								\
+{									\
+									\
+	return ck_pool_realloc((cache), p, old_size, new_size, defer);	\
+}									\
+									\
+static void								\
+ck_pool_free_##name(void *p, size_t size, bool defer)			\
+{									\
+									\
+	ck_pool_free((cache), p, size, defer);				\
+	return;								\
+}									\
+									\
+static struct ck_malloc ck_pool_allocator_##name CK_CC_UNUSED = {	\
+	.malloc = ck_pool_malloc_##name,				\
+	.realloc = ck_pool_realloc_##name,				\
+	.free = ck_pool_free_##name					\
+}
+
+#endif /* CK_POOL_H */
@@ -61,6 +61,15 @@
  */
 #define CK_RHS_MODE_READ_MOSTLY	16
 
+/*
+ * Indicates a latency-sensitive workload. When the set must grow
+ * for load, a map of twice the capacity is published immediately
+ * and the entries of the previous map are migrated by subsequent
+ * write operations, a bounded number of slots at a time. Readers
+ * consult both maps until migration completes.
+ */
+#define CK_RHS_MODE_INCREMENTAL	32
+
 /* Currently unsupported. */
 #define CK_RHS_MODE_MPMC    (void)
 
@@ -117,8 +126,12 @@ bool ck_rhs_init(ck_rhs_t *, unsigned int, ck_rhs_hash_cb_t *,
     ck_rhs_compare_cb_t *, struct ck_malloc *, unsigned long, unsigned long);
 void ck_rhs_destroy(ck_rhs_t *);
 void *ck_rhs_get(ck_rhs_t *, unsigned long, const void *);
+void ck_rhs_get_batch(ck_rhs_t *, const unsigned long *, const void *const *,
+    void **, size_t);
 bool ck_rhs_put(ck_rhs_t *, unsigned long, const void *);
 bool ck_rhs_put_unique(ck_rhs_t *, unsigned long, const void *);
+bool ck_rhs_put_bulk(ck_rhs_t *, const unsigned long *, const void *const *,
+    size_t);
 bool ck_rhs_set(ck_rhs_t *, unsigned long, const void *, void **);
 bool ck_rhs_fas(ck_rhs_t *, unsigned long, const void *, void **);
 void *ck_rhs_remove(ck_rhs_t *, unsigned long, const void *);
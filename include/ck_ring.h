@@ -488,6 +488,195 @@ _ck_ring_dequeue_mc(struct ck_ring *ring,
 	return true;
 }
 
+/*
+ * Burst operations transfer up to n entries with a single update of the
+ * shared counters, returning the number of entries transferred. Slots
+ * are copied in at most two passes, as a burst may wrap around the end
+ * of the buffer.
+ */
+CK_CC_FORCE_INLINE static void
+_ck_ring_burst_copy_in(unsigned int mask,
+    void *CK_CC_RESTRICT buffer,
+    const void *CK_CC_RESTRICT entries,
+    unsigned int ts,
+    unsigned int position,
+    unsigned int n)
+{
+	unsigned int offset = position & mask;
+	unsigned int first = mask + 1 - offset;
+
+	if (first > n)
+		first = n;
+
+	memcpy((char *)buffer + ts * offset, entries, ts * first);
+	memcpy(buffer, (const char *)entries + ts * first, ts * (n - first));
+	return;
+}
+
+CK_CC_FORCE_INLINE static void
+_ck_ring_burst_copy_out(unsigned int mask,
+    const void *CK_CC_RESTRICT buffer,
+    void *CK_CC_RESTRICT target,
+    unsigned int ts,
+    unsigned int position,
+    unsigned int n)
+{
+	unsigned int offset = position & mask;
+	unsigned int first = mask + 1 - offset;
+
+	if (first > n)
+		first = n;
+
+	memcpy(target, (const char *)buffer + ts * offset, ts * first);
+	memcpy((char *)target + ts * first, buffer, ts * (n - first));
+	return;
+}
+
+CK_CC_FORCE_INLINE static unsigned int
+_ck_ring_enqueue_burst_sp(struct ck_ring *ring,
+    void *CK_CC_RESTRICT buffer,
+    const void *CK_CC_RESTRICT entries,
+    unsigned int ts,
+    unsigned int n)
+{
+	unsigned int consumer, producer, available;
+
+	consumer = ck_pr_load_uint(&ring->c_head);
+	producer = ring->p_tail;
+	available = ring->mask - (producer - consumer);
+	if (n > available)
+		n = available;
+
+	if (CK_CC_UNLIKELY(n == 0))
+		return 0;
+
+	_ck_ring_burst_copy_in(ring->mask, buffer, entries, ts, producer, n);
+
+	/*
+	 * Make sure to update slot values before indicating
+	 * that the slots are available for consumption.
+	 */
+	ck_pr_fence_store();
+	ck_pr_store_uint(&ring->p_tail, producer + n);
+	return n;
+}
+
+CK_CC_FORCE_INLINE static unsigned int
+_ck_ring_enqueue_burst_mp(struct ck_ring *ring,
+    void *buffer,
+    const void *entries,
+    unsigned int ts,
+    unsigned int n)
+{
+	const unsigned int mask = ring->mask;
+	unsigned int producer, consumer, available;
+
+	producer = ck_pr_load_uint(&ring->p_head);
+
+	for (;;) {
+		ck_pr_fence_load();
+		consumer = ck_pr_load_uint(&ring->c_head);
+
+		/*
+		 * As with _ck_ring_enqueue_mp, a full ring and a stale
+		 * snapshot of p_head are told apart by reading p_head again.
+		 */
+		if (CK_CC_LIKELY((producer - consumer) < mask)) {
+			available = mask - (producer - consumer);
+			if (available > n)
+				available = n;
+
+			if (ck_pr_cas_uint_value(&ring->p_head,
+			    producer, producer + available, &producer) == true) {
+				n = available;
+				break;
+			}
+		} else {
+			unsigned int new_producer;
+
+			ck_pr_fence_load();
+			new_producer = ck_pr_load_uint(&ring->p_head);
+			if (producer == new_producer)
+				return 0;
+
+			producer = new_producer;
+		}
+	}
+
+	_ck_ring_burst_copy_in(ring->mask, buffer, entries, ts, producer, n);
+
+	/*
+	 * Producers publish their reservations in order, so wait for
+	 * preceding producers to complete.
+	 */
+	while (ck_pr_load_uint(&ring->p_tail) != producer)
+		ck_pr_stall();
+
+	ck_pr_fence_store();
+	ck_pr_store_uint(&ring->p_tail, producer + n);
+	return n;
+}
+
+CK_CC_FORCE_INLINE static unsigned int
+_ck_ring_dequeue_burst_sc(struct ck_ring *ring,
+    const void *CK_CC_RESTRICT buffer,
+    void *CK_CC_RESTRICT target,
+    unsigned int ts,
+    unsigned int n)
+{
+	unsigned int consumer, producer;
+
+	consumer = ring->c_head;
+	producer = ck_pr_load_uint(&ring->p_tail);
+	if (n > producer - consumer)
+		n = producer - consumer;
+
+	if (CK_CC_UNLIKELY(n == 0))
+		return 0;
+
+	ck_pr_fence_load();
+	_ck_ring_burst_copy_out(ring->mask, buffer, target, ts, consumer, n);
+
+	/* See _ck_ring_dequeue_sc. */
+	ck_pr_fence_load_store();
+	ck_pr_store_uint(&ring->c_head, consumer + n);
+	return n;
+}
+
+CK_CC_FORCE_INLINE static unsigned int
+_ck_ring_dequeue_burst_mc(struct ck_ring *ring,
+    const void *buffer,
+    void *target,
+    unsigned int ts,
+    unsigned int n)
+{
+	unsigned int consumer, producer, available;
+
+	consumer = ck_pr_load_uint(&ring->c_head);
+
+	do {
+		ck_pr_fence_load();
+		producer = ck_pr_load_uint(&ring->p_tail);
+
+		available = producer - consumer;
+		if (CK_CC_UNLIKELY(available == 0))
+			return 0;
+
+		if (available > n)
+			available = n;
+
+		ck_pr_fence_load();
+		_ck_ring_burst_copy_out(ring->mask, buffer, target, ts,
+		    consumer, available);
+		ck_pr_fence_load_store();
+	} while (ck_pr_cas_uint_value(&ring->c_head,
+				      consumer,
+				      consumer + available,
+				      &consumer) == false);
+
+	return available;
+}
+
 /*
  * The ck_ring_*_spsc namespace is the public interface for interacting with a
  * ring buffer containing pointers. Correctness is only provided if there is up
@@ -551,6 +740,215 @@ ck_ring_dequeue_spsc(struct ck_ring *ring,
 	    (void **)data, sizeof(void *));
 }
 
+/*
+ * Enqueues up to n pointers from the array pointed to by entries.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_enqueue_burst_spsc(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    const void *entries,
+    unsigned int n)
+{
+
+	return _ck_ring_enqueue_burst_sp(ring, buffer, entries,
+	    sizeof(void *), n);
+}
+
+/*
+ * Dequeues up to n pointers into the array pointed to by data.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_dequeue_burst_spsc(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    void *data,
+    unsigned int n)
+{
+
+	return _ck_ring_dequeue_burst_sc(ring, buffer, data,
+	    sizeof(void *), n);
+}
+
+/*
+ * The ck_ring_*_spsc_bytes namespace is the public interface for interacting
+ * with a ring buffer of variable-length messages. The ring is initialized with
+ * ck_ring_init and a size in bytes, which must be a power of 2 and a multiple
+ * of CK_RING_BYTES_ALIGN. The buffer is an array of that many bytes aligned to
+ * CK_RING_BYTES_ALIGN. Messages are written and read in place. Correctness is
+ * only provided if there is up to one concurrent consumer and up to one
+ * concurrent producer, each with at most one outstanding reservation.
+ */
+#ifndef CK_RING_BYTES_ALIGN
+#define CK_RING_BYTES_ALIGN 8
+#endif /* CK_RING_BYTES_ALIGN */
+
+/*
+ * Every message is preceded by a header of CK_RING_BYTES_ALIGN bytes holding
+ * its length. A message never wraps around the end of the buffer: if it would,
+ * the remainder of the buffer is skipped with a header of this length.
+ */
+#define CK_RING_BYTES_WRAP (~0U)
+
+#define CK_RING_BYTES_ROUND(length)					\
+	(((length) + CK_RING_BYTES_ALIGN - 1) & ~(CK_RING_BYTES_ALIGN - 1))
+
+/*
+ * Returns the largest message length that is guaranteed to eventually fit in
+ * a ring of the specified size, regardless of where the producer stands.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_capacity_spsc_bytes(const struct ck_ring *ring)
+{
+
+	return ring->size / 2 - CK_RING_BYTES_ALIGN;
+}
+
+/*
+ * Returns a region of length bytes to write the next message into, or NULL if
+ * there is currently not enough contiguous space. The message only becomes
+ * visible to the consumer once ck_ring_enqueue_commit_spsc_bytes is called.
+ */
+CK_CC_INLINE static void *
+ck_ring_enqueue_reserve_spsc_bytes(struct ck_ring *ring,
+    void *buffer,
+    unsigned int length)
+{
+	const unsigned int mask = ring->mask;
+	unsigned int consumer, producer, offset, total, skip;
+	unsigned char *slot;
+
+	if (CK_CC_UNLIKELY(length > ck_ring_capacity_spsc_bytes(ring)))
+		return NULL;
+
+	consumer = ck_pr_load_uint(&ring->c_head);
+	producer = ring->p_tail;
+	offset = producer & mask;
+	total = CK_RING_BYTES_ALIGN + CK_RING_BYTES_ROUND(length);
+
+	/* The message must be contiguous, so skip to the front if needed. */
+	skip = 0;
+	if (ring->size - offset < total)
+		skip = ring->size - offset;
+
+	if (CK_CC_UNLIKELY(skip + total > ring->size - (producer - consumer)))
+		return NULL;
+
+	slot = (unsigned char *)buffer + offset;
+	if (skip != 0) {
+		*(unsigned int *)(void *)slot = CK_RING_BYTES_WRAP;
+		slot = buffer;
+	}
+
+	*(unsigned int *)(void *)slot = length;
+
+	/*
+	 * The producer head is otherwise unused by a single producer and holds
+	 * the position to commit.
+	 */
+	ring->p_head = producer + skip + total;
+	return slot + CK_RING_BYTES_ALIGN;
+}
+
+/*
+ * Makes the message previously reserved with ck_ring_enqueue_reserve_spsc_bytes
+ * visible to the consumer.
+ */
+CK_CC_INLINE static void
+ck_ring_enqueue_commit_spsc_bytes(struct ck_ring *ring)
+{
+
+	ck_pr_fence_store();
+	ck_pr_store_uint(&ring->p_tail, ring->p_head);
+	return;
+}
+
+CK_CC_INLINE static bool
+ck_ring_enqueue_spsc_bytes(struct ck_ring *ring,
+    void *buffer,
+    const void *message,
+    unsigned int length)
+{
+	void *slot;
+
+	slot = ck_ring_enqueue_reserve_spsc_bytes(ring, buffer, length);
+	if (slot == NULL)
+		return false;
+
+	memcpy(slot, message, length);
+	ck_ring_enqueue_commit_spsc_bytes(ring);
+	return true;
+}
+
+/*
+ * Returns the oldest message in the ring and stores its length in the location
+ * pointed to by length, or returns NULL if the ring is empty. The message
+ * remains in the ring until ck_ring_dequeue_commit_spsc_bytes is called.
+ */
+CK_CC_INLINE static const void *
+ck_ring_dequeue_reserve_spsc_bytes(struct ck_ring *ring,
+    const void *buffer,
+    unsigned int *length)
+{
+	const unsigned int mask = ring->mask;
+	unsigned int consumer, producer;
+	const unsigned char *slot;
+
+	consumer = ring->c_head;
+	producer = ck_pr_load_uint(&ring->p_tail);
+
+	if (CK_CC_UNLIKELY(consumer == producer))
+		return NULL;
+
+	/*
+	 * Make sure to serialize with respect to our snapshot
+	 * of the producer counter.
+	 */
+	ck_pr_fence_load();
+
+	/*
+	 * A wrap header is always committed together with the message that
+	 * follows it at the front of the buffer.
+	 */
+	slot = (const unsigned char *)buffer + (consumer & mask);
+	if (*(const unsigned int *)(const void *)slot == CK_RING_BYTES_WRAP)
+		slot = buffer;
+
+	*length = *(const unsigned int *)(const void *)slot;
+	return slot + CK_RING_BYTES_ALIGN;
+}
+
+/*
+ * Releases the message previously returned by
+ * ck_ring_dequeue_reserve_spsc_bytes back to the producer.
+ */
+CK_CC_INLINE static void
+ck_ring_dequeue_commit_spsc_bytes(struct ck_ring *ring,
+    const void *buffer)
+{
+	const unsigned int mask = ring->mask;
+	unsigned int consumer, offset, length;
+	const unsigned char *slot;
+
+	consumer = ring->c_head;
+	offset = consumer & mask;
+	slot = (const unsigned char *)buffer + offset;
+	if (*(const unsigned int *)(const void *)slot == CK_RING_BYTES_WRAP) {
+		consumer += ring->size - offset;
+		slot = buffer;
+	}
+
+	length = *(const unsigned int *)(const void *)slot;
+	consumer += CK_RING_BYTES_ALIGN + CK_RING_BYTES_ROUND(length);
+
+	/*
+	 * The consumer counter update is the producer's license to
+	 * overwrite the message, so reads of the message must complete
+	 * before it is published.
+	 */
+	ck_pr_fence_load_store();
+	ck_pr_store_uint(&ring->c_head, consumer);
+	return;
+}
+
 /*
  * The ck_ring_*_mpmc namespace is the public interface for interacting with a
  * ring buffer containing pointers. Correctness is provided for any number of
@@ -625,6 +1023,34 @@ ck_ring_dequeue_mpmc(struct ck_ring *ring,
 	    sizeof(void *));
 }
 
+/*
+ * Enqueues up to n pointers from the array pointed to by entries.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_enqueue_burst_mpmc(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    const void *entries,
+    unsigned int n)
+{
+
+	return _ck_ring_enqueue_burst_mp(ring, buffer, entries,
+	    sizeof(void *), n);
+}
+
+/*
+ * Dequeues up to n pointers into the array pointed to by data.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_dequeue_burst_mpmc(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    void *data,
+    unsigned int n)
+{
+
+	return _ck_ring_dequeue_burst_mc(ring, buffer, data,
+	    sizeof(void *), n);
+}
+
 /*
  * The ck_ring_*_spmc namespace is the public interface for interacting with a
  * ring buffer containing pointers. Correctness is provided for any number of
@@ -694,6 +1120,34 @@ ck_ring_dequeue_spmc(struct ck_ring *ring,
 	return _ck_ring_dequeue_mc(ring, buffer, (void **)data, sizeof(void *));
 }
 
+/*
+ * Enqueues up to n pointers from the array pointed to by entries.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_enqueue_burst_spmc(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    const void *entries,
+    unsigned int n)
+{
+
+	return _ck_ring_enqueue_burst_sp(ring, buffer, entries,
+	    sizeof(void *), n);
+}
+
+/*
+ * Dequeues up to n pointers into the array pointed to by data.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_dequeue_burst_spmc(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    void *data,
+    unsigned int n)
+{
+
+	return _ck_ring_dequeue_burst_mc(ring, buffer, data,
+	    sizeof(void *), n);
+}
+
 /*
  * The ck_ring_*_mpsc namespace is the public interface for interacting with a
  * ring buffer containing pointers. Correctness is provided for any number of
@@ -759,6 +1213,34 @@ ck_ring_dequeue_mpsc(struct ck_ring *ring,
 	    sizeof(void *));
 }
 
+/*
+ * Enqueues up to n pointers from the array pointed to by entries.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_enqueue_burst_mpsc(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    const void *entries,
+    unsigned int n)
+{
+
+	return _ck_ring_enqueue_burst_mp(ring, buffer, entries,
+	    sizeof(void *), n);
+}
+
+/*
+ * Dequeues up to n pointers into the array pointed to by data.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_dequeue_burst_mpsc(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    void *data,
+    unsigned int n)
+{
+
+	return _ck_ring_dequeue_burst_sc(ring, buffer, data,
+	    sizeof(void *), n);
+}
+
 /*
  * CK_RING_PROTOTYPE is used to define a type-safe interface for inlining
  * values of a particular type in the ring the buffer.
@@ -814,6 +1296,28 @@ ck_ring_dequeue_spsc_##name(struct ck_ring *a,			\
 	    sizeof(struct type));				\
 }								\
 								\
+CK_CC_INLINE static unsigned int				\
+ck_ring_enqueue_burst_spsc_##name(struct ck_ring *a,		\
+    struct type *b,						\
+    struct type *c,						\
+    unsigned int d)						\
+{								\
+								\
+	return _ck_ring_enqueue_burst_sp(a, b, c,		\
+	    sizeof(struct type), d);				\
+}								\
+								\
+CK_CC_INLINE static unsigned int				\
+ck_ring_dequeue_burst_spsc_##name(struct ck_ring *a,		\
+    struct type *b,						\
+    struct type *c,						\
+    unsigned int d)						\
+{								\
+								\
+	return _ck_ring_dequeue_burst_sc(a, b, c,		\
+	    sizeof(struct type), d);				\
+}								\
+								\
 CK_CC_INLINE static struct type *				\
 ck_ring_enqueue_reserve_spmc_##name(struct ck_ring *a,		\
     struct type *b)						\
@@ -874,6 +1378,28 @@ ck_ring_dequeue_spmc_##name(struct ck_ring *a,			\
 	    sizeof(struct type));				\
 }								\
 								\
+CK_CC_INLINE static unsigned int				\
+ck_ring_enqueue_burst_spmc_##name(struct ck_ring *a,		\
+    struct type *b,						\
+    struct type *c,						\
+    unsigned int d)						\
+{								\
+								\
+	return _ck_ring_enqueue_burst_sp(a, b, c,		\
+	    sizeof(struct type), d);				\
+}								\
+								\
+CK_CC_INLINE static unsigned int				\
+ck_ring_dequeue_burst_spmc_##name(struct ck_ring *a,		\
+    struct type *b,						\
+    struct type *c,						\
+    unsigned int d)						\
+{								\
+								\
+	return _ck_ring_dequeue_burst_mc(a, b, c,		\
+	    sizeof(struct type), d);				\
+}								\
+								\
 CK_CC_INLINE static struct type *				\
 ck_ring_enqueue_reserve_mpsc_##name(struct ck_ring *a,		\
     struct type *b,						\
@@ -926,6 +1452,28 @@ ck_ring_dequeue_mpsc_##name(struct ck_ring *a,			\
 	    sizeof(struct type));				\
 }								\
 								\
+CK_CC_INLINE static unsigned int				\
+ck_ring_enqueue_burst_mpsc_##name(struct ck_ring *a,		\
+    struct type *b,						\
+    struct type *c,						\
+    unsigned int d)						\
+{								\
+								\
+	return _ck_ring_enqueue_burst_mp(a, b, c,		\
+	    sizeof(struct type), d);				\
+}								\
+								\
+CK_CC_INLINE static unsigned int				\
+ck_ring_dequeue_burst_mpsc_##name(struct ck_ring *a,		\
+    struct type *b,						\
+    struct type *c,						\
+    unsigned int d)						\
+{								\
+								\
+	return _ck_ring_dequeue_burst_sc(a, b, c,		\
+	    sizeof(struct type), d);				\
+}								\
+								\
 CK_CC_INLINE static struct type *				\
 ck_ring_enqueue_reserve_mpmc_##name(struct ck_ring *a,		\
     struct type *b,						\
@@ -986,6 +1534,28 @@ ck_ring_dequeue_mpmc_##name(struct ck_ring *a,			\
 								\
 	return _ck_ring_dequeue_mc(a, b, c,			\
 	    sizeof(struct type));				\
+}								\
+								\
+CK_CC_INLINE static unsigned int				\
+ck_ring_enqueue_burst_mpmc_##name(struct ck_ring *a,		\
+    struct type *b,						\
+    struct type *c,						\
+    unsigned int d)						\
+{								\
+								\
+	return _ck_ring_enqueue_burst_mp(a, b, c,		\
+	    sizeof(struct type), d);				\
+}								\
+								\
+CK_CC_INLINE static unsigned int				\
+ck_ring_dequeue_burst_mpmc_##name(struct ck_ring *a,		\
+    struct type *b,						\
+    struct type *c,						\
+    unsigned int d)						\
+{								\
+								\
+	return _ck_ring_dequeue_burst_mc(a, b, c,		\
+	    sizeof(struct type), d);				\
 }
 
 /*
@@ -1001,6 +1571,10 @@ ck_ring_dequeue_mpmc_##name(struct ck_ring *a,			\
 	ck_ring_enqueue_reserve_spsc_size_##name(a, b, c, d)
 #define CK_RING_DEQUEUE_SPSC(name, a, b, c)			\
 	ck_ring_dequeue_spsc_##name(a, b, c)
+#define CK_RING_ENQUEUE_BURST_SPSC(name, a, b, c, d)		\
+	ck_ring_enqueue_burst_spsc_##name(a, b, c, d)
+#define CK_RING_DEQUEUE_BURST_SPSC(name, a, b, c, d)		\
+	ck_ring_dequeue_burst_spsc_##name(a, b, c, d)
 
 /*
  * A single producer with any number of concurrent consumers.
@@ -1017,6 +1591,10 @@ ck_ring_dequeue_mpmc_##name(struct ck_ring *a,			\
 	ck_ring_trydequeue_spmc_##name(a, b, c)
 #define CK_RING_DEQUEUE_SPMC(name, a, b, c)			\
 	ck_ring_dequeue_spmc_##name(a, b, c)
+#define CK_RING_ENQUEUE_BURST_SPMC(name, a, b, c, d)		\
+	ck_ring_enqueue_burst_spmc_##name(a, b, c, d)
+#define CK_RING_DEQUEUE_BURST_SPMC(name, a, b, c, d)		\
+	ck_ring_dequeue_burst_spmc_##name(a, b, c, d)
 
 /*
  * Any number of concurrent producers with up to one
@@ -1032,6 +1610,10 @@ ck_ring_dequeue_mpmc_##name(struct ck_ring *a,			\
 	ck_ring_enqueue_reserve_mpsc_size_##name(a, b, c, d)
 #define CK_RING_DEQUEUE_MPSC(name, a, b, c)			\
 	ck_ring_dequeue_mpsc_##name(a, b, c)
+#define CK_RING_ENQUEUE_BURST_MPSC(name, a, b, c, d)		\
+	ck_ring_enqueue_burst_mpsc_##name(a, b, c, d)
+#define CK_RING_DEQUEUE_BURST_MPSC(name, a, b, c, d)		\
+	ck_ring_dequeue_burst_mpsc_##name(a, b, c, d)
 
 /*
  * Any number of concurrent producers and consumers.
@@ -1048,5 +1630,9 @@ ck_ring_dequeue_mpmc_##name(struct ck_ring *a,			\
 	ck_ring_trydequeue_mpmc_##name(a, b, c)
 #define CK_RING_DEQUEUE_MPMC(name, a, b, c)			\
 	ck_ring_dequeue_mpmc_##name(a, b, c)
+#define CK_RING_ENQUEUE_BURST_MPMC(name, a, b, c, d)		\
+	ck_ring_enqueue_burst_mpmc_##name(a, b, c, d)
+#define CK_RING_DEQUEUE_BURST_MPMC(name, a, b, c, d)		\
+	ck_ring_dequeue_burst_mpmc_##name(a, b, c, d)
 
 #endif /* CK_RING_H */
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_RING_BROADCAST_H
+#define CK_RING_BROADCAST_H
+
+#include <ck_cc.h>
+#include <ck_md.h>
+#include <ck_pr.h>
+#include <ck_ring.h>
+#include <ck_stdbool.h>
+#include <ck_string.h>
+
+/*
+ * A bounded single-producer ring in which every entry is delivered to every
+ * subscriber. Each subscriber owns a cursor into the shared ring buffer and
+ * the producer only waits on the slowest cursor, so fanning out to many
+ * consumers costs neither copies nor additional rings. Entries are stored in
+ * an array of struct ck_ring_buffer, as with ck_ring.
+ */
+struct ck_ring_cursor {
+	unsigned int position;
+	char pad[CK_MD_CACHELINE - sizeof(unsigned int)];
+};
+typedef struct ck_ring_cursor ck_ring_cursor_t;
+
+struct ck_ring_broadcast {
+	unsigned int p_tail;
+	char pad[CK_MD_CACHELINE - sizeof(unsigned int)];
+
+	/* Producer-private snapshot of the slowest cursor. */
+	unsigned int gate;
+	unsigned int size;
+	unsigned int mask;
+	unsigned int n_cursors;
+	struct ck_ring_cursor *cursors;
+};
+typedef struct ck_ring_broadcast ck_ring_broadcast_t;
+
+/*
+ * The cursors array must hold n_cursors entries, one per subscriber, and
+ * remain valid for the lifetime of the ring. Size must be a power of 2.
+ */
+CK_CC_INLINE static void
+ck_ring_broadcast_init(struct ck_ring_broadcast *ring,
+    unsigned int size,
+    struct ck_ring_cursor *cursors,
+    unsigned int n_cursors)
+{
+	unsigned int i;
+
+	ring->p_tail = 0;
+	ring->gate = 0;
+	ring->size = size;
+	ring->mask = size - 1;
+	ring->n_cursors = n_cursors;
+	ring->cursors = cursors;
+	for (i = 0; i < n_cursors; i++)
+		cursors[i].position = 0;
+
+	return;
+}
+
+CK_CC_INLINE static unsigned int
+ck_ring_broadcast_capacity(const struct ck_ring_broadcast *ring)
+{
+
+	return ring->size;
+}
+
+/*
+ * Returns the number of entries that remain to be read by the subscriber
+ * owning the specified cursor.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_broadcast_size(const struct ck_ring_broadcast *ring,
+    const struct ck_ring_cursor *cursor)
+{
+	unsigned int c, p;
+
+	c = ck_pr_load_uint(&cursor->position);
+	p = ck_pr_load_uint(&ring->p_tail);
+	return p - c;
+}
+
+/*
+ * Returns the position of the slowest subscriber. Counters are free-running,
+ * so cursors are only ever compared through their distance to the producer.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_broadcast_gate(struct ck_ring_broadcast *ring)
+{
+	unsigned int producer = ring->p_tail;
+	unsigned int gate = producer;
+	unsigned int i, position;
+
+	for (i = 0; i < ring->n_cursors; i++) {
+		position = ck_pr_load_uint(&ring->cursors[i].position);
+		if (producer - position > producer - gate)
+			gate = position;
+	}
+
+	ring->gate = gate;
+	return gate;
+}
+
+/*
+ * The _ck_ring_broadcast_* namespace is internal only and must not used
+ * externally.
+ */
+CK_CC_FORCE_INLINE static unsigned int
+_ck_ring_broadcast_available(struct ck_ring_broadcast *ring,
+    unsigned int producer,
+    unsigned int n)
+{
+	unsigned int available;
+
+	/* Only rescan the cursors once the cached gate is exhausted. */
+	available = ring->size - (producer - ring->gate);
+	if (available < n) {
+		available = ring->size -
+		    (producer - ck_ring_broadcast_gate(ring));
+	}
+
+	return available;
+}
+
+CK_CC_FORCE_INLINE static bool
+_ck_ring_broadcast_enqueue(struct ck_ring_broadcast *ring,
+    struct ck_ring_buffer *buffer,
+    const void *entry)
+{
+	unsigned int producer = ring->p_tail;
+
+	if (CK_CC_UNLIKELY(_ck_ring_broadcast_available(ring,
+	    producer, 1) == 0))
+		return false;
+
+	/*
+	 * The cursor loads that opened the slot must complete before the
+	 * slot is overwritten.
+	 */
+	ck_pr_fence_load_store();
+	buffer[producer & ring->mask].value = CK_CC_DECONST_PTR(entry);
+
+	/*
+	 * Make sure to update slot value before indicating
+	 * that the slot is available for consumption.
+	 */
+	ck_pr_fence_store();
+	ck_pr_store_uint(&ring->p_tail, producer + 1);
+	return true;
+}
+
+CK_CC_FORCE_INLINE static bool
+_ck_ring_broadcast_dequeue(struct ck_ring_broadcast *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_cursor *cursor,
+    void *data)
+{
+	unsigned int consumer = cursor->position;
+	unsigned int producer;
+
+	producer = ck_pr_load_uint(&ring->p_tail);
+	if (CK_CC_UNLIKELY(consumer == producer))
+		return false;
+
+	/*
+	 * Make sure to serialize with respect to our snapshot
+	 * of the producer counter.
+	 */
+	ck_pr_fence_load();
+	*(void **)data = buffer[consumer & ring->mask].value;
+
+	/*
+	 * The cursor update is the producer's license to overwrite the
+	 * slot, so the slot load must complete before it is published.
+	 */
+	ck_pr_fence_load_store();
+	ck_pr_store_uint(&cursor->position, consumer + 1);
+	return true;
+}
+
+/*
+ * Makes entry visible to every subscriber. Returns false if the slowest
+ * subscriber is a full ring behind the producer. Only one thread may
+ * enqueue at a time.
+ */
+CK_CC_INLINE static bool
+ck_ring_broadcast_enqueue(struct ck_ring_broadcast *ring,
+    struct ck_ring_buffer *buffer,
+    const void *entry)
+{
+
+	return _ck_ring_broadcast_enqueue(ring, buffer, entry);
+}
+
+/*
+ * Enqueues up to n pointers from the array pointed to by entries, and
+ * returns the number of pointers enqueued.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_broadcast_enqueue_burst(struct ck_ring_broadcast *ring,
+    struct ck_ring_buffer *buffer,
+    const void *entries,
+    unsigned int n)
+{
+	unsigned int producer = ring->p_tail;
+	unsigned int available;
+
+	available = _ck_ring_broadcast_available(ring, producer, n);
+	if (n > available)
+		n = available;
+
+	if (CK_CC_UNLIKELY(n == 0))
+		return 0;
+
+	ck_pr_fence_load_store();
+	_ck_ring_burst_copy_in(ring->mask, buffer, entries,
+	    sizeof(void *), producer, n);
+	ck_pr_fence_store();
+	ck_pr_store_uint(&ring->p_tail, producer + n);
+	return n;
+}
+
+/*
+ * Reads the next entry for the subscriber owning cursor. Every subscriber
+ * observes every entry, in order. Only one thread may use a given cursor at
+ * a time.
+ */
+CK_CC_INLINE static bool
+ck_ring_broadcast_dequeue(struct ck_ring_broadcast *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_cursor *cursor,
+    void *data)
+{
+
+	return _ck_ring_broadcast_dequeue(ring, buffer, cursor, data);
+}
+
+/*
+ * Reads up to n entries for the subscriber owning cursor into the array
+ * pointed to by data, and returns the number of entries read.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_broadcast_dequeue_burst(struct ck_ring_broadcast *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_cursor *cursor,
+    void *data,
+    unsigned int n)
+{
+	unsigned int consumer = cursor->position;
+	unsigned int producer;
+
+	producer = ck_pr_load_uint(&ring->p_tail);
+	if (n > producer - consumer)
+		n = producer - consumer;
+
+	if (CK_CC_UNLIKELY(n == 0))
+		return 0;
+
+	ck_pr_fence_load();
+	_ck_ring_burst_copy_out(ring->mask, buffer, data,
+	    sizeof(void *), consumer, n);
+	ck_pr_fence_load_store();
+	ck_pr_store_uint(&cursor->position, consumer + n);
+	return n;
+}
+
+#endif /* CK_RING_BROADCAST_H */
@@ -0,0 +1,392 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_RING_EC_H
+#define CK_RING_EC_H
+
+#include <ck_cc.h>
+#include <ck_ec.h>
+#include <ck_ring.h>
+#include <ck_ring_broadcast.h>
+#include <ck_stdbool.h>
+#include <ck_stdint.h>
+
+/*
+ * Blocking operations on a ck_ring. A ring is paired with two event
+ * counts: one is incremented after every enqueue and waited upon by
+ * consumers that find the ring empty, the other is incremented after
+ * every dequeue and waited upon by producers that find the ring full.
+ * Waiters spin on the event count for a bounded number of iterations
+ * (see busy_loop_iter in struct ck_ec_ops) before parking in the
+ * kernel, and only then does a signaller pay for a wake-up.
+ *
+ * Every thread that operates on a ring with blocked waiters must do so
+ * through these functions, otherwise the waiters are never woken. A
+ * deadline of { 0, 0 } turns any of them into a non-blocking operation
+ * that still signals waiters. A NULL deadline waits forever.
+ */
+struct ck_ring_ec {
+	struct ck_ec32 readable;
+	struct ck_ec32 writable;
+};
+typedef struct ck_ring_ec ck_ring_ec_t;
+
+#define CK_RING_EC_INITIALIZER { CK_EC_INITIALIZER, CK_EC_INITIALIZER }
+
+CK_CC_INLINE static void
+ck_ring_ec_init(struct ck_ring_ec *ec)
+{
+
+	ck_ec32_init(&ec->readable, 0);
+	ck_ec32_init(&ec->writable, 0);
+	return;
+}
+
+/*
+ * The single-producer mode of an event count is only correct if a
+ * single thread ever increments it, so the readable event count takes
+ * the producer side of the ring and the writable event count takes the
+ * consumer side.
+ */
+CK_CC_FORCE_INLINE static bool
+_ck_ring_enqueue_wait(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    const void *entry,
+    const struct timespec *deadline,
+    bool sp,
+    bool sc)
+{
+	const struct ck_ec_mode produce = { .ops = ops, .single_producer = sp };
+	const struct ck_ec_mode consume = { .ops = ops, .single_producer = sc };
+	uint32_t snapshot;
+
+	for (;;) {
+		if (sp == true) {
+			if (_ck_ring_enqueue_sp(ring, buffer, &entry,
+			    sizeof(entry), NULL) == true)
+				break;
+		} else {
+			if (_ck_ring_enqueue_mp(ring, buffer, &entry,
+			    sizeof(entry), NULL) == true)
+				break;
+		}
+
+		/*
+		 * The ring is full. Any dequeue that completes after the
+		 * snapshot is taken moves the event count past it, so a
+		 * second failed attempt is safe to sleep on.
+		 */
+		snapshot = ck_ec32_value(&ec->writable);
+		if (sp == true) {
+			if (_ck_ring_enqueue_sp(ring, buffer, &entry,
+			    sizeof(entry), NULL) == true)
+				break;
+		} else {
+			if (_ck_ring_enqueue_mp(ring, buffer, &entry,
+			    sizeof(entry), NULL) == true)
+				break;
+		}
+
+		if (ck_ec32_wait(&ec->writable, &consume,
+		    snapshot, deadline) != 0)
+			return false;
+	}
+
+	ck_ec32_inc(&ec->readable, &produce);
+	return true;
+}
+
+CK_CC_FORCE_INLINE static bool
+_ck_ring_dequeue_wait(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    void *data,
+    const struct timespec *deadline,
+    bool sp,
+    bool sc)
+{
+	const struct ck_ec_mode produce = { .ops = ops, .single_producer = sp };
+	const struct ck_ec_mode consume = { .ops = ops, .single_producer = sc };
+	uint32_t snapshot;
+
+	for (;;) {
+		if (sc == true) {
+			if (_ck_ring_dequeue_sc(ring, buffer,
+			    (void **)data, sizeof(void *)) == true)
+				break;
+		} else {
+			if (_ck_ring_dequeue_mc(ring, buffer,
+			    (void **)data, sizeof(void *)) == true)
+				break;
+		}
+
+		snapshot = ck_ec32_value(&ec->readable);
+		if (sc == true) {
+			if (_ck_ring_dequeue_sc(ring, buffer,
+			    (void **)data, sizeof(void *)) == true)
+				break;
+		} else {
+			if (_ck_ring_dequeue_mc(ring, buffer,
+			    (void **)data, sizeof(void *)) == true)
+				break;
+		}
+
+		if (ck_ec32_wait(&ec->readable, &produce,
+		    snapshot, deadline) != 0)
+			return false;
+	}
+
+	ck_ec32_inc(&ec->writable, &consume);
+	return true;
+}
+
+/*
+ * The ring buffer can support at most one producer and at most one
+ * consumer at the same time.
+ */
+CK_CC_INLINE static bool
+ck_ring_enqueue_wait_spsc(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    const void *entry,
+    const struct timespec *deadline)
+{
+
+	return _ck_ring_enqueue_wait(ring, buffer, ec, ops,
+	    entry, deadline, true, true);
+}
+
+CK_CC_INLINE static bool
+ck_ring_dequeue_wait_spsc(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    void *data,
+    const struct timespec *deadline)
+{
+
+	return _ck_ring_dequeue_wait(ring, buffer, ec, ops,
+	    data, deadline, true, true);
+}
+
+/*
+ * The ring buffer can support at most one producer and any number of
+ * concurrent consumers.
+ */
+CK_CC_INLINE static bool
+ck_ring_enqueue_wait_spmc(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    const void *entry,
+    const struct timespec *deadline)
+{
+
+	return _ck_ring_enqueue_wait(ring, buffer, ec, ops,
+	    entry, deadline, true, false);
+}
+
+CK_CC_INLINE static bool
+ck_ring_dequeue_wait_spmc(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    void *data,
+    const struct timespec *deadline)
+{
+
+	return _ck_ring_dequeue_wait(ring, buffer, ec, ops,
+	    data, deadline, true, false);
+}
+
+/*
+ * The ring buffer can support any number of concurrent producers and at
+ * most one consumer.
+ */
+CK_CC_INLINE static bool
+ck_ring_enqueue_wait_mpsc(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    const void *entry,
+    const struct timespec *deadline)
+{
+
+	return _ck_ring_enqueue_wait(ring, buffer, ec, ops,
+	    entry, deadline, false, true);
+}
+
+CK_CC_INLINE static bool
+ck_ring_dequeue_wait_mpsc(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    void *data,
+    const struct timespec *deadline)
+{
+
+	return _ck_ring_dequeue_wait(ring, buffer, ec, ops,
+	    data, deadline, false, true);
+}
+
+/*
+ * The ring buffer can support any number of concurrent producers and
+ * consumers.
+ */
+CK_CC_INLINE static bool
+ck_ring_enqueue_wait_mpmc(struct ck_ring *ring,
+    struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    const void *entry,
+    const struct timespec *deadline)
+{
+
+	return _ck_ring_enqueue_wait(ring, buffer, ec, ops,
+	    entry, deadline, false, false);
+}
+
+CK_CC_INLINE static bool
+ck_ring_dequeue_wait_mpmc(struct ck_ring *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    void *data,
+    const struct timespec *deadline)
+{
+
+	return _ck_ring_dequeue_wait(ring, buffer, ec, ops,
+	    data, deadline, false, false);
+}
+
+/*
+ * Blocking operations on a ck_ring_broadcast, which is paired with a
+ * ck_ring_ec in the same way as a ck_ring. Subscribers are many and the
+ * producer is rarely blocked, so a subscriber only signals the writable
+ * event count when the producer has flagged it as waited upon. The
+ * producer's predicate re-checks the cursors after flagging, so either
+ * it observes the subscriber's progress or the subscriber observes the
+ * flag.
+ */
+CK_CC_INLINE static int
+_ck_ring_broadcast_writable(const struct ck_ec_wait_state *state,
+    struct timespec *deadline)
+{
+	struct ck_ring_broadcast *ring = state->data;
+
+	(void)deadline;
+	return ring->p_tail - ck_ring_broadcast_gate(ring) < ring->size;
+}
+
+CK_CC_INLINE static bool
+ck_ring_broadcast_enqueue_wait(struct ck_ring_broadcast *ring,
+    struct ck_ring_buffer *buffer,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    const void *entry,
+    const struct timespec *deadline)
+{
+	const struct ck_ec_mode produce = {
+		.ops = ops,
+		.single_producer = true
+	};
+	const struct ck_ec_mode consume = {
+		.ops = ops,
+		.single_producer = false
+	};
+	uint32_t snapshot = 0;
+	bool armed = false;
+
+	/*
+	 * A failed attempt takes a snapshot of the event count and retries,
+	 * and only a second failure against the same snapshot waits.
+	 */
+	while (_ck_ring_broadcast_enqueue(ring, buffer, entry) == false) {
+		if (armed == false) {
+			snapshot = ck_ec32_value(&ec->writable);
+			armed = true;
+			continue;
+		}
+
+		if (ck_ec32_wait_pred(&ec->writable, &consume, snapshot,
+		    _ck_ring_broadcast_writable, ring, deadline) == -1)
+			return false;
+
+		armed = false;
+	}
+
+	ck_ec32_inc(&ec->readable, &produce);
+	return true;
+}
+
+CK_CC_INLINE static bool
+ck_ring_broadcast_dequeue_wait(struct ck_ring_broadcast *ring,
+    const struct ck_ring_buffer *buffer,
+    struct ck_ring_cursor *cursor,
+    struct ck_ring_ec *ec,
+    const struct ck_ec_ops *ops,
+    void *data,
+    const struct timespec *deadline)
+{
+	const struct ck_ec_mode produce = {
+		.ops = ops,
+		.single_producer = true
+	};
+	const struct ck_ec_mode consume = {
+		.ops = ops,
+		.single_producer = false
+	};
+	uint32_t snapshot = 0;
+	bool armed = false;
+
+	while (_ck_ring_broadcast_dequeue(ring, buffer,
+	    cursor, data) == false) {
+		if (armed == false) {
+			snapshot = ck_ec32_value(&ec->readable);
+			armed = true;
+			continue;
+		}
+
+		if (ck_ec32_wait(&ec->readable, &produce,
+		    snapshot, deadline) != 0)
+			return false;
+
+		armed = false;
+	}
+
+	/* Order the cursor update before the load of the waiter flag. */
+	ck_pr_fence_store_load();
+	if (CK_CC_UNLIKELY(ck_ec32_has_waiters(&ec->writable) == true))
+		ck_ec32_inc(&ec->writable, &consume);
+
+	return true;
+}
+
+#endif /* CK_RING_EC_H */
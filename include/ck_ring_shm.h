@@ -0,0 +1,240 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_RING_SHM_H
+#define CK_RING_SHM_H
+
+#include <ck_cc.h>
+#include <ck_md.h>
+#include <ck_pr.h>
+#include <ck_ring.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+
+/*
+ * A ring placed in memory shared between processes, such as a shm_open or
+ * MAP_SHARED segment. The segment starts with a struct ck_ring_shm which
+ * is followed by the ring buffer, and must be zero-filled when created.
+ * The ring is operated upon with the ck_ring_*_spsc functions (or their
+ * CK_RING_PROTOTYPE counterparts for entries of entry_size bytes) or, if
+ * entry_size is 0, with the ck_ring_*_spsc_bytes functions. Pointers have
+ * no meaning in another address space, so entries must be self-contained.
+ *
+ * Only one producer process and one consumer process are supported, which
+ * is what makes recovery possible: a single producer only publishes an
+ * entry once it is complete and a single consumer only releases an entry
+ * once it is done with it, so a crash never leaves the ring inconsistent.
+ */
+#define CK_RING_SHM_MAGIC	0x636b7273U
+
+/*
+ * Number of iterations ck_ring_shm_init waits for another process to
+ * initialize the segment before giving up.
+ */
+#ifndef CK_RING_SHM_INIT_SPIN
+#define CK_RING_SHM_INIT_SPIN	(1U << 24)
+#endif
+
+enum ck_ring_shm_role {
+	CK_RING_SHM_PRODUCER = 0,
+	CK_RING_SHM_CONSUMER
+};
+
+struct ck_ring_shm_endpoint {
+	unsigned int owner;
+	unsigned int heartbeat;
+	char pad[CK_MD_CACHELINE - sizeof(unsigned int) * 2];
+};
+
+struct ck_ring_shm {
+	unsigned int state;
+	unsigned int initializer;
+	unsigned int size;
+	unsigned int entry_size;
+	char pad[CK_MD_CACHELINE - sizeof(unsigned int) * 4];
+	struct ck_ring_shm_endpoint endpoint[2];
+	struct ck_ring ring;
+};
+typedef struct ck_ring_shm ck_ring_shm_t;
+
+#define CK_RING_SHM_HEADER						\
+	((sizeof(struct ck_ring_shm) + CK_MD_CACHELINE - 1) &		\
+	    ~(size_t)(CK_MD_CACHELINE - 1))
+
+/*
+ * Returns the number of bytes the segment must span for a ring of size
+ * entries of entry_size bytes, or of size bytes if entry_size is 0.
+ */
+CK_CC_INLINE static size_t
+ck_ring_shm_footprint(unsigned int size, unsigned int entry_size)
+{
+
+	if (entry_size == 0)
+		return CK_RING_SHM_HEADER + size;
+
+	return CK_RING_SHM_HEADER + (size_t)size * entry_size;
+}
+
+CK_CC_INLINE static struct ck_ring *
+ck_ring_shm_ring(struct ck_ring_shm *shm)
+{
+
+	return &shm->ring;
+}
+
+CK_CC_INLINE static void *
+ck_ring_shm_buffer(struct ck_ring_shm *shm)
+{
+
+	return (char *)shm + CK_RING_SHM_HEADER;
+}
+
+/*
+ * Claims the producer or consumer end of the ring for the owner token,
+ * which must be non-zero and should identify the process (such as its
+ * process identifier). Returns false if the end is already owned or if
+ * owner is 0.
+ */
+CK_CC_INLINE static bool
+ck_ring_shm_attach(struct ck_ring_shm *shm,
+    enum ck_ring_shm_role role,
+    unsigned int owner)
+{
+
+	if (owner == 0)
+		return false;
+
+	return ck_pr_cas_uint(&shm->endpoint[role].owner, 0, owner);
+}
+
+CK_CC_INLINE static void
+ck_ring_shm_detach(struct ck_ring_shm *shm, enum ck_ring_shm_role role)
+{
+
+	ck_pr_fence_release();
+	ck_pr_store_uint(&shm->endpoint[role].owner, 0);
+	return;
+}
+
+/*
+ * Returns the owner token of an end of the ring, or 0 if it is not
+ * attached. A process may use it to determine whether its peer has
+ * terminated, for example with kill(owner, 0).
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_shm_owner(const struct ck_ring_shm *shm,
+    enum ck_ring_shm_role role)
+{
+
+	return ck_pr_load_uint(&shm->endpoint[role].owner);
+}
+
+/*
+ * Called periodically by the owner of an end of the ring to indicate
+ * that it is making progress.
+ */
+CK_CC_INLINE static void
+ck_ring_shm_heartbeat(struct ck_ring_shm *shm, enum ck_ring_shm_role role)
+{
+	struct ck_ring_shm_endpoint *endpoint = &shm->endpoint[role];
+
+	ck_pr_store_uint(&endpoint->heartbeat, endpoint->heartbeat + 1);
+	return;
+}
+
+/*
+ * Returns true if the end of the ring is attached and its owner has
+ * issued a heartbeat since the heartbeat recorded in the location
+ * pointed to by snapshot, which is then updated.
+ */
+CK_CC_INLINE static bool
+ck_ring_shm_alive(const struct ck_ring_shm *shm,
+    enum ck_ring_shm_role role,
+    unsigned int *snapshot)
+{
+	unsigned int heartbeat;
+
+	if (ck_ring_shm_owner(shm, role) == 0)
+		return false;
+
+	heartbeat = ck_pr_load_uint(&shm->endpoint[role].heartbeat);
+	if (heartbeat == *snapshot)
+		return false;
+
+	*snapshot = heartbeat;
+	return true;
+}
+
+/*
+ * Returns the owner token of the process that initialized the segment,
+ * or is initializing it, or 0 if no process has claimed it yet.
+ */
+CK_CC_INLINE static unsigned int
+ck_ring_shm_initializer(const struct ck_ring_shm *shm)
+{
+
+	return ck_pr_load_uint(&shm->initializer);
+}
+
+/*
+ * Initializes the segment exactly once on behalf of owner, which must be
+ * non-zero, no matter how many processes race to do so. Every caller
+ * waits for the winner to publish the ring and returns true if the ring
+ * it finds has the requested geometry. Returns false if the ring is not
+ * published within CK_RING_SHM_INIT_SPIN iterations, in which case the
+ * initializer may have terminated and the segment may be taken over with
+ * ck_ring_shm_init_recover.
+ */
+bool ck_ring_shm_init(struct ck_ring_shm *, unsigned int, unsigned int,
+    unsigned int);
+
+/*
+ * Takes over the initialization of the segment from a dead initializer
+ * on behalf of owner, and initializes the ring unless it was published.
+ * Returns false if owner is 0, if the segment is no longer claimed by
+ * dead or if the ring does not have the requested geometry.
+ */
+bool ck_ring_shm_init_recover(struct ck_ring_shm *, unsigned int,
+    unsigned int, unsigned int, unsigned int);
+
+/*
+ * Checks the ring for consistency. Unlike ck_ring_valid, this only relies
+ * on state maintained by a single producer, and may be called while the
+ * peer is operating on the ring.
+ */
+bool ck_ring_shm_valid(const struct ck_ring_shm *);
+
+/*
+ * Takes over an end of the ring from a dead owner on behalf of owner.
+ * Returns false if owner is 0, if the end is no longer owned by dead or
+ * if the ring is inconsistent. A reservation left behind by a dead producer is
+ * discarded, and entries that a dead consumer read but did not release
+ * are delivered again.
+ */
+bool ck_ring_shm_recover(struct ck_ring_shm *, enum ck_ring_shm_role,
+    unsigned int, unsigned int);
+
+#endif /* CK_RING_SHM_H */
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_SHT_H
+#define CK_SHT_H
+
+#include <ck_cc.h>
+#include <ck_ht.h>
+#include <ck_malloc.h>
+#include <ck_md.h>
+#include <ck_spinlock.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+#include <ck_stdint.h>
+
+/*
+ * A sharded hash table partitions keys across a power-of-two number of
+ * ck_ht instances by the high bits of their hash value. Every shard has
+ * its own writer lock, so writers of different shards proceed in
+ * parallel, while readers remain lock-free. Shards may be allocated by
+ * distinct allocators, such as one per NUMA node.
+ */
+
+/*
+ * Hash value bits below CK_SHT_SHARD_SHIFT select a slot in a shard and,
+ * with pointer packing, are memoized in its entries.
+ */
+#define CK_SHT_SHARD_SHIFT	48
+#define CK_SHT_SHARD_MAX	(1U << (64 - CK_SHT_SHARD_SHIFT))
+
+struct ck_sht_shard {
+	ck_spinlock_t lock;
+	char pad[CK_MD_CACHELINE - sizeof(ck_spinlock_t)];
+	struct ck_ht table;
+	struct ck_malloc *m;
+};
+typedef struct ck_sht_shard ck_sht_shard_t;
+
+struct ck_sht {
+	struct ck_sht_shard **shards;
+	struct ck_malloc *m;
+	unsigned int mask;
+};
+typedef struct ck_sht ck_sht_t;
+
+struct ck_sht_iterator {
+	struct ck_ht_iterator iterator;
+	unsigned int shard;
+};
+typedef struct ck_sht_iterator ck_sht_iterator_t;
+
+#define CK_SHT_ITERATOR_INITIALIZER { CK_HT_ITERATOR_INITIALIZER, 0 }
+
+CK_CC_INLINE static void
+ck_sht_iterator_init(struct ck_sht_iterator *iterator)
+{
+
+	ck_ht_iterator_init(&iterator->iterator);
+	iterator->shard = 0;
+	return;
+}
+
+/*
+ * Returns the index of the shard that holds keys of the specified hash
+ * value. Writers may use it to route operations to a thread local to
+ * the memory of the shard.
+ */
+CK_CC_INLINE static unsigned int
+ck_sht_shard(const struct ck_sht *sht, ck_ht_hash_t h)
+{
+
+	return (unsigned int)(h.value >> CK_SHT_SHARD_SHIFT) & sht->mask;
+}
+
+CK_CC_INLINE static unsigned int
+ck_sht_shards(const struct ck_sht *sht)
+{
+
+	return sht->mask + 1;
+}
+
+/*
+ * Iteration must occur without any concurrent mutations on
+ * the hash table.
+ */
+bool ck_sht_next(ck_sht_t *, ck_sht_iterator_t *, ck_ht_entry_t **);
+
+void ck_sht_stat(ck_sht_t *, struct ck_ht_stat *);
+void ck_sht_hash(ck_ht_hash_t *, ck_sht_t *, const void *, uint16_t);
+void ck_sht_hash_direct(ck_ht_hash_t *, ck_sht_t *, uintptr_t);
+bool ck_sht_init(ck_sht_t *, unsigned int, ck_ht_hash_cb_t *,
+    struct ck_malloc *, struct ck_malloc **, unsigned int, CK_HT_TYPE,
+    uint64_t);
+void ck_sht_destroy(ck_sht_t *);
+bool ck_sht_set(ck_sht_t *, ck_ht_hash_t, ck_ht_entry_t *);
+bool ck_sht_put(ck_sht_t *, ck_ht_hash_t, ck_ht_entry_t *);
+bool ck_sht_get(ck_sht_t *, ck_ht_hash_t, ck_ht_entry_t *);
+bool ck_sht_remove(ck_sht_t *, ck_ht_hash_t, ck_ht_entry_t *);
+bool ck_sht_gc(ck_sht_t *, unsigned long, unsigned long);
+bool ck_sht_reset(ck_sht_t *);
+CK_HT_TYPE ck_sht_count(ck_sht_t *);
+
+#endif /* CK_SHT_H */
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CK_SL_H
+#define CK_SL_H
+
+#include <ck_cc.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+#include <ck_stdint.h>
+
+/*
+ * A lock-free ordered set of objects, implemented as a skip list. Any
+ * number of readers and writers may operate concurrently. Readers never
+ * write to shared memory. Nodes that are removed are released through
+ * the free function of the allocator with the defer flag set, and must
+ * only be destroyed once no thread may still be traversing the list,
+ * for example by way of ck_epoch_call.
+ */
+
+/*
+ * Maximum height of a node. Every level holds about a quarter of the
+ * nodes of the level below, so the default accommodates 4^16 entries.
+ */
+#ifndef CK_SL_HEIGHT
+#define CK_SL_HEIGHT 16
+#endif /* CK_SL_HEIGHT */
+
+/*
+ * Returns a negative value, zero or a positive value if the first object
+ * is respectively less than, equal to or greater than the second.
+ */
+typedef int ck_sl_compare_cb_t(const void *, const void *);
+
+struct ck_sl_node;
+struct ck_sl {
+	struct ck_malloc *m;
+	ck_sl_compare_cb_t *compare;
+	struct ck_sl_node *head;
+	unsigned int n_entries;
+	unsigned int seed;
+};
+typedef struct ck_sl ck_sl_t;
+
+struct ck_sl_iterator {
+	struct ck_sl_node *cursor;
+};
+typedef struct ck_sl_iterator ck_sl_iterator_t;
+
+#define CK_SL_ITERATOR_INITIALIZER { NULL }
+
+CK_CC_INLINE static void
+ck_sl_iterator_init(struct ck_sl_iterator *iterator)
+{
+
+	iterator->cursor = NULL;
+	return;
+}
+
+/*
+ * Iteration may occur concurrently with mutations, in which case it
+ * returns every object present for its entire duration in ascending order.
+ */
+bool ck_sl_next(ck_sl_t *, ck_sl_iterator_t *, void **);
+void ck_sl_seek(ck_sl_t *, ck_sl_iterator_t *, const void *);
+
+bool ck_sl_init(ck_sl_t *, ck_sl_compare_cb_t *, struct ck_malloc *,
+    unsigned long);
+void ck_sl_deinit(ck_sl_t *);
+void *ck_sl_get(ck_sl_t *, const void *);
+bool ck_sl_put(ck_sl_t *, const void *);
+void *ck_sl_remove(ck_sl_t *, const void *);
+unsigned long ck_sl_count(ck_sl_t *);
+
+#endif /* CK_SL_H */
@@ -257,6 +257,139 @@ ck_stack_trypop_mpmc(struct ck_stack *target, struct ck_stack_entry **r)
 	return false;
 }
 #endif /* CK_F_STACK_TRYPOP_MPMC */
+
+#ifndef CK_F_STACK_ELIMINATION
+#define CK_F_STACK_ELIMINATION
+/*
+ * An elimination array may be placed in front of a stack, after Hendler,
+ * Shavit and Yerushalmi. When a push fails to update the head due to
+ * contention, the entry is offered in a random slot of the array for a
+ * short while instead. A pop that fails to update the head takes an offered
+ * entry if there is one. Matched operations cancel each other out without
+ * touching the head of the stack.
+ */
+struct ck_stack_elimination_slot {
+	struct ck_stack_entry *entry;
+} CK_CC_CACHELINE;
+typedef struct ck_stack_elimination_slot ck_stack_elimination_slot_t;
+
+struct ck_stack_elimination {
+	struct ck_stack_elimination_slot *slots;
+	unsigned int mask;
+	unsigned int spin;
+};
+typedef struct ck_stack_elimination ck_stack_elimination_t;
+
+#ifndef CK_STACK_ELIMINATION_SPIN
+#define CK_STACK_ELIMINATION_SPIN 128
+#endif
+
+/*
+ * The slots array must hold n_slots entries, where n_slots is a power of
+ * 2. Wider arrays suit more threads. An offered entry is withdrawn after
+ * spin iterations without a matching pop.
+ */
+CK_CC_INLINE static void
+ck_stack_elimination_init(struct ck_stack_elimination *elimination,
+			  struct ck_stack_elimination_slot *slots,
+			  unsigned int n_slots,
+			  unsigned int spin)
+{
+	unsigned int i;
+
+	for (i = 0; i < n_slots; i++)
+		slots[i].entry = NULL;
+
+	elimination->slots = slots;
+	elimination->mask = n_slots - 1;
+	elimination->spin = spin;
+	return;
+}
+
+/*
+ * Callers provide the state of a per-thread pseudo-random generator,
+ * which must not be zero, to spread operations across slots.
+ */
+CK_CC_INLINE static struct ck_stack_elimination_slot *
+ck_stack_elimination_slot(struct ck_stack_elimination *elimination,
+			  unsigned int *seed)
+{
+	unsigned int x = *seed;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*seed = x;
+	return &elimination->slots[x & elimination->mask];
+}
+
+/*
+ * Stack producer operation safe for multiple producers and multiple consumers.
+ */
+CK_CC_INLINE static void
+ck_stack_elimination_push(struct ck_stack *target,
+			  struct ck_stack_elimination *elimination,
+			  struct ck_stack_entry *entry,
+			  unsigned int *seed)
+{
+	struct ck_stack_elimination_slot *slot;
+	unsigned int i;
+
+	while (ck_stack_trypush_mpmc(target, entry) == false) {
+		slot = ck_stack_elimination_slot(elimination, seed);
+
+		/* Entry contents must be visible before it is offered. */
+		ck_pr_fence_store_atomic();
+		if (ck_pr_cas_ptr(&slot->entry, NULL, entry) == false)
+			continue;
+
+		for (i = 0; i < elimination->spin; i++) {
+			if (ck_pr_load_ptr(&slot->entry) != entry)
+				return;
+
+			ck_pr_stall();
+		}
+
+		/* A failure to withdraw the entry means it was taken. */
+		if (ck_pr_cas_ptr(&slot->entry, entry, NULL) == false)
+			return;
+	}
+
+	return;
+}
+
+/*
+ * Stack consumer operation safe for multiple producers and multiple consumers.
+ */
+CK_CC_INLINE static struct ck_stack_entry *
+ck_stack_elimination_pop(struct ck_stack *target,
+			 struct ck_stack_elimination *elimination,
+			 unsigned int *seed)
+{
+	struct ck_stack_elimination_slot *slot;
+	struct ck_stack_entry *entry;
+
+	for (;;) {
+		if (ck_stack_trypop_mpmc(target, &entry) == true)
+			return entry;
+
+		slot = ck_stack_elimination_slot(elimination, seed);
+		entry = ck_pr_load_ptr(&slot->entry);
+		if (entry != NULL &&
+		    ck_pr_cas_ptr(&slot->entry, entry, NULL) == true) {
+			ck_pr_fence_atomic_load();
+			return entry;
+		}
+
+		/*
+		 * The stack may only be reported as empty if it was not
+		 * merely contended.
+		 */
+		if (ck_pr_load_ptr(&target->head) == NULL)
+			return NULL;
+	}
+}
+#endif /* CK_F_STACK_ELIMINATION */
 #endif /* CK_F_PR_CAS_PTR_2_VALUE */
 
 #ifndef CK_F_STACK_BATCH_POP_MPMC_WF
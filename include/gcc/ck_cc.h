@@ -107,6 +107,12 @@
 #define CK_CC_LIKELY(x) (__builtin_expect(!!(x), 1))
 #define CK_CC_UNLIKELY(x) (__builtin_expect(!!(x), 0))
 
+/*
+ * Hints that the cache line containing the specified address is
+ * about to be read.
+ */
+#define CK_CC_PREFETCH(x) __builtin_prefetch((x), 0, 3)
+
 /*
  * Some compilers are overly strict regarding aliasing semantics.
  * Unfortunately, in many cases it makes more sense to pay aliasing
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_deque.h>
+
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../common.h"
+
+/*
+ * Computes Fibonacci numbers by recursive fork-join parallelism. Every
+ * level of the recursion forks its second branch onto the deque of the
+ * worker and joins it after computing the first, either by popping it
+ * back or, if it was stolen, by stealing work until it has completed.
+ */
+#ifndef CUTOFF
+#define CUTOFF 12
+#endif
+
+/* Deeper than the recursion, so that deques never grow. */
+#define DEPTH 64
+
+struct task {
+	unsigned int n;
+	unsigned int done;
+	uint64_t result;
+};
+
+struct worker {
+	ck_deque_t deque;
+	unsigned int seed;
+	uint64_t forks;
+	uint64_t steals;
+} CK_CC_CACHELINE;
+
+static struct worker *workers;
+static struct affinity affinity;
+static unsigned int n_workers;
+static unsigned int barrier;
+static unsigned int done;
+
+static void *
+deque_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+deque_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+	(void)r;
+	free(p);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = deque_malloc,
+	.free = deque_free
+};
+
+static uint64_t
+fib_serial(unsigned int n)
+{
+
+	return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static uint64_t fib(struct worker *, unsigned int);
+
+static void
+run(struct worker *worker, struct task *task)
+{
+
+	task->result = fib(worker, task->n);
+	ck_pr_fence_store();
+	ck_pr_store_uint(&task->done, 1);
+	return;
+}
+
+/* Steals and runs a single task from a random victim. */
+static bool
+steal(struct worker *worker)
+{
+	struct worker *victim;
+	struct task *task;
+
+	worker->seed ^= worker->seed << 13;
+	worker->seed ^= worker->seed >> 17;
+	worker->seed ^= worker->seed << 5;
+	victim = &workers[worker->seed % n_workers];
+	if (victim == worker)
+		return false;
+
+	if (ck_deque_trysteal(&victim->deque, &task) == false)
+		return false;
+
+	worker->steals++;
+	run(worker, task);
+	return true;
+}
+
+static uint64_t
+fib(struct worker *worker, unsigned int n)
+{
+	struct task child, *task;
+	uint64_t r;
+
+	if (n < CUTOFF)
+		return fib_serial(n);
+
+	child.n = n - 2;
+	child.done = 0;
+	if (ck_deque_push(&worker->deque, &child) == false)
+		ck_error("ERROR: Failed to fork.\n");
+
+	worker->forks++;
+	r = fib(worker, n - 1);
+
+	/* Everything forked since has been joined, so child is the bottom. */
+	if (ck_deque_pop(&worker->deque, &task) == true)
+		return r + fib(worker, task->n);
+
+	while (ck_pr_load_uint(&child.done) == 0) {
+		if (steal(worker) == false)
+			ck_pr_stall();
+	}
+
+	ck_pr_fence_load();
+	return r + child.result;
+}
+
+static void *
+thief(void *arg)
+{
+	struct worker *worker = arg;
+
+	aff_iterate(&affinity);
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&done) == 0) {
+		if (steal(worker) == false)
+			ck_pr_stall();
+	}
+
+	return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+	pthread_t *threads;
+	uint64_t s, e, r, forks = 0, steals = 0;
+	unsigned int i, n = 32;
+
+	if (argc != 3 && argc != 4) {
+		ck_error("Usage: fork_join <workers> <affinity delta> [n]\n");
+	}
+
+	n_workers = atoi(argv[1]);
+	affinity.delta = atoi(argv[2]);
+	if (argc == 4)
+		n = atoi(argv[3]);
+
+	if (n_workers == 0 || n >= DEPTH)
+		ck_error("ERROR: Invalid arguments.\n");
+
+	workers = calloc(n_workers, sizeof *workers);
+	threads = malloc(sizeof(pthread_t) * n_workers);
+	if (workers == NULL || threads == NULL)
+		ck_error("ERROR: Failed to allocate workers.\n");
+
+	for (i = 0; i < n_workers; i++) {
+		workers[i].seed = i * 2654435761U + 1;
+		if (ck_deque_init(&workers[i].deque, &my_allocator,
+		    DEPTH) == false)
+			ck_error("ERROR: Failed to initialize deque.\n");
+	}
+
+	aff_iterate(&affinity);
+	for (i = 1; i < n_workers; i++) {
+		if (pthread_create(&threads[i], NULL, thief,
+		    &workers[i]) != 0)
+			ck_error("ERROR: Failed to create worker.\n");
+	}
+
+	while (ck_pr_load_uint(&barrier) < n_workers - 1)
+		ck_pr_stall();
+
+	s = rdtsc();
+	r = fib(&workers[0], n);
+	e = rdtsc();
+
+	ck_pr_store_uint(&done, 1);
+	for (i = 1; i < n_workers; i++)
+		pthread_join(threads[i], NULL);
+
+	if (r != fib_serial(n))
+		ck_error("ERROR: fib(%u) is %" PRIu64 ".\n", n, r);
+
+	for (i = 0; i < n_workers; i++) {
+		forks += workers[i].forks;
+		steals += workers[i].steals;
+		ck_deque_deinit(&workers[i].deque);
+	}
+
+	printf("fib(%u) = %" PRIu64 "\n", n, r);
+	printf("  cycles: %16" PRIu64 "\n", e - s);
+	printf("   forks: %16" PRIu64 "\n", forks);
+	printf("  steals: %16" PRIu64 "\n", steals);
+	printf("cycles/fork: %13" PRIu64 "\n", (e - s) / (forks ? forks : 1));
+	return 0;
+}
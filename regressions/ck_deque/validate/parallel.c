@@ -0,0 +1,196 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_deque.h>
+
+#include <ck_epoch.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../common.h"
+
+#define N_THIEVES	3
+#define N_ENTRIES	(1 << 16)
+
+struct deque_epoch {
+	ck_epoch_entry_t epoch_entry;
+	size_t size;
+};
+
+static ck_deque_t deque;
+static ck_epoch_t epoch_deque;
+static ck_epoch_record_t epoch_owner;
+static ck_epoch_record_t records[N_THIEVES];
+static unsigned int seen[N_ENTRIES];
+static unsigned int barrier;
+static unsigned int done;
+
+static void
+deque_destroy(ck_epoch_entry_t *e)
+{
+	struct deque_epoch *h = (struct deque_epoch *)e;
+
+	/* Poison the array so that premature reclamation is detected. */
+	memset(h + 1, 0, h->size);
+	free(h);
+	return;
+}
+
+static void *
+deque_malloc(size_t r)
+{
+	struct deque_epoch *h;
+
+	h = malloc(sizeof(*h) + r);
+	if (h == NULL)
+		return NULL;
+
+	h->size = r;
+	return h + 1;
+}
+
+static void
+deque_free(void *p, size_t b, bool r)
+{
+	struct deque_epoch *h = p;
+
+	(void)b;
+
+	/* Only the owner grows the deque. */
+	if (r == true) {
+		ck_epoch_call(&epoch_owner, &(--h)->epoch_entry, deque_destroy);
+	} else {
+		free(--h);
+	}
+
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = deque_malloc,
+	.free = deque_free
+};
+
+/* Values are offset by one so that poisoned slots are detected. */
+#define VALUE(v) ((void *)((uintptr_t)(v) + 1))
+
+static void
+take(void *r)
+{
+	uintptr_t v = (uintptr_t)r;
+
+	if (v == 0 || v > N_ENTRIES)
+		ck_error("invalid entry %p\n", r);
+
+	ck_pr_inc_uint(&seen[v - 1]);
+	return;
+}
+
+static void *
+thief(void *arg)
+{
+	ck_epoch_record_t *record = arg;
+	unsigned int d;
+	bool stolen;
+	void *r;
+
+	ck_epoch_register(&epoch_deque, record, NULL);
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) < N_THIEVES + 1)
+		sched_yield();
+
+	do {
+		d = ck_pr_load_uint(&done);
+		ck_epoch_begin(record, NULL);
+		stolen = ck_deque_steal(&deque, &r);
+		ck_epoch_end(record, NULL);
+
+		if (stolen == true)
+			take(r);
+		else
+			sched_yield();
+	} while (stolen == true || d == 0);
+
+	ck_epoch_unregister(record);
+	return NULL;
+}
+
+int
+main(void)
+{
+	pthread_t threads[N_THIEVES];
+	unsigned int i;
+	void *r;
+
+	ck_epoch_init(&epoch_deque);
+	ck_epoch_register(&epoch_deque, &epoch_owner, NULL);
+	if (ck_deque_init(&deque, &my_allocator, 2) == false)
+		ck_error("init failed\n");
+
+	for (i = 0; i < N_THIEVES; i++) {
+		if (pthread_create(&threads[i], NULL, thief, &records[i]) != 0)
+			ck_error("failed to create thief\n");
+	}
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) < N_THIEVES + 1)
+		sched_yield();
+
+	for (i = 0; i < N_ENTRIES; i++) {
+		if (ck_deque_push(&deque, VALUE(i)) == false)
+			ck_error("push %u failed\n", i);
+
+		/* Race the thieves for the bottom entry. */
+		if ((i & 3) == 3 && ck_deque_pop(&deque, &r) == true)
+			take(r);
+
+		if ((i & 1023) == 0) {
+			ck_epoch_poll(&epoch_owner);
+			sched_yield();
+		}
+	}
+
+	while (ck_deque_pop(&deque, &r) == true)
+		take(r);
+
+	ck_pr_store_uint(&done, 1);
+	for (i = 0; i < N_THIEVES; i++)
+		pthread_join(threads[i], NULL);
+
+	for (i = 0; i < N_ENTRIES; i++) {
+		if (seen[i] != 1)
+			ck_error("entry %u taken %u times\n", i, seen[i]);
+	}
+
+	ck_epoch_barrier(&epoch_owner);
+	ck_deque_deinit(&deque);
+	return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_deque.h>
+
+#include <ck_malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../common.h"
+
+#define N_ENTRIES 1000
+
+static unsigned int n_deferred;
+
+static void *
+deque_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+deque_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+
+	/* Nothing else is reading the array in this test. */
+	if (r == true)
+		n_deferred++;
+
+	free(p);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = deque_malloc,
+	.free = deque_free
+};
+
+#define VALUE(v) ((void *)(uintptr_t)(v))
+
+static void
+test_round(ck_deque_t *deque, unsigned int n)
+{
+	unsigned int i, top = 0, bottom = n;
+	void *r;
+
+	for (i = 0; i < n; i++) {
+		if (ck_deque_push(deque, VALUE(i)) == false)
+			ck_error("push %u failed\n", i);
+	}
+
+	if (ck_deque_size(deque) != n)
+		ck_error("size is %u, expected %u\n", ck_deque_size(deque), n);
+
+	/* Alternate between both ends until the deque is drained. */
+	for (i = 0; i < n; i++) {
+		if ((i & 1) == 0) {
+			if (ck_deque_pop(deque, &r) == false ||
+			    r != VALUE(--bottom))
+				ck_error("pop %u failed\n", i);
+		} else {
+			if (ck_deque_steal(deque, &r) == false ||
+			    r != VALUE(top++))
+				ck_error("steal %u failed\n", i);
+		}
+	}
+
+	if (ck_deque_size(deque) != 0)
+		ck_error("drained deque has size %u\n", ck_deque_size(deque));
+
+	if (ck_deque_pop(deque, &r) == true)
+		ck_error("pop from empty deque succeeded\n");
+
+	if (ck_deque_trysteal(deque, &r) == true)
+		ck_error("steal from empty deque succeeded\n");
+
+	return;
+}
+
+int
+main(void)
+{
+	ck_deque_t deque;
+	unsigned int n;
+
+	if (ck_deque_init(&deque, &my_allocator, 0) == true)
+		ck_error("init with zero capacity succeeded\n");
+
+	if (ck_deque_init(&deque, &my_allocator, 3) == false)
+		ck_error("init failed\n");
+
+	if (ck_deque_capacity(&deque) != 4)
+		ck_error("capacity is %u\n", ck_deque_capacity(&deque));
+
+	/*
+	 * Later rounds start with counters in the middle of the array, so
+	 * that growing must also copy across the wrap-around point.
+	 */
+	for (n = 1; n <= N_ENTRIES; n = n * 3 + 1)
+		test_round(&deque, n);
+
+	if (ck_deque_capacity(&deque) < N_ENTRIES / 3)
+		ck_error("capacity is %u\n", ck_deque_capacity(&deque));
+
+	if (n_deferred == 0 ||
+	    4U << n_deferred != ck_deque_capacity(&deque))
+		ck_error("%u arrays deferred\n", n_deferred);
+
+	ck_deque_deinit(&deque);
+	return 0;
+}
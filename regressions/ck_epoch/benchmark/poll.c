@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_epoch.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../common.h"
+
+/*
+ * Compares the cost of reclamation when every thread owns a record with
+ * that of sharing one record per processor.
+ */
+#ifndef THREADS
+#define THREADS 4096
+#endif
+
+#ifndef CPUS
+#define CPUS 64
+#endif
+
+#ifndef STEPS
+#define STEPS 10000
+#endif
+
+static ck_epoch_record_t threads[THREADS];
+static ck_epoch_record_t cpus[CPUS];
+
+static void
+measure(const char *label, ck_epoch_record_t *records, unsigned int n,
+    bool per_cpu)
+{
+	ck_epoch_t epoch;
+	ck_epoch_record_t writer;
+	ck_epoch_section_t section;
+	uint64_t s, e, a_poll = 0, a_section = 0;
+	unsigned int i;
+
+	ck_epoch_init(&epoch);
+	ck_epoch_register(&epoch, &writer, NULL);
+	for (i = 0; i < n; i++) {
+		if (per_cpu == true)
+			ck_epoch_register_cpu(&epoch, &records[i], NULL);
+		else
+			ck_epoch_register(&epoch, &records[i], NULL);
+	}
+
+	for (i = 0; i < STEPS; i++) {
+		s = rdtsc();
+		if (per_cpu == true) {
+			ck_epoch_cpu_begin(&records[i % n], &section);
+			ck_epoch_cpu_end(&records[i % n], &section);
+		} else {
+			ck_epoch_begin(&records[i % n], NULL);
+			ck_epoch_end(&records[i % n], NULL);
+		}
+		e = rdtsc();
+		a_section += e - s;
+
+		s = rdtsc();
+		ck_epoch_poll(&writer);
+		e = rdtsc();
+		a_poll += e - s;
+	}
+
+	printf("%10s %8u records: section %8" PRIu64 " poll %10" PRIu64 "\n",
+	    label, n, a_section / STEPS, a_poll / STEPS);
+	return;
+}
+
+int
+main(void)
+{
+
+	measure("per-thread", threads, THREADS, false);
+	measure("per-cpu", cpus, CPUS, true);
+	return 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <ck_epoch.h>
+#include <ck_pr.h>
+
+#include "../../common.h"
+
+#define N_CPUS		4
+#define N_OBJECTS	65536
+
+#define VALID		0x5a5a5a5aU
+#define RETIRED		0xdeadbeefU
+
+struct object {
+	unsigned int magic;
+	ck_epoch_entry_t epoch_entry;
+};
+CK_EPOCH_CONTAINER(struct object, epoch_entry, object_container)
+
+static ck_epoch_t epoch;
+static ck_epoch_record_t cpus[N_CPUS];
+static ck_epoch_record_t writer;
+static struct object objects[N_OBJECTS];
+static struct object *current;
+static unsigned int n_retired;
+static unsigned int done;
+static struct affinity a;
+
+static void
+retire(ck_epoch_entry_t *e)
+{
+	struct object *o = object_container(e);
+
+	/* Only the writer dispatches, so the counter need not be atomic. */
+	o->magic = RETIRED;
+	n_retired++;
+	return;
+}
+
+static void
+test_serial(void)
+{
+	ck_epoch_section_t section;
+	unsigned int i;
+
+	objects[0].magic = VALID;
+	ck_epoch_cpu_begin(&cpus[1], &section);
+	ck_epoch_call(&writer, &objects[0].epoch_entry, retire);
+
+	/* An open section on any per-CPU record holds back reclamation. */
+	for (i = 0; i < 8; i++)
+		ck_epoch_poll(&writer);
+
+	if (objects[0].magic != VALID)
+		ck_error("ERROR: Object retired within a section.\n");
+
+	ck_epoch_cpu_end(&cpus[1], &section);
+	ck_epoch_barrier(&writer);
+	if (objects[0].magic != RETIRED)
+		ck_error("ERROR: Object was not retired.\n");
+
+	n_retired = 0;
+	return;
+}
+
+static void *
+reader(void *arg)
+{
+	unsigned int id = (unsigned int)(uintptr_t)arg;
+	ck_epoch_section_t section;
+	ck_epoch_record_t *record;
+	struct object *o;
+	unsigned int i, n = 0;
+
+	if (aff_iterate(&a)) {
+		perror("ERROR: Could not affine thread");
+		exit(EXIT_FAILURE);
+	}
+
+	while (ck_pr_load_uint(&done) == 0) {
+		/*
+		 * Threads outnumber records, and a thread is not bound to
+		 * a record across sections, as if it were migrating.
+		 */
+		record = &cpus[(id + n++) % N_CPUS];
+		ck_epoch_cpu_begin(record, &section);
+		o = ck_pr_load_ptr(&current);
+		for (i = 0; i < 16; i++) {
+			if (ck_pr_load_uint(&o->magic) != VALID)
+				ck_error("ERROR: Object %td retired while "
+				    "referenced.\n", o - objects);
+		}
+		ck_epoch_cpu_end(record, &section);
+
+		if ((n & 15) == 0)
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+	pthread_t *threads;
+	struct object *previous;
+	unsigned int i, nthr;
+
+	if (argc != 3)
+		ck_error("Usage: ck_epoch_cpu <threads> <affinity delta>\n");
+
+	nthr = atoi(argv[1]);
+	a.delta = atoi(argv[2]);
+	assert(nthr >= 1);
+
+	ck_epoch_init(&epoch);
+	ck_epoch_register(&epoch, &writer, NULL);
+	for (i = 0; i < N_CPUS; i++)
+		ck_epoch_register_cpu(&epoch, &cpus[i], NULL);
+
+	test_serial();
+
+	objects[0].magic = VALID;
+	ck_pr_store_ptr(&current, &objects[0]);
+
+	threads = malloc(sizeof(pthread_t) * nthr * 2);
+	assert(threads != NULL);
+	for (i = 0; i < nthr * 2; i++) {
+		if (pthread_create(&threads[i], NULL, reader,
+		    (void *)(uintptr_t)i) != 0)
+			ck_error("ERROR: Failed to create thread.\n");
+	}
+
+	for (i = 1; i < N_OBJECTS; i++) {
+		ck_pr_store_uint(&objects[i].magic, VALID);
+		previous = ck_pr_fas_ptr(&current, &objects[i]);
+		ck_epoch_call(&writer, &previous->epoch_entry, retire);
+		ck_epoch_poll(&writer);
+
+		if ((i & 15) == 0)
+			sched_yield();
+	}
+
+	ck_pr_store_uint(&done, 1);
+	for (i = 0; i < nthr * 2; i++)
+		pthread_join(threads[i], NULL);
+
+	ck_epoch_barrier(&writer);
+	if (n_retired != N_OBJECTS - 1)
+		ck_error("ERROR: Retired %u of %u objects.\n",
+		    n_retired, N_OBJECTS - 1);
+
+	free(threads);
+	return 0;
+}
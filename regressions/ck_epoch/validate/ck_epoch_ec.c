@@ -0,0 +1,249 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ck_epoch.h>
+#include <ck_epoch_ec.h>
+#include <ck_pr.h>
+
+#include "../../common.h"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#ifndef ITERATIONS
+#define ITERATIONS 2000
+#endif
+
+static int
+gettime(const struct ck_ec_ops *ops, struct timespec *out)
+{
+
+	(void)ops;
+	return clock_gettime(CLOCK_MONOTONIC, out);
+}
+
+static void
+wait32(const struct ck_ec_wait_state *state, const uint32_t *address,
+    uint32_t expected, const struct timespec *deadline)
+{
+
+	(void)state;
+	syscall(SYS_futex, address, FUTEX_WAIT_BITSET, expected, deadline,
+	    NULL, FUTEX_BITSET_MATCH_ANY, 0);
+	return;
+}
+
+static void
+wake32(const struct ck_ec_ops *ops, const uint32_t *address)
+{
+
+	(void)ops;
+	syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+	return;
+}
+
+static const struct ck_ec_ops ops = {
+	.gettime = gettime,
+	.wait32 = wait32,
+	.wake32 = wake32
+};
+
+static ck_epoch_t epoch;
+static ck_epoch_ec_t eec;
+static unsigned int n_rd;
+static unsigned int barrier;
+static unsigned int leave;
+static unsigned int ended;
+
+static struct {
+	unsigned int value;
+} valid CK_CC_CACHELINE = { 1 };
+
+static struct {
+	unsigned int value;
+} invalid CK_CC_CACHELINE;
+
+static double
+elapsed(clockid_t clock, const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(clock, &now);
+	return (double)(now.tv_sec - start->tv_sec) +
+	    (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void *
+stall_thread(void *unused)
+{
+	ck_epoch_record_t *record;
+
+	record = malloc(sizeof *record);
+	if (record == NULL)
+		ck_error("malloc failed\n");
+
+	ck_epoch_register(&epoch, record, NULL);
+	ck_epoch_begin(record, NULL);
+	ck_pr_store_uint(&barrier, 1);
+	usleep(200000);
+	ck_pr_store_uint(&ended, 1);
+	ck_epoch_end(record, NULL);
+	return unused;
+}
+
+/*
+ * A writer waiting for a long section must sleep, and is woken up by
+ * the end of the section.
+ */
+static void
+test_sleep(ck_epoch_record_t *record)
+{
+	struct timespec wall, cpu;
+	pthread_t thread;
+	double w, c;
+
+	pthread_create(&thread, NULL, stall_thread, NULL);
+	while (ck_pr_load_uint(&barrier) == 0)
+		sched_yield();
+
+	/* The epoch must be advanced past the stalled reader. */
+	ck_pr_inc_uint(&epoch.epoch);
+	clock_gettime(CLOCK_MONOTONIC, &wall);
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+	ck_epoch_ec_synchronize(record, &eec);
+	w = elapsed(CLOCK_MONOTONIC, &wall);
+	c = elapsed(CLOCK_THREAD_CPUTIME_ID, &cpu);
+
+	if (ck_pr_load_uint(&ended) == 0)
+		ck_error("grace period detected within a section\n");
+
+	if (c > w / 2)
+		ck_error("writer spun for %.3fs of %.3fs\n", c, w);
+
+	if (ck_ec32_value(&eec.ec) == 0 ||
+	    ck_pr_load_uint(&epoch.n_waiters) != 0)
+		ck_error("writer was not woken up by the reader\n");
+
+	pthread_join(thread, NULL);
+	return;
+}
+
+static void *
+read_thread(void *unused)
+{
+	ck_epoch_record_t *record;
+	unsigned int b, c;
+
+	record = malloc(sizeof *record);
+	if (record == NULL)
+		ck_error("malloc failed\n");
+
+	ck_epoch_register(&epoch, record, NULL);
+	ck_pr_inc_uint(&barrier);
+
+	while (ck_pr_load_uint(&leave) == 0) {
+		ck_epoch_begin(record, NULL);
+		c = ck_pr_load_uint(&invalid.value);
+		ck_pr_fence_load();
+		b = ck_pr_load_uint(&valid.value);
+		ck_test(c > b, "Invalid value: %u > %u\n", c, b);
+		sched_yield();
+		ck_epoch_end(record, NULL);
+	}
+
+	return unused;
+}
+
+/* Readers must never observe a value retired by a grace period. */
+static void
+test_grace(ck_epoch_record_t *record)
+{
+	pthread_t *threads;
+	unsigned int i;
+
+	threads = malloc(sizeof(pthread_t) * n_rd);
+	if (threads == NULL)
+		ck_error("malloc failed\n");
+
+	ck_pr_store_uint(&barrier, 0);
+	for (i = 0; i < n_rd; i++)
+		pthread_create(&threads[i], NULL, read_thread, NULL);
+
+	while (ck_pr_load_uint(&barrier) < n_rd)
+		sched_yield();
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		ck_pr_store_uint(&valid.value, i + 1);
+		ck_epoch_ec_synchronize(record, &eec);
+		ck_pr_store_uint(&invalid.value, i);
+		ck_pr_fence_store();
+	}
+
+	ck_pr_store_uint(&leave, 1);
+	for (i = 0; i < n_rd; i++)
+		pthread_join(threads[i], NULL);
+
+	free(threads);
+	return;
+}
+
+int
+main(int argc, char *argv[])
+{
+	ck_epoch_record_t record;
+
+	if (argc != 2)
+		ck_error("Usage: ck_epoch_ec <#readers>\n");
+
+	n_rd = atoi(argv[1]);
+	if (n_rd == 0)
+		n_rd = 1;
+
+	ck_epoch_init(&epoch);
+	ck_epoch_ec_init(&epoch, &eec, &ops);
+	ck_epoch_register(&epoch, &record, NULL);
+
+	test_sleep(&record);
+	test_grace(&record);
+	return 0;
+}
+#else
+int
+main(void)
+{
+
+	fprintf(stderr, "ck_epoch_ec requires futexes, skipping.\n");
+	return 0;
+}
+#endif /* __linux__ */
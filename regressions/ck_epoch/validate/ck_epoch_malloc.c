@@ -0,0 +1,250 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <ck_epoch.h>
+#include <ck_epoch_malloc.h>
+#include <ck_hs.h>
+#include <ck_pr.h>
+
+#include "../../common.h"
+
+static ck_epoch_t epoch;
+static ck_epoch_record_t writer;
+static ck_epoch_malloc_t em;
+static ck_hs_t hs;
+/* Only the writer allocates and reclaims. */
+static size_t outstanding;
+static unsigned int n_keys;
+static unsigned int done;
+static struct affinity a;
+
+CK_EPOCH_MALLOC_ALLOCATOR(test, &em);
+
+static void *
+backing_malloc(size_t r)
+{
+
+	outstanding += r;
+	return malloc(r);
+}
+
+static void
+backing_free(void *p, size_t b, bool r)
+{
+
+	(void)r;
+	outstanding -= b;
+	free(p);
+	return;
+}
+
+static struct ck_malloc m = {
+	.malloc = backing_malloc,
+	.free = backing_free
+};
+
+static struct ck_malloc *allocator = &ck_epoch_malloc_allocator_test;
+
+static void
+test_serial(void)
+{
+	unsigned char *p, *r;
+	unsigned int i;
+	void *objects[127];
+
+	ck_epoch_malloc_init(&em, &m, &writer, 0);
+
+	p = allocator->malloc(100);
+	allocator->free(p, 100, false);
+	if (outstanding != 0)
+		ck_error("ERROR: Immediate free was deferred.\n");
+
+	p = allocator->malloc(100);
+	for (i = 0; i < 100; i++)
+		p[i] = i;
+
+	/* A deferred realloc must leave the old object intact. */
+	ck_epoch_begin(&writer, NULL);
+	r = allocator->realloc(p, 100, 1000, true);
+	for (i = 0; i < 100; i++) {
+		if (p[i] != i || r[i] != i)
+			ck_error("ERROR: Byte %u was not preserved.\n", i);
+	}
+	ck_epoch_end(&writer, NULL);
+
+	allocator->free(r, 1000, true);
+	if (outstanding == 0)
+		ck_error("ERROR: Deferred objects were freed early.\n");
+
+	ck_epoch_barrier(&writer);
+	if (outstanding != 0)
+		ck_error("ERROR: Deferred objects were not reclaimed.\n");
+
+	/*
+	 * Without readers, every batch is reclaimed by the poll that
+	 * completes it.
+	 */
+	ck_epoch_malloc_init(&em, &m, &writer, 4);
+	for (i = 0; i < 127; i++)
+		objects[i] = allocator->malloc(64);
+
+	for (i = 0; i < 127; i++)
+		allocator->free(objects[i], 64, true);
+
+	if (writer.n_pending != 3)
+		ck_error("ERROR: %u objects pending reclamation.\n",
+		    writer.n_pending);
+
+	ck_epoch_barrier(&writer);
+	if (outstanding != 0)
+		ck_error("ERROR: Deferred objects were not reclaimed.\n");
+
+	return;
+}
+
+static unsigned long
+hs_hash(const void *object, unsigned long seed)
+{
+
+	return (uintptr_t)object * 2654435761UL ^ seed;
+}
+
+static bool
+hs_compare(const void *previous, const void *compare)
+{
+
+	return previous == compare;
+}
+
+#define KEY(i) ((void *)(uintptr_t)((i) + 1))
+
+static void *
+reader(void *unused)
+{
+	ck_epoch_record_t *record;
+	unsigned int i, n;
+	void *key;
+
+	(void)unused;
+	if (aff_iterate(&a)) {
+		perror("ERROR: Could not affine thread");
+		exit(EXIT_FAILURE);
+	}
+
+	record = malloc(sizeof *record);
+	assert(record != NULL);
+	ck_epoch_register(&epoch, record, NULL);
+
+	/* Maps retired by the writer must remain readable in a section. */
+	while (ck_pr_load_uint(&done) == 0) {
+		ck_epoch_begin(record, NULL);
+		n = ck_pr_load_uint(&n_keys);
+		for (i = 0; i < n; i += 7) {
+			key = KEY(i);
+			if (ck_hs_get(&hs, CK_HS_HASH(&hs, hs_hash, key),
+			    key) != key)
+				ck_error("ERROR: Key %u is missing.\n", i);
+		}
+		ck_epoch_end(record, NULL);
+		sched_yield();
+	}
+
+	ck_epoch_unregister(record);
+	return NULL;
+}
+
+static void
+test_concurrent(unsigned int nthr, unsigned int size)
+{
+	pthread_t *threads;
+	unsigned int i;
+	void *key;
+
+	ck_epoch_malloc_init(&em, &m, &writer, CK_EPOCH_MALLOC_BATCH);
+	if (ck_hs_init(&hs, CK_HS_MODE_SPMC | CK_HS_MODE_DIRECT, hs_hash,
+	    hs_compare, allocator, 8, 6602834) == false)
+		ck_error("ERROR: Failed to initialize set.\n");
+
+	threads = malloc(sizeof(pthread_t) * nthr);
+	assert(threads != NULL);
+	for (i = 0; i < nthr; i++) {
+		if (pthread_create(&threads[i], NULL, reader, NULL) != 0)
+			ck_error("ERROR: Failed to create thread.\n");
+	}
+
+	for (i = 0; i < size; i++) {
+		key = KEY(i);
+		if (ck_hs_put(&hs, CK_HS_HASH(&hs, hs_hash, key),
+		    key) == false)
+			ck_error("ERROR: Failed to insert key %u.\n", i);
+
+		ck_pr_store_uint(&n_keys, i + 1);
+		if ((i & 255) == 0)
+			sched_yield();
+	}
+
+	ck_pr_store_uint(&done, 1);
+	for (i = 0; i < nthr; i++)
+		pthread_join(threads[i], NULL);
+
+	ck_hs_deinit(&hs);
+	ck_epoch_barrier(&writer);
+	if (outstanding != 0)
+		ck_error("ERROR: %zu bytes leaked.\n", outstanding);
+
+	free(threads);
+	return;
+}
+
+int
+main(int argc, char *argv[])
+{
+	unsigned int nthr, size;
+
+	if (argc != 4)
+		ck_error("Usage: ck_epoch_malloc <threads> <affinity delta> "
+		    "<size>\n");
+
+	nthr = atoi(argv[1]);
+	a.delta = atoi(argv[2]);
+	size = atoi(argv[3]);
+	assert(nthr >= 1 && size > 0);
+
+	ck_epoch_init(&epoch);
+	ck_epoch_register(&epoch, &writer, NULL);
+
+	test_serial();
+	test_concurrent(nthr, size);
+	return 0;
+}
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <ck_epoch.h>
+#include <ck_pr.h>
+
+#include "../../common.h"
+
+#define N_SLOTS		16
+#define HANDOFF		32
+
+#define VALID		0x5a5a5a5aU
+#define RETIRED		0xdeadbeefU
+
+struct object {
+	unsigned int magic;
+	ck_epoch_entry_t epoch_entry;
+};
+CK_EPOCH_CONTAINER(struct object, epoch_entry, object_container)
+
+static ck_epoch_t epoch;
+static ck_epoch_reclaimer_t reclaimer;
+static struct object *slots[N_SLOTS];
+static unsigned int n_retired;
+static unsigned int n_writers;
+static unsigned int barrier;
+static unsigned int iterations;
+static struct affinity a;
+
+static void
+retire(ck_epoch_entry_t *e)
+{
+	struct object *o = object_container(e);
+
+	/* Callbacks only ever run on the reclaimer thread. */
+	o->magic = RETIRED;
+	n_retired++;
+	free(o);
+	return;
+}
+
+static struct object *
+object_create(void)
+{
+	struct object *o;
+
+	o = malloc(sizeof *o);
+	if (o == NULL)
+		ck_error("ERROR: Failed to allocate object.\n");
+
+	o->magic = VALID;
+	return o;
+}
+
+static void
+test_serial(void)
+{
+	struct ck_epoch_reclaimer_stat st;
+	static ck_epoch_record_t record;
+	unsigned int i;
+
+	ck_epoch_register(&epoch, &record, NULL);
+	for (i = 0; i < 10; i++) {
+		ck_epoch_call(&record, &object_create()->epoch_entry, retire);
+		if ((i & 3) == 0)
+			ck_epoch_poll(&reclaimer.record);
+	}
+
+	if (ck_epoch_reclaimer_handoff(&reclaimer, &record) != 10 ||
+	    record.n_pending != 0)
+		ck_error("ERROR: Handoff did not move every callback.\n");
+
+	ck_epoch_reclaimer_stat(&reclaimer, &st);
+	if (st.n_pending != 10 || st.n_handoff != 10)
+		ck_error("ERROR: Reclaimer has %u of %u callbacks.\n",
+		    st.n_pending, st.n_handoff);
+
+	while (ck_epoch_reclaimer_poll(&reclaimer) != 0);
+
+	ck_epoch_reclaimer_stat(&reclaimer, &st);
+	if (n_retired != 10 || st.n_dispatch != 10)
+		ck_error("ERROR: Dispatched %u of 10 callbacks.\n", n_retired);
+
+	ck_epoch_unregister(&record);
+	return;
+}
+
+static ck_epoch_record_t race_reader;
+static ck_epoch_record_t race_writer;
+static ck_epoch_entry_t race_entry[2];
+static unsigned int race_dispatched;
+
+static void
+race_victim(ck_epoch_entry_t *e)
+{
+
+	(void)e;
+	if (ck_pr_load_uint(&race_reader.active) != 0)
+		ck_error("ERROR: Callback dispatched within a section.\n");
+
+	race_dispatched = 1;
+	return;
+}
+
+/*
+ * Runs on the reclaimer, after the records were scanned. A reader begins
+ * a section, and a callback is then handed off to the reclaimer.
+ */
+static void
+race_trigger(ck_epoch_entry_t *e)
+{
+
+	(void)e;
+	ck_pr_inc_uint(&epoch.epoch);
+	ck_epoch_begin(&race_reader, NULL);
+
+	ck_epoch_begin(&race_writer, NULL);
+	ck_epoch_call(&race_writer, &race_entry[1], race_victim);
+	ck_epoch_end(&race_writer, NULL);
+	ck_epoch_reclaimer_handoff(&reclaimer, &race_writer);
+	return;
+}
+
+static void
+test_handoff_race(void)
+{
+
+	ck_epoch_register(&epoch, &race_reader, NULL);
+	ck_epoch_register(&epoch, &race_writer, NULL);
+
+	/* Callbacks of later slots are dispatched after the trigger. */
+	while ((ck_pr_load_uint(&epoch.epoch) & (CK_EPOCH_LENGTH - 1)) != 0)
+		ck_pr_inc_uint(&epoch.epoch);
+
+	ck_epoch_begin(&race_writer, NULL);
+	ck_epoch_call(&race_writer, &race_entry[0], race_trigger);
+	ck_epoch_end(&race_writer, NULL);
+	ck_epoch_reclaimer_handoff(&reclaimer, &race_writer);
+
+	ck_epoch_reclaimer_poll(&reclaimer);
+	if (ck_pr_load_uint(&race_reader.active) == 0)
+		ck_error("ERROR: Trigger was not dispatched.\n");
+
+	ck_epoch_reclaimer_poll(&reclaimer);
+	ck_epoch_end(&race_reader, NULL);
+	while (ck_epoch_reclaimer_poll(&reclaimer) != 0);
+
+	if (race_dispatched == 0)
+		ck_error("ERROR: Handed off callback was not dispatched.\n");
+
+	ck_epoch_unregister(&race_writer);
+	ck_epoch_unregister(&race_reader);
+	return;
+}
+
+static void *
+writer(void *arg)
+{
+	unsigned int seed = (unsigned int)(uintptr_t)arg + 1;
+	ck_epoch_record_t *record;
+	struct object *o;
+	unsigned int i;
+
+	if (aff_iterate(&a)) {
+		perror("ERROR: Could not affine thread");
+		exit(EXIT_FAILURE);
+	}
+
+	record = malloc(sizeof *record);
+	assert(record != NULL);
+	ck_epoch_register(&epoch, record, NULL);
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) < n_writers)
+		sched_yield();
+
+	for (i = 0; i < iterations; i++) {
+		seed = seed * 1103515245 + 12345;
+
+		/* Readers may hold a reference to the displaced object. */
+		ck_epoch_begin(record, NULL);
+		o = ck_pr_load_ptr(&slots[(seed >> 20) % N_SLOTS]);
+		if (o != NULL && ck_pr_load_uint(&o->magic) != VALID)
+			ck_error("ERROR: Object retired while referenced.\n");
+		ck_epoch_end(record, NULL);
+
+		o = ck_pr_fas_ptr(&slots[(seed >> 8) % N_SLOTS],
+		    object_create());
+		if (o != NULL)
+			ck_epoch_call(record, &o->epoch_entry, retire);
+
+		/* Request threads never poll, they only hand off. */
+		if ((i % HANDOFF) == 0) {
+			ck_epoch_reclaimer_handoff(&reclaimer, record);
+			sched_yield();
+		}
+	}
+
+	ck_epoch_reclaimer_handoff(&reclaimer, record);
+	if (record->n_pending != 0)
+		ck_error("ERROR: Record still has %u callbacks.\n",
+		    record->n_pending);
+
+	ck_pr_dec_uint(&barrier);
+	return NULL;
+}
+
+static void *
+reclaim(void *unused)
+{
+	unsigned int pending;
+	bool done;
+
+	/* Writers hand off their last callbacks before checking out. */
+	(void)unused;
+	do {
+		done = ck_pr_load_uint(&barrier) == 0;
+		ck_pr_fence_load();
+		pending = ck_epoch_reclaimer_poll(&reclaimer);
+		sched_yield();
+	} while (done == false || pending != 0);
+
+	return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct ck_epoch_reclaimer_stat st;
+	pthread_t *threads;
+	unsigned int i, n;
+
+	if (argc != 4)
+		ck_error("Usage: ck_epoch_reclaimer <threads> "
+		    "<affinity delta> <iterations>\n");
+
+	n_writers = atoi(argv[1]);
+	a.delta = atoi(argv[2]);
+	iterations = atoi(argv[3]);
+	assert(n_writers >= 1);
+
+	ck_epoch_init(&epoch);
+	ck_epoch_reclaimer_init(&epoch, &reclaimer);
+	test_serial();
+	test_handoff_race();
+	n_retired = 0;
+
+	threads = malloc(sizeof(pthread_t) * (n_writers + 1));
+	assert(threads != NULL);
+
+	/* The reclaimer waits for writers to check in. */
+	barrier = 0;
+	for (i = 0; i < n_writers; i++) {
+		if (pthread_create(&threads[i], NULL, writer,
+		    (void *)(uintptr_t)i) != 0)
+			ck_error("ERROR: Failed to create thread.\n");
+	}
+
+	while (ck_pr_load_uint(&barrier) < n_writers)
+		sched_yield();
+
+	if (pthread_create(&threads[n_writers], NULL, reclaim, NULL) != 0)
+		ck_error("ERROR: Failed to create thread.\n");
+
+	for (i = 0; i <= n_writers; i++)
+		pthread_join(threads[i], NULL);
+
+	/* Every displaced object has been retired by the reclaimer. */
+	for (i = 0, n = 0; i < N_SLOTS; i++)
+		n += slots[i] != NULL;
+
+	ck_epoch_reclaimer_stat(&reclaimer, &st);
+	if (n_retired != n_writers * iterations - n ||
+	    st.n_pending != 0 || st.n_dispatch != st.n_handoff)
+		ck_error("ERROR: Retired %u of %u objects.\n", n_retired,
+		    n_writers * iterations - n);
+
+	for (i = 0; i < N_SLOTS; i++)
+		free(slots[i]);
+
+	free(threads);
+	return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <ck_epoch.h>
+
+#include "../../common.h"
+
+#ifndef CK_MD_EPOCH_STAT_ENABLE
+#error "CK_MD_EPOCH_STAT_ENABLE must be defined"
+#endif
+
+static ck_epoch_t epoch;
+static ck_epoch_record_t records[3];
+static ck_epoch_entry_t entries[8];
+static unsigned int now;
+static unsigned int tick;
+static unsigned int n_dispatch;
+
+static unsigned int
+clock_now(void)
+{
+
+	now += tick;
+	return now;
+}
+
+static void
+cb(ck_epoch_entry_t *e)
+{
+
+	(void)e;
+	n_dispatch++;
+	return;
+}
+
+int
+main(void)
+{
+	struct ck_epoch_stat st;
+	unsigned int i;
+
+	ck_epoch_init(&epoch);
+	ck_epoch_stat_clock(&epoch, clock_now);
+	for (i = 0; i < 3; i++)
+		ck_epoch_register(&epoch, &records[i], NULL);
+
+	/* The oldest section is the one that began first. */
+	now = 10;
+	ck_epoch_begin(&records[0], NULL);
+	now = 50;
+	ck_epoch_begin(&records[1], NULL);
+	now = 100;
+	ck_epoch_stat(&epoch, &st);
+	if (st.n_records != 3 || st.n_active != 2)
+		ck_error("%u records, %u active\n", st.n_records, st.n_active);
+
+	if (st.oldest != &records[0] || st.oldest_age != 90)
+		ck_error("oldest section %p of age %u\n",
+		    (void *)st.oldest, st.oldest_age);
+
+	/* Nested sections do not reset the age. */
+	ck_epoch_begin(&records[0], NULL);
+	ck_epoch_stat(&epoch, &st);
+	if (st.oldest != &records[0] || st.oldest_age != 90)
+		ck_error("nested section reset age to %u\n", st.oldest_age);
+
+	ck_epoch_end(&records[0], NULL);
+	ck_epoch_end(&records[0], NULL);
+	ck_epoch_stat(&epoch, &st);
+	if (st.oldest != &records[1] || st.oldest_age != 50)
+		ck_error("oldest section %p of age %u\n",
+		    (void *)st.oldest, st.oldest_age);
+
+	/*
+	 * Polls with an active section advance the epoch and dispatch the
+	 * callbacks of two generations ago.
+	 */
+	for (i = 0; i < 8; i++)
+		ck_epoch_call(&records[2], &entries[i], cb);
+
+	for (i = 0; i < 3; i++) {
+		ck_epoch_poll(&records[2]);
+		ck_epoch_end(&records[1], NULL);
+		ck_epoch_begin(&records[1], NULL);
+	}
+
+	ck_epoch_end(&records[1], NULL);
+	ck_epoch_stat(&epoch, &st);
+	if (st.n_advance != 3 || st.n_poll != 3 ||
+	    st.n_poll_dispatch != n_dispatch || n_dispatch != 8)
+		ck_error("%u advances, %u polls, %u/%u dispatched\n",
+		    st.n_advance, st.n_poll, st.n_poll_dispatch, n_dispatch);
+
+	if (st.n_active != 0 || st.oldest != NULL || st.n_dispatch != 8 ||
+	    st.n_pending != 0 || st.n_peak != 8)
+		ck_error("%u active, %u dispatched, %u pending, %u peak\n",
+		    st.n_active, st.n_dispatch, st.n_pending, st.n_peak);
+
+	/* Grace periods are binned by the log2 of their latency. */
+	tick = 1000;
+	ck_epoch_synchronize(&records[2]);
+	tick = 0;
+	ck_epoch_synchronize(&records[2]);
+	ck_epoch_stat(&epoch, &st);
+	if (st.n_synchronize != 2 || st.synchronize[9] != 1 ||
+	    st.synchronize[0] != 1)
+		ck_error("%u grace periods, histogram %u %u\n",
+		    st.n_synchronize, st.synchronize[0], st.synchronize[9]);
+
+	/* Statistics of unregistered records are discarded. */
+	ck_epoch_unregister(&records[2]);
+	ck_epoch_stat(&epoch, &st);
+	if (st.n_records != 2 || st.n_poll != 0)
+		ck_error("%u records, %u polls\n", st.n_records, st.n_poll);
+
+	return 0;
+}
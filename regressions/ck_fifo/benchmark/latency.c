@@ -62,6 +62,14 @@ main(void)
 	ck_fifo_mpmc_entry_t *garbage;
 #endif
 
+#if defined(CK_F_FIFO_FAA)
+	ck_fifo_faa_t faa_fifo;
+	static ck_fifo_faa_segment_t faa_segment[ENTRIES /
+	    CK_FIFO_FAA_SEGMENT_SIZE + 1];
+	ck_fifo_faa_segment_t *faa_spare, *faa_garbage;
+	unsigned int k;
+#endif
+
 #ifdef CK_F_FIFO_SPSC
 	a = 0;
 	for (i = 0; i < STEPS; i++) {
@@ -153,5 +161,44 @@ main(void)
 	printf("ck_fifo_mpmc_dequeue: %16" PRIu64 "\n", a / STEPS / (sizeof(mpmc_entry) / sizeof(*mpmc_entry)));
 #endif
 
+#ifdef CK_F_FIFO_FAA
+	a = 0;
+	for (i = 0; i < STEPS; i++) {
+		ck_fifo_faa_init(&faa_fifo, faa_segment);
+		faa_spare = NULL;
+		k = 1;
+
+		s = rdtsc();
+		for (j = 0; j < ENTRIES; j++) {
+			while (ck_fifo_faa_enqueue(&faa_fifo, &faa_spare,
+			    &r) == false)
+				faa_spare = faa_segment + k++;
+		}
+		e = rdtsc();
+
+		a += e - s;
+	}
+	printf(" ck_fifo_faa_enqueue: %16" PRIu64 "\n", a / STEPS / ENTRIES);
+
+	a = 0;
+	for (i = 0; i < STEPS; i++) {
+		ck_fifo_faa_init(&faa_fifo, faa_segment);
+		faa_spare = NULL;
+		k = 1;
+		for (j = 0; j < ENTRIES; j++) {
+			while (ck_fifo_faa_enqueue(&faa_fifo, &faa_spare,
+			    &r) == false)
+				faa_spare = faa_segment + k++;
+		}
+
+		s = rdtsc();
+		for (j = 0; j < ENTRIES; j++)
+			ck_fifo_faa_dequeue(&faa_fifo, &r, &faa_garbage);
+		e = rdtsc();
+		a += e - s;
+	}
+	printf(" ck_fifo_faa_dequeue: %16" PRIu64 "\n", a / STEPS / ENTRIES);
+#endif
+
 	return 0;
 }
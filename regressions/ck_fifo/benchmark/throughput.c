@@ -0,0 +1,215 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_epoch.h>
+#include <ck_fifo.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../common.h"
+
+/*
+ * Every thread alternates between enqueuing and dequeuing, so that all
+ * threads contend on both ends of the queue.
+ */
+#ifndef PAIRS
+#define PAIRS 1000000
+#endif
+
+static struct affinity affinity;
+static unsigned int nthr;
+static unsigned int barrier;
+static uint64_t cycles;
+
+#ifdef CK_F_FIFO_MPMC
+static ck_fifo_mpmc_t mpmc_fifo CK_CC_CACHELINE;
+
+static void *
+mpmc_thread(void *unused)
+{
+	ck_fifo_mpmc_entry_t *entry;
+	uint64_t s;
+	unsigned int i;
+	void *r;
+
+	(void)unused;
+	aff_iterate(&affinity);
+
+	/* Dequeued entries are type-stable and are recycled as is. */
+	entry = malloc(sizeof *entry);
+	if (entry == NULL)
+		ck_error("ERROR: Failed to allocate entry.\n");
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) < nthr)
+		ck_pr_stall();
+
+	s = rdtsc();
+	for (i = 0; i < PAIRS; i++) {
+		ck_fifo_mpmc_enqueue(&mpmc_fifo, entry, &r);
+		while (ck_fifo_mpmc_dequeue(&mpmc_fifo, &r, &entry) == false)
+			ck_pr_stall();
+	}
+
+	ck_pr_add_64(&cycles, rdtsc() - s);
+	return NULL;
+}
+#endif
+
+#ifdef CK_F_FIFO_FAA
+struct segment {
+	ck_fifo_faa_segment_t segment;
+	ck_epoch_entry_t epoch_entry;
+};
+CK_EPOCH_CONTAINER(struct segment, epoch_entry, segment_container)
+
+static ck_fifo_faa_t faa_fifo CK_CC_CACHELINE;
+static ck_epoch_t epoch;
+
+static ck_fifo_faa_segment_t *
+segment_malloc(void)
+{
+	struct segment *segment;
+
+	segment = malloc(sizeof *segment);
+	if (segment == NULL)
+		ck_error("ERROR: Failed to allocate segment.\n");
+
+	return &segment->segment;
+}
+
+static void
+segment_destroy(ck_epoch_entry_t *e)
+{
+
+	free(segment_container(e));
+	return;
+}
+
+static void *
+faa_thread(void *unused)
+{
+	ck_fifo_faa_segment_t *spare = NULL, *garbage;
+	ck_epoch_record_t *record;
+	uint64_t s;
+	unsigned int i;
+	bool dequeued;
+	void *r;
+
+	(void)unused;
+	aff_iterate(&affinity);
+
+	record = malloc(sizeof *record);
+	if (record == NULL)
+		ck_error("ERROR: Failed to allocate record.\n");
+
+	ck_epoch_register(&epoch, record, NULL);
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) < nthr)
+		ck_pr_stall();
+
+	s = rdtsc();
+	for (i = 0; i < PAIRS; i++) {
+		ck_epoch_begin(record, NULL);
+		while (ck_fifo_faa_enqueue(&faa_fifo, &spare, &r) == false)
+			spare = segment_malloc();
+
+		do {
+			dequeued = ck_fifo_faa_dequeue(&faa_fifo, &r, &garbage);
+			if (garbage != NULL) {
+				ck_epoch_call(record,
+				    &((struct segment *)garbage)->epoch_entry,
+				    segment_destroy);
+			}
+		} while (dequeued == false);
+		ck_epoch_end(record, NULL);
+
+		if ((i & 1023) == 0)
+			ck_epoch_poll(record);
+	}
+
+	ck_pr_add_64(&cycles, rdtsc() - s);
+	ck_epoch_barrier(record);
+	free(spare);
+	return NULL;
+}
+#endif
+
+static void
+run(const char *name, void *(*thread)(void *))
+{
+	pthread_t *threads;
+	unsigned int i;
+
+	threads = malloc(sizeof(pthread_t) * nthr);
+	if (threads == NULL)
+		ck_error("ERROR: Failed to allocate threads.\n");
+
+	affinity.request = 0;
+	barrier = 0;
+	cycles = 0;
+	for (i = 0; i < nthr; i++) {
+		if (pthread_create(threads + i, NULL, thread, NULL) != 0)
+			ck_error("ERROR: Failed to create thread.\n");
+	}
+
+	for (i = 0; i < nthr; i++)
+		pthread_join(threads[i], NULL);
+
+	printf("%20s: %16" PRIu64 "\n", name, cycles / nthr / PAIRS);
+	free(threads);
+	return;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	if (argc != 3) {
+		ck_error("Usage: throughput <threads> <affinity delta>\n");
+	}
+
+	nthr = atoi(argv[1]);
+	affinity.delta = atoi(argv[2]);
+	if (nthr == 0)
+		ck_error("ERROR: Number of threads must be positive.\n");
+
+#ifdef CK_F_FIFO_MPMC
+	ck_fifo_mpmc_init(&mpmc_fifo, malloc(sizeof(ck_fifo_mpmc_entry_t)));
+	run("ck_fifo_mpmc", mpmc_thread);
+#endif
+
+#ifdef CK_F_FIFO_FAA
+	ck_epoch_init(&epoch);
+	ck_fifo_faa_init(&faa_fifo, segment_malloc());
+	run("ck_fifo_faa", faa_thread);
+#endif
+
+	return 0;
+}
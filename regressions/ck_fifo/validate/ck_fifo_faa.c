@@ -0,0 +1,343 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+
+/* Small segments exercise the segment transitions. */
+#define CK_FIFO_FAA_SEGMENT_SIZE 16
+
+#include <ck_epoch.h>
+#include <ck_fifo.h>
+
+#include "../../common.h"
+
+#ifdef CK_F_FIFO_FAA
+struct segment {
+	ck_fifo_faa_segment_t segment;
+	ck_epoch_entry_t epoch_entry;
+};
+CK_EPOCH_CONTAINER(struct segment, epoch_entry, segment_container)
+
+static ck_fifo_faa_t fifo CK_CC_CACHELINE;
+static ck_epoch_t epoch;
+static unsigned int *seen;
+static unsigned int barrier;
+static struct affinity a;
+static unsigned int nthr;
+static unsigned int size;
+
+/* Values are offset by one so that they are never NULL. */
+#define VALUE(tid, i) ((void *)((uintptr_t)(tid) * size + (i) + 1))
+
+static ck_fifo_faa_segment_t *
+segment_malloc(void)
+{
+	struct segment *s;
+
+	/* The queue segment is the first member, so it may be freed. */
+	s = malloc(sizeof *s);
+	if (s == NULL)
+		ck_error("ERROR: Failed to allocate segment.\n");
+
+	return &s->segment;
+}
+
+static void
+segment_destroy(ck_epoch_entry_t *e)
+{
+
+	free(segment_container(e));
+	return;
+}
+
+static bool
+dequeue(void *r, ck_fifo_faa_segment_t **garbage)
+{
+
+	return ck_fifo_faa_dequeue(&fifo, r, garbage);
+}
+
+static void
+test_serial(void)
+{
+	ck_fifo_faa_segment_t *spare = NULL, *garbage, *s, *n;
+	unsigned int i, round, length, allocated = 1, retired = 0;
+	void *r;
+
+	size = CK_FIFO_FAA_SEGMENT_SIZE * 4 + 3;
+	ck_fifo_faa_init(&fifo, segment_malloc());
+
+	/* The second round starts out in the middle of a segment. */
+	for (round = 0; round < 2; round++) {
+		if (CK_FIFO_FAA_ISEMPTY(&fifo) == false)
+			ck_error("ERROR: Queue is not empty.\n");
+
+		for (i = 0; i < size; i++) {
+			if (ck_fifo_faa_enqueue(&fifo, &spare,
+			    VALUE(0, i)) == true)
+				continue;
+
+			if (spare != NULL)
+				ck_error("ERROR: Enqueue %u failed.\n", i);
+
+			spare = segment_malloc();
+			allocated++;
+			if (ck_fifo_faa_enqueue(&fifo, &spare,
+			    VALUE(0, i)) == false || spare != NULL)
+				ck_error("ERROR: Spare was not consumed.\n");
+		}
+
+		/* The last dequeue must observe an empty queue. */
+		for (i = 0; i <= size; i++) {
+			if (dequeue(&r, &garbage) != (i < size))
+				ck_error("ERROR: Dequeue %u failed.\n", i);
+
+			if (i < size && r != VALUE(0, i))
+				ck_error("ERROR: Entry %u is %p.\n", i, r);
+
+			if (garbage != NULL) {
+				free(garbage);
+				retired++;
+			}
+		}
+	}
+
+	ck_fifo_faa_deinit(&fifo, &s);
+	for (length = 0; s != NULL; s = n, length++) {
+		n = s->next;
+		free(s);
+	}
+
+	if (length != 1 || allocated != retired + length)
+		ck_error("ERROR: Retired %u of %u segments.\n",
+		    retired, allocated);
+
+	return;
+}
+
+/*
+ * A producer may link a new segment and stall before forwarding the tail
+ * to it. A consumer that drains and unlinks the old segment must not
+ * leave the tail pointing to it once it is retired.
+ */
+static void
+test_stalled_tail(void)
+{
+	ck_fifo_faa_segment_t *spare = NULL, *garbage, *first, *segment;
+	unsigned int i;
+	void *r;
+
+	size = CK_FIFO_FAA_SEGMENT_SIZE + 1;
+	first = segment_malloc();
+	ck_fifo_faa_init(&fifo, first);
+	for (i = 0; i < CK_FIFO_FAA_SEGMENT_SIZE; i++) {
+		if (ck_fifo_faa_enqueue(&fifo, &spare, VALUE(0, i)) == false)
+			ck_error("ERROR: Enqueue %u failed.\n", i);
+	}
+
+	/* The steps of ck_fifo_faa_enqueue up to forwarding the tail. */
+	segment = segment_malloc();
+	ck_fifo_faa_segment_init(segment);
+	segment->p_tail = 1;
+	segment->slots[0] = VALUE(0, i);
+	if (ck_pr_cas_ptr(&first->next, NULL, segment) == false)
+		ck_error("ERROR: Failed to link segment.\n");
+
+	for (i = 0; i < size;) {
+		if (dequeue(&r, &garbage) == true) {
+			if (r != VALUE(0, i))
+				ck_error("ERROR: Entry %u is %p.\n", i, r);
+
+			i++;
+		} else if (garbage == NULL) {
+			ck_error("ERROR: Dequeue %u failed.\n", i);
+		}
+
+		if (garbage != NULL) {
+			if (garbage != first)
+				ck_error("ERROR: Unexpected garbage.\n");
+
+			if (ck_pr_load_ptr(&fifo.tail) == first)
+				ck_error("ERROR: Tail is a retired segment.\n");
+
+			free(garbage);
+			first = NULL;
+		}
+	}
+
+	if (first != NULL)
+		ck_error("ERROR: Segment was not retired.\n");
+
+	/* The stalled producer resumes, the queue must remain usable. */
+	if (ck_fifo_faa_enqueue(&fifo, &spare, VALUE(0, 0)) == false ||
+	    dequeue(&r, &garbage) == false || r != VALUE(0, 0))
+		ck_error("ERROR: Queue is unusable.\n");
+
+	ck_fifo_faa_deinit(&fifo, &segment);
+	free(segment);
+	return;
+}
+
+static void *
+test(void *c)
+{
+	unsigned int tid = (unsigned int)(uintptr_t)c;
+	ck_fifo_faa_segment_t *spare = NULL, *garbage;
+	ck_epoch_record_t *record;
+	unsigned int *last, i, producer, sequence;
+	uintptr_t v;
+	bool r;
+
+	if (aff_iterate(&a)) {
+		perror("ERROR: Could not affine thread");
+		exit(EXIT_FAILURE);
+	}
+
+	record = malloc(sizeof *record);
+	last = calloc(nthr, sizeof *last);
+	if (record == NULL || last == NULL)
+		ck_error("ERROR: Failed to allocate thread state.\n");
+
+	ck_epoch_register(&epoch, record, NULL);
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) < nthr)
+		ck_pr_stall();
+
+	for (i = 0; i < size; i++) {
+		ck_epoch_begin(record, NULL);
+		while (ck_fifo_faa_enqueue(&fifo, &spare,
+		    VALUE(tid, i)) == false)
+			spare = segment_malloc();
+		ck_epoch_end(record, NULL);
+
+		/*
+		 * Every thread enqueues before it dequeues. Values are never
+		 * 0, so an entry that is not stored is reported as invalid.
+		 */
+		v = 0;
+		do {
+			ck_epoch_begin(record, NULL);
+			r = ck_fifo_faa_dequeue(&fifo, &v, &garbage);
+			ck_epoch_end(record, NULL);
+
+			if (garbage != NULL) {
+				ck_epoch_call(record,
+				    &((struct segment *)garbage)->epoch_entry,
+				    segment_destroy);
+			} else if (r == false) {
+				ck_error("ERROR [%u] Queue should never be "
+				    "empty.\n", tid);
+			}
+		} while (r == false);
+
+		v--;
+		producer = v / size;
+		sequence = v % size + 1;
+		if (producer >= nthr)
+			ck_error("ERROR [%u] Invalid entry %lu.\n",
+			    tid, (unsigned long)v);
+
+		/* Entries of a producer are observed in order. */
+		if (sequence <= last[producer])
+			ck_error("ERROR [%u] Entry %u of %u after %u.\n",
+			    tid, sequence, producer, last[producer]);
+
+		last[producer] = sequence;
+		ck_pr_inc_uint(&seen[v]);
+		ck_epoch_poll(record);
+	}
+
+	ck_epoch_barrier(record);
+	free(spare);
+	free(last);
+	return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+	ck_fifo_faa_segment_t *s, *n;
+	pthread_t *thread;
+	unsigned int i;
+
+	if (argc != 4) {
+		ck_error("Usage: validate <threads> <affinity delta> <size>\n");
+	}
+
+	test_serial();
+	test_stalled_tail();
+
+	a.delta = atoi(argv[2]);
+	nthr = atoi(argv[1]);
+	assert(nthr >= 1);
+
+	size = atoi(argv[3]);
+	assert(size > 0);
+
+	thread = malloc(sizeof(pthread_t) * nthr);
+	seen = calloc((size_t)nthr * size, sizeof *seen);
+	assert(thread != NULL && seen != NULL);
+
+	ck_epoch_init(&epoch);
+	ck_fifo_faa_init(&fifo, segment_malloc());
+	for (i = 0; i < nthr; i++) {
+		if (pthread_create(thread + i, NULL, test,
+		    (void *)(uintptr_t)i) != 0)
+			ck_error("ERROR: Failed to create thread.\n");
+	}
+
+	for (i = 0; i < nthr; i++)
+		pthread_join(thread[i], NULL);
+
+	for (i = 0; i < nthr * size; i++) {
+		if (seen[i] != 1)
+			ck_error("ERROR: Entry %u observed %u times.\n",
+			    i, seen[i]);
+	}
+
+	if (CK_FIFO_FAA_ISEMPTY(&fifo) == false)
+		ck_error("ERROR: Queue is not empty.\n");
+
+	ck_fifo_faa_deinit(&fifo, &s);
+	for (; s != NULL; s = n) {
+		n = s->next;
+		free(s);
+	}
+
+	return 0;
+}
+#else
+int
+main(void)
+{
+	fprintf(stderr, "Unsupported.\n");
+	return 0;
+}
+#endif
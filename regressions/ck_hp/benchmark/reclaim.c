@@ -0,0 +1,113 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_hp.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../common.h"
+
+#ifndef DEGREE
+#define DEGREE 4
+#endif
+
+#ifndef RECORDS
+#define RECORDS 1024
+#endif
+
+#ifndef PENDING
+#define PENDING 1024
+#endif
+
+#ifndef STEPS
+#define STEPS 1000
+#endif
+
+struct object {
+	ck_hp_hazard_t hazard;
+};
+
+static ck_hp_t hp;
+static ck_hp_record_t records[RECORDS];
+static void *slots[RECORDS][DEGREE];
+static struct object objects[PENDING];
+
+static void
+destructor(void *pointer)
+{
+
+	(void)pointer;
+	return;
+}
+
+/*
+ * Measures the cost of a reclamation pass as a function of the number of
+ * subscribers, where every hazard slot is active and every other pending
+ * object is protected.
+ */
+int
+main(void)
+{
+	ck_hp_record_t *writer = &records[0];
+	uint64_t s, a;
+	unsigned int i, j, k, n;
+
+	ck_hp_init(&hp, DEGREE, PENDING + 1, destructor);
+	for (n = 1; n <= RECORDS; n <<= 1) {
+		for (i = n >> 1; i < n; i++)
+			ck_hp_register(&hp, &records[i], slots[i]);
+
+		a = 0;
+		for (i = 0; i < STEPS; i++) {
+			k = 0;
+			for (j = 0; j < n * DEGREE; j++) {
+				slots[j / DEGREE][j % DEGREE] = &objects[k];
+				k = (k + 2) % PENDING;
+			}
+
+			for (j = 0; j < PENDING; j++) {
+				ck_hp_retire(writer, &objects[j].hazard,
+				    &objects[j], &objects[j]);
+			}
+
+			s = rdtsc();
+			ck_hp_reclaim(writer);
+			a += rdtsc() - s;
+
+			memset(slots, 0, sizeof slots);
+			ck_hp_reclaim(writer);
+		}
+
+		printf("%5u subscribers: %16" PRIu64 " cycles/reclaim, "
+		    "%" PRIu64 " reclamations\n", n, a / STEPS,
+		    writer->n_reclamations);
+	}
+
+	return 0;
+}
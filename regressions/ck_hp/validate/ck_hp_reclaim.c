@@ -0,0 +1,166 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <ck_hp.h>
+
+#include "../../common.h"
+
+#define DEGREE		4
+#define RECORDS		512
+#define OBJECTS		1024
+
+struct object {
+	unsigned int freed;
+	ck_hp_hazard_t hazard;
+};
+
+static ck_hp_t hp;
+static ck_hp_record_t records[RECORDS];
+static void *slots[RECORDS][DEGREE];
+static struct object objects[OBJECTS];
+static char decoys[RECORDS * DEGREE];
+
+static void
+destructor(void *pointer)
+{
+	struct object *o = pointer;
+
+	if (o->freed++ != 0)
+		ck_error("object %td destroyed twice\n", o - objects);
+
+	return;
+}
+
+/*
+ * Every stride-th object is protected by the hazards of the first
+ * n_records records, the remaining slots of which point to decoys.
+ */
+static void
+test(unsigned int n_records, unsigned int stride)
+{
+	ck_hp_record_t *writer = &records[0];
+	unsigned int i, j, k, protected = 0;
+	uint64_t reclaimed = writer->n_reclamations;
+
+	for (i = 0; i < RECORDS; i++) {
+		for (j = 0; j < DEGREE; j++)
+			ck_hp_set(&records[i], j, NULL);
+	}
+
+	k = 0;
+	for (i = 0; i < n_records; i++) {
+		for (j = 0; j < DEGREE; j++) {
+			if (k < OBJECTS) {
+				ck_hp_set(&records[i], j, &objects[k]);
+				protected++;
+				k += stride;
+			} else {
+				ck_hp_set(&records[i], j,
+				    &decoys[i * DEGREE + j]);
+			}
+		}
+	}
+
+	for (i = 0; i < OBJECTS; i++) {
+		objects[i].freed = 0;
+		ck_hp_retire(writer, &objects[i].hazard, &objects[i],
+		    &objects[i]);
+	}
+
+	ck_hp_reclaim(writer);
+	for (i = 0; i < OBJECTS; i++) {
+		if (i % stride == 0 && i / stride < protected) {
+			if (objects[i].freed != 0)
+				ck_error("[%u] protected object %u destroyed\n",
+				    n_records, i);
+		} else if (objects[i].freed == 0) {
+			ck_error("[%u] unprotected object %u pending\n",
+			    n_records, i);
+		}
+	}
+
+	if (writer->n_pending != protected ||
+	    writer->n_reclamations - reclaimed != OBJECTS - protected)
+		ck_error("[%u] %u pending, expected %u\n",
+		    n_records, writer->n_pending, protected);
+
+	for (i = 0; i < RECORDS; i++) {
+		for (j = 0; j < DEGREE; j++)
+			ck_hp_set(&records[i], j, NULL);
+	}
+
+	ck_hp_reclaim(writer);
+	if (writer->n_pending != 0 ||
+	    writer->n_reclamations - reclaimed != OBJECTS)
+		ck_error("[%u] %u objects pending after hazards cleared\n",
+		    n_records, writer->n_pending);
+
+	return;
+}
+
+int
+main(void)
+{
+	unsigned int i;
+
+	ck_hp_init(&hp, DEGREE, OBJECTS, destructor);
+	for (i = 0; i < RECORDS; i++)
+		ck_hp_register(&hp, &records[i], slots[i]);
+
+	/* Hazards fit in the cache. */
+	test(1, 3);
+	test(16, 3);
+	test(64, 1);
+
+	/* Hazards overflow the cache and pending objects are batched. */
+	test(128, 1);
+	test(RECORDS, 1);
+	test(RECORDS, 3);
+
+	/* Duplicate hazards. */
+	for (i = 0; i < DEGREE; i++)
+		slots[1][i] = &objects[0];
+
+	ck_hp_retire(&records[0], &objects[0].hazard, &objects[0],
+	    &objects[0]);
+	objects[0].freed = 0;
+	ck_hp_reclaim(&records[0]);
+	if (objects[0].freed != 0)
+		ck_error("object protected by duplicates destroyed\n");
+
+	for (i = 0; i < DEGREE; i++)
+		slots[1][i] = NULL;
+
+	ck_hp_reclaim(&records[0]);
+	if (objects[0].freed != 1)
+		ck_error("object was not destroyed\n");
+
+	return 0;
+}
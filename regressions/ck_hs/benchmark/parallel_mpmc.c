@@ -0,0 +1,277 @@
+/*
+ * Copyright 2012 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyrights
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyrights
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures write throughput of a CK_HS_MODE_MPMC set at 1 to N writers,
+ * against a CK_HS_MODE_SPMC set with writers serialized on a single lock.
+ * Every writer inserts, looks up and removes its own range of keys.
+ */
+
+#include <ck_hs.h>
+
+#include <assert.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <ck_spinlock.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../common.h"
+
+struct deferred {
+	struct deferred *next;
+};
+
+static ck_hs_t hs CK_CC_CACHELINE;
+static ck_spinlock_t global_lock CK_CC_CACHELINE = CK_SPINLOCK_INITIALIZER;
+static ck_spinlock_t deferred_lock = CK_SPINLOCK_INITIALIZER;
+static struct deferred *deferred_head;
+static unsigned int n_writers;
+static unsigned int barrier;
+static unsigned long n_keys;
+static unsigned int n_rounds;
+static bool mpmc;
+static struct affinity affinerator = AFFINITY_INITIALIZER;
+
+static void *
+hs_malloc(size_t r)
+{
+	struct deferred *d;
+
+	d = malloc(sizeof(*d) + r);
+	if (d == NULL)
+		return NULL;
+
+	return d + 1;
+}
+
+/*
+ * Writers may still reference a replaced map, deferred destruction
+ * occurs once all writers have exited.
+ */
+static void
+hs_free(void *p, size_t b, bool r)
+{
+	struct deferred *d = p;
+
+	(void)b;
+
+	d--;
+	if (r == false) {
+		free(d);
+		return;
+	}
+
+	ck_spinlock_lock(&deferred_lock);
+	d->next = deferred_head;
+	deferred_head = d;
+	ck_spinlock_unlock(&deferred_lock);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = hs_malloc,
+	.free = hs_free
+};
+
+static unsigned long
+hs_hash(const void *object, unsigned long seed)
+{
+	uintptr_t h = (uintptr_t)object;
+
+	h ^= seed;
+	h *= (uintptr_t)0x9E3779B97F4A7C15ULL;
+	return (unsigned long)(h ^ (h >> 29));
+}
+
+static void
+set_init(void)
+{
+	unsigned int mode = CK_HS_MODE_DIRECT;
+
+	mode |= mpmc == true ? CK_HS_MODE_MPMC : CK_HS_MODE_SPMC;
+	if (ck_hs_init(&hs, mode, hs_hash, NULL, &my_allocator, 1024,
+	    6602834) == false) {
+		ck_error("ERROR: Failed to initialize hash set.\n");
+	}
+
+	return;
+}
+
+static void
+set_destroy(void)
+{
+	struct deferred *d;
+
+	ck_hs_deinit(&hs);
+	while (deferred_head != NULL) {
+		d = deferred_head;
+		deferred_head = d->next;
+		free(d);
+	}
+
+	return;
+}
+
+static void
+set_lock(void)
+{
+
+	if (mpmc == false)
+		ck_spinlock_lock(&global_lock);
+
+	return;
+}
+
+static void
+set_unlock(void)
+{
+
+	if (mpmc == false)
+		ck_spinlock_unlock(&global_lock);
+
+	return;
+}
+
+static void *
+writer(void *arg)
+{
+	uintptr_t base = (uintptr_t)arg * n_keys + 1;
+	unsigned long i, h;
+	unsigned int j;
+	void *k;
+
+	if (aff_iterate(&affinerator) != 0)
+		perror("WARNING: Failed to affine thread");
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) != n_writers)
+		ck_pr_stall();
+
+	for (j = 0; j < n_rounds; j++) {
+		for (i = 0; i < n_keys; i++) {
+			k = (void *)(base + i);
+			h = CK_HS_HASH(&hs, hs_hash, k);
+
+			set_lock();
+			ck_hs_put(&hs, h, k);
+			set_unlock();
+		}
+
+		for (i = 0; i < n_keys; i++) {
+			k = (void *)(base + i);
+			h = CK_HS_HASH(&hs, hs_hash, k);
+
+			if (ck_hs_get(&hs, h, k) != k)
+				ck_error("ERROR: Failed to find key.\n");
+
+			set_lock();
+			ck_hs_remove(&hs, h, k);
+			set_unlock();
+		}
+	}
+
+	return NULL;
+}
+
+static double
+run(unsigned int n)
+{
+	struct timeval start, end;
+	pthread_t *threads;
+	unsigned int i;
+	double elapsed;
+
+	threads = malloc(sizeof(pthread_t) * n);
+	assert(threads != NULL);
+
+	set_init();
+	n_writers = n;
+	barrier = 0;
+	affinerator.request = 0;
+
+	common_gettimeofday(&start, NULL);
+	for (i = 0; i < n; i++) {
+		if (pthread_create(&threads[i], NULL, writer,
+		    (void *)(uintptr_t)i) != 0)
+			ck_error("ERROR: Failed to create thread %u.\n", i);
+	}
+
+	for (i = 0; i < n; i++)
+		pthread_join(threads[i], NULL);
+	common_gettimeofday(&end, NULL);
+
+	set_destroy();
+	free(threads);
+
+	elapsed = (double)(end.tv_sec - start.tv_sec) +
+	    (double)(end.tv_usec - start.tv_usec) / 1000000.0;
+
+	/* Every round performs two write operations per key. */
+	return ((double)n * n_rounds * n_keys * 2) / elapsed;
+}
+
+int
+main(int argc, char *argv[])
+{
+	unsigned int maximum, n;
+	double a, b;
+
+	maximum = CORES;
+	n_keys = 65536;
+	n_rounds = 16;
+
+	if (argc >= 2)
+		maximum = atoi(argv[1]);
+
+	if (argc >= 3)
+		n_keys = strtoul(argv[2], NULL, 10);
+
+	if (argc >= 4)
+		n_rounds = atoi(argv[3]);
+
+	if (maximum == 0 || n_keys == 0 || n_rounds == 0) {
+		ck_error("Usage: parallel_mpmc [<maximum writers> <keys per writer> "
+		    "<rounds>]\n");
+	}
+
+	affinerator.delta = 1;
+	fprintf(stderr, "# writers, MPMC (ops/s), SPMC + lock (ops/s)\n");
+	for (n = 1; n <= maximum; n++) {
+		mpmc = true;
+		a = run(n);
+
+		mpmc = false;
+		b = run(n);
+
+		printf("%u,%.0f,%.0f\n", n, a, b);
+	}
+
+	return 0;
+}
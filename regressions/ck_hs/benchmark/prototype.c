@@ -0,0 +1,163 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_hs.h>
+
+#include <ck_malloc.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../common.h"
+
+struct entry {
+	uint64_t key;
+};
+
+static unsigned long
+entry_hash(const struct entry *e, unsigned long seed)
+{
+	uint64_t h = (e->key ^ seed) * 0x9E3779B97F4A7C15ULL;
+
+	return (unsigned long)(h ^ (h >> 29));
+}
+
+static bool
+entry_compare(const struct entry *a, const struct entry *b)
+{
+
+	return a->key == b->key;
+}
+
+CK_HS_PROTOTYPE(entry, entry, entry_hash, entry_compare)
+
+static void *
+hs_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+hs_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+	(void)r;
+	free(p);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = hs_malloc,
+	.free = hs_free
+};
+
+static ck_hs_t hs;
+static struct entry *entries;
+static struct entry *lookups;
+
+/*
+ * Lookups use copies of the keys, so that every hit is resolved by the
+ * comparison function rather than by pointer equality.
+ */
+static uint64_t
+bench(bool typed, size_t n, size_t offset, unsigned int r)
+{
+	uint64_t s, a = 0;
+	unsigned int j;
+	size_t i, found = 0;
+	unsigned long h;
+
+	for (j = 0; j < r; j++) {
+		s = rdtsc();
+		for (i = 0; i < n; i++) {
+			if (typed == true) {
+				found += CK_HS_GET(entry, &hs,
+				    &lookups[i + offset]) != NULL;
+			} else {
+				h = CK_HS_HASH(&hs, entry_hash,
+				    &lookups[i + offset]);
+				found += ck_hs_get(&hs, h,
+				    &lookups[i + offset]) != NULL;
+			}
+		}
+		a += rdtsc() - s;
+	}
+
+	if (found != (offset == 0 ? n * r : 0))
+		ck_error("ERROR: %zu lookups succeeded.\n", found);
+
+	return a / (r * n);
+}
+
+int
+main(int argc, char *argv[])
+{
+	unsigned int mode = CK_HS_MODE_SPMC | CK_HS_MODE_OBJECT;
+	unsigned int r = 100;
+	size_t i, n = 1000000;
+
+	if (argc > 1)
+		n = strtoul(argv[1], NULL, 10);
+
+	if (argc > 2)
+		r = atoi(argv[2]);
+
+	if (argc > 3 && atoi(argv[3]) != 0)
+		mode |= CK_HS_MODE_TAG;
+
+	if (n == 0 || r == 0)
+		ck_error("Usage: prototype [<entries> [<repetitions> [<tag>]]]\n");
+
+	entries = malloc(sizeof(*entries) * n);
+	lookups = malloc(sizeof(*lookups) * n * 2);
+	if (entries == NULL || lookups == NULL)
+		ck_error("ERROR: Failed to allocate keys.\n");
+
+	if (CK_HS_INIT(entry, &hs, mode, &my_allocator, n, 6602834) == false)
+		ck_error("ERROR: Failed to initialize hash set.\n");
+
+	for (i = 0; i < n; i++) {
+		entries[i].key = i;
+		lookups[i].key = i;
+		lookups[i + n].key = i + n;
+		if (CK_HS_PUT(entry, &hs, &entries[i]) == false)
+			ck_error("ERROR: Failed to insert key %zu.\n", i);
+	}
+
+	printf("#  entries    generic hit  prototype hit"
+	    "   generic miss prototype miss\n");
+	printf("%10zu %14" PRIu64 " %14" PRIu64 " %14" PRIu64 " %14" PRIu64 "\n",
+	    n, bench(false, n, 0, r), bench(true, n, 0, r),
+	    bench(false, n, n, r), bench(true, n, n, r));
+
+	ck_hs_deinit(&hs);
+	free(lookups);
+	free(entries);
+	return 0;
+}
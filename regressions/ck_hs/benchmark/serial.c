@@ -44,6 +44,9 @@ static size_t keys_length = 0;
 static size_t keys_capacity = 128;
 static unsigned long global_seed;
 
+/* Number of keys looked up per ck_hs_get_batch call. */
+#define SET_BATCH 64
+
 static void *
 hs_malloc(size_t r)
 {
@@ -147,6 +150,23 @@ set_get(const char *value)
 	return v;
 }
 
+static size_t
+set_get_batch(char **value, size_t n)
+{
+	unsigned long h[SET_BATCH];
+	void *v[SET_BATCH];
+	size_t i, found = 0;
+
+	for (i = 0; i < n; i++)
+		h[i] = CK_HS_HASH(&hs, hs_hash, value[i]);
+
+	ck_hs_get_batch(&hs, h, (const void *const *)value, v, n);
+	for (i = 0; i < n; i++)
+		found += v[i] != NULL;
+
+	return found;
+}
+
 static bool
 set_insert(const char *value)
 {
@@ -221,7 +241,7 @@ run_test(const char *file, size_t r, unsigned int size, unsigned int mode)
 	char buffer[512];
 	size_t i, j;
 	unsigned int d = 0;
-	uint64_t s, e, a, ri, si, ai, sr, rg, sg, ag, sd, ng, ss, sts, su, sgc, sb;
+	uint64_t s, e, a, ri, si, ai, sr, rg, sg, ag, bg, sd, ng, ss, sts, su, sgc, sb;
 	struct ck_hs_stat st;
 	char **t;
 
@@ -364,6 +384,26 @@ run_test(const char *file, size_t r, unsigned int size, unsigned int mode)
 	}
 	ag = a / (r * keys_length);
 
+	a = 0;
+	for (j = 0; j < r; j++) {
+		keys_shuffle(keys);
+
+		s = rdtsc();
+		for (i = 0; i < keys_length; i += SET_BATCH) {
+			size_t n = keys_length - i;
+
+			if (n > SET_BATCH)
+				n = SET_BATCH;
+
+			if (set_get_batch(keys + i, n) != n) {
+				ck_error("ERROR: Unexpected NULL value.\n");
+			}
+		}
+		e = rdtsc();
+		a += e - s;
+	}
+	bg = a / (r * keys_length);
+
 	a = 0;
 	for (j = 0; j < r; j++) {
 		s = rdtsc();
@@ -472,8 +512,9 @@ run_test(const char *file, size_t r, unsigned int size, unsigned int mode)
 	    "%" PRIu64 " "
 	    "%" PRIu64 " "
 	    "%" PRIu64 " "
+	    "%" PRIu64 " "
 	    "%" PRIu64 "\n",
-	    keys_length, ri, si, ai, ss, sr, rg, sg, ag, sd, ng, sts, su, sgc, sb);
+	    keys_length, ri, si, ai, ss, sr, rg, sg, ag, bg, sd, ng, sts, su, sgc, sb);
 
 	fclose(fp);
 
@@ -508,9 +549,10 @@ main(int argc, char *argv[])
 	global_seed = common_lrand48();
 	run_test(argv[1], r, size, 0);
 	run_test(argv[1], r, size, CK_HS_MODE_DELETE);
+	run_test(argv[1], r, size, CK_HS_MODE_TAG);
 	fprintf(stderr, "#    reverse_insertion serial_insertion random_insertion serial_swap "
-	    "serial_replace reverse_get serial_get random_get serial_remove negative_get tombstone "
-	    "set_unique gc rebuild\n\n");
+	    "serial_replace reverse_get serial_get random_get batch_get serial_remove "
+	    "negative_get tombstone set_unique gc rebuild\n\n");
 
 	return 0;
 }
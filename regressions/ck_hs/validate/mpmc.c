@@ -0,0 +1,301 @@
+/*
+ * Copyright 2012 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyrights
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyrights
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_hs.h>
+
+#include <assert.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <ck_spinlock.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../common.h"
+
+/*
+ * Keys in [1, PERMANENT] are inserted before any thread starts and are never
+ * removed: readers must always observe them, across concurrent grows. Each
+ * writer then repeatedly inserts and removes its own range of keys and races
+ * all other writers on a range of shared keys.
+ */
+#define PERMANENT	512
+#define OWNED		1024
+#define SHARED		256
+#define ROUNDS		64
+
+struct deferred {
+	struct deferred *next;
+};
+
+static ck_hs_t hs;
+static unsigned int n_writers;
+static unsigned int n_readers;
+static unsigned int barrier;
+static unsigned int done;
+static unsigned int inserted[SHARED];
+static ck_spinlock_t deferred_lock = CK_SPINLOCK_INITIALIZER;
+static struct deferred *deferred_head;
+static struct affinity a;
+
+static void *
+hs_malloc(size_t r)
+{
+	struct deferred *d;
+
+	d = malloc(sizeof(*d) + r);
+	if (d == NULL)
+		return NULL;
+
+	return d + 1;
+}
+
+/*
+ * Maps may still be referenced by concurrent readers and writers, so
+ * deferred destruction is postponed until all threads have exited.
+ */
+static void
+hs_free(void *p, size_t b, bool r)
+{
+	struct deferred *d = p;
+
+	(void)b;
+
+	d--;
+	if (r == false) {
+		free(d);
+		return;
+	}
+
+	ck_spinlock_lock(&deferred_lock);
+	d->next = deferred_head;
+	deferred_head = d;
+	ck_spinlock_unlock(&deferred_lock);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = hs_malloc,
+	.free = hs_free
+};
+
+static unsigned long
+hs_hash(const void *object, unsigned long seed)
+{
+	uintptr_t h = (uintptr_t)object;
+
+	h ^= seed;
+	h *= (uintptr_t)0x9E3779B97F4A7C15ULL;
+	return (unsigned long)(h ^ (h >> 29));
+}
+
+static void *
+key(uintptr_t k)
+{
+
+	return (void *)k;
+}
+
+static uintptr_t
+shared_key(unsigned int i)
+{
+
+	return PERMANENT + 1 + i;
+}
+
+static uintptr_t
+owned_key(unsigned int id, unsigned int i)
+{
+
+	return PERMANENT + SHARED + 1 + (uintptr_t)id * OWNED + i;
+}
+
+static void *
+reader(void *unused)
+{
+	unsigned long h;
+	uintptr_t k;
+
+	(void)unused;
+	if (aff_iterate(&a) != 0)
+		perror("WARNING: Failed to affine thread");
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) != n_readers + n_writers)
+		ck_pr_stall();
+
+	while (ck_pr_load_uint(&done) != n_writers) {
+		for (k = 1; k <= PERMANENT; k++) {
+			h = CK_HS_HASH(&hs, hs_hash, key(k));
+			if (ck_hs_get(&hs, h, key(k)) != key(k))
+				ck_error("ERROR: Permanent key %lu not found.\n",
+				    (unsigned long)k);
+		}
+	}
+
+	return NULL;
+}
+
+static void *
+writer(void *arg)
+{
+	unsigned int id = (unsigned int)(uintptr_t)arg;
+	unsigned int i, j;
+	unsigned long h;
+	void *previous;
+	uintptr_t k;
+
+	if (aff_iterate(&a) != 0)
+		perror("WARNING: Failed to affine thread");
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) != n_readers + n_writers)
+		ck_pr_stall();
+
+	for (j = 0; j < ROUNDS; j++) {
+		for (i = 0; i < OWNED; i++) {
+			k = owned_key(id, i);
+			h = CK_HS_HASH(&hs, hs_hash, key(k));
+			if (ck_hs_put(&hs, h, key(k)) == false)
+				ck_error("ERROR: Failed to insert owned key.\n");
+
+			if (ck_hs_put(&hs, h, key(k)) == true)
+				ck_error("ERROR: Duplicate insertion succeeded.\n");
+		}
+
+		for (i = 0; i < SHARED; i++) {
+			k = shared_key(i);
+			h = CK_HS_HASH(&hs, hs_hash, key(k));
+			if (ck_hs_put(&hs, h, key(k)) == true)
+				ck_pr_inc_uint(&inserted[i]);
+		}
+
+		for (i = 0; i < OWNED; i++) {
+			k = owned_key(id, i);
+			h = CK_HS_HASH(&hs, hs_hash, key(k));
+			if (ck_hs_get(&hs, h, key(k)) != key(k))
+				ck_error("ERROR: Owned key not found.\n");
+
+			if (i & 1) {
+				if (ck_hs_set(&hs, h, key(k), &previous) == false ||
+				    previous != key(k))
+					ck_error("ERROR: Failed to replace owned key.\n");
+			}
+
+			if (ck_hs_remove(&hs, h, key(k)) != key(k))
+				ck_error("ERROR: Failed to remove owned key.\n");
+
+			if (ck_hs_get(&hs, h, key(k)) != NULL)
+				ck_error("ERROR: Removed key still found.\n");
+		}
+	}
+
+	ck_pr_inc_uint(&done);
+	return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+	pthread_t *threads;
+	struct deferred *d;
+	unsigned int i;
+	unsigned long h;
+	uintptr_t k;
+
+	if (argc != 4) {
+		ck_error("Usage: mpmc <#readers> <#writers> <affinity delta>\n");
+	}
+
+	n_readers = atoi(argv[1]);
+	n_writers = atoi(argv[2]);
+	a.delta = atoi(argv[3]);
+	if (n_writers == 0)
+		ck_error("ERROR: At least one writer is required.\n");
+
+	threads = malloc(sizeof(pthread_t) * (n_readers + n_writers));
+	assert(threads != NULL);
+
+	if (ck_hs_init(&hs, CK_HS_MODE_MPMC | CK_HS_MODE_SPMC | CK_HS_MODE_DIRECT,
+	    hs_hash, NULL, &my_allocator, 8, 6602834) == true)
+		ck_error("ERROR: SPMC and MPMC modes must be mutually exclusive.\n");
+
+	if (ck_hs_init(&hs, CK_HS_MODE_MPMC | CK_HS_MODE_DIRECT | CK_HS_MODE_DELETE,
+	    hs_hash, NULL, &my_allocator, 8, 6602834) == false)
+		ck_error("ck_hs_init\n");
+
+	for (k = 1; k <= PERMANENT; k++) {
+		h = CK_HS_HASH(&hs, hs_hash, key(k));
+		if (ck_hs_put(&hs, h, key(k)) == false)
+			ck_error("ERROR: Failed to insert permanent key.\n");
+	}
+
+	for (i = 0; i < n_readers; i++)
+		pthread_create(threads + i, NULL, reader, NULL);
+
+	for (i = 0; i < n_writers; i++) {
+		pthread_create(threads + n_readers + i, NULL, writer,
+		    (void *)(uintptr_t)i);
+	}
+
+	for (i = 0; i < n_readers + n_writers; i++)
+		pthread_join(threads[i], NULL);
+
+	for (i = 0; i < SHARED; i++) {
+		if (inserted[i] != 1)
+			ck_error("ERROR: Shared key inserted %u times.\n", inserted[i]);
+
+		k = shared_key(i);
+		h = CK_HS_HASH(&hs, hs_hash, key(k));
+		if (ck_hs_get(&hs, h, key(k)) != key(k))
+			ck_error("ERROR: Shared key not found.\n");
+	}
+
+	if (ck_hs_count(&hs) != PERMANENT + SHARED) {
+		ck_error("ERROR: Expected %u entries, found %lu.\n",
+		    PERMANENT + SHARED, ck_hs_count(&hs));
+	}
+
+	if (ck_hs_gc(&hs, 0, 0) == false)
+		ck_error("ERROR: Failed to compact the set.\n");
+
+	for (k = 1; k <= PERMANENT + SHARED; k++) {
+		h = CK_HS_HASH(&hs, hs_hash, key(k));
+		if (ck_hs_get(&hs, h, key(k)) != key(k))
+			ck_error("ERROR: Key lost after compaction.\n");
+	}
+
+	ck_hs_deinit(&hs);
+	while (deferred_head != NULL) {
+		d = deferred_head;
+		deferred_head = d->next;
+		free(d);
+	}
+
+	free(threads);
+	return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_hs.h>
+
+#include <ck_malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../common.h"
+
+#define N_ENTRIES 4096
+
+struct entry {
+	unsigned long key;
+	unsigned long value;
+};
+
+static unsigned long
+entry_hash(const struct entry *e, unsigned long seed)
+{
+	unsigned long h = (e->key ^ seed) * 0x9E3779B97F4A7C15ULL;
+
+	return h ^ (h >> 29);
+}
+
+static bool
+entry_compare(const struct entry *a, const struct entry *b)
+{
+
+	return a->key == b->key;
+}
+
+CK_HS_PROTOTYPE(entry, entry, entry_hash, entry_compare)
+
+static void *
+hs_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+hs_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+	(void)r;
+	free(p);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = hs_malloc,
+	.free = hs_free
+};
+
+static struct entry entries[N_ENTRIES];
+static struct entry replacements[N_ENTRIES];
+
+static void
+run_test(unsigned int mode)
+{
+	struct entry key, *previous;
+	ck_hs_t hs;
+	unsigned long i;
+
+	if (CK_HS_INIT(entry, &hs, mode, &my_allocator, 8, 6602834) == false)
+		ck_error("ck_hs_init_entry\n");
+
+	for (i = 0; i < N_ENTRIES; i++) {
+		entries[i].key = i;
+		entries[i].value = i;
+		if (CK_HS_PUT(entry, &hs, &entries[i]) == false)
+			ck_error("[%u] ck_hs_put_entry %lu\n", mode, i);
+
+		if (CK_HS_PUT(entry, &hs, &entries[i]) == true)
+			ck_error("[%u] duplicate put %lu\n", mode, i);
+	}
+
+	if (ck_hs_count(&hs) != N_ENTRIES)
+		ck_error("[%u] count %lu\n", mode, ck_hs_count(&hs));
+
+	/* Lookups by an equal key at a different address. */
+	for (i = 0; i < N_ENTRIES; i++) {
+		key.key = i;
+		if (CK_HS_GET(entry, &hs, &key) != &entries[i])
+			ck_error("[%u] ck_hs_get_entry %lu\n", mode, i);
+
+		if (ck_hs_get(&hs, ck_hs_hash_entry(&hs, &key), &key) !=
+		    &entries[i])
+			ck_error("[%u] ck_hs_get %lu\n", mode, i);
+	}
+
+	key.key = N_ENTRIES;
+	if (CK_HS_GET(entry, &hs, &key) != NULL)
+		ck_error("[%u] found absent key\n", mode);
+
+	for (i = 0; i < N_ENTRIES; i++) {
+		replacements[i].key = i;
+		replacements[i].value = i + 1;
+		if (i & 1) {
+			if (CK_HS_SET(entry, &hs, &replacements[i],
+			    &previous) == false)
+				ck_error("[%u] ck_hs_set_entry %lu\n", mode, i);
+		} else {
+			if (CK_HS_FAS(entry, &hs, &replacements[i],
+			    &previous) == false)
+				ck_error("[%u] ck_hs_fas_entry %lu\n", mode, i);
+		}
+
+		if (previous != &entries[i])
+			ck_error("[%u] previous %lu\n", mode, i);
+	}
+
+	for (i = 0; i < N_ENTRIES; i++) {
+		key.key = i;
+		previous = CK_HS_GET(entry, &hs, &key);
+		if (previous == NULL || previous->value != i + 1)
+			ck_error("[%u] replaced value %lu\n", mode, i);
+
+		if (i & 1)
+			continue;
+
+		if (CK_HS_REMOVE(entry, &hs, &key) != &replacements[i])
+			ck_error("[%u] ck_hs_remove_entry %lu\n", mode, i);
+
+		if (CK_HS_GET(entry, &hs, &key) != NULL)
+			ck_error("[%u] found removed key %lu\n", mode, i);
+	}
+
+	for (i = 0; i < N_ENTRIES; i += 2) {
+		if (CK_HS_PUT_UNIQUE(entry, &hs, &entries[i]) == false)
+			ck_error("[%u] ck_hs_put_unique_entry %lu\n", mode, i);
+
+		key.key = i;
+		if (CK_HS_GET(entry, &hs, &key) != &entries[i])
+			ck_error("[%u] reinserted key %lu\n", mode, i);
+	}
+
+	ck_hs_deinit(&hs);
+	return;
+}
+
+int
+main(void)
+{
+	static const unsigned int modes[] = {
+		CK_HS_MODE_SPMC | CK_HS_MODE_OBJECT,
+		CK_HS_MODE_SPMC | CK_HS_MODE_OBJECT | CK_HS_MODE_DELETE,
+		CK_HS_MODE_SPMC | CK_HS_MODE_OBJECT | CK_HS_MODE_TAG,
+		CK_HS_MODE_SPMC | CK_HS_MODE_OBJECT | CK_HS_MODE_INCREMENTAL,
+		CK_HS_MODE_MPMC | CK_HS_MODE_OBJECT | CK_HS_MODE_TAG
+	};
+	unsigned int i;
+
+	for (i = 0; i < sizeof(modes) / sizeof(*modes); i++)
+		run_test(modes[i]);
+
+	return 0;
+}
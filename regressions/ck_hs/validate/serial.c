@@ -154,7 +154,7 @@ run_test(unsigned int is, unsigned int ad)
 	unsigned long h;
 	ck_hs_iterator_t it;
 
-	if (ck_hs_init(&hs[0], CK_HS_MODE_SPMC | CK_HS_MODE_OBJECT | ad, hs_hash, hs_compare, &my_allocator, is, 6602834) == false)
+	if (ck_hs_init(&hs[0], CK_HS_MODE_OBJECT | ad, hs_hash, hs_compare, &my_allocator, is, 6602834) == false)
 		ck_error("ck_hs_init\n");
 
 	for (j = 0; j < size; j++) {
@@ -403,7 +403,7 @@ test_set_relocation(unsigned int mode)
 	char b0[] = "B-key", b1[] = "B-key";
 	char c0[] = "C-key", c1[] = "C-key";
 
-	if (ck_hs_init(&hs, CK_HS_MODE_SPMC | CK_HS_MODE_OBJECT | mode,
+	if (ck_hs_init(&hs, CK_HS_MODE_OBJECT | mode,
 	    hs_collide, hs_compare, &my_allocator, 64, 6602834) == false)
 		ck_error("ck_hs_init (collide)\n");
 
@@ -452,17 +452,192 @@ test_set_relocation(unsigned int mode)
 	return;
 }
 
+static unsigned long
+hs_direct(const void *object, unsigned long seed)
+{
+	unsigned long h = (unsigned long)(uintptr_t)object;
+
+	h ^= seed;
+	h *= 2654435761UL;
+	return h ^ (h >> 16);
+}
+
+/*
+ * Grows a set from its minimum capacity one key at a time, so that most
+ * write operations occur while a migration is in progress, and validates
+ * membership, count and iteration along the way.
+ */
+static void
+test_incremental(unsigned int mode)
+{
+	const uintptr_t n_keys = 4096;
+	ck_hs_iterator_t it;
+	unsigned long h, n;
+	uintptr_t i, k;
+	ck_hs_t hs;
+	void *v;
+
+	if (ck_hs_init(&hs, CK_HS_MODE_DIRECT | CK_HS_MODE_INCREMENTAL | mode,
+	    hs_direct, NULL, &my_allocator, 8, 6602834) == false)
+		ck_error("ck_hs_init (incremental)\n");
+
+	for (i = 1; i <= n_keys; i++) {
+		h = CK_HS_HASH(&hs, hs_direct, (void *)i);
+		if (ck_hs_put(&hs, h, (void *)i) == false)
+			ck_error("ERROR: Failed to insert %lu.\n", (unsigned long)i);
+
+		if (i % 5 == 0 && (ck_hs_set(&hs, h, (void *)i, &v) == false ||
+		    v != (void *)i))
+			ck_error("ERROR: Failed to replace %lu.\n", (unsigned long)i);
+
+		/* Every third key is removed. */
+		if (i % 3 == 0 && ck_hs_remove(&hs, h, (void *)i) != (void *)i)
+			ck_error("ERROR: Failed to remove %lu.\n", (unsigned long)i);
+
+		if (i % 97 != 0 && i != n_keys)
+			continue;
+
+		for (k = 1; k <= i; k++) {
+			h = CK_HS_HASH(&hs, hs_direct, (void *)k);
+			v = ck_hs_get(&hs, h, (void *)k);
+			if ((k % 3 == 0) != (v == NULL))
+				ck_error("ERROR: Invalid membership of %lu.\n",
+				    (unsigned long)k);
+		}
+
+		if (ck_hs_count(&hs) != i - i / 3)
+			ck_error("ERROR: Expected %lu entries, found %lu.\n",
+			    (unsigned long)(i - i / 3), ck_hs_count(&hs));
+	}
+
+	n = 0;
+	ck_hs_iterator_init(&it);
+	while (ck_hs_next(&hs, &it, &v) == true) {
+		if ((uintptr_t)v % 3 == 0)
+			ck_error("ERROR: Iterated over removed key.\n");
+
+		n++;
+	}
+
+	if (n != ck_hs_count(&hs))
+		ck_error("ERROR: Iterated over %lu of %lu entries.\n", n,
+		    ck_hs_count(&hs));
+
+	if (ck_hs_rebuild(&hs) == false)
+		ck_error("ERROR: Failed to rebuild.\n");
+
+	if (ck_hs_count(&hs) != n)
+		ck_error("ERROR: Entries lost on rebuild.\n");
+
+	ck_hs_deinit(&hs);
+	return;
+}
+
+/*
+ * Looks up batches of every length up to the number of keys, half of
+ * which are present, and validates every result against ck_hs_get.
+ */
+static void
+test_get_batch(unsigned int mode)
+{
+	const void *keys[512];
+	unsigned long hashes[512];
+	void *out[512];
+	size_t i, n;
+	ck_hs_t hs;
+
+	if (ck_hs_init(&hs, CK_HS_MODE_SPMC | CK_HS_MODE_DIRECT | mode,
+	    hs_direct, NULL, &my_allocator, 64, 6602834) == false)
+		ck_error("ck_hs_init (batch)\n");
+
+	for (i = 0; i < 512; i++) {
+		keys[i] = (const void *)(uintptr_t)(i + 1);
+		hashes[i] = CK_HS_HASH(&hs, hs_direct, keys[i]);
+		if ((i & 1) == 0 && ck_hs_put(&hs, hashes[i], keys[i]) == false)
+			ck_error("ERROR: Failed to insert %zu.\n", i + 1);
+	}
+
+	for (n = 0; n <= 512; n += n < 32 ? 1 : 61) {
+		memset(out, 0xff, sizeof(out));
+		ck_hs_get_batch(&hs, hashes + (512 - n), keys + (512 - n), out, n);
+		for (i = 0; i < n; i++) {
+			size_t j = 512 - n + i;
+
+			if (out[i] != ck_hs_get(&hs, hashes[j], keys[j]) ||
+			    (out[i] == NULL) != ((j & 1) == 1))
+				ck_error("ERROR: Batch of %zu, invalid result for %zu.\n",
+				    n, j + 1);
+		}
+
+		if (n < 512 && out[n] != (void *)~(uintptr_t)0)
+			ck_error("ERROR: Batch of %zu overflowed.\n", n);
+	}
+
+	ck_hs_deinit(&hs);
+	return;
+}
+
+/*
+ * Tags must distinguish hash values that only differ in their low-order
+ * bits, such as those of 32-bit hash functions or of hs_hash.
+ */
+static void
+test_tag(void)
+{
+	bool seen[_CK_HS_TAG_FULL] = { false };
+	unsigned int n = 0, t;
+	unsigned long h;
+
+	for (h = 0; h < 256; h++) {
+		t = _ck_hs_tag(h);
+		if ((t & _CK_HS_TAG_FULL) == 0)
+			ck_error("ERROR: Tag %#x of %lu is not full.\n", t, h);
+
+		t &= _CK_HS_TAG_FULL - 1;
+		if (seen[t] == false) {
+			seen[t] = true;
+			n++;
+		}
+	}
+
+	if (n < _CK_HS_TAG_FULL / 2)
+		ck_error("ERROR: Only %u tags for 256 hash values.\n", n);
+
+	return;
+}
+
 int
 main(void)
 {
 	unsigned int k;
 
-	test_set_relocation(0);
-	test_set_relocation(CK_HS_MODE_DELETE);
+	test_tag();
+
+	test_set_relocation(CK_HS_MODE_SPMC);
+	test_set_relocation(CK_HS_MODE_SPMC | CK_HS_MODE_DELETE);
+	test_set_relocation(CK_HS_MODE_MPMC);
+	test_set_relocation(CK_HS_MODE_MPMC | CK_HS_MODE_DELETE);
+	test_set_relocation(CK_HS_MODE_SPMC | CK_HS_MODE_TAG);
+	test_set_relocation(CK_HS_MODE_MPMC | CK_HS_MODE_DELETE | CK_HS_MODE_TAG);
+	test_set_relocation(CK_HS_MODE_SPMC | CK_HS_MODE_INCREMENTAL);
+
+	test_incremental(CK_HS_MODE_SPMC);
+	test_incremental(CK_HS_MODE_SPMC | CK_HS_MODE_DELETE | CK_HS_MODE_TAG);
+
+	test_get_batch(0);
+	test_get_batch(CK_HS_MODE_DELETE | CK_HS_MODE_TAG);
+	test_get_batch(CK_HS_MODE_INCREMENTAL);
 
 	for (k = 16; k <= 64; k <<= 1) {
-		run_test(k, 0);
-		run_test(k, CK_HS_MODE_DELETE);
+		run_test(k, CK_HS_MODE_SPMC);
+		run_test(k, CK_HS_MODE_SPMC | CK_HS_MODE_DELETE);
+		run_test(k, CK_HS_MODE_MPMC);
+		run_test(k, CK_HS_MODE_MPMC | CK_HS_MODE_DELETE);
+		run_test(k, CK_HS_MODE_SPMC | CK_HS_MODE_TAG);
+		run_test(k, CK_HS_MODE_SPMC | CK_HS_MODE_DELETE | CK_HS_MODE_TAG);
+		run_test(k, CK_HS_MODE_MPMC | CK_HS_MODE_TAG);
+		run_test(k, CK_HS_MODE_SPMC | CK_HS_MODE_INCREMENTAL);
+		run_test(k, CK_HS_MODE_SPMC | CK_HS_MODE_DELETE | CK_HS_MODE_INCREMENTAL);
 		break;
 	}
 
@@ -0,0 +1,400 @@
+/*
+ * Copyright 2012 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyrights
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyrights
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <ck_hs.h>
+
+#include <assert.h>
+#include <ck_malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../../common.h"
+
+#define N_KEYS 4096
+
+static void *
+hs_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+hs_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+	(void)r;
+	free(p);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = hs_malloc,
+	.free = hs_free
+};
+
+static unsigned long
+hs_direct(const void *object, unsigned long seed)
+{
+	unsigned long h = (unsigned long)(uintptr_t)object;
+
+	h ^= seed;
+	h *= 2654435761UL;
+	return h ^ (h >> 16);
+}
+
+/*
+ * Object keys are offsets into a string arena, so that they remain valid
+ * wherever the arena is mapped.
+ */
+static char *arena;
+static size_t arena_length;
+
+static unsigned long
+hs_offset_hash(const void *object, unsigned long seed)
+{
+	const char *c = arena + (uintptr_t)object;
+	unsigned long h = seed;
+
+	while (*c != '\0')
+		h = (h ^ (unsigned char)*c++) * 1099511628211UL;
+
+	return h;
+}
+
+static bool
+hs_offset_compare(const void *previous, const void *compare)
+{
+
+	return strcmp(arena + (uintptr_t)previous,
+	    arena + (uintptr_t)compare) == 0;
+}
+
+/*
+ * Writes an image to an unlinked file and maps it read-only, as a
+ * process sharing a snapshot would.
+ */
+static void *
+image_map(const void *image, size_t length)
+{
+	char path[] = "/tmp/ck_hs_snapshot.XXXXXX";
+	void *r;
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd == -1)
+		ck_error("ERROR: Failed to create image file.\n");
+
+	unlink(path);
+	if (write(fd, image, length) != (ssize_t)length)
+		ck_error("ERROR: Failed to write image.\n");
+
+	r = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+	if (r == MAP_FAILED)
+		ck_error("ERROR: Failed to map image.\n");
+
+	close(fd);
+	return r;
+}
+
+static void *
+image_create(ck_hs_t *hs, size_t *length)
+{
+	void *image;
+
+	*length = ck_hs_snapshot_size(hs);
+	if (posix_memalign(&image, CK_MD_CACHELINE, *length) != 0)
+		ck_error("ERROR: Failed to allocate image.\n");
+
+	if (ck_hs_snapshot(hs, image, *length - 1) == true)
+		ck_error("ERROR: Snapshot into short buffer.\n");
+
+	if (ck_hs_snapshot(hs, image, *length) == false)
+		ck_error("ERROR: Failed to snapshot.\n");
+
+	return image;
+}
+
+static void
+test_direct(unsigned int mode)
+{
+	ck_hs_iterator_t it = CK_HS_ITERATOR_INITIALIZER;
+	const void *keys[N_KEYS];
+	unsigned long hashes[N_KEYS];
+	void *out[N_KEYS];
+	struct ck_hs_stat st, st_image;
+	unsigned long h, n;
+	size_t length;
+	uintptr_t i;
+	void *image, *mapped, *v;
+	ck_hs_t hs, ro;
+
+	if (ck_hs_init(&hs, CK_HS_MODE_SPMC | CK_HS_MODE_DIRECT | mode,
+	    hs_direct, NULL, &my_allocator, 8, 6602834) == false)
+		ck_error("ck_hs_init\n");
+
+	for (i = 1; i <= N_KEYS; i++) {
+		h = CK_HS_HASH(&hs, hs_direct, (void *)i);
+		ck_hs_put(&hs, h, (void *)i);
+	}
+
+	/* Every fourth key is removed, leaving tombstones in the image. */
+	for (i = 4; i <= N_KEYS; i += 4) {
+		h = CK_HS_HASH(&hs, hs_direct, (void *)i);
+		ck_hs_remove(&hs, h, (void *)i);
+	}
+
+	image = image_create(&hs, &length);
+	mapped = image_map(image, length);
+	ck_hs_stat(&hs, &st);
+	ck_hs_deinit(&hs);
+	free(image);
+
+	if (ck_hs_init_snapshot(&ro, hs_direct, NULL, &my_allocator,
+	    (char *)mapped + 8, length - 8) == true)
+		ck_error("ERROR: Accepted misaligned image.\n");
+
+	if (ck_hs_init_snapshot(&ro, hs_direct, NULL, &my_allocator,
+	    mapped, length - 1) == true)
+		ck_error("ERROR: Accepted truncated image.\n");
+
+	if (ck_hs_init_snapshot(&ro, hs_direct, NULL, &my_allocator,
+	    mapped, length) == false)
+		ck_error("ERROR: Failed to initialize from image.\n");
+
+	ck_hs_stat(&ro, &st_image);
+	if (st.n_entries != st_image.n_entries ||
+	    st.probe_maximum != st_image.probe_maximum ||
+	    st.tombstones != st_image.tombstones)
+		ck_error("ERROR: Image statistics differ.\n");
+
+	for (i = 1; i <= N_KEYS + 64; i++) {
+		h = CK_HS_HASH(&ro, hs_direct, (void *)i);
+		v = ck_hs_get(&ro, h, (void *)i);
+		if ((i % 4 == 0 || i > N_KEYS) != (v == NULL))
+			ck_error("ERROR: Invalid membership of %lu.\n",
+			    (unsigned long)i);
+
+		if (i <= N_KEYS) {
+			keys[i - 1] = (void *)i;
+			hashes[i - 1] = h;
+		}
+	}
+
+	ck_hs_get_batch(&ro, hashes, keys, out, N_KEYS);
+	for (i = 0; i < N_KEYS; i++) {
+		if ((out[i] == NULL) != ((i + 1) % 4 == 0))
+			ck_error("ERROR: Invalid batch result for %lu.\n",
+			    (unsigned long)i + 1);
+	}
+
+	n = 0;
+	while (ck_hs_next(&ro, &it, &v) == true)
+		n++;
+
+	if (n != ck_hs_count(&ro) || n != N_KEYS - N_KEYS / 4)
+		ck_error("ERROR: Iterated over %lu entries.\n", n);
+
+	/* A rebuild replaces the image with a writable map. */
+	if (ck_hs_rebuild(&ro) == false)
+		ck_error("ERROR: Failed to rebuild.\n");
+
+	for (i = 4; i <= N_KEYS; i += 4) {
+		h = CK_HS_HASH(&ro, hs_direct, (void *)i);
+		if (ck_hs_put(&ro, h, (void *)i) == false)
+			ck_error("ERROR: Failed to insert %lu.\n", (unsigned long)i);
+	}
+
+	if (ck_hs_count(&ro) != N_KEYS)
+		ck_error("ERROR: Expected %d entries after rebuild.\n", N_KEYS);
+
+	ck_hs_deinit(&ro);
+	munmap(mapped, length);
+	return;
+}
+
+/*
+ * Offsets of the mode and probe bounds in the image header, as written by
+ * ck_hs_snapshot.
+ */
+#define IMAGE_MODE		16
+#define IMAGE_PROBE_MAXIMUM	20
+#define IMAGE_PROBE_LIMIT	24
+
+static void
+image_patch(void *copy, const void *image, size_t length,
+    size_t offset, uint32_t value)
+{
+
+	memcpy(copy, image, length);
+	memcpy((char *)copy + offset, &value, sizeof(value));
+	return;
+}
+
+/* Images with modes or probe bounds that ck_hs_snapshot never writes. */
+static void
+test_corrupt(void)
+{
+	const unsigned int modes[] = {
+		CK_HS_MODE_SPMC, CK_HS_MODE_MPMC, CK_HS_MODE_INCREMENTAL
+	};
+	void *image, *copy;
+	uint32_t mode, limit;
+	unsigned int i;
+	size_t length;
+	uintptr_t k;
+	ck_hs_t hs, ro;
+
+	if (ck_hs_init(&hs, CK_HS_MODE_SPMC | CK_HS_MODE_DIRECT |
+	    CK_HS_MODE_DELETE, hs_direct, NULL, &my_allocator, 8,
+	    6602834) == false)
+		ck_error("ck_hs_init\n");
+
+	for (k = 1; k <= N_KEYS; k++)
+		ck_hs_put(&hs, CK_HS_HASH(&hs, hs_direct, (void *)k),
+		    (void *)k);
+
+	image = image_create(&hs, &length);
+	ck_hs_deinit(&hs);
+	if (posix_memalign(&copy, CK_MD_CACHELINE, length) != 0)
+		ck_error("ERROR: Failed to allocate image.\n");
+
+	memcpy(&mode, (char *)image + IMAGE_MODE, sizeof(mode));
+	for (i = 0; i < sizeof(modes) / sizeof(*modes); i++) {
+		image_patch(copy, image, length, IMAGE_MODE, mode | modes[i]);
+		if (ck_hs_init_snapshot(&ro, hs_direct, NULL, &my_allocator,
+		    copy, length) == true)
+			ck_error("ERROR: Accepted image with mode %#x.\n",
+			    mode | modes[i]);
+	}
+
+	memcpy(&limit, (char *)image + IMAGE_PROBE_LIMIT, sizeof(limit));
+	if (limit == 0)
+		ck_error("ERROR: Image has no probe limit.\n");
+
+	image_patch(copy, image, length, IMAGE_PROBE_LIMIT, UINT32_MAX);
+	if (ck_hs_init_snapshot(&ro, hs_direct, NULL, &my_allocator,
+	    copy, length) == true)
+		ck_error("ERROR: Accepted image with unbounded probe limit.\n");
+
+	image_patch(copy, image, length, IMAGE_PROBE_MAXIMUM, UINT32_MAX);
+	if (ck_hs_init_snapshot(&ro, hs_direct, NULL, &my_allocator,
+	    copy, length) == true)
+		ck_error("ERROR: Accepted image with unbounded probe maximum.\n");
+
+	/* The unmodified image is accepted. */
+	memcpy(copy, image, length);
+	if (ck_hs_init_snapshot(&ro, hs_direct, NULL, &my_allocator,
+	    copy, length) == false)
+		ck_error("ERROR: Failed to initialize from image.\n");
+
+	if (ck_hs_count(&ro) != N_KEYS)
+		ck_error("ERROR: Expected %d entries in image.\n", N_KEYS);
+
+	ck_hs_deinit(&ro);
+	free(copy);
+	free(image);
+	return;
+}
+
+static void
+test_object(unsigned int mode)
+{
+	uintptr_t offsets[N_KEYS];
+	char *relocated;
+	size_t i, length;
+	unsigned long h;
+	void *image, *mapped;
+	ck_hs_t hs, ro;
+
+	arena_length = 1;
+	arena = malloc(N_KEYS * 16);
+	assert(arena != NULL);
+
+	/* Offset zero is reserved, as it would be an empty slot. */
+	arena[0] = '\0';
+	for (i = 0; i < N_KEYS; i++) {
+		offsets[i] = arena_length;
+		arena_length += sprintf(arena + arena_length, "key-%zu", i) + 1;
+	}
+
+	if (ck_hs_init(&hs, CK_HS_MODE_SPMC | CK_HS_MODE_OBJECT | mode,
+	    hs_offset_hash, hs_offset_compare, &my_allocator, 8,
+	    6602834) == false)
+		ck_error("ck_hs_init\n");
+
+	for (i = 0; i < N_KEYS; i++) {
+		h = CK_HS_HASH(&hs, hs_offset_hash, (void *)offsets[i]);
+		ck_hs_put(&hs, h, (void *)offsets[i]);
+	}
+
+	image = image_create(&hs, &length);
+	mapped = image_map(image, length);
+	ck_hs_deinit(&hs);
+	free(image);
+
+	/* The arena is moved, as it would be in another process. */
+	relocated = malloc(arena_length);
+	assert(relocated != NULL);
+	memcpy(relocated, arena, arena_length);
+	memset(arena, 0, arena_length);
+	free(arena);
+	arena = relocated;
+
+	if (ck_hs_init_snapshot(&ro, hs_offset_hash, hs_offset_compare,
+	    &my_allocator, mapped, length) == false)
+		ck_error("ERROR: Failed to initialize from image.\n");
+
+	for (i = 0; i < N_KEYS; i++) {
+		h = CK_HS_HASH(&ro, hs_offset_hash, (void *)offsets[i]);
+		if (ck_hs_get(&ro, h, (void *)offsets[i]) != (void *)offsets[i])
+			ck_error("ERROR: Failed to find key-%zu.\n", i);
+	}
+
+	ck_hs_deinit(&ro);
+	munmap(mapped, length);
+	free(arena);
+	return;
+}
+
+int
+main(void)
+{
+
+	test_direct(0);
+	test_direct(CK_HS_MODE_DELETE);
+	test_direct(CK_HS_MODE_TAG);
+	test_direct(CK_HS_MODE_DELETE | CK_HS_MODE_TAG);
+	test_corrupt();
+	test_object(0);
+	test_object(CK_HS_MODE_DELETE | CK_HS_MODE_TAG);
+	return 0;
+}
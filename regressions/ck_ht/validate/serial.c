@@ -91,6 +91,8 @@ main(void)
 	ck_ht_hash_t h;
 	ck_ht_iterator_t iterator = CK_HT_ITERATOR_INITIALIZER;
 	ck_ht_entry_t *cursor;
+	ck_ht_entry_t batch[sizeof(test) / sizeof(*test) + 1];
+	ck_ht_hash_t hashes[sizeof(test) / sizeof(*test) + 1];
 	unsigned int mode = CK_HT_MODE_BYTESTRING;
 
 #ifdef HT_DELETE
@@ -139,6 +141,28 @@ main(void)
 		ck_error("ERROR: Found non-existing entry.\n");
 	}
 
+	/* The negative key is looked up last. */
+	for (i = 0; i <= sizeof(test) / sizeof(*test); i++) {
+		const char *k = i < sizeof(test) / sizeof(*test) ? test[i] : negative;
+
+		l = strlen(k);
+		ck_ht_hash(&hashes[i], &ht, k, l);
+		ck_ht_entry_key_set(&batch[i], k, l);
+	}
+
+	l = ck_ht_get_batch_spmc(&ht, hashes, batch, sizeof(test) / sizeof(*test) + 1);
+	if (l != sizeof(test) / sizeof(*test))
+		ck_error("ERROR: Batch found %zu entries.\n", l);
+
+	for (i = 0; i < sizeof(test) / sizeof(*test); i++) {
+		if (strcmp(ck_ht_entry_key(&batch[i]), test[i]) != 0 ||
+		    strcmp(ck_ht_entry_value(&batch[i]), test[i]) != 0)
+			ck_error("ERROR: Batch mismatch for [%s]\n", test[i]);
+	}
+
+	if (ck_ht_entry_empty(&batch[i]) == false)
+		ck_error("ERROR: Batch found non-existing entry.\n");
+
 	for (i = 0; i < sizeof(test) / sizeof(*test); i++) {
 		l = strlen(test[i]);
 		ck_ht_hash(&h, &ht, test[i], l);
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <ck_ibr.h>
+
+#include "../../common.h"
+
+#ifndef ITERATIONS
+#define ITERATIONS 65536
+#endif
+
+#ifndef READERS
+#define READERS 128
+#endif
+
+struct node {
+	unsigned int value;
+	ck_ibr_entry_t entry;
+};
+CK_IBR_CONTAINER(struct node, entry, node_container)
+
+static ck_ibr_t ibr;
+static ck_ibr_record_t writer;
+static ck_ibr_record_t reader;
+static struct node *head;
+static struct node *stalled;
+static unsigned int n_reclaimed;
+
+static void
+node_destroy(ck_ibr_entry_t *e)
+{
+	struct node *n = node_container(e);
+
+	if (n->value == 0)
+		ck_error("node reclaimed twice\n");
+
+	n->value = 0;
+	n_reclaimed++;
+	if (n != stalled)
+		free(n);
+
+	return;
+}
+
+static struct node *
+node_publish(unsigned int value)
+{
+	struct node *n;
+
+	n = malloc(sizeof *n);
+	if (n == NULL)
+		ck_error("malloc failed\n");
+
+	n->value = value;
+	ck_ibr_entry_init(&writer, &n->entry);
+	ck_pr_fence_store();
+	ck_pr_store_ptr(&head, n);
+	return n;
+}
+
+static void
+node_unlink(struct node *n)
+{
+
+	ck_pr_store_ptr(&head, NULL);
+	ck_ibr_retire(&writer, &n->entry, node_destroy);
+	return;
+}
+
+/*
+ * A reader that stalls within a section must only hold back the objects
+ * whose lifetime overlaps the eras it has observed.
+ */
+static void
+test_stall(void)
+{
+	struct node *n, *r;
+	unsigned int i;
+
+	stalled = node_publish(1);
+	ck_ibr_begin(&reader);
+	r = ck_ibr_read(&reader, &head);
+	if (r != stalled)
+		ck_error("reader observed %p, expected %p\n",
+		    (void *)r, (void *)stalled);
+
+	node_unlink(stalled);
+	for (i = 0; i < ITERATIONS; i++) {
+		n = node_publish(i + 2);
+		node_unlink(n);
+
+		if (writer.n_pending > CK_IBR_THRESHOLD + CK_IBR_FREQUENCY)
+			ck_error("%u objects pending after %u retirements\n",
+			    writer.n_pending, i + 1);
+	}
+
+	ck_ibr_reclaim(&writer);
+	if (stalled->value != 1)
+		ck_error("object reclaimed under an active reservation\n");
+
+	/* Extending the reservation protects newer objects. */
+	n = node_publish(ITERATIONS + 2);
+	r = ck_ibr_read(&reader, &head);
+	if (r != n || ck_pr_load_uint(&reader.upper) !=
+	    ck_pr_load_uint(&ibr.era))
+		ck_error("reservation was not extended\n");
+
+	node_unlink(n);
+	ck_ibr_reclaim(&writer);
+	if (n->value != ITERATIONS + 2)
+		ck_error("object reclaimed under an extended reservation\n");
+
+	if (ck_ibr_end(&reader) == false)
+		ck_error("section did not end\n");
+
+	ck_ibr_barrier(&writer);
+	if (writer.n_pending != 0 || stalled->value != 0)
+		ck_error("%u objects pending after barrier\n",
+		    writer.n_pending);
+
+	if (n_reclaimed != ITERATIONS + 2 ||
+	    writer.n_dispatch != n_reclaimed)
+		ck_error("%u objects reclaimed, %u dispatched\n",
+		    n_reclaimed, writer.n_dispatch);
+
+	free(stalled);
+	return;
+}
+
+/* Nested sections share the reservation of the outermost section. */
+static void
+test_nested(void)
+{
+	unsigned int lower;
+
+	ck_ibr_begin(&reader);
+	lower = reader.lower;
+	ck_pr_inc_uint(&ibr.era);
+	ck_ibr_begin(&reader);
+	if (reader.lower != lower || reader.active != 2)
+		ck_error("nested section reset the reservation\n");
+
+	if (ck_ibr_end(&reader) == true)
+		ck_error("nested section ended the outer section\n");
+
+	if (ck_ibr_end(&reader) == false)
+		ck_error("outer section did not end\n");
+
+	return;
+}
+
+static void
+node_mark(ck_ibr_entry_t *e)
+{
+
+	node_container(e)->value = 0;
+	return;
+}
+
+/*
+ * Retires an object born before the reservation of a section and one born
+ * after it for each of n sections, so that reservations and unreserved
+ * lifetimes interleave. Returns the number of unreserved objects that
+ * were reclaimed.
+ */
+static unsigned int
+test_interleave(ck_ibr_record_t *records, struct node *nodes, unsigned int n)
+{
+	unsigned int i, r = 0;
+
+	for (i = 0; i < n; i++) {
+		nodes[i * 2].value = 1;
+		ck_ibr_entry_init(&writer, &nodes[i * 2].entry);
+		ck_pr_inc_uint(&ibr.era);
+		ck_ibr_begin(&records[i]);
+		ck_ibr_retire(&writer, &nodes[i * 2].entry, node_mark);
+		ck_pr_inc_uint(&ibr.era);
+
+		nodes[i * 2 + 1].value = 1;
+		ck_ibr_entry_init(&writer, &nodes[i * 2 + 1].entry);
+		ck_ibr_retire(&writer, &nodes[i * 2 + 1].entry, node_mark);
+		ck_pr_inc_uint(&ibr.era);
+	}
+
+	ck_ibr_reclaim(&writer);
+	for (i = 0; i < n; i++) {
+		if (nodes[i * 2].value != 1)
+			ck_error("object reclaimed under reservation %u\n", i);
+
+		r += nodes[i * 2 + 1].value == 0;
+	}
+
+	for (i = 0; i < n; i++)
+		ck_ibr_end(&records[i]);
+
+	ck_ibr_barrier(&writer);
+	if (writer.n_pending != 0)
+		ck_error("%u objects pending after barrier\n",
+		    writer.n_pending);
+
+	return r;
+}
+
+/*
+ * Reclamation tests pending objects against a bounded snapshot of the
+ * reservations. Disjoint reservations must never be lost, even if there
+ * are more of them than the snapshot may track separately.
+ */
+static void
+test_reservations(void)
+{
+	static ck_ibr_record_t records[READERS];
+	static struct node nodes[READERS * 2];
+	unsigned int i, r;
+
+	for (i = 0; i < READERS; i++)
+		ck_ibr_register(&ibr, &records[i], NULL);
+
+	r = test_interleave(records, nodes, 8);
+	if (r != 8)
+		ck_error("%u of 8 unreserved objects reclaimed\n", r);
+
+	test_interleave(records, nodes, READERS);
+	return;
+}
+
+static void
+test_recycle(void)
+{
+	ck_ibr_record_t *record;
+
+	if (ck_ibr_recycle(&ibr, NULL) != NULL)
+		ck_error("recycled a record in use\n");
+
+	ck_ibr_unregister(&reader);
+	record = ck_ibr_recycle(&ibr, &ibr);
+	if (record != &reader || record->ct != &ibr)
+		ck_error("failed to recycle record\n");
+
+	return;
+}
+
+int
+main(void)
+{
+
+	ck_ibr_init(&ibr);
+	ck_ibr_register(&ibr, &writer, NULL);
+	ck_ibr_register(&ibr, &reader, NULL);
+
+	test_stall();
+	test_nested();
+	test_reservations();
+	test_recycle();
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_pool.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../common.h"
+
+#ifndef ENTRIES
+#define ENTRIES 1024
+#endif
+
+#ifndef STEPS
+#define STEPS 4000
+#endif
+
+static void *objects[ENTRIES];
+
+static void *
+backing_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+backing_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+	(void)r;
+	free(p);
+	return;
+}
+
+static struct ck_malloc m = {
+	.malloc = backing_malloc,
+	.free = backing_free
+};
+
+int
+main(void)
+{
+	ck_pool_t pool;
+	ck_pool_cache_t cache;
+	uint64_t s, e, a_malloc, a_free;
+	unsigned int i, j;
+	size_t size;
+
+	if (ck_pool_init(&pool, &m) == false)
+		ck_error("ERROR: Failed to initialize pool.\n");
+
+	ck_pool_cache_init(&cache, &pool, NULL);
+
+	printf("%8s %12s %12s %12s %12s\n", "size", "malloc", "free",
+	    "pool_malloc", "pool_free");
+	for (size = CK_POOL_CLASS_MIN; size <= CK_POOL_CLASS_MAX; size <<= 1) {
+		printf("%8zu", size);
+
+		a_malloc = a_free = 0;
+		for (i = 0; i < STEPS; i++) {
+			s = rdtsc();
+			for (j = 0; j < ENTRIES; j++)
+				objects[j] = malloc(size);
+			e = rdtsc();
+			a_malloc += e - s;
+
+			s = rdtsc();
+			for (j = 0; j < ENTRIES; j++)
+				free(objects[j]);
+			e = rdtsc();
+			a_free += e - s;
+		}
+		printf(" %12" PRIu64 " %12" PRIu64,
+		    a_malloc / STEPS / ENTRIES, a_free / STEPS / ENTRIES);
+
+		a_malloc = a_free = 0;
+		for (i = 0; i < STEPS; i++) {
+			s = rdtsc();
+			for (j = 0; j < ENTRIES; j++)
+				objects[j] = ck_pool_malloc(&cache, size);
+			e = rdtsc();
+			a_malloc += e - s;
+
+			s = rdtsc();
+			for (j = 0; j < ENTRIES; j++)
+				ck_pool_free(&cache, objects[j], size, false);
+			e = rdtsc();
+			a_free += e - s;
+		}
+		printf(" %12" PRIu64 " %12" PRIu64 "\n",
+		    a_malloc / STEPS / ENTRIES, a_free / STEPS / ENTRIES);
+	}
+
+	ck_pool_cache_flush(&cache);
+	ck_pool_deinit(&pool);
+	return 0;
+}
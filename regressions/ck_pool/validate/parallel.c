@@ -0,0 +1,240 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <ck_epoch.h>
+#include <ck_pool.h>
+#include <ck_pr.h>
+
+#include "../../common.h"
+
+#define N_SLOTS 64
+
+/*
+ * Objects are stamped with their address and size, and filled with a
+ * byte derived from both, so that any object handed out twice or
+ * recycled while still reachable is detected.
+ */
+struct object {
+	struct object *self;
+	size_t size;
+};
+
+static ck_pool_t pool;
+static ck_epoch_t epoch;
+static struct object *slots[N_SLOTS];
+static unsigned int barrier;
+static struct affinity a;
+static unsigned int nthr;
+static unsigned int iterations;
+static __thread ck_pool_cache_t *cache;
+
+CK_POOL_ALLOCATOR(thread, cache);
+
+static void *
+backing_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+backing_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+	(void)r;
+	free(p);
+	return;
+}
+
+static struct ck_malloc m = {
+	.malloc = backing_malloc,
+	.free = backing_free
+};
+
+static unsigned char
+fill(const struct object *o)
+{
+
+	return (unsigned char)(((uintptr_t)o >> 5) ^ o->size);
+}
+
+static struct object *
+object_create(size_t size)
+{
+	struct object *o;
+
+	o = ck_pool_allocator_thread.malloc(size);
+	if (o == NULL)
+		ck_error("ERROR: Failed to allocate %zu bytes.\n", size);
+
+	o->self = o;
+	o->size = size;
+	memset(o + 1, fill(o), size - sizeof *o);
+	return o;
+}
+
+static void
+object_check(const struct object *o, size_t size)
+{
+	const unsigned char *p = (const unsigned char *)(o + 1);
+	size_t i;
+
+	if (o->self != o || o->size != size)
+		ck_error("ERROR: Object %p header is corrupt.\n",
+		    (const void *)o);
+
+	for (i = 0; i < size - sizeof *o; i++) {
+		if (p[i] != fill(o))
+			ck_error("ERROR: Object %p byte %zu is corrupt.\n",
+			    (const void *)o, i);
+	}
+
+	return;
+}
+
+static void *
+test(void *c)
+{
+	unsigned int seed = (unsigned int)(uintptr_t)c + 1;
+	ck_epoch_record_t *record;
+	struct object *o, *peek, *local;
+	unsigned int i, s;
+	size_t size;
+
+	if (aff_iterate(&a)) {
+		perror("ERROR: Could not affine thread");
+		exit(EXIT_FAILURE);
+	}
+
+	record = malloc(sizeof *record);
+	cache = malloc(sizeof *cache);
+	if (record == NULL || cache == NULL)
+		ck_error("ERROR: Failed to allocate thread state.\n");
+
+	ck_epoch_register(&epoch, record, NULL);
+	ck_pool_cache_init(cache, &pool, record);
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) < nthr)
+		sched_yield();
+
+	for (i = 0; i < iterations; i++) {
+		seed = seed * 1103515245 + 12345;
+		size = sizeof(struct object) +
+		    ((seed >> 8) % (CK_POOL_CLASS_MAX + 1024));
+		s = (seed >> 20) % N_SLOTS;
+
+		/* Private objects are freed immediately. */
+		local = object_create(sizeof(struct object) + (seed >> 24));
+		o = object_create(size);
+
+		ck_epoch_begin(record, NULL);
+		peek = ck_pr_load_ptr(&slots[(s + 1) % N_SLOTS]);
+		if (peek != NULL)
+			object_check(peek, peek->size);
+
+		o = ck_pr_fas_ptr(&slots[s], o);
+		if (o != NULL) {
+			object_check(o, o->size);
+
+			/* Other threads may still be peeking at the object. */
+			ck_pool_allocator_thread.free(o, o->size, true);
+		}
+		ck_epoch_end(record, NULL);
+
+		object_check(local, local->size);
+		ck_pool_allocator_thread.free(local, local->size, false);
+
+		if ((i & 63) == 0) {
+			ck_epoch_poll(record);
+			sched_yield();
+		}
+	}
+
+	ck_epoch_barrier(record);
+	ck_pool_cache_flush(cache);
+	free(cache);
+	return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+	ck_pool_cache_t main_cache;
+	pthread_t *thread;
+	unsigned int i;
+
+	if (argc != 4) {
+		ck_error("Usage: validate <threads> <affinity delta> "
+		    "<iterations>\n");
+	}
+
+	nthr = atoi(argv[1]);
+	assert(nthr >= 1);
+
+	a.delta = atoi(argv[2]);
+	iterations = atoi(argv[3]);
+
+	thread = malloc(sizeof(pthread_t) * nthr);
+	assert(thread != NULL);
+
+	ck_epoch_init(&epoch);
+	if (ck_pool_init(&pool, &m) == false)
+		ck_error("ERROR: Failed to initialize pool.\n");
+
+	for (i = 0; i < nthr; i++) {
+		if (pthread_create(thread + i, NULL, test,
+		    (void *)(uintptr_t)i) != 0)
+			ck_error("ERROR: Failed to create thread.\n");
+	}
+
+	for (i = 0; i < nthr; i++)
+		pthread_join(thread[i], NULL);
+
+	ck_pool_cache_init(&main_cache, &pool, NULL);
+	cache = &main_cache;
+	for (i = 0; i < N_SLOTS; i++) {
+		if (slots[i] == NULL)
+			continue;
+
+		object_check(slots[i], slots[i]->size);
+		ck_pool_allocator_thread.free(slots[i], slots[i]->size, false);
+	}
+
+	ck_pool_cache_flush(&main_cache);
+	ck_pool_deinit(&pool);
+	free(thread);
+	return 0;
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ck_epoch.h>
+#include <ck_pool.h>
+
+#include "../../common.h"
+
+static ck_pool_t pool;
+static ck_pool_cache_t caches[2];
+static ck_epoch_t epoch;
+static ck_epoch_record_t record;
+static size_t outstanding;
+
+static void *
+backing_malloc(size_t r)
+{
+
+	outstanding += r;
+	return malloc(r);
+}
+
+static void
+backing_free(void *p, size_t b, bool r)
+{
+
+	(void)r;
+	outstanding -= b;
+	free(p);
+	return;
+}
+
+static struct ck_malloc m = {
+	.malloc = backing_malloc,
+	.free = backing_free
+};
+
+CK_POOL_ALLOCATOR(serial, &caches[0]);
+
+static void
+test_classes(void)
+{
+	size_t size;
+	unsigned int c;
+
+	for (size = 1; size <= CK_POOL_CLASS_MAX; size++) {
+		c = ck_pool_class(size);
+		if ((CK_POOL_CLASS_MIN << c) < size)
+			ck_error("class %u too small for %zu\n", c, size);
+
+		if (c > 0 && (CK_POOL_CLASS_MIN << (c - 1)) >= size)
+			ck_error("class %u too large for %zu\n", c, size);
+	}
+
+	return;
+}
+
+static void
+test_reuse(void)
+{
+	void *objects[256];
+	size_t size;
+	unsigned int i;
+
+	for (size = 1; size <= CK_POOL_CLASS_MAX; size <<= 1) {
+		for (i = 0; i < 256; i++) {
+			objects[i] = ck_pool_malloc(&caches[0], size);
+			if (objects[i] == NULL)
+				ck_error("allocation of %zu failed\n", size);
+
+			memset(objects[i], i, size);
+		}
+
+		for (i = 0; i < 256; i++) {
+			if (((unsigned char *)objects[i])[size - 1] !=
+			    (unsigned char)i)
+				ck_error("object %u of %zu corrupted\n",
+				    i, size);
+		}
+
+		for (i = 0; i < 256; i++)
+			ck_pool_free(&caches[0], objects[i], size, false);
+
+		/* The most recently freed object is handed out first. */
+		if (ck_pool_malloc(&caches[0], size) != objects[255])
+			ck_error("cache is not LIFO for %zu\n", size);
+
+		ck_pool_free(&caches[0], objects[255], size, false);
+	}
+
+	return;
+}
+
+static void
+test_exchange(void)
+{
+	void *objects[4096];
+	unsigned int i, j;
+	size_t total;
+
+	/*
+	 * Objects freed by the second cache beyond its limit and after a
+	 * flush must be handed to the first cache instead of new slabs.
+	 */
+	for (i = 0; i < 4096; i++)
+		objects[i] = ck_pool_malloc(&caches[0], 64);
+
+	for (i = 0; i < 4096; i++)
+		ck_pool_free(&caches[1], objects[i], 64, false);
+
+	ck_pool_cache_flush(&caches[0]);
+	ck_pool_cache_flush(&caches[1]);
+	total = outstanding;
+
+	for (i = 0; i < 4096; i++) {
+		objects[i] = ck_pool_malloc(&caches[0], 64);
+		for (j = 0; j < i; j += 97) {
+			if (objects[j] == objects[i])
+				ck_error("object %u handed out twice\n", i);
+		}
+	}
+
+	if (outstanding != total)
+		ck_error("refill allocated new slabs\n");
+
+	for (i = 0; i < 4096; i++)
+		ck_pool_free(&caches[0], objects[i], 64, false);
+
+	return;
+}
+
+static void
+test_large(void)
+{
+	size_t before = outstanding;
+	unsigned char *p;
+
+	p = ck_pool_allocator_serial.malloc(CK_POOL_CLASS_MAX + 1);
+	if (p == NULL || outstanding != before + CK_POOL_CLASS_MAX + 1)
+		ck_error("large allocation bypassed the backing allocator\n");
+
+	p[CK_POOL_CLASS_MAX] = 1;
+	ck_pool_allocator_serial.free(p, CK_POOL_CLASS_MAX + 1, false);
+	if (outstanding != before)
+		ck_error("large object was not returned\n");
+
+	return;
+}
+
+static void
+test_realloc(void)
+{
+	unsigned char *p, *r;
+	unsigned int i;
+
+	p = ck_pool_allocator_serial.malloc(40);
+	for (i = 0; i < 40; i++)
+		p[i] = i;
+
+	/* Growth within a size class is done in place. */
+	r = ck_pool_allocator_serial.realloc(p, 40, 64, false);
+	if (r != p)
+		ck_error("realloc within class moved object\n");
+
+	r = ck_pool_allocator_serial.realloc(p, 64, 20000, false);
+	for (i = 0; i < 40; i++) {
+		if (r[i] != i)
+			ck_error("realloc lost byte %u\n", i);
+	}
+
+	p = ck_pool_allocator_serial.realloc(r, 20000, 100, false);
+	for (i = 0; i < 40; i++) {
+		if (p[i] != i)
+			ck_error("realloc lost byte %u\n", i);
+	}
+
+	ck_pool_allocator_serial.free(p, 100, false);
+	return;
+}
+
+static void
+test_defer(void)
+{
+	size_t before;
+	void *p, *q;
+
+	ck_epoch_init(&epoch);
+	ck_epoch_register(&epoch, &record, NULL);
+	caches[0].record = &record;
+
+	ck_epoch_begin(&record, NULL);
+	p = ck_pool_allocator_serial.malloc(32);
+	ck_pool_allocator_serial.free(p, 32, true);
+	q = ck_pool_allocator_serial.malloc(32);
+	if (p == q)
+		ck_error("deferred object reused within a section\n");
+
+	ck_epoch_end(&record, NULL);
+	ck_pool_allocator_serial.free(q, 32, false);
+
+	before = outstanding;
+	q = ck_pool_allocator_serial.malloc(CK_POOL_CLASS_MAX * 2);
+	ck_pool_allocator_serial.free(q, CK_POOL_CLASS_MAX * 2, true);
+	if (outstanding == before)
+		ck_error("deferred large object freed early\n");
+
+	/* Reclaimed objects are returned to the shared free lists. */
+	ck_pool_cache_flush(&caches[0]);
+	ck_epoch_barrier(&record);
+	if (outstanding != before)
+		ck_error("deferred large object not freed\n");
+
+	q = ck_pool_allocator_serial.malloc(32);
+	if (q != p)
+		ck_error("reclaimed object was not reused\n");
+
+	ck_pool_allocator_serial.free(q, 32, false);
+	caches[0].record = NULL;
+	return;
+}
+
+int
+main(void)
+{
+
+	if (ck_pool_init(&pool, &m) == false)
+		ck_error("ck_pool_init failed\n");
+
+	ck_pool_cache_init(&caches[0], &pool, NULL);
+	ck_pool_cache_init(&caches[1], &pool, NULL);
+
+	test_classes();
+	test_reuse();
+	test_exchange();
+	test_large();
+	test_realloc();
+	test_defer();
+
+	ck_pool_cache_flush(&caches[0]);
+	ck_pool_cache_flush(&caches[1]);
+	ck_pool_deinit(&pool);
+	if (outstanding != 0)
+		ck_error("%zu bytes leaked\n", outstanding);
+
+	return 0;
+}
@@ -221,7 +221,8 @@ run_test(const char *file, size_t r, unsigned int size, unsigned int mode)
 	char buffer[512];
 	size_t i, j;
 	unsigned int d = 0;
-	uint64_t s, e, a, ri, si, ai, sr, rg, sg, ag, sd, ng, ss, sts, su, sgc, sb;
+	uint64_t s, e, a, ri, si, ai, sr, rg, sg, ag, sd, ng, ss, sts, su, sbl, sgc, sb;
+	unsigned long *hashes;
 	struct ck_rhs_stat st;
 	char **t;
 
@@ -434,6 +435,30 @@ run_test(const char *file, size_t r, unsigned int size, unsigned int mode)
 	}
 	su = a / (r * keys_length);
 
+	/* Bulk load of all keys into a set of the initial size. */
+	hashes = malloc(sizeof(unsigned long) * keys_length);
+	assert(hashes != NULL);
+
+	a = 0;
+	for (j = 0; j < r; j++) {
+		set_destroy();
+		set_init(size, mode);
+
+		s = rdtsc();
+		for (i = 0; i < keys_length; i++)
+			hashes[i] = CK_RHS_HASH(&hs, hs_hash, keys[i]);
+
+		if (ck_rhs_put_bulk(&hs, hashes, (const void *const *)keys,
+		    keys_length) == false)
+			ck_error("ERROR: Failed to bulk load.\n");
+		e = rdtsc();
+		a += e - s;
+	}
+	sbl = a / (r * keys_length);
+
+	free(hashes);
+	set_reset();
+
 	for (i = 0; i < keys_length; i++)
 		set_insert_unique(keys[i]);
 
@@ -472,8 +497,10 @@ run_test(const char *file, size_t r, unsigned int size, unsigned int mode)
 	    "%" PRIu64 " "
 	    "%" PRIu64 " "
 	    "%" PRIu64 " "
+	    "%" PRIu64 " "
 	    "%" PRIu64 "\n",
-	    keys_length, ri, si, ai, ss, sr, rg, sg, ag, sd, ng, sts, su, sgc, sb);
+	    keys_length, ri, si, ai, ss, sr, rg, sg, ag, sd, ng, sts, su, sbl, sgc,
+	    sb);
 
 	fclose(fp);
 
@@ -510,7 +537,7 @@ main(int argc, char *argv[])
 	run_test(argv[1], r, size, CK_RHS_MODE_READ_MOSTLY);
 	fprintf(stderr, "#    reverse_insertion serial_insertion random_insertion serial_swap "
 	    "serial_replace reverse_get serial_get random_get serial_remove negative_get tombstone "
-	    "set_unique gc rebuild\n\n");
+	    "set_unique bulk_load gc rebuild\n\n");
 
 	return 0;
 }
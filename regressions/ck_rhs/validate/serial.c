@@ -328,6 +328,252 @@ test_reset_preallocated(void)
 	return;
 }
 
+static unsigned long
+hs_direct(const void *object, unsigned long seed)
+{
+	unsigned long h = (unsigned long)(uintptr_t)object;
+
+	h ^= seed;
+	h *= 2654435761UL;
+	return h ^ (h >> 16);
+}
+
+/*
+ * Grows a set from its minimum capacity one key at a time, so that most
+ * write operations occur while a migration is in progress, and validates
+ * membership, count and iteration along the way.
+ */
+static void
+test_incremental(unsigned int mode)
+{
+	const uintptr_t n_keys = 4096;
+	ck_rhs_iterator_t it = CK_RHS_ITERATOR_INITIALIZER;
+	unsigned long h, n;
+	uintptr_t i, k;
+	ck_rhs_t hs;
+	void *v;
+
+	if (ck_rhs_init(&hs, CK_RHS_MODE_SPMC | CK_RHS_MODE_DIRECT |
+	    CK_RHS_MODE_INCREMENTAL | mode, hs_direct, NULL, &my_allocator,
+	    8, 6602834) == false)
+		ck_error("ck_rhs_init (incremental)\n");
+
+	for (i = 1; i <= n_keys; i++) {
+		h = CK_RHS_HASH(&hs, hs_direct, (void *)i);
+		if (ck_rhs_put(&hs, h, (void *)i) == false)
+			ck_error("ERROR: Failed to insert %lu.\n", (unsigned long)i);
+
+		if (i % 5 == 0 && (ck_rhs_set(&hs, h, (void *)i, &v) == false ||
+		    v != (void *)i))
+			ck_error("ERROR: Failed to replace %lu.\n", (unsigned long)i);
+
+		if (i % 7 == 0 && (ck_rhs_fas(&hs, h, (void *)i, &v) == false ||
+		    v != (void *)i))
+			ck_error("ERROR: Failed to swap %lu.\n", (unsigned long)i);
+
+		/* Every third key is removed. */
+		if (i % 3 == 0 && ck_rhs_remove(&hs, h, (void *)i) != (void *)i)
+			ck_error("ERROR: Failed to remove %lu.\n", (unsigned long)i);
+
+		if (i % 97 != 0 && i != n_keys)
+			continue;
+
+		for (k = 1; k <= i; k++) {
+			h = CK_RHS_HASH(&hs, hs_direct, (void *)k);
+			v = ck_rhs_get(&hs, h, (void *)k);
+			if ((k % 3 == 0) != (v == NULL))
+				ck_error("ERROR: Invalid membership of %lu.\n",
+				    (unsigned long)k);
+		}
+
+		if (ck_rhs_count(&hs) != i - i / 3)
+			ck_error("ERROR: Expected %lu entries, found %lu.\n",
+			    (unsigned long)(i - i / 3), ck_rhs_count(&hs));
+	}
+
+	n = 0;
+	while (ck_rhs_next(&hs, &it, &v) == true) {
+		if ((uintptr_t)v % 3 == 0)
+			ck_error("ERROR: Iterated over removed key.\n");
+
+		n++;
+	}
+
+	if (n != ck_rhs_count(&hs))
+		ck_error("ERROR: Iterated over %lu of %lu entries.\n", n,
+		    ck_rhs_count(&hs));
+
+	if (ck_rhs_rebuild(&hs) == false)
+		ck_error("ERROR: Failed to rebuild.\n");
+
+	if (ck_rhs_count(&hs) != n)
+		ck_error("ERROR: Entries lost on rebuild.\n");
+
+	ck_rhs_destroy(&hs);
+	return;
+}
+
+/*
+ * Looks up batches of every length up to the number of keys, half of
+ * which are present, and validates every result against ck_rhs_get.
+ */
+static void
+test_get_batch(unsigned int mode)
+{
+	const void *keys[512];
+	unsigned long hashes[512];
+	void *out[512];
+	size_t i, n;
+	ck_rhs_t hs;
+
+	if (ck_rhs_init(&hs, CK_RHS_MODE_SPMC | CK_RHS_MODE_DIRECT | mode,
+	    hs_direct, NULL, &my_allocator, 64, 6602834) == false)
+		ck_error("ck_rhs_init (batch)\n");
+
+	for (i = 0; i < 512; i++) {
+		keys[i] = (const void *)(uintptr_t)(i + 1);
+		hashes[i] = CK_RHS_HASH(&hs, hs_direct, keys[i]);
+		if ((i & 1) == 0 && ck_rhs_put(&hs, hashes[i], keys[i]) == false)
+			ck_error("ERROR: Failed to insert %zu.\n", i + 1);
+	}
+
+	for (n = 0; n <= 512; n += n < 32 ? 1 : 61) {
+		memset(out, 0xff, sizeof(out));
+		ck_rhs_get_batch(&hs, hashes + (512 - n), keys + (512 - n), out, n);
+		for (i = 0; i < n; i++) {
+			size_t j = 512 - n + i;
+
+			if (out[i] != ck_rhs_get(&hs, hashes[j], keys[j]) ||
+			    (out[i] == NULL) != ((j & 1) == 1))
+				ck_error("ERROR: Batch of %zu, invalid result for %zu.\n",
+				    n, j + 1);
+		}
+
+		if (n < 512 && out[n] != (void *)~(uintptr_t)0)
+			ck_error("ERROR: Batch of %zu overflowed.\n", n);
+	}
+
+	ck_rhs_destroy(&hs);
+	return;
+}
+
+/*
+ * Bulk loads keys into empty and populated sets, including one with a
+ * migration in progress, and validates membership, count and iteration.
+ */
+static void
+test_put_bulk(unsigned int mode)
+{
+	const size_t n_keys = 16384;
+	ck_rhs_iterator_t it = CK_RHS_ITERATOR_INITIALIZER;
+	const void **keys;
+	unsigned long *hashes;
+	const char *strings[sizeof(test) / sizeof(*test)];
+	unsigned long h, n;
+	size_t i, j;
+	ck_rhs_t hs;
+	void *v;
+
+	keys = malloc(sizeof(*keys) * n_keys);
+	hashes = malloc(sizeof(*hashes) * n_keys);
+	if (keys == NULL || hashes == NULL)
+		ck_error("malloc (bulk)\n");
+
+	if (ck_rhs_init(&hs, CK_RHS_MODE_SPMC | CK_RHS_MODE_DIRECT | mode,
+	    hs_direct, NULL, &my_allocator, 8, 6602834) == false)
+		ck_error("ck_rhs_init (bulk)\n");
+
+	for (i = 0; i < n_keys; i++) {
+		keys[i] = (const void *)(uintptr_t)(i + 1);
+		hashes[i] = CK_RHS_HASH(&hs, hs_direct, keys[i]);
+	}
+
+	/* Populate enough of the set for a growth to be under way. */
+	for (i = 0; i < 100; i++) {
+		if (ck_rhs_put(&hs, hashes[i], keys[i]) == false)
+			ck_error("ERROR: Failed to insert %zu.\n", i + 1);
+	}
+
+	if (ck_rhs_put_bulk(&hs, hashes + 100, keys + 100, n_keys / 2 - 100) == false)
+		ck_error("ERROR: Failed to bulk load into populated set.\n");
+
+	if (ck_rhs_count(&hs) != n_keys / 2)
+		ck_error("ERROR: Expected %zu entries, found %lu.\n",
+		    n_keys / 2, ck_rhs_count(&hs));
+
+	/* Every third key of the first half is removed before the second load. */
+	for (i = 0; i < n_keys / 2; i += 3) {
+		if (ck_rhs_remove(&hs, hashes[i], keys[i]) != keys[i])
+			ck_error("ERROR: Failed to remove %zu.\n", i + 1);
+	}
+
+	if (ck_rhs_put_bulk(&hs, hashes + n_keys / 2, keys + n_keys / 2,
+	    n_keys / 2) == false)
+		ck_error("ERROR: Failed to bulk load.\n");
+
+	for (i = 0; i < n_keys; i++) {
+		v = ck_rhs_get(&hs, hashes[i], keys[i]);
+		if ((i < n_keys / 2 && i % 3 == 0) != (v == NULL))
+			ck_error("ERROR: Invalid membership of %zu.\n", i + 1);
+	}
+
+	n = 0;
+	while (ck_rhs_next(&hs, &it, &v) == true)
+		n++;
+
+	if (n != ck_rhs_count(&hs) || n != n_keys - (n_keys / 2 + 2) / 3)
+		ck_error("ERROR: Iterated over %lu of %lu entries.\n", n,
+		    ck_rhs_count(&hs));
+
+	/* The set remains writable after a bulk load. */
+	for (i = 0; i < n_keys / 2; i += 3) {
+		if (ck_rhs_put(&hs, hashes[i], keys[i]) == false)
+			ck_error("ERROR: Failed to reinsert %zu.\n", i + 1);
+	}
+
+	if (ck_rhs_count(&hs) != n_keys)
+		ck_error("ERROR: Expected %zu entries after reinsertion.\n", n_keys);
+
+	ck_rhs_destroy(&hs);
+
+	/* Object keys with a degenerate hash function. */
+	if (ck_rhs_init(&hs, CK_RHS_MODE_SPMC | CK_RHS_MODE_OBJECT | mode,
+	    hs_hash, hs_compare, &my_allocator, 8, 6602834) == false)
+		ck_error("ck_rhs_init (bulk object)\n");
+
+	for (i = j = 0; i < sizeof(test) / sizeof(*test); i++) {
+		if (ck_rhs_get(&hs, test[i][0], test[i]) != NULL)
+			continue;
+
+		strings[j] = test[i];
+		hashes[j] = test[i][0];
+		ck_rhs_put(&hs, hashes[j], strings[j]);
+		j++;
+	}
+
+	if (ck_rhs_reset(&hs) == false)
+		ck_error("ck_rhs_reset (bulk object)\n");
+
+	if (ck_rhs_put_bulk(&hs, hashes, (const void *const *)strings, j) == false)
+		ck_error("ERROR: Failed to bulk load objects.\n");
+
+	if (ck_rhs_count(&hs) != j)
+		ck_error("ERROR: Expected %zu objects, found %lu.\n", j,
+		    ck_rhs_count(&hs));
+
+	for (i = 0; i < sizeof(test) / sizeof(*test); i++) {
+		h = test[i][0];
+		v = ck_rhs_get(&hs, h, test[i]);
+		if (v == NULL || strcmp(v, test[i]) != 0)
+			ck_error("ERROR: Failed to find [%s].\n", test[i]);
+	}
+
+	ck_rhs_destroy(&hs);
+	free(hashes);
+	free(keys);
+	return;
+}
+
 int
 main(void)
 {
@@ -335,9 +581,18 @@ main(void)
 
 	for (k = 16; k <= 64; k <<= 1) {
 		run_test(k, 0);
+		run_test(k, CK_RHS_MODE_INCREMENTAL);
+		run_test(k, CK_RHS_MODE_READ_MOSTLY | CK_RHS_MODE_INCREMENTAL);
 		break;
 	}
 
+	test_incremental(0);
+	test_incremental(CK_RHS_MODE_READ_MOSTLY);
+	test_get_batch(0);
+	test_get_batch(CK_RHS_MODE_READ_MOSTLY);
+	test_put_bulk(0);
+	test_put_bulk(CK_RHS_MODE_INCREMENTAL);
+	test_put_bulk(CK_RHS_MODE_READ_MOSTLY | CK_RHS_MODE_INCREMENTAL);
 	test_reset_preallocated();
 	return 0;
 }
@@ -0,0 +1,209 @@
+#include <ck_pr.h>
+#include <ck_ring.h>
+#include <ck_ring_broadcast.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../../common.h"
+
+#ifndef ITERATIONS
+#define ITERATIONS (1 << 20)
+#endif
+
+#ifndef BURST
+#define BURST 32
+#endif
+
+/*
+ * Fans a single producer out to n consumers, either through one broadcast
+ * ring with a cursor per consumer or through one single-producer ring per
+ * consumer, and reports the throughput observed by every consumer.
+ */
+struct consumer {
+	unsigned int id;
+	uint64_t ns;
+	ck_ring_t ring;
+	ck_ring_buffer_t *buffer;
+} CK_CC_CACHELINE;
+
+static struct consumer *consumers;
+static ck_ring_broadcast_t broadcast;
+static ck_ring_buffer_t *broadcast_buffer;
+static ck_ring_cursor_t *cursors;
+static unsigned int n_consumers;
+static int barrier;
+
+static uint64_t
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void *
+broadcast_consumer(void *arg)
+{
+	struct consumer *c = arg;
+	void *entries[BURST];
+	unsigned int i, n;
+	uint64_t s;
+
+	ck_pr_inc_int(&barrier);
+	while (ck_pr_load_int(&barrier) != (int)n_consumers + 1)
+		ck_pr_stall();
+
+	s = now();
+	for (i = 0; i < ITERATIONS; i += n) {
+		n = ck_ring_broadcast_dequeue_burst(&broadcast,
+		    broadcast_buffer, &cursors[c->id], entries, BURST);
+		if (n == 0)
+			sched_yield();
+	}
+
+	c->ns = now() - s;
+	return NULL;
+}
+
+static void *
+spsc_consumer(void *arg)
+{
+	struct consumer *c = arg;
+	void *entries[BURST];
+	unsigned int i, n;
+	uint64_t s;
+
+	ck_pr_inc_int(&barrier);
+	while (ck_pr_load_int(&barrier) != (int)n_consumers + 1)
+		ck_pr_stall();
+
+	s = now();
+	for (i = 0; i < ITERATIONS; i += n) {
+		n = ck_ring_dequeue_burst_spsc(&c->ring, c->buffer,
+		    entries, BURST);
+		if (n == 0)
+			sched_yield();
+	}
+
+	c->ns = now() - s;
+	return NULL;
+}
+
+static void
+report(const char *label, unsigned int size)
+{
+	unsigned int i;
+
+	for (i = 0; i < n_consumers; i++) {
+		printf("%-9s %10u %8u %16" PRIu64 "\n", label, size, i,
+		    (uint64_t)(ITERATIONS * 1000000000ULL /
+		    (consumers[i].ns ? consumers[i].ns : 1)));
+	}
+
+	return;
+}
+
+static void
+run(void *(*consumer)(void *), pthread_t *threads)
+{
+	unsigned int i;
+
+	barrier = 0;
+	for (i = 0; i < n_consumers; i++) {
+		consumers[i].id = i;
+		if (pthread_create(&threads[i], NULL, consumer,
+		    &consumers[i]) != 0)
+			ck_error("ERROR: Failed to create consumer\n");
+	}
+
+	while (ck_pr_load_int(&barrier) != (int)n_consumers)
+		ck_pr_stall();
+
+	ck_pr_inc_int(&barrier);
+	return;
+}
+
+int
+main(int argc, char *argv[])
+{
+	void *entries[BURST];
+	pthread_t *threads;
+	unsigned int i, j, n, size;
+
+	if (argc != 3) {
+		ck_error("Usage: broadcast <consumers> <size>\n");
+	}
+
+	n_consumers = atoi(argv[1]);
+	size = atoi(argv[2]);
+	if (n_consumers == 0) {
+		ck_error("ERROR: At least one consumer is required.\n");
+	}
+
+	if (size <= BURST || (size & (size - 1))) {
+		ck_error("ERROR: Size must be a power of 2 greater than %d.\n",
+		    BURST);
+	}
+
+	consumers = calloc(n_consumers, sizeof(*consumers));
+	cursors = calloc(n_consumers, sizeof(*cursors));
+	threads = malloc(sizeof(*threads) * n_consumers);
+	broadcast_buffer = malloc(sizeof(ck_ring_buffer_t) * size);
+	if (consumers == NULL || cursors == NULL || threads == NULL ||
+	    broadcast_buffer == NULL) {
+		ck_error("ERROR: Failed to allocate memory\n");
+	}
+
+	for (i = 0; i < BURST; i++)
+		entries[i] = &entries[i];
+
+	printf("%-9s %10s %8s %16s\n", "mode", "size", "consumer",
+	    "entries/s");
+
+	/* One broadcast ring, consumers share the buffer. */
+	ck_ring_broadcast_init(&broadcast, size, cursors, n_consumers);
+	run(broadcast_consumer, threads);
+	for (i = 0; i < ITERATIONS; i += n) {
+		n = ck_ring_broadcast_enqueue_burst(&broadcast,
+		    broadcast_buffer, entries, BURST);
+		if (n == 0)
+			sched_yield();
+	}
+
+	for (i = 0; i < n_consumers; i++)
+		pthread_join(threads[i], NULL);
+
+	report("broadcast", size);
+
+	/* One ring per consumer, every entry is enqueued n times. */
+	for (i = 0; i < n_consumers; i++) {
+		consumers[i].buffer = malloc(sizeof(ck_ring_buffer_t) * size);
+		if (consumers[i].buffer == NULL)
+			ck_error("ERROR: Failed to allocate buffer\n");
+
+		ck_ring_init(&consumers[i].ring, size);
+	}
+
+	run(spsc_consumer, threads);
+	for (i = 0; i < ITERATIONS; i += BURST) {
+		for (j = 0; j < n_consumers; j++) {
+			n = 0;
+			while ((n += ck_ring_enqueue_burst_spsc(
+			    &consumers[j].ring, consumers[j].buffer,
+			    entries + n, BURST - n)) < BURST)
+				sched_yield();
+		}
+	}
+
+	for (i = 0; i < n_consumers; i++)
+		pthread_join(threads[i], NULL);
+
+	report("spsc", size);
+	return (0);
+}
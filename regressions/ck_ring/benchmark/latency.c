@@ -15,11 +15,16 @@ struct entry {
 	int value;
 };
 
+#ifndef BURST
+#define BURST 32
+#endif
+
 int
 main(int argc, char *argv[])
 {
 	int i, r, size;
 	uint64_t s, e, e_a, d_a;
+	void *burst[BURST];
 	struct entry entry = {0, 0};
 	ck_ring_buffer_t *buf;
 	ck_ring_t ring;
@@ -138,5 +143,46 @@ main(int argc, char *argv[])
 		d_a += (e - s) / 4;
 	}
 	printf("mpmc %10d %16" PRIu64 " %16" PRIu64 "\n", size, e_a / ITERATIONS, d_a / ITERATIONS);
+	/* Burst operations, reported per entry. */
+	ck_ring_init(&ring, size);
+	for (i = 0; i < BURST; i++)
+		burst[i] = &entry;
+
+	e_a = d_a = s = e = 0;
+	for (r = 0; r < ITERATIONS; r++) {
+		for (i = 0; i < size / 4; i += BURST) {
+			s = rdtsc();
+			ck_ring_enqueue_burst_spsc(&ring, buf, burst, BURST);
+			e = rdtsc();
+		}
+		e_a += (e - s) / BURST;
+
+		for (i = 0; i < size / 4; i += BURST) {
+			s = rdtsc();
+			ck_ring_dequeue_burst_spsc(&ring, buf, burst, BURST);
+			e = rdtsc();
+		}
+		d_a += (e - s) / BURST;
+	}
+	printf("spsc/%-2d %7d %16" PRIu64 " %16" PRIu64 "\n", BURST, size, e_a / ITERATIONS, d_a / ITERATIONS);
+
+	ck_ring_init(&ring, size);
+	e_a = d_a = s = e = 0;
+	for (r = 0; r < ITERATIONS; r++) {
+		for (i = 0; i < size / 4; i += BURST) {
+			s = rdtsc();
+			ck_ring_enqueue_burst_mpmc(&ring, buf, burst, BURST);
+			e = rdtsc();
+		}
+		e_a += (e - s) / BURST;
+
+		for (i = 0; i < size / 4; i += BURST) {
+			s = rdtsc();
+			ck_ring_dequeue_burst_mpmc(&ring, buf, burst, BURST);
+			e = rdtsc();
+		}
+		d_a += (e - s) / BURST;
+	}
+	printf("mpmc/%-2d %7d %16" PRIu64 " %16" PRIu64 "\n", BURST, size, e_a / ITERATIONS, d_a / ITERATIONS);
 	return (0);
 }
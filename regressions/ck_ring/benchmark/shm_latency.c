@@ -0,0 +1,148 @@
+#include <ck_pr.h>
+#include <ck_ring.h>
+#include <ck_ring_shm.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../common.h"
+
+#ifndef ITERATIONS
+#define ITERATIONS (1 << 16)
+#endif
+
+#ifndef SPIN
+#define SPIN 1024
+#endif
+
+/*
+ * Measures the round-trip latency of a message between two processes
+ * through a pair of ck_ring_shm rings, with no system call on the fast
+ * path. A waiting side spins for SPIN iterations before yielding, so
+ * that the benchmark remains usable on a single core.
+ */
+struct message {
+	uint64_t sequence;
+	uint64_t payload[7];
+};
+
+CK_RING_PROTOTYPE(message, message)
+
+static struct ck_ring_shm *
+segment(unsigned int size)
+{
+	size_t length = ck_ring_shm_footprint(size, sizeof(struct message));
+	struct ck_ring_shm *shm;
+
+	shm = mmap(NULL, length, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (shm == MAP_FAILED)
+		ck_error("ERROR: mmap: %s\n", strerror(errno));
+
+	if (ck_ring_shm_init(shm, size, sizeof(struct message),
+	    getpid()) == false)
+		ck_error("ERROR: Failed to initialize ring\n");
+
+	return shm;
+}
+
+static void
+transmit(struct ck_ring_shm *shm, struct message *m)
+{
+	unsigned int i = 0;
+
+	while (CK_RING_ENQUEUE_SPSC(message, ck_ring_shm_ring(shm),
+	    ck_ring_shm_buffer(shm), m) == false) {
+		if (++i % SPIN == 0)
+			sched_yield();
+	}
+
+	return;
+}
+
+static void
+receive(struct ck_ring_shm *shm, struct message *m)
+{
+	unsigned int i = 0;
+
+	while (CK_RING_DEQUEUE_SPSC(message, ck_ring_shm_ring(shm),
+	    ck_ring_shm_buffer(shm), m) == false) {
+		if (++i % SPIN == 0)
+			sched_yield();
+	}
+
+	return;
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct ck_ring_shm *request, *response;
+	struct message m;
+	uint64_t s, e, best = UINT64_MAX, total = 0;
+	unsigned int i, size;
+	pid_t pid;
+	int status;
+
+	if (argc != 2) {
+		ck_error("Usage: shm_latency <size>\n");
+	}
+
+	size = atoi(argv[1]);
+	if (size <= 4 || (size & (size - 1))) {
+		ck_error("ERROR: Size must be a power of 2 greater than 4.\n");
+	}
+
+	request = segment(size);
+	response = segment(size);
+	memset(&m, 0, sizeof(m));
+
+	pid = fork();
+	if (pid == -1)
+		ck_error("ERROR: fork: %s\n", strerror(errno));
+
+	if (pid == 0) {
+		ck_ring_shm_attach(request, CK_RING_SHM_CONSUMER, getpid());
+		ck_ring_shm_attach(response, CK_RING_SHM_PRODUCER, getpid());
+		for (i = 0; i < ITERATIONS; i++) {
+			receive(request, &m);
+			transmit(response, &m);
+		}
+
+		_exit(0);
+	}
+
+	ck_ring_shm_attach(request, CK_RING_SHM_PRODUCER, getpid());
+	ck_ring_shm_attach(response, CK_RING_SHM_CONSUMER, getpid());
+	for (i = 0; i < ITERATIONS; i++) {
+		m.sequence = i;
+		s = rdtsc();
+		transmit(request, &m);
+		receive(response, &m);
+		e = rdtsc();
+
+		if (m.sequence != i)
+			ck_error("ERROR: Response %" PRIu64 " to request %u\n",
+			    m.sequence, i);
+
+		total += e - s;
+		if (e - s < best)
+			best = e - s;
+	}
+
+	if (waitpid(pid, &status, 0) != pid)
+		ck_error("ERROR: waitpid: %s\n", strerror(errno));
+
+	printf("%10s %16s %16s\n", "size", "rtt (avg)", "rtt (min)");
+	printf("%10u %16" PRIu64 " %16" PRIu64 "\n", size,
+	    total / ITERATIONS, best);
+	return (0);
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <ck_pr.h>
+#include <ck_ring_broadcast.h>
+#include "../../common.h"
+
+#define RING_SIZE	64
+#define BURST		16
+#define N_CURSORS	4
+#define N_ENTRIES	(1 << 16)
+
+static ck_ring_broadcast_t ring;
+static ck_ring_buffer_t buffer[RING_SIZE];
+static ck_ring_cursor_t cursors[N_CURSORS] CK_CC_CACHELINE;
+
+/* Values are offset by one so that they are never NULL. */
+#define VALUE(v) ((void *)(uintptr_t)((v) + 1))
+
+static bool
+enqueue(unsigned int v)
+{
+
+	return ck_ring_broadcast_enqueue(&ring, buffer, VALUE(v));
+}
+
+static void
+test_serial(unsigned int size)
+{
+	void *entries[RING_SIZE];
+	unsigned int i, j, n;
+	void *r;
+
+	ck_ring_broadcast_init(&ring, size, cursors, N_CURSORS);
+	if (ck_ring_broadcast_capacity(&ring) != size)
+		ck_error("capacity is %u\n", ck_ring_broadcast_capacity(&ring));
+
+	for (i = 0; i < N_CURSORS; i++) {
+		if (ck_ring_broadcast_dequeue(&ring, buffer, &cursors[i],
+		    &r) == true)
+			ck_error("dequeue from empty ring succeeded\n");
+	}
+
+	for (i = 0; i < size; i++) {
+		if (enqueue(i) == false)
+			ck_error("enqueue %u failed\n", i);
+	}
+
+	if (enqueue(i) == true)
+		ck_error("enqueue into full ring succeeded\n");
+
+	/*
+	 * Every cursor but the last drains the ring, which must remain full
+	 * as far as the producer is concerned.
+	 */
+	for (i = 0; i < N_CURSORS - 1; i++) {
+		for (j = 0; j < size; j++) {
+			if (ck_ring_broadcast_dequeue(&ring, buffer,
+			    &cursors[i], &r) == false || r != VALUE(j))
+				ck_error("cursor %u: dequeue %u failed\n",
+				    i, j);
+		}
+
+		if (ck_ring_broadcast_size(&ring, &cursors[i]) != 0)
+			ck_error("cursor %u not drained\n", i);
+	}
+
+	if (enqueue(size) == true)
+		ck_error("enqueue past slowest cursor succeeded\n");
+
+	if (ck_ring_broadcast_size(&ring, &cursors[N_CURSORS - 1]) != size)
+		ck_error("slowest cursor lost entries\n");
+
+	/* The slowest cursor reads half, opening up half of the ring. */
+	n = ck_ring_broadcast_dequeue_burst(&ring, buffer,
+	    &cursors[N_CURSORS - 1], entries, size / 2);
+	if (n != size / 2)
+		ck_error("burst dequeue returned %u\n", n);
+
+	for (j = 0; j < n; j++) {
+		if (entries[j] != VALUE(j))
+			ck_error("burst entry %u is %p\n", j, entries[j]);
+	}
+
+	for (j = 0; j < size; j++)
+		entries[j] = VALUE(size + j);
+
+	n = ck_ring_broadcast_enqueue_burst(&ring, buffer, entries, size);
+	if (n != size / 2)
+		ck_error("burst enqueue returned %u\n", n);
+
+	/* Drain everything, across the wrap-around point. */
+	for (i = 0; i < N_CURSORS; i++) {
+		j = (i == N_CURSORS - 1) ? size / 2 : size;
+		while (ck_ring_broadcast_dequeue(&ring, buffer,
+		    &cursors[i], &r) == true) {
+			if (r != VALUE(j))
+				ck_error("cursor %u: entry %u is %p\n",
+				    i, j, r);
+
+			j++;
+		}
+
+		if (j != size + size / 2)
+			ck_error("cursor %u stopped at %u\n", i, j);
+	}
+
+	return;
+}
+
+static void *
+subscriber(void *arg)
+{
+	ck_ring_cursor_t *cursor = arg;
+	void *entries[BURST];
+	unsigned int i, j, n;
+
+	for (i = 0; i < N_ENTRIES; i += n) {
+		n = ck_ring_broadcast_dequeue_burst(&ring, buffer, cursor,
+		    entries, BURST);
+		if (n == 0) {
+			sched_yield();
+			continue;
+		}
+
+		for (j = 0; j < n; j++) {
+			if (entries[j] != VALUE(i + j))
+				ck_error("entry %u is %p\n", i + j, entries[j]);
+		}
+	}
+
+	return NULL;
+}
+
+static void
+test_concurrent(void)
+{
+	pthread_t threads[N_CURSORS];
+	unsigned int i;
+
+	ck_ring_broadcast_init(&ring, RING_SIZE, cursors, N_CURSORS);
+	for (i = 0; i < N_CURSORS; i++) {
+		if (pthread_create(&threads[i], NULL, subscriber,
+		    &cursors[i]) != 0)
+			ck_error("failed to create subscriber\n");
+	}
+
+	for (i = 0; i < N_ENTRIES; i++) {
+		while (enqueue(i) == false)
+			sched_yield();
+	}
+
+	for (i = 0; i < N_CURSORS; i++)
+		pthread_join(threads[i], NULL);
+
+	return;
+}
+
+int
+main(void)
+{
+	unsigned int size;
+
+	for (size = 2; size <= RING_SIZE; size <<= 1)
+		test_serial(size);
+
+	test_concurrent();
+	return 0;
+}
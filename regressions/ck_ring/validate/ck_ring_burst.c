@@ -0,0 +1,284 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <ck_pr.h>
+#include <ck_ring.h>
+#include "../../common.h"
+
+#define RING_SIZE	64
+#define BURST		32
+#define N_PRODUCERS	2
+#define N_CONSUMERS	2
+#define N_ENTRIES	(1 << 13)
+
+struct entry {
+	unsigned int tid;
+	unsigned int value;
+};
+
+CK_RING_PROTOTYPE(entry, entry)
+
+static ck_ring_t ring CK_CC_CACHELINE;
+static ck_ring_buffer_t buffer[RING_SIZE];
+static struct entry entry_buffer[RING_SIZE];
+static unsigned int seen[N_PRODUCERS][N_ENTRIES];
+static unsigned int consumed;
+
+/*
+ * Values are transferred as pointers, offset by one so that they are
+ * never NULL.
+ */
+#define VALUE(v) ((void *)(uintptr_t)((v) + 1))
+
+static unsigned int
+enqueue_burst(unsigned int mode, void **entries, unsigned int n)
+{
+
+	switch (mode) {
+	case 0:
+		return ck_ring_enqueue_burst_spsc(&ring, buffer, entries, n);
+	case 1:
+		return ck_ring_enqueue_burst_spmc(&ring, buffer, entries, n);
+	case 2:
+		return ck_ring_enqueue_burst_mpsc(&ring, buffer, entries, n);
+	default:
+		return ck_ring_enqueue_burst_mpmc(&ring, buffer, entries, n);
+	}
+}
+
+static unsigned int
+dequeue_burst(unsigned int mode, void **data, unsigned int n)
+{
+
+	switch (mode) {
+	case 0:
+		return ck_ring_dequeue_burst_spsc(&ring, buffer, data, n);
+	case 1:
+		return ck_ring_dequeue_burst_spmc(&ring, buffer, data, n);
+	case 2:
+		return ck_ring_dequeue_burst_mpsc(&ring, buffer, data, n);
+	default:
+		return ck_ring_dequeue_burst_mpmc(&ring, buffer, data, n);
+	}
+}
+
+static void
+test_serial(unsigned int mode)
+{
+	void *in[BURST], *out[BURST];
+	unsigned int produced = 0, next = 0;
+	unsigned int i, j, r;
+
+	ck_ring_init(&ring, RING_SIZE);
+
+	/* The ring holds one entry less than its size. */
+	do {
+		for (i = 0; i < BURST; i++)
+			in[i] = VALUE(produced + i);
+
+		r = enqueue_burst(mode, in, BURST);
+		produced += r;
+	} while (r > 0);
+
+	if (produced != RING_SIZE - 1 || ck_ring_size(&ring) != RING_SIZE - 1)
+		ck_error("ERROR: [%u] Enqueued %u entries into full ring\n",
+		    mode, produced);
+
+	/* Transfer odd-sized bursts so that they wrap around the buffer. */
+	for (j = 0; j < 1024; j++) {
+		r = dequeue_burst(mode, out, 7);
+		for (i = 0; i < r; i++) {
+			if (out[i] != VALUE(next))
+				ck_error("ERROR: [%u] Dequeued %p, expected %u\n",
+				    mode, out[i], next);
+
+			next++;
+		}
+
+		for (i = 0; i < 5; i++)
+			in[i] = VALUE(produced + i);
+
+		produced += enqueue_burst(mode, in, 5);
+		if (ck_ring_size(&ring) != produced - next)
+			ck_error("ERROR: [%u] Size %u, expected %u\n", mode,
+			    ck_ring_size(&ring), produced - next);
+	}
+
+	while ((r = dequeue_burst(mode, out, BURST)) > 0) {
+		for (i = 0; i < r; i++) {
+			if (out[i] != VALUE(next))
+				ck_error("ERROR: [%u] Dequeued %p, expected %u\n",
+				    mode, out[i], next);
+
+			next++;
+		}
+	}
+
+	if (next != produced)
+		ck_error("ERROR: [%u] Dequeued %u of %u entries\n", mode,
+		    next, produced);
+
+	return;
+}
+
+static void
+test_template(void)
+{
+	struct entry in[BURST], out[BURST];
+	unsigned int i, r, next = 0, produced = 0;
+
+	ck_ring_init(&ring, RING_SIZE);
+
+	for (;;) {
+		for (i = 0; i < BURST; i++) {
+			in[i].tid = 0;
+			in[i].value = produced + i;
+		}
+
+		r = CK_RING_ENQUEUE_BURST_SPMC(entry, &ring, entry_buffer, in, BURST);
+		if (r == 0)
+			break;
+
+		produced += r;
+	}
+
+	if (produced != RING_SIZE - 1)
+		ck_error("ERROR: Enqueued %u entries into full ring\n", produced);
+
+	while ((r = CK_RING_DEQUEUE_BURST_MPMC(entry, &ring, entry_buffer,
+	    out, 5)) > 0) {
+		for (i = 0; i < r; i++) {
+			if (out[i].value != next++)
+				ck_error("ERROR: Dequeued %u, expected %u\n",
+				    out[i].value, next - 1);
+		}
+	}
+
+	if (next != produced)
+		ck_error("ERROR: Dequeued %u of %u entries\n", next, produced);
+
+	return;
+}
+
+static void *
+producer(void *arg)
+{
+	unsigned int tid = (unsigned int)(uintptr_t)arg;
+	struct entry in[BURST];
+	unsigned int i, n, r;
+
+	for (n = 0; n < N_ENTRIES; n += r) {
+		for (i = 0; i < BURST; i++) {
+			in[i].tid = tid;
+			in[i].value = n + i;
+		}
+
+		i = N_ENTRIES - n < BURST ? N_ENTRIES - n : BURST;
+		r = CK_RING_ENQUEUE_BURST_MPMC(entry, &ring, entry_buffer, in, i);
+		if (r == 0)
+			ck_pr_stall();
+	}
+
+	return NULL;
+}
+
+static void *
+consumer(void *arg)
+{
+	unsigned int previous[N_PRODUCERS];
+	struct entry out[BURST];
+	unsigned int i, r;
+
+	(void)arg;
+	memset(previous, 0, sizeof(previous));
+
+	while (ck_pr_load_uint(&consumed) != N_PRODUCERS * N_ENTRIES) {
+		r = CK_RING_DEQUEUE_BURST_MPMC(entry, &ring, entry_buffer, out, BURST);
+		if (r == 0) {
+			ck_pr_stall();
+			continue;
+		}
+
+		for (i = 0; i < r; i++) {
+			if (out[i].tid >= N_PRODUCERS || out[i].value >= N_ENTRIES)
+				ck_error("ERROR: Dequeued invalid entry\n");
+
+			/* Entries of a producer are consumed in order by any consumer. */
+			if (out[i].value < previous[out[i].tid])
+				ck_error("ERROR: Entry %u of producer %u out of order\n",
+				    out[i].value, out[i].tid);
+
+			previous[out[i].tid] = out[i].value;
+			if (ck_pr_faa_uint(&seen[out[i].tid][out[i].value], 1) != 0)
+				ck_error("ERROR: Entry %u of producer %u dequeued twice\n",
+				    out[i].value, out[i].tid);
+		}
+
+		ck_pr_add_uint(&consumed, r);
+	}
+
+	return NULL;
+}
+
+int
+main(void)
+{
+	pthread_t threads[N_PRODUCERS + N_CONSUMERS];
+	unsigned int i;
+
+	for (i = 0; i < 4; i++)
+		test_serial(i);
+
+	test_template();
+
+	ck_ring_init(&ring, RING_SIZE);
+	for (i = 0; i < N_PRODUCERS; i++) {
+		if (pthread_create(&threads[i], NULL, producer,
+		    (void *)(uintptr_t)i) != 0)
+			ck_error("ERROR: Failed to create producer\n");
+	}
+
+	for (i = 0; i < N_CONSUMERS; i++) {
+		if (pthread_create(&threads[N_PRODUCERS + i], NULL, consumer,
+		    NULL) != 0)
+			ck_error("ERROR: Failed to create consumer\n");
+	}
+
+	for (i = 0; i < N_PRODUCERS + N_CONSUMERS; i++)
+		pthread_join(threads[i], NULL);
+
+	if (ck_ring_size(&ring) != 0)
+		ck_error("ERROR: Ring not empty\n");
+
+	return 0;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <ck_pr.h>
+#include <ck_ring.h>
+#include "../../common.h"
+
+#define RING_SIZE	1024
+#ifndef N_MESSAGES
+#define N_MESSAGES	(1 << 16)
+#endif
+
+static ck_ring_t ring CK_CC_CACHELINE;
+static uint64_t buffer[RING_SIZE / sizeof(uint64_t)];
+
+/*
+ * Message i is (i * 7) % capacity bytes long and filled with the low byte of
+ * i + offset, so that both truncation and corruption are detected.
+ */
+static unsigned int
+message_length(unsigned int i)
+{
+
+	return (i * 7) % (ck_ring_capacity_spsc_bytes(&ring) + 1);
+}
+
+static void
+message_fill(unsigned char *p, unsigned int i, unsigned int length)
+{
+	unsigned int j;
+
+	for (j = 0; j < length; j++)
+		p[j] = (unsigned char)(i + j);
+
+	return;
+}
+
+static void
+message_check(const unsigned char *p, unsigned int i, unsigned int length)
+{
+	unsigned int j;
+
+	if (length != message_length(i))
+		ck_error("message %u has length %u, expected %u\n",
+		    i, length, message_length(i));
+
+	for (j = 0; j < length; j++) {
+		if (p[j] != (unsigned char)(i + j))
+			ck_error("message %u corrupted at byte %u\n", i, j);
+	}
+
+	return;
+}
+
+static void
+test_serial(void)
+{
+	unsigned char message[RING_SIZE];
+	const void *r;
+	unsigned int i, length, n;
+	void *slot;
+
+	ck_ring_init(&ring, RING_SIZE);
+	if (ck_ring_dequeue_reserve_spsc_bytes(&ring, buffer, &length) != NULL)
+		ck_error("dequeue from empty ring succeeded\n");
+
+	if (ck_ring_enqueue_reserve_spsc_bytes(&ring, buffer,
+	    ck_ring_capacity_spsc_bytes(&ring) + 1) != NULL)
+		ck_error("oversized reservation succeeded\n");
+
+	/* Empty messages still take a header each. */
+	for (n = 0; n < RING_SIZE / CK_RING_BYTES_ALIGN; n++) {
+		if (ck_ring_enqueue_spsc_bytes(&ring, buffer, "", 0) == false)
+			ck_error("enqueue %u of empty message failed\n", n);
+	}
+
+	if (ck_ring_enqueue_spsc_bytes(&ring, buffer, "", 0) == true)
+		ck_error("enqueue into full ring succeeded\n");
+
+	for (i = 0; i < n; i++) {
+		r = ck_ring_dequeue_reserve_spsc_bytes(&ring, buffer, &length);
+		if (r == NULL || length != 0)
+			ck_error("dequeue %u of empty message failed\n", i);
+
+		ck_ring_dequeue_commit_spsc_bytes(&ring, buffer);
+	}
+
+	/*
+	 * Walk every offset with messages of every length, so that all
+	 * wrap-around paths are exercised.
+	 */
+	for (i = 0; i < RING_SIZE * 4; i++) {
+		length = message_length(i);
+		slot = ck_ring_enqueue_reserve_spsc_bytes(&ring, buffer, length);
+		if (slot == NULL)
+			ck_error("reservation %u of %u bytes failed\n", i, length);
+
+		if ((uintptr_t)slot % CK_RING_BYTES_ALIGN != 0)
+			ck_error("reservation %u is misaligned\n", i);
+
+		if ((unsigned char *)slot + length >
+		    (unsigned char *)buffer + RING_SIZE)
+			ck_error("reservation %u overflows the buffer\n", i);
+
+		message_fill(slot, i, length);
+
+		/* Nothing is visible before the commit. */
+		if (ck_ring_dequeue_reserve_spsc_bytes(&ring, buffer,
+		    &length) != NULL)
+			ck_error("uncommitted message %u is visible\n", i);
+
+		ck_ring_enqueue_commit_spsc_bytes(&ring);
+
+		r = ck_ring_dequeue_reserve_spsc_bytes(&ring, buffer, &length);
+		if (r == NULL)
+			ck_error("dequeue %u failed\n", i);
+
+		message_check(r, i, length);
+		ck_ring_dequeue_commit_spsc_bytes(&ring, buffer);
+	}
+
+	/* Copying enqueue until full, then drain in order. */
+	for (n = 0;; n++) {
+		length = message_length(n);
+		message_fill(message, n, length);
+		if (ck_ring_enqueue_spsc_bytes(&ring, buffer, message,
+		    length) == false)
+			break;
+	}
+
+	if (n == 0)
+		ck_error("no message fit in an empty ring\n");
+
+	for (i = 0; i < n; i++) {
+		r = ck_ring_dequeue_reserve_spsc_bytes(&ring, buffer, &length);
+		if (r == NULL)
+			ck_error("dequeue %u of %u failed\n", i, n);
+
+		message_check(r, i, length);
+		ck_ring_dequeue_commit_spsc_bytes(&ring, buffer);
+	}
+
+	if (ck_ring_dequeue_reserve_spsc_bytes(&ring, buffer, &length) != NULL)
+		ck_error("ring not empty after drain\n");
+
+	return;
+}
+
+static void *
+consumer(void *arg)
+{
+	const void *r;
+	unsigned int i, length;
+
+	(void)arg;
+	for (i = 0; i < N_MESSAGES; i++) {
+		while ((r = ck_ring_dequeue_reserve_spsc_bytes(&ring, buffer,
+		    &length)) == NULL)
+			sched_yield();
+
+		message_check(r, i, length);
+		ck_ring_dequeue_commit_spsc_bytes(&ring, buffer);
+	}
+
+	return NULL;
+}
+
+static void
+test_concurrent(void)
+{
+	pthread_t thread;
+	unsigned int i, length;
+	void *slot;
+
+	ck_ring_init(&ring, RING_SIZE);
+	if (pthread_create(&thread, NULL, consumer, NULL) != 0)
+		ck_error("failed to create consumer\n");
+
+	for (i = 0; i < N_MESSAGES; i++) {
+		length = message_length(i);
+		while ((slot = ck_ring_enqueue_reserve_spsc_bytes(&ring,
+		    buffer, length)) == NULL)
+			sched_yield();
+
+		message_fill(slot, i, length);
+		ck_ring_enqueue_commit_spsc_bytes(&ring);
+	}
+
+	pthread_join(thread, NULL);
+	return;
+}
+
+int
+main(void)
+{
+
+	test_serial();
+	test_concurrent();
+	return 0;
+}
@@ -0,0 +1,403 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <ck_pr.h>
+#include <ck_ring_ec.h>
+#include "../../common.h"
+
+#define RING_SIZE	8
+#define N_PRODUCERS	2
+#define N_CONSUMERS	2
+#define N_ENTRIES	(1 << 12)
+#define TIMEOUT_NS	10000000L
+
+#ifndef __linux__
+/* Zero-initialize to mark the ops as unavailable. */
+static const struct ck_ec_ops test_ops;
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+static int
+gettime(const struct ck_ec_ops *ops, struct timespec *out)
+{
+
+	(void)ops;
+	return clock_gettime(CLOCK_MONOTONIC, out);
+}
+
+static void
+wait32(const struct ck_ec_wait_state *state, const uint32_t *address,
+    uint32_t expected, const struct timespec *deadline)
+{
+
+	(void)state;
+	syscall(SYS_futex, address, FUTEX_WAIT_BITSET, expected, deadline,
+	    NULL, FUTEX_BITSET_MATCH_ANY, 0);
+	return;
+}
+
+static void
+wake32(const struct ck_ec_ops *ops, const uint32_t *address)
+{
+
+	(void)ops;
+	syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+	return;
+}
+
+static const struct ck_ec_ops test_ops = {
+	.gettime = gettime,
+	.wait32 = wait32,
+	.wake32 = wake32
+};
+#endif /* __linux__ */
+
+static ck_ring_t ring CK_CC_CACHELINE;
+static ck_ring_buffer_t buffer[RING_SIZE];
+static ck_ring_ec_t ec = CK_RING_EC_INITIALIZER;
+static unsigned int seen[N_PRODUCERS][N_ENTRIES];
+static unsigned int n_producers, n_consumers;
+
+static ck_ring_broadcast_t broadcast;
+static ck_ring_cursor_t cursors[N_CONSUMERS] CK_CC_CACHELINE;
+
+static const struct timespec now = { 0, 0 };
+
+/*
+ * Values encode the producer in the upper bits and are offset by one so
+ * that they are never NULL. A NULL value tells a consumer to exit.
+ */
+#define VALUE(t, v)	((void *)(uintptr_t)(((t) << 24 | (v)) + 1))
+#define TID(p)		((unsigned int)(((uintptr_t)(p) - 1) >> 24))
+#define SEQ(p)		((unsigned int)(((uintptr_t)(p) - 1) & 0xffffff))
+
+static bool
+enqueue_wait(unsigned int mode, void *entry, const struct timespec *deadline)
+{
+
+	switch (mode) {
+	case 0:
+		return ck_ring_enqueue_wait_spsc(&ring, buffer, &ec,
+		    &test_ops, entry, deadline);
+	case 1:
+		return ck_ring_enqueue_wait_spmc(&ring, buffer, &ec,
+		    &test_ops, entry, deadline);
+	case 2:
+		return ck_ring_enqueue_wait_mpsc(&ring, buffer, &ec,
+		    &test_ops, entry, deadline);
+	default:
+		return ck_ring_enqueue_wait_mpmc(&ring, buffer, &ec,
+		    &test_ops, entry, deadline);
+	}
+}
+
+static bool
+dequeue_wait(unsigned int mode, void *data, const struct timespec *deadline)
+{
+
+	switch (mode) {
+	case 0:
+		return ck_ring_dequeue_wait_spsc(&ring, buffer, &ec,
+		    &test_ops, data, deadline);
+	case 1:
+		return ck_ring_dequeue_wait_spmc(&ring, buffer, &ec,
+		    &test_ops, data, deadline);
+	case 2:
+		return ck_ring_dequeue_wait_mpsc(&ring, buffer, &ec,
+		    &test_ops, data, deadline);
+	default:
+		return ck_ring_dequeue_wait_mpmc(&ring, buffer, &ec,
+		    &test_ops, data, deadline);
+	}
+}
+
+static long
+elapsed(const struct timespec *a, const struct timespec *b)
+{
+
+	return (b->tv_sec - a->tv_sec) * 1000000000L +
+	    (b->tv_nsec - a->tv_nsec);
+}
+
+static void
+test_serial(unsigned int mode)
+{
+	struct timespec begin, end, deadline;
+	const struct timespec timeout = { 0, TIMEOUT_NS };
+	const struct ck_ec_mode ec_mode = { .ops = &test_ops };
+	unsigned int i;
+	void *r;
+
+	ck_ring_init(&ring, RING_SIZE);
+	ck_ring_ec_init(&ec);
+
+	/* An empty ring times out. */
+	if (dequeue_wait(mode, &r, &now) == true)
+		ck_error("[%u] dequeue from empty ring succeeded\n", mode);
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	if (ck_ec_deadline(&deadline, &ec_mode, &timeout) != 0)
+		ck_error("[%u] ck_ec_deadline failed\n", mode);
+
+	if (dequeue_wait(mode, &r, &deadline) == true)
+		ck_error("[%u] dequeue from empty ring succeeded\n", mode);
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if (elapsed(&begin, &end) < TIMEOUT_NS)
+		ck_error("[%u] dequeue returned early\n", mode);
+
+	/* Fill the ring without blocking, then time out on a full ring. */
+	for (i = 0; i < RING_SIZE - 1; i++) {
+		if (enqueue_wait(mode, VALUE(0, i), &now) == false)
+			ck_error("[%u] enqueue %u failed\n", mode, i);
+	}
+
+	if (enqueue_wait(mode, VALUE(0, i), &now) == true)
+		ck_error("[%u] enqueue into full ring succeeded\n", mode);
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	if (ck_ec_deadline(&deadline, &ec_mode, &timeout) != 0)
+		ck_error("[%u] ck_ec_deadline failed\n", mode);
+
+	if (enqueue_wait(mode, VALUE(0, i), &deadline) == true)
+		ck_error("[%u] enqueue into full ring succeeded\n", mode);
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if (elapsed(&begin, &end) < TIMEOUT_NS)
+		ck_error("[%u] enqueue returned early\n", mode);
+
+	for (i = 0; i < RING_SIZE - 1; i++) {
+		if (dequeue_wait(mode, &r, NULL) == false)
+			ck_error("[%u] dequeue %u failed\n", mode, i);
+
+		if (r != VALUE(0, i))
+			ck_error("[%u] dequeue %u returned %p\n", mode, i, r);
+	}
+
+	if (ck_ec32_value(&ec.readable) != RING_SIZE - 1 ||
+	    ck_ec32_value(&ec.writable) != RING_SIZE - 1)
+		ck_error("[%u] event counts out of sync\n", mode);
+
+	return;
+}
+
+static void *
+producer(void *arg)
+{
+	unsigned int tid = (unsigned int)(uintptr_t)arg;
+	unsigned int mode = (n_producers > 1) << 1 | (n_consumers > 1);
+	unsigned int i;
+
+	for (i = 0; i < N_ENTRIES; i++) {
+		if (enqueue_wait(mode, VALUE(tid, i), NULL) == false)
+			ck_error("enqueue without deadline timed out\n");
+	}
+
+	return NULL;
+}
+
+static void *
+consumer(void *arg)
+{
+	unsigned int mode = (n_producers > 1) << 1 | (n_consumers > 1);
+	unsigned int last[N_PRODUCERS];
+	unsigned int i, tid, seq;
+	void *r;
+
+	(void)arg;
+	for (i = 0; i < N_PRODUCERS; i++)
+		last[i] = 0;
+
+	for (;;) {
+		if (dequeue_wait(mode, &r, NULL) == false)
+			ck_error("dequeue without deadline timed out\n");
+
+		if (r == NULL)
+			break;
+
+		tid = TID(r);
+		seq = SEQ(r);
+		if (tid >= n_producers || seq >= N_ENTRIES)
+			ck_error("invalid entry %p\n", r);
+
+		/* Entries of a producer are dequeued in order. */
+		if (seq + 1 <= last[tid])
+			ck_error("entry %u of producer %u out of order\n",
+			    seq, tid);
+
+		last[tid] = seq + 1;
+		ck_pr_inc_uint(&seen[tid][seq]);
+	}
+
+	return NULL;
+}
+
+static void
+test_concurrent(unsigned int producers, unsigned int consumers)
+{
+	pthread_t threads[N_PRODUCERS + N_CONSUMERS];
+	unsigned int i, j;
+
+	ck_ring_init(&ring, RING_SIZE);
+	ck_ring_ec_init(&ec);
+	n_producers = producers;
+	n_consumers = consumers;
+	for (i = 0; i < N_PRODUCERS; i++) {
+		for (j = 0; j < N_ENTRIES; j++)
+			seen[i][j] = 0;
+	}
+
+	for (i = 0; i < consumers; i++) {
+		if (pthread_create(&threads[producers + i], NULL, consumer,
+		    NULL) != 0)
+			ck_error("failed to create consumer\n");
+	}
+
+	for (i = 0; i < producers; i++) {
+		if (pthread_create(&threads[i], NULL, producer,
+		    (void *)(uintptr_t)i) != 0)
+			ck_error("failed to create producer\n");
+	}
+
+	for (i = 0; i < producers; i++)
+		pthread_join(threads[i], NULL);
+
+	/*
+	 * Every producer has finished, so the main thread may act as the
+	 * only one left and hand out one exit marker per consumer.
+	 */
+	for (i = 0; i < consumers; i++) {
+		if (enqueue_wait((producers > 1) << 1 | (consumers > 1),
+		    NULL, NULL) == false)
+			ck_error("enqueue of exit marker timed out\n");
+	}
+
+	for (i = 0; i < consumers; i++)
+		pthread_join(threads[producers + i], NULL);
+
+	for (i = 0; i < producers; i++) {
+		for (j = 0; j < N_ENTRIES; j++) {
+			if (seen[i][j] != 1) {
+				ck_error("entry %u of producer %u seen %u "
+				    "times\n", j, i, seen[i][j]);
+			}
+		}
+	}
+
+	return;
+}
+
+static void *
+subscriber(void *arg)
+{
+	ck_ring_cursor_t *cursor = arg;
+	unsigned int i;
+	void *r;
+
+	for (i = 0; i < N_ENTRIES; i++) {
+		if (ck_ring_broadcast_dequeue_wait(&broadcast, buffer, cursor,
+		    &ec, &test_ops, &r, NULL) == false)
+			ck_error("dequeue without deadline timed out\n");
+
+		if (r != VALUE(0, i))
+			ck_error("entry %u is %p\n", i, r);
+	}
+
+	return NULL;
+}
+
+static void
+test_broadcast(void)
+{
+	pthread_t threads[N_CONSUMERS];
+	unsigned int i;
+	void *r;
+
+	ck_ring_broadcast_init(&broadcast, RING_SIZE, cursors, N_CONSUMERS);
+	ck_ring_ec_init(&ec);
+
+	if (ck_ring_broadcast_dequeue_wait(&broadcast, buffer, &cursors[0],
+	    &ec, &test_ops, &r, &now) == true)
+		ck_error("dequeue from empty ring succeeded\n");
+
+	for (i = 0; i < RING_SIZE; i++) {
+		if (ck_ring_broadcast_enqueue_wait(&broadcast, buffer, &ec,
+		    &test_ops, VALUE(0, i), &now) == false)
+			ck_error("enqueue %u failed\n", i);
+	}
+
+	if (ck_ring_broadcast_enqueue_wait(&broadcast, buffer, &ec,
+	    &test_ops, VALUE(0, i), &now) == true)
+		ck_error("enqueue into full ring succeeded\n");
+
+	for (i = 0; i < N_CONSUMERS; i++) {
+		if (pthread_create(&threads[i], NULL, subscriber,
+		    &cursors[i]) != 0)
+			ck_error("failed to create subscriber\n");
+	}
+
+	for (i = RING_SIZE; i < N_ENTRIES; i++) {
+		if (ck_ring_broadcast_enqueue_wait(&broadcast, buffer, &ec,
+		    &test_ops, VALUE(0, i), NULL) == false)
+			ck_error("enqueue without deadline timed out\n");
+	}
+
+	for (i = 0; i < N_CONSUMERS; i++)
+		pthread_join(threads[i], NULL);
+
+	return;
+}
+
+int
+main(void)
+{
+	unsigned int i;
+
+	if (test_ops.gettime == NULL || test_ops.wait32 == NULL ||
+	    test_ops.wake32 == NULL) {
+		printf("No ck_ec ops for this platform. Trivial success.\n");
+		return 0;
+	}
+
+	for (i = 0; i < 4; i++)
+		test_serial(i);
+
+	test_concurrent(1, 1);
+	test_concurrent(1, N_CONSUMERS);
+	test_concurrent(N_PRODUCERS, 1);
+	test_concurrent(N_PRODUCERS, N_CONSUMERS);
+	test_broadcast();
+	return 0;
+}
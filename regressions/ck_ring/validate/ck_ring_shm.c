@@ -0,0 +1,458 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ck_pr.h>
+#include <ck_ring.h>
+#include <ck_ring_shm.h>
+#include "../../common.h"
+
+#define RING_SIZE	64
+#define N_RACERS	4
+#define N_ENTRIES	(1 << 14)
+#define N_MESSAGES	(1 << 12)
+
+struct entry {
+	unsigned int sequence;
+	unsigned int check;
+};
+
+CK_RING_PROTOTYPE(entry, entry)
+
+static void *
+segment(size_t length)
+{
+	void *p;
+
+	/* A fresh anonymous mapping is zero-filled, like a new shm object. */
+	p = mmap(NULL, length, PROT_READ | PROT_WRITE,
+	    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		ck_error("mmap: %s\n", strerror(errno));
+
+	return p;
+}
+
+static void
+reap(pid_t pid, int expected)
+{
+	int status;
+
+	if (waitpid(pid, &status, 0) != pid)
+		ck_error("waitpid: %s\n", strerror(errno));
+
+	if (WIFEXITED(status) == 0 || WEXITSTATUS(status) != expected)
+		ck_error("child %d exited with status %d\n", (int)pid, status);
+
+	return;
+}
+
+static void
+test_init(void)
+{
+	size_t length = ck_ring_shm_footprint(RING_SIZE, sizeof(struct entry));
+	struct ck_ring_shm *shm = segment(length);
+	pid_t pids[N_RACERS];
+	unsigned int i;
+
+	for (i = 0; i < N_RACERS; i++) {
+		pids[i] = fork();
+		if (pids[i] == -1)
+			ck_error("fork: %s\n", strerror(errno));
+
+		if (pids[i] == 0) {
+			_exit(ck_ring_shm_init(shm, RING_SIZE,
+			    sizeof(struct entry), getpid()) == true ? 0 : 1);
+		}
+	}
+
+	if (ck_ring_shm_init(shm, RING_SIZE, sizeof(struct entry),
+	    getpid()) == false)
+		ck_error("init failed\n");
+
+	for (i = 0; i < N_RACERS; i++)
+		reap(pids[i], 0);
+
+	/* A mismatched geometry is refused. */
+	if (ck_ring_shm_init(shm, RING_SIZE * 2, sizeof(struct entry),
+	    getpid()) == true)
+		ck_error("init with another size succeeded\n");
+
+	if (ck_ring_shm_init(shm, RING_SIZE, 0, getpid()) == true)
+		ck_error("init with another entry size succeeded\n");
+
+	if (ck_ring_shm_valid(shm) == false)
+		ck_error("ring invalid after init\n");
+
+	/* A consumer counter ahead of the producer is detected. */
+	ck_ring_shm_ring(shm)->c_head = 1;
+	if (ck_ring_shm_valid(shm) == true)
+		ck_error("corrupted ring is valid\n");
+
+	munmap(shm, length);
+	return;
+}
+
+/*
+ * A process that terminates after claiming the segment, but before
+ * publishing the ring, must not hang the processes attaching to it.
+ */
+static void
+test_init_recover(void)
+{
+	size_t length = ck_ring_shm_footprint(RING_SIZE, sizeof(struct entry));
+	struct ck_ring_shm *shm = segment(length);
+	struct entry e = { 1, 2 };
+	pid_t dead;
+
+	dead = fork();
+	if (dead == -1)
+		ck_error("fork: %s\n", strerror(errno));
+
+	if (dead == 0) {
+		if (ck_pr_cas_uint(&shm->initializer, 0, getpid()) == false)
+			_exit(1);
+
+		/* Terminate in the middle of initialization. */
+		ck_ring_shm_ring(shm)->size = RING_SIZE;
+		_exit(0);
+	}
+
+	reap(dead, 0);
+
+	if (ck_ring_shm_init(shm, RING_SIZE, sizeof(struct entry),
+	    getpid()) == true)
+		ck_error("init succeeded on an unpublished segment\n");
+
+	if (ck_ring_shm_initializer(shm) != (unsigned int)dead)
+		ck_error("initializer is %u\n", ck_ring_shm_initializer(shm));
+
+	if (ck_ring_shm_init_recover(shm, RING_SIZE, sizeof(struct entry),
+	    getpid(), getpid()) == true)
+		ck_error("recovered from a live initializer\n");
+
+	if (ck_ring_shm_init_recover(shm, RING_SIZE, sizeof(struct entry),
+	    dead, getpid()) == false)
+		ck_error("init recovery failed\n");
+
+	if (ck_ring_shm_init(shm, RING_SIZE, sizeof(struct entry),
+	    dead) == false)
+		ck_error("init failed after recovery\n");
+
+	if (ck_ring_enqueue_spsc_entry(ck_ring_shm_ring(shm),
+	    ck_ring_shm_buffer(shm), &e) == false ||
+	    ck_ring_dequeue_spsc_entry(ck_ring_shm_ring(shm),
+	    ck_ring_shm_buffer(shm), &e) == false ||
+	    e.sequence != 1 || e.check != 2)
+		ck_error("recovered ring is unusable\n");
+
+	munmap(shm, length);
+	return;
+}
+
+/*
+ * An owner token of 0 is indistinguishable from an unclaimed segment or
+ * end, so it must never claim either.
+ */
+static void
+test_owner(void)
+{
+	size_t length = ck_ring_shm_footprint(RING_SIZE, sizeof(struct entry));
+	struct ck_ring_shm *shm = segment(length);
+	unsigned int pid = getpid();
+	struct entry e = { 1, 2 };
+
+	if (ck_ring_shm_init(shm, RING_SIZE, sizeof(struct entry), 0) == true ||
+	    ck_ring_shm_initializer(shm) != 0)
+		ck_error("init succeeded with a zero owner\n");
+
+	if (ck_ring_shm_init(shm, RING_SIZE, sizeof(struct entry),
+	    pid) == false)
+		ck_error("init failed\n");
+
+	if (ck_ring_enqueue_spsc_entry(ck_ring_shm_ring(shm),
+	    ck_ring_shm_buffer(shm), &e) == false)
+		ck_error("enqueue failed\n");
+
+	/* The live ring must not be published again. */
+	if (ck_ring_shm_init(shm, RING_SIZE, sizeof(struct entry), 0) == true)
+		ck_error("init succeeded with a zero owner\n");
+
+	if (ck_ring_shm_init_recover(shm, RING_SIZE, sizeof(struct entry),
+	    pid, 0) == true || ck_ring_shm_initializer(shm) != pid)
+		ck_error("init recovery succeeded with a zero owner\n");
+
+	if (ck_ring_size(ck_ring_shm_ring(shm)) != 1)
+		ck_error("ring was reset\n");
+
+	if (ck_ring_shm_attach(shm, CK_RING_SHM_PRODUCER, 0) == true)
+		ck_error("attach succeeded with a zero owner\n");
+
+	if (ck_ring_shm_attach(shm, CK_RING_SHM_PRODUCER, pid) == false)
+		ck_error("attach failed\n");
+
+	if (ck_ring_shm_attach(shm, CK_RING_SHM_PRODUCER, pid + 1) == true)
+		ck_error("second producer attached\n");
+
+	if (ck_ring_shm_recover(shm, CK_RING_SHM_PRODUCER, pid, 0) == true ||
+	    ck_ring_shm_owner(shm, CK_RING_SHM_PRODUCER) != pid)
+		ck_error("recovery succeeded with a zero owner\n");
+
+	munmap(shm, length);
+	return;
+}
+
+static void
+produce(struct ck_ring_shm *shm, unsigned int from, unsigned int to)
+{
+	struct ck_ring *ring = ck_ring_shm_ring(shm);
+	struct entry *buffer = ck_ring_shm_buffer(shm);
+	struct entry e;
+	unsigned int i;
+
+	for (i = from; i < to; i++) {
+		e.sequence = i;
+		e.check = ~i;
+		while (CK_RING_ENQUEUE_SPSC(entry, ring, buffer, &e) == false)
+			sched_yield();
+
+		ck_ring_shm_heartbeat(shm, CK_RING_SHM_PRODUCER);
+	}
+
+	return;
+}
+
+static void
+consume(struct ck_ring_shm *shm, unsigned int from, unsigned int to)
+{
+	struct ck_ring *ring = ck_ring_shm_ring(shm);
+	struct entry *buffer = ck_ring_shm_buffer(shm);
+	struct entry e;
+	unsigned int i;
+
+	for (i = from; i < to; i++) {
+		while (CK_RING_DEQUEUE_SPSC(entry, ring, buffer, &e) == false)
+			sched_yield();
+
+		if (e.sequence != i || e.check != ~i)
+			ck_error("entry %u is {%u, %u}\n", i, e.sequence, e.check);
+	}
+
+	return;
+}
+
+static void
+test_transfer(void)
+{
+	size_t length = ck_ring_shm_footprint(RING_SIZE, sizeof(struct entry));
+	struct ck_ring_shm *shm = segment(length);
+	struct entry *slot;
+	unsigned int heartbeat = 0;
+	pid_t pid, observer;
+
+	if (ck_ring_shm_init(shm, RING_SIZE, sizeof(struct entry),
+	    getpid()) == false)
+		ck_error("init failed\n");
+
+	if (ck_ring_shm_attach(shm, CK_RING_SHM_CONSUMER, getpid()) == false)
+		ck_error("consumer attach failed\n");
+
+	if (ck_ring_shm_attach(shm, CK_RING_SHM_CONSUMER, getpid()) == true)
+		ck_error("second consumer attach succeeded\n");
+
+	pid = fork();
+	if (pid == -1)
+		ck_error("fork: %s\n", strerror(errno));
+
+	if (pid == 0) {
+		if (ck_ring_shm_attach(shm, CK_RING_SHM_PRODUCER,
+		    getpid()) == false)
+			_exit(1);
+
+		produce(shm, 0, N_ENTRIES);
+		ck_ring_shm_detach(shm, CK_RING_SHM_PRODUCER);
+		_exit(0);
+	}
+
+	/* The ring is consistent at any time while in use. */
+	observer = fork();
+	if (observer == -1)
+		ck_error("fork: %s\n", strerror(errno));
+
+	if (observer == 0) {
+		while (ck_pr_load_uint(&ck_ring_shm_ring(shm)->c_head) !=
+		    N_ENTRIES) {
+			if (ck_ring_shm_valid(shm) == false)
+				_exit(1);
+		}
+
+		_exit(0);
+	}
+
+	consume(shm, 0, N_ENTRIES);
+	reap(pid, 0);
+	reap(observer, 0);
+	if (ck_ring_shm_owner(shm, CK_RING_SHM_PRODUCER) != 0)
+		ck_error("producer still attached after detach\n");
+
+	/*
+	 * The next producer dies with entries in flight and a reservation
+	 * that was never committed.
+	 */
+	pid = fork();
+	if (pid == -1)
+		ck_error("fork: %s\n", strerror(errno));
+
+	if (pid == 0) {
+		if (ck_ring_shm_attach(shm, CK_RING_SHM_PRODUCER,
+		    getpid()) == false)
+			_exit(1);
+
+		produce(shm, N_ENTRIES, N_ENTRIES + RING_SIZE / 2);
+		slot = ck_ring_enqueue_reserve_spsc_entry(
+		    ck_ring_shm_ring(shm), ck_ring_shm_buffer(shm));
+		if (slot == NULL)
+			_exit(1);
+
+		slot->sequence = 0;
+		_exit(0);
+	}
+
+	reap(pid, 0);
+	if (ck_ring_shm_owner(shm, CK_RING_SHM_PRODUCER) != (unsigned int)pid)
+		ck_error("dead producer is not the owner\n");
+
+	if (kill(pid, 0) == 0 || errno != ESRCH)
+		ck_error("dead producer is alive\n");
+
+	if (ck_ring_shm_alive(shm, CK_RING_SHM_PRODUCER, &heartbeat) == false)
+		ck_error("no heartbeat from the producer\n");
+
+	if (ck_ring_shm_alive(shm, CK_RING_SHM_PRODUCER, &heartbeat) == true)
+		ck_error("heartbeat from dead producer\n");
+
+	if (ck_ring_shm_recover(shm, CK_RING_SHM_PRODUCER, getpid(),
+	    getpid()) == true)
+		ck_error("recovery from a live owner succeeded\n");
+
+	if (ck_ring_shm_recover(shm, CK_RING_SHM_PRODUCER, pid,
+	    getpid()) == false)
+		ck_error("recovery failed\n");
+
+	/* Committed entries survive, the reservation does not. */
+	if (ck_ring_size(ck_ring_shm_ring(shm)) != RING_SIZE / 2)
+		ck_error("%u entries after recovery\n",
+		    ck_ring_size(ck_ring_shm_ring(shm)));
+
+	produce(shm, N_ENTRIES + RING_SIZE / 2, N_ENTRIES + RING_SIZE - 1);
+	consume(shm, N_ENTRIES, N_ENTRIES + RING_SIZE - 1);
+	munmap(shm, length);
+	return;
+}
+
+static void
+test_bytes(void)
+{
+	size_t length = ck_ring_shm_footprint(RING_SIZE * 16, 0);
+	struct ck_ring_shm *shm = segment(length);
+	struct ck_ring *ring;
+	unsigned char *buffer;
+	const unsigned char *message;
+	unsigned int i, j, size;
+	pid_t pid;
+
+	if (ck_ring_shm_init(shm, RING_SIZE * 16, 0, getpid()) == false)
+		ck_error("init failed\n");
+
+	ring = ck_ring_shm_ring(shm);
+	buffer = ck_ring_shm_buffer(shm);
+	pid = fork();
+	if (pid == -1)
+		ck_error("fork: %s\n", strerror(errno));
+
+	if (pid == 0) {
+		unsigned char *slot;
+
+		for (i = 0; i < N_MESSAGES; i++) {
+			size = i % 100;
+			while ((slot = ck_ring_enqueue_reserve_spsc_bytes(ring,
+			    buffer, size)) == NULL)
+				sched_yield();
+
+			for (j = 0; j < size; j++)
+				slot[j] = (unsigned char)(i + j);
+
+			ck_ring_enqueue_commit_spsc_bytes(ring);
+		}
+
+		_exit(0);
+	}
+
+	for (i = 0; i < N_MESSAGES; i++) {
+		while ((message = ck_ring_dequeue_reserve_spsc_bytes(ring,
+		    buffer, &size)) == NULL)
+			sched_yield();
+
+		if (size != i % 100)
+			ck_error("message %u has %u bytes\n", i, size);
+
+		for (j = 0; j < size; j++) {
+			if (message[j] != (unsigned char)(i + j))
+				ck_error("message %u corrupted\n", i);
+		}
+
+		ck_ring_dequeue_commit_spsc_bytes(ring, buffer);
+		if (ck_ring_shm_valid(shm) == false)
+			ck_error("ring invalid after message %u\n", i);
+	}
+
+	reap(pid, 0);
+	munmap(shm, length);
+	return;
+}
+
+int
+main(void)
+{
+
+	test_init();
+	test_init_recover();
+	test_owner();
+	test_transfer();
+	test_bytes();
+	return 0;
+}
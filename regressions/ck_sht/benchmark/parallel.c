@@ -0,0 +1,193 @@
+/*
+ * Copyright 2012 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyrights
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyrights
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures write throughput of a sharded table at 1 to N writers, against
+ * a table of a single shard with all writers serialized on its lock.
+ * Every writer inserts and removes its own range of keys.
+ */
+
+#include <ck_sht.h>
+
+#include <assert.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../common.h"
+
+static ck_sht_t sht CK_CC_CACHELINE;
+static unsigned int n_writers;
+static unsigned int n_shards;
+static unsigned int barrier;
+static unsigned long n_keys;
+static unsigned int n_rounds;
+static struct affinity affinerator = AFFINITY_INITIALIZER;
+
+static void *
+ht_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+ht_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+	(void)r;
+	free(p);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = ht_malloc,
+	.free = ht_free
+};
+
+static void *
+writer(void *arg)
+{
+	uintptr_t base = (uintptr_t)arg * n_keys + 1;
+	ck_ht_entry_t entry;
+	ck_ht_hash_t h;
+	unsigned long i;
+	unsigned int j;
+
+	if (aff_iterate(&affinerator) != 0)
+		perror("WARNING: Failed to affine thread");
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) != n_writers)
+		ck_pr_stall();
+
+	for (j = 0; j < n_rounds; j++) {
+		for (i = 0; i < n_keys; i++) {
+			ck_sht_hash_direct(&h, &sht, base + i);
+			ck_ht_entry_set_direct(&entry, h, base + i, base + i);
+			ck_sht_put(&sht, h, &entry);
+		}
+
+		for (i = 0; i < n_keys; i++) {
+			ck_sht_hash_direct(&h, &sht, base + i);
+			ck_ht_entry_key_set_direct(&entry, base + i);
+			ck_sht_remove(&sht, h, &entry);
+		}
+	}
+
+	return NULL;
+}
+
+static double
+run(unsigned int n, unsigned int shards)
+{
+	struct timeval start, end;
+	pthread_t *threads;
+	unsigned int i;
+	double elapsed;
+
+	threads = malloc(sizeof(pthread_t) * n);
+	assert(threads != NULL);
+
+	if (ck_sht_init(&sht, CK_HT_MODE_DIRECT, NULL, &my_allocator, NULL,
+	    shards, 1024, 6602834) == false) {
+		ck_error("ERROR: Failed to initialize hash table.\n");
+	}
+
+	n_writers = n;
+	barrier = 0;
+	affinerator.request = 0;
+
+	common_gettimeofday(&start, NULL);
+	for (i = 0; i < n; i++) {
+		if (pthread_create(&threads[i], NULL, writer,
+		    (void *)(uintptr_t)i) != 0)
+			ck_error("ERROR: Failed to create thread %u.\n", i);
+	}
+
+	for (i = 0; i < n; i++)
+		pthread_join(threads[i], NULL);
+	common_gettimeofday(&end, NULL);
+
+	ck_sht_destroy(&sht);
+	free(threads);
+
+	elapsed = (double)(end.tv_sec - start.tv_sec) +
+	    (double)(end.tv_usec - start.tv_usec) / 1000000.0;
+
+	/* Every round performs two write operations per key. */
+	return ((double)n * n_rounds * n_keys * 2) / elapsed;
+}
+
+int
+main(int argc, char *argv[])
+{
+	unsigned int maximum, n;
+	double a, b;
+
+	maximum = CORES;
+	n_shards = 0;
+	n_keys = 65536;
+	n_rounds = 16;
+
+	if (argc >= 2)
+		maximum = atoi(argv[1]);
+
+	if (argc >= 3)
+		n_shards = atoi(argv[2]);
+
+	if (argc >= 4)
+		n_keys = strtoul(argv[3], NULL, 10);
+
+	if (argc >= 5)
+		n_rounds = atoi(argv[4]);
+
+	if (maximum == 0 || n_keys == 0 || n_rounds == 0) {
+		ck_error("Usage: parallel [<maximum writers> <shards> "
+		    "<keys per writer> <rounds>]\n");
+	}
+
+	/* By default, use the smallest power of two of at least 4 shards per writer. */
+	if (n_shards == 0) {
+		for (n_shards = 1; n_shards < maximum * 4; n_shards <<= 1);
+	}
+
+	affinerator.delta = 1;
+	fprintf(stderr, "# writers, %u shards (ops/s), 1 shard (ops/s)\n",
+	    n_shards);
+	for (n = 1; n <= maximum; n++) {
+		a = run(n, n_shards);
+		b = run(n, 1);
+		printf("%u,%.0f,%.0f\n", n, a, b);
+	}
+
+	return 0;
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2012-2015 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_sht.h>
+
+#include <assert.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../common.h"
+#include "../../../src/ck_ht_hash.h"
+
+#define N_SHARDS	8
+#define N_WRITERS	4
+#define N_KEYS		4096
+
+static void *
+ht_malloc(size_t r)
+{
+
+	return malloc(r);
+}
+
+static void
+ht_free(void *p, size_t b, bool r)
+{
+
+	(void)b;
+	(void)r;
+	free(p);
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = ht_malloc,
+	.free = ht_free
+};
+
+static struct ck_malloc shard_allocator[N_SHARDS];
+
+static void
+ht_hash_wrapper(struct ck_ht_hash *h,
+	const void *key,
+	size_t length,
+	uint64_t seed)
+{
+
+	h->value = (unsigned long)MurmurHash64A(key, length, seed);
+	return;
+}
+
+const char *test[] = {"Samy", "Al", "Bahra", "dances", "in", "the", "wind.", "Once",
+			"upon", "a", "time", "his", "gypsy", "ate", "one", "itsy",
+			    "bitsy", "spider.", "What", "goes", "up", "must",
+				"come", "down.", "What", "is", "down", "stays",
+				    "down.", "A", "B", "C", "D", "E", "F", "G", "H",
+					"I", "J", "K", "L", "M", "N", "O"};
+
+#define TEST_N (sizeof(test) / sizeof(*test))
+
+static ck_sht_t sht;
+static unsigned int barrier;
+
+static void
+test_bytestring(unsigned int n_shards, struct ck_malloc **allocators)
+{
+	ck_sht_iterator_t iterator = CK_SHT_ITERATOR_INITIALIZER;
+	ck_ht_entry_t entry, *cursor;
+	struct ck_ht_stat st;
+	ck_ht_hash_t h;
+	size_t i, l, n;
+
+	if (ck_sht_init(&sht, CK_HT_MODE_BYTESTRING, ht_hash_wrapper,
+	    &my_allocator, allocators, n_shards, 2, 6602834) == false)
+		ck_error("ck_sht_init: %u shards\n", n_shards);
+
+	if (ck_sht_shards(&sht) != n_shards)
+		ck_error("ERROR: %u != %u shards\n", ck_sht_shards(&sht), n_shards);
+
+	for (i = 0; i < TEST_N; i++) {
+		l = strlen(test[i]);
+		ck_sht_hash(&h, &sht, test[i], l);
+		ck_ht_entry_set(&entry, h, test[i], l, test[i]);
+		ck_sht_put(&sht, h, &entry);
+	}
+
+	/* "What" and "down." are duplicates. */
+	if (ck_sht_count(&sht) != TEST_N - 2) {
+		ck_error("ERROR: Expected %zu entries, got %ju\n", TEST_N - 2,
+		    (uintmax_t)ck_sht_count(&sht));
+	}
+
+	ck_sht_stat(&sht, &st);
+	if (st.n_entries != ck_sht_count(&sht))
+		ck_error("ERROR: stat and count disagree\n");
+
+	for (i = 0; i < TEST_N; i++) {
+		l = strlen(test[i]);
+		ck_sht_hash(&h, &sht, test[i], l);
+		ck_ht_entry_key_set(&entry, test[i], l);
+		if (ck_sht_get(&sht, h, &entry) == false)
+			ck_error("ERROR: Failed to find [%s]\n", test[i]);
+
+		if (strcmp(ck_ht_entry_value(&entry), test[i]) != 0)
+			ck_error("ERROR: Mismatch for [%s]\n", test[i]);
+	}
+
+	n = 0;
+	while (ck_sht_next(&sht, &iterator, &cursor) == true)
+		n++;
+
+	if (n != ck_sht_count(&sht))
+		ck_error("ERROR: Iterated %zu entries, expected %ju\n", n,
+		    (uintmax_t)ck_sht_count(&sht));
+
+	/* A finished iterator stays finished. */
+	if (ck_sht_next(&sht, &iterator, &cursor) == true)
+		ck_error("ERROR: Iterator did not terminate\n");
+
+	for (i = 0; i < TEST_N; i++) {
+		l = strlen(test[i]);
+		ck_sht_hash(&h, &sht, test[i], l);
+		ck_ht_entry_set(&entry, h, test[i], l, "REPLACED");
+		if (ck_sht_set(&sht, h, &entry) == false)
+			ck_error("ERROR: Failed to set [%s]\n", test[i]);
+	}
+
+	for (i = 0; i < TEST_N; i += 2) {
+		l = strlen(test[i]);
+		ck_sht_hash(&h, &sht, test[i], l);
+		ck_ht_entry_key_set(&entry, test[i], l);
+		ck_sht_remove(&sht, h, &entry);
+		if (ck_sht_get(&sht, h, &entry) == true)
+			ck_error("ERROR: Found removed [%s]\n", test[i]);
+	}
+
+	for (i = 1; i < TEST_N; i += 2) {
+		l = strlen(test[i]);
+		ck_sht_hash(&h, &sht, test[i], l);
+		ck_ht_entry_key_set(&entry, test[i], l);
+		if (ck_sht_get(&sht, h, &entry) == false &&
+		    strcmp(test[i], "What") != 0 && strcmp(test[i], "down.") != 0)
+			ck_error("ERROR: Failed to find [%s]\n", test[i]);
+	}
+
+	if (ck_sht_gc(&sht, 0, 0) == false)
+		ck_error("ERROR: Failed to compact shards\n");
+
+	if (ck_sht_reset(&sht) == false)
+		ck_error("ERROR: Failed to reset shards\n");
+
+	if (ck_sht_count(&sht) != 0)
+		ck_error("ERROR: Shards not empty after reset\n");
+
+	ck_sht_iterator_init(&iterator);
+	if (ck_sht_next(&sht, &iterator, &cursor) == true)
+		ck_error("ERROR: Iterated over empty table\n");
+
+	ck_sht_destroy(&sht);
+	return;
+}
+
+static void *
+writer(void *arg)
+{
+	uintptr_t base = (uintptr_t)arg * N_KEYS + 1;
+	ck_ht_entry_t entry;
+	ck_ht_hash_t h;
+	uintptr_t i;
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) != N_WRITERS)
+		ck_pr_stall();
+
+	for (i = base; i < base + N_KEYS; i++) {
+		ck_sht_hash_direct(&h, &sht, i);
+		ck_ht_entry_set_direct(&entry, h, i, i);
+		if (ck_sht_put(&sht, h, &entry) == false)
+			ck_error("ERROR: Failed to put %ju\n", (uintmax_t)i);
+	}
+
+	for (i = base; i < base + N_KEYS; i += 2) {
+		ck_sht_hash_direct(&h, &sht, i);
+		ck_ht_entry_key_set_direct(&entry, i);
+		if (ck_sht_remove(&sht, h, &entry) == false)
+			ck_error("ERROR: Failed to remove %ju\n", (uintmax_t)i);
+	}
+
+	return NULL;
+}
+
+static void
+test_writers(void)
+{
+	pthread_t threads[N_WRITERS];
+	ck_sht_iterator_t iterator = CK_SHT_ITERATOR_INITIALIZER;
+	ck_ht_entry_t entry, *cursor;
+	ck_ht_hash_t h;
+	uintptr_t i, k;
+	size_t n;
+
+	if (ck_sht_init(&sht, CK_HT_MODE_DIRECT, NULL, &my_allocator, NULL,
+	    N_SHARDS, 64, 6602834) == false)
+		ck_error("ck_sht_init: direct\n");
+
+	for (i = 0; i < N_WRITERS; i++) {
+		if (pthread_create(&threads[i], NULL, writer, (void *)i) != 0)
+			ck_error("ERROR: Failed to create thread\n");
+	}
+
+	for (i = 0; i < N_WRITERS; i++)
+		pthread_join(threads[i], NULL);
+
+	if (ck_sht_count(&sht) != N_WRITERS * N_KEYS / 2)
+		ck_error("ERROR: %ju entries after concurrent writes\n",
+		    (uintmax_t)ck_sht_count(&sht));
+
+	for (i = 1; i <= N_WRITERS * N_KEYS; i++) {
+		ck_sht_hash_direct(&h, &sht, i);
+		ck_ht_entry_key_set_direct(&entry, i);
+		if (ck_sht_get(&sht, h, &entry) != ((i - 1) & 1))
+			ck_error("ERROR: Unexpected state for %ju\n", (uintmax_t)i);
+	}
+
+	n = 0;
+	while (ck_sht_next(&sht, &iterator, &cursor) == true) {
+		k = ck_ht_entry_key_direct(cursor);
+		if (((k - 1) & 1) == 0 || ck_ht_entry_value_direct(cursor) != k)
+			ck_error("ERROR: Unexpected entry %ju\n", (uintmax_t)k);
+
+		n++;
+	}
+
+	if (n != N_WRITERS * N_KEYS / 2)
+		ck_error("ERROR: Iterated %zu entries\n", n);
+
+	ck_sht_destroy(&sht);
+	return;
+}
+
+int
+main(void)
+{
+	struct ck_malloc *allocators[N_SHARDS];
+	unsigned int i;
+
+	if (ck_sht_init(&sht, CK_HT_MODE_BYTESTRING, ht_hash_wrapper,
+	    &my_allocator, NULL, 3, 2, 6602834) == true)
+		ck_error("ERROR: Accepted non-power-of-two shard count\n");
+
+	if (ck_sht_init(&sht, CK_HT_MODE_BYTESTRING, ht_hash_wrapper,
+	    &my_allocator, NULL, 0, 2, 6602834) == true)
+		ck_error("ERROR: Accepted zero shards\n");
+
+	for (i = 0; i < N_SHARDS; i++) {
+		shard_allocator[i] = my_allocator;
+		allocators[i] = &shard_allocator[i];
+	}
+
+	for (i = 1; i <= N_SHARDS; i <<= 1)
+		test_bytestring(i, NULL);
+
+	test_bytestring(N_SHARDS, allocators);
+	test_writers();
+	return 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_sl.h>
+
+#include <assert.h>
+#include <ck_epoch.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../common.h"
+
+#define N_WRITERS	4
+#define N_READERS	2
+#define N_KEYS		2048
+#define N_ROUNDS	64
+
+/*
+ * Keys that are multiples of STRIDE are inserted before the test starts
+ * and never removed, so readers must always observe them.
+ */
+#define STRIDE		(N_WRITERS + 1)
+
+struct sl_epoch {
+	ck_epoch_entry_t epoch_entry;
+	size_t size;
+};
+
+static ck_sl_t sl;
+static ck_epoch_t epoch_sl;
+static ck_epoch_record_t epoch_wr;
+static ck_epoch_record_t records[N_WRITERS + N_READERS];
+static unsigned int barrier;
+static unsigned int done;
+
+static void
+sl_destroy(ck_epoch_entry_t *e)
+{
+	struct sl_epoch *h = (struct sl_epoch *)e;
+
+	/* Poison the node so that premature reclamation is detected. */
+	memset(h + 1, 0, h->size);
+	free(h);
+	return;
+}
+
+static void *
+sl_malloc(size_t r)
+{
+	struct sl_epoch *h;
+
+	h = malloc(sizeof(*h) + r);
+	if (h == NULL)
+		return NULL;
+
+	h->size = r;
+	return h + 1;
+}
+
+static void
+sl_free(void *p, size_t b, bool r)
+{
+	struct sl_epoch *h = p;
+
+	(void)b;
+
+	if (r == true) {
+		/* Writers share a record, so deferral must be thread-safe. */
+		ck_epoch_call_strict(&epoch_wr, &(--h)->epoch_entry, sl_destroy);
+	} else {
+		free(--h);
+	}
+
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = sl_malloc,
+	.free = sl_free
+};
+
+static int
+sl_compare(const void *a, const void *b)
+{
+	uintptr_t x = (uintptr_t)a;
+	uintptr_t y = (uintptr_t)b;
+
+	return (x > y) - (x < y);
+}
+
+#define KEY(k) ((void *)(uintptr_t)(k))
+
+static void
+scan(void)
+{
+	ck_sl_iterator_t iterator = CK_SL_ITERATOR_INITIALIZER;
+	uintptr_t previous = 0, k;
+	size_t stable = 0;
+	void *object;
+
+	while (ck_sl_next(&sl, &iterator, &object) == true) {
+		k = (uintptr_t)object;
+		if (k <= previous || k > N_KEYS)
+			ck_error("ERROR: Iterated %lu after %lu\n",
+			    (unsigned long)k, (unsigned long)previous);
+
+		stable += k % STRIDE == 0;
+		previous = k;
+	}
+
+	if (stable != N_KEYS / STRIDE)
+		ck_error("ERROR: Iterated %zu stable keys, expected %d\n",
+		    stable, N_KEYS / STRIDE);
+
+	return;
+}
+
+static void *
+writer(void *arg)
+{
+	uintptr_t id = (uintptr_t)arg;
+	ck_epoch_record_t *record = &records[id - 1];
+	ck_sl_iterator_t iterator;
+	unsigned int round;
+	uintptr_t k;
+	void *object;
+
+	ck_epoch_register(&epoch_sl, record, NULL);
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) != N_WRITERS + N_READERS)
+		ck_pr_stall();
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		ck_epoch_begin(record, NULL);
+
+		/* Every writer owns the keys congruent to its identifier. */
+		for (k = id; k <= N_KEYS; k += STRIDE) {
+			if (ck_sl_put(&sl, KEY(k)) == false)
+				ck_error("ERROR: Failed to insert %lu\n", (unsigned long)k);
+		}
+
+		for (k = id; k <= N_KEYS; k += STRIDE) {
+			if (ck_sl_get(&sl, KEY(k)) != KEY(k))
+				ck_error("ERROR: Failed to find %lu\n", (unsigned long)k);
+		}
+
+		ck_sl_seek(&sl, &iterator, KEY(id));
+		if (ck_sl_next(&sl, &iterator, &object) == false || object != KEY(id))
+			ck_error("ERROR: Seek to %lu\n", (unsigned long)id);
+
+		for (k = id; k <= N_KEYS; k += STRIDE) {
+			if (ck_sl_remove(&sl, KEY(k)) != KEY(k))
+				ck_error("ERROR: Failed to remove %lu\n", (unsigned long)k);
+		}
+
+		scan();
+		ck_epoch_end(record, NULL);
+	}
+
+	ck_pr_inc_uint(&done);
+	return NULL;
+}
+
+static void *
+reader(void *arg)
+{
+	ck_epoch_record_t *record = arg;
+	uintptr_t k;
+
+	ck_epoch_register(&epoch_sl, record, NULL);
+
+	ck_pr_inc_uint(&barrier);
+	while (ck_pr_load_uint(&barrier) != N_WRITERS + N_READERS)
+		ck_pr_stall();
+
+	while (ck_pr_load_uint(&done) != N_WRITERS) {
+		ck_epoch_begin(record, NULL);
+		scan();
+
+		for (k = STRIDE; k <= N_KEYS; k += STRIDE) {
+			if (ck_sl_get(&sl, KEY(k)) != KEY(k))
+				ck_error("ERROR: Failed to find stable %lu\n", (unsigned long)k);
+		}
+
+		ck_epoch_end(record, NULL);
+	}
+
+	return NULL;
+}
+
+int
+main(void)
+{
+	pthread_t threads[N_WRITERS + N_READERS];
+	uintptr_t i, k;
+
+	ck_epoch_init(&epoch_sl);
+	ck_epoch_register(&epoch_sl, &epoch_wr, NULL);
+
+	if (ck_sl_init(&sl, sl_compare, &my_allocator, 6602834) == false)
+		ck_error("ck_sl_init\n");
+
+	for (k = STRIDE; k <= N_KEYS; k += STRIDE)
+		ck_sl_put(&sl, KEY(k));
+
+	for (i = 0; i < N_WRITERS; i++) {
+		if (pthread_create(&threads[i], NULL, writer, KEY(i + 1)) != 0)
+			ck_error("ERROR: Failed to create writer %lu\n", (unsigned long)i);
+	}
+
+	for (i = 0; i < N_READERS; i++) {
+		if (pthread_create(&threads[N_WRITERS + i], NULL, reader,
+		    &records[N_WRITERS + i]) != 0)
+			ck_error("ERROR: Failed to create reader %lu\n", (unsigned long)i);
+	}
+
+	/* Reclaim concurrently with the workload. */
+	while (ck_pr_load_uint(&done) != N_WRITERS)
+		ck_epoch_poll(&epoch_wr);
+
+	for (i = 0; i < N_WRITERS + N_READERS; i++)
+		pthread_join(threads[i], NULL);
+
+	if (ck_sl_count(&sl) != N_KEYS / STRIDE)
+		ck_error("ERROR: Expected %d entries, got %lu\n",
+		    N_KEYS / STRIDE, ck_sl_count(&sl));
+
+	ck_epoch_barrier(&epoch_wr);
+	ck_sl_deinit(&sl);
+	return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_sl.h>
+
+#include <assert.h>
+#include <ck_malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../common.h"
+
+#define N_KEYS	100000
+
+struct sl_header {
+	struct sl_header *next;
+	size_t size;
+};
+
+static struct sl_header *deferred;
+static size_t allocated;
+
+static void *
+sl_malloc(size_t r)
+{
+	struct sl_header *h;
+
+	h = malloc(sizeof(*h) + r);
+	if (h == NULL)
+		return NULL;
+
+	h->size = r;
+	allocated += r;
+	return h + 1;
+}
+
+static void
+sl_free(void *p, size_t b, bool r)
+{
+	struct sl_header *h = p;
+
+	h--;
+	if (h->size != b)
+		ck_error("ERROR: Freed %zu bytes, allocated %zu\n", b, h->size);
+
+	allocated -= b;
+
+	/* Retired nodes are released once the test is quiescent. */
+	if (r == true) {
+		h->next = deferred;
+		deferred = h;
+	} else {
+		free(h);
+	}
+
+	return;
+}
+
+static struct ck_malloc my_allocator = {
+	.malloc = sl_malloc,
+	.free = sl_free
+};
+
+static void
+sl_reclaim(void)
+{
+	struct sl_header *h;
+
+	while (deferred != NULL) {
+		h = deferred;
+		deferred = h->next;
+		free(h);
+	}
+
+	return;
+}
+
+static int
+sl_compare(const void *a, const void *b)
+{
+	uintptr_t x = (uintptr_t)a;
+	uintptr_t y = (uintptr_t)b;
+
+	return (x > y) - (x < y);
+}
+
+#define KEY(k) ((void *)(uintptr_t)(k))
+
+int
+main(void)
+{
+	ck_sl_iterator_t iterator = CK_SL_ITERATOR_INITIALIZER;
+	static uintptr_t keys[N_KEYS];
+	uintptr_t previous;
+	ck_sl_t sl;
+	size_t i, j, n;
+	void *object;
+
+	if (ck_sl_init(&sl, sl_compare, &my_allocator, 6602834) == false)
+		ck_error("ck_sl_init\n");
+
+	/* Insert odd keys in a random order. */
+	for (i = 0; i < N_KEYS; i++)
+		keys[i] = i * 2 + 1;
+
+	for (i = N_KEYS - 1; i > 0; i--) {
+		j = common_lrand48() % (i + 1);
+		previous = keys[i];
+		keys[i] = keys[j];
+		keys[j] = previous;
+	}
+
+	if (ck_sl_next(&sl, &iterator, &object) == true)
+		ck_error("ERROR: Iterated over empty list\n");
+
+	for (i = 0; i < N_KEYS; i++) {
+		if (ck_sl_put(&sl, KEY(keys[i])) == false)
+			ck_error("ERROR: Failed to insert %lu\n", (unsigned long)keys[i]);
+	}
+
+	if (ck_sl_count(&sl) != N_KEYS)
+		ck_error("ERROR: Expected %d entries, got %lu\n", N_KEYS, ck_sl_count(&sl));
+
+	for (i = 0; i < N_KEYS; i += 7) {
+		if (ck_sl_put(&sl, KEY(keys[i])) == true)
+			ck_error("ERROR: Inserted duplicate %lu\n", (unsigned long)keys[i]);
+	}
+
+	for (i = 0; i < N_KEYS; i++) {
+		if (ck_sl_get(&sl, KEY(i * 2 + 1)) != KEY(i * 2 + 1))
+			ck_error("ERROR: Failed to find %zu\n", i * 2 + 1);
+
+		if (ck_sl_get(&sl, KEY(i * 2 + 2)) != NULL)
+			ck_error("ERROR: Found absent %zu\n", i * 2 + 2);
+	}
+
+	/* Iteration is ordered. */
+	ck_sl_iterator_init(&iterator);
+	for (n = 0; ck_sl_next(&sl, &iterator, &object) == true; n++) {
+		if ((uintptr_t)object != n * 2 + 1)
+			ck_error("ERROR: Iterated %lu, expected %zu\n",
+			    (unsigned long)(uintptr_t)object, n * 2 + 1);
+	}
+
+	if (n != N_KEYS)
+		ck_error("ERROR: Iterated %zu entries\n", n);
+
+	/* A finished iterator stays finished. */
+	if (ck_sl_next(&sl, &iterator, &object) == true)
+		ck_error("ERROR: Iterator did not terminate\n");
+
+	/* Range iteration starts at the first object not less than the key. */
+	ck_sl_seek(&sl, &iterator, KEY(1000));
+	if (ck_sl_next(&sl, &iterator, &object) == false || object != KEY(1001))
+		ck_error("ERROR: Seek to absent key\n");
+
+	ck_sl_seek(&sl, &iterator, KEY(1001));
+	if (ck_sl_next(&sl, &iterator, &object) == false || object != KEY(1001))
+		ck_error("ERROR: Seek to present key\n");
+
+	ck_sl_seek(&sl, &iterator, KEY(0));
+	if (ck_sl_next(&sl, &iterator, &object) == false || object != KEY(1))
+		ck_error("ERROR: Seek to head\n");
+
+	ck_sl_seek(&sl, &iterator, KEY(N_KEYS * 2));
+	if (ck_sl_next(&sl, &iterator, &object) == true)
+		ck_error("ERROR: Seek past tail\n");
+
+	/* Remove every key equal to 1 modulo 4. */
+	for (i = 0; i < N_KEYS; i += 2) {
+		if (ck_sl_remove(&sl, KEY(i * 2 + 1)) != KEY(i * 2 + 1))
+			ck_error("ERROR: Failed to remove %zu\n", i * 2 + 1);
+
+		if (ck_sl_remove(&sl, KEY(i * 2 + 1)) != NULL)
+			ck_error("ERROR: Removed %zu twice\n", i * 2 + 1);
+	}
+
+	if (ck_sl_count(&sl) != N_KEYS / 2)
+		ck_error("ERROR: Expected %d entries, got %lu\n", N_KEYS / 2, ck_sl_count(&sl));
+
+	ck_sl_iterator_init(&iterator);
+	for (n = 0; ck_sl_next(&sl, &iterator, &object) == true; n++) {
+		if ((uintptr_t)object != n * 4 + 3)
+			ck_error("ERROR: Iterated %lu, expected %zu\n",
+			    (unsigned long)(uintptr_t)object, n * 4 + 3);
+	}
+
+	if (n != N_KEYS / 2)
+		ck_error("ERROR: Iterated %zu entries\n", n);
+
+	for (i = 0; i < N_KEYS; i++) {
+		if ((ck_sl_get(&sl, KEY(i * 2 + 1)) != NULL) != (i & 1))
+			ck_error("ERROR: Look-up of %zu after removal\n", i * 2 + 1);
+	}
+
+	/* Removed keys may be inserted again. */
+	for (i = 0; i < N_KEYS; i += 2) {
+		if (ck_sl_put(&sl, KEY(i * 2 + 1)) == false)
+			ck_error("ERROR: Failed to reinsert %zu\n", i * 2 + 1);
+	}
+
+	if (ck_sl_count(&sl) != N_KEYS)
+		ck_error("ERROR: Expected %d entries, got %lu\n", N_KEYS, ck_sl_count(&sl));
+
+	ck_sl_deinit(&sl);
+	sl_reclaim();
+
+	if (allocated != 0)
+		ck_error("ERROR: Leaked %zu bytes\n", allocated);
+
+	return 0;
+}
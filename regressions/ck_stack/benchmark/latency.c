@@ -47,6 +47,11 @@
 
 static ck_stack_t stack CK_CC_CACHELINE;
 
+#ifdef CK_F_STACK_ELIMINATION
+static ck_stack_elimination_t elimination;
+static ck_stack_elimination_slot_t slots[8];
+#endif
+
 int
 main(void)
 {
@@ -172,5 +177,47 @@ main(void)
 	r++;
 #endif
 
+#ifdef CK_F_STACK_ELIMINATION
+	{
+		unsigned int seed = 1;
+
+		ck_stack_elimination_init(&elimination, slots, 8,
+		    CK_STACK_ELIMINATION_SPIN);
+
+		a = 0;
+		for (i = 0; i < STEPS; i++) {
+			ck_stack_init(&stack);
+
+			s = rdtsc();
+			for (j = 0; j < ENTRIES; j++) {
+				ck_stack_elimination_push(&stack, &elimination,
+				    entry + j, &seed);
+			}
+			e = rdtsc();
+
+			a += e - s;
+		}
+		printf("  elimination_push: %16" PRIu64 "\n", a / STEPS / ENTRIES);
+
+		a = 0;
+		for (i = 0; i < STEPS; i++) {
+			ck_stack_init(&stack);
+
+			for (j = 0; j < ENTRIES; j++)
+				ck_stack_push_mpmc(&stack, entry + j);
+
+			s = rdtsc();
+			for (j = 0; j < ENTRIES; j++) {
+				r = ck_stack_elimination_pop(&stack,
+				    &elimination, &seed);
+			}
+			e = rdtsc();
+			a += e - s;
+		}
+		printf("   elimination_pop: %16" PRIu64 "\n", a / STEPS / ENTRIES);
+		r++;
+	}
+#endif
+
 	return 0;
 }
@@ -74,6 +74,13 @@ pthread_mutex_t stack_spinlock = PTHREAD_MUTEX_INITIALIZER;
 #else
 static ck_stack_t stack CK_CC_CACHELINE;
 CK_STACK_CONTAINER(struct entry, next, getvalue)
+#if defined(ELIMINATION) && defined(CK_F_STACK_ELIMINATION)
+#ifndef SLOTS
+#define SLOTS 8
+#endif
+static ck_stack_elimination_t elimination;
+static ck_stack_elimination_slot_t slots[SLOTS];
+#endif
 #endif
 
 static struct affinity affinerator;
@@ -84,8 +91,11 @@ static unsigned int critical;
 static void *
 stack_thread(void *buffer)
 {
-#if (defined(MPMC) && defined(CK_F_STACK_POP_MPMC)) || (defined(UPMC) && defined(CK_F_STACK_POP_UPMC)) || (defined(TRYUPMC) && defined(CK_F_STACK_TRYPOP_UPMC)) || (defined(TRYMPMC) && defined(CK_F_STACK_TRYPOP_MPMC))
+#if (defined(MPMC) && defined(CK_F_STACK_POP_MPMC)) || (defined(UPMC) && defined(CK_F_STACK_POP_UPMC)) || (defined(TRYUPMC) && defined(CK_F_STACK_TRYPOP_UPMC)) || (defined(TRYMPMC) && defined(CK_F_STACK_TRYPOP_MPMC)) || (defined(ELIMINATION) && defined(CK_F_STACK_ELIMINATION))
 	ck_stack_entry_t *ref;
+#endif
+#if defined(ELIMINATION) && defined(CK_F_STACK_ELIMINATION)
+	unsigned int state = (unsigned int)(uintptr_t)buffer | 1;
 #endif
 	struct entry *entry = buffer;
 	unsigned long long i, n = ITEMS;
@@ -102,6 +112,11 @@ stack_thread(void *buffer)
 	for (i = 0; i < n; i++) {
 #if defined(MPMC)
                 ck_stack_push_mpmc(&stack, &entry->next);
+#elif defined(ELIMINATION)
+#ifdef CK_F_STACK_ELIMINATION
+		ck_stack_elimination_push(&stack, &elimination, &entry->next,
+		    &state);
+#endif
 #elif defined(TRYMPMC)
 		while (ck_stack_trypush_mpmc(&stack, &entry->next) == false)
 			ck_pr_stall();
@@ -130,6 +145,14 @@ stack_thread(void *buffer)
 		ref = ck_stack_pop_mpmc(&stack);
 		entry = getvalue(ref);
 #endif
+#elif defined(ELIMINATION)
+#ifdef CK_F_STACK_ELIMINATION
+		ref = ck_stack_elimination_pop(&stack, &elimination, &state);
+		if (ref == NULL)
+			ck_error("ERROR: stack should never be empty\n");
+
+		entry = getvalue(ref);
+#endif
 #elif defined(TRYMPMC)
 #ifdef CK_F_STACK_TRYPOP_MPMC
 		while (ck_stack_trypop_mpmc(&stack, &ref) == false)
@@ -177,6 +200,16 @@ main(int argc, char *argv[])
         return 0;
 #endif
 
+#ifdef ELIMINATION
+#ifdef CK_F_STACK_ELIMINATION
+	ck_stack_elimination_init(&elimination, slots, SLOTS,
+	    CK_STACK_ELIMINATION_SPIN);
+#else
+	fprintf(stderr, "Unsupported.\n");
+	return 0;
+#endif
+#endif
+
 	if (argc != 4) {
 		ck_error("Usage: stack <threads> <delta> <critical>\n");
 	}
@@ -161,12 +161,58 @@ batch_generation(ck_stack_t *stack, ck_stack_entry_t *(*batch)(ck_stack_t *))
 }
 #endif
 
+#ifdef CK_F_STACK_ELIMINATION
+static ck_stack_elimination_t elimination;
+static ck_stack_elimination_slot_t slots[1];
+static unsigned int seed = 1;
+static ck_stack_entry_t *(*volatile elimination_pop)(ck_stack_t *,
+    ck_stack_elimination_t *, unsigned int *) = ck_stack_elimination_pop;
+
+#define ELIMINATION_PUSH(s, e)	\
+	ck_stack_elimination_push(s, &elimination, e, &seed)
+#define ELIMINATION_POP(s)	\
+	ck_stack_elimination_pop(s, &elimination, &seed)
+
+static void
+serial_elimination(ck_stack_t *stack)
+{
+	struct entry *entries;
+	ck_stack_entry_t *entry;
+	struct entry a;
+	int i;
+
+	ck_stack_init(stack);
+	ck_stack_elimination_init(&elimination, slots, 1,
+	    CK_STACK_ELIMINATION_SPIN);
+
+	entries = malloc(sizeof(struct entry) * SIZE);
+	assert(entries != NULL);
+
+	/* Without contention, every operation goes through the stack. */
+	LOOP(ELIMINATION_PUSH, ELIMINATION_POP);
+	assert(slots[0].entry == NULL);
+	assert(elimination_pop(stack, &elimination, &seed) == NULL);
+
+	/* A pop from an empty stack takes an offered entry. */
+	ck_pr_store_ptr(&slots[0].entry, &a.next);
+	assert(elimination_pop(stack, &elimination, &seed) == &a.next);
+	assert(slots[0].entry == NULL);
+	assert(elimination_pop(stack, &elimination, &seed) == NULL);
+
+	free(entries);
+	return;
+}
+#endif
+
 int
 main(void)
 {
 	ck_stack_t stack CK_CC_CACHELINE;
 
 	serial(&stack);
+#ifdef CK_F_STACK_ELIMINATION
+	serial_elimination(&stack);
+#endif
 	batch_advance(&stack, batch_pop);
 	batch_advance(&stack, batch_pop_wf);
 #ifdef CK_F_STACK_POP_MPMC
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_cc.h>
+#include <ck_deque.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+#include <ck_stdint.h>
+
+#include "ck_internal.h"
+
+/* The array must fit in the unsigned counters of the deque. */
+#define CK_DEQUE_SIZE_MAX (1U << 31)
+
+static size_t
+ck_deque_array_size(unsigned int capacity)
+{
+
+	return sizeof(struct ck_deque_array) + sizeof(void *) * capacity;
+}
+
+static struct ck_deque_array *
+ck_deque_array_create(struct ck_malloc *m, unsigned int capacity)
+{
+	struct ck_deque_array *array;
+
+	array = m->malloc(ck_deque_array_size(capacity));
+	if (array == NULL)
+		return NULL;
+
+	array->mask = capacity - 1;
+	return array;
+}
+
+bool
+ck_deque_init(struct ck_deque *deque,
+    struct ck_malloc *m,
+    unsigned int capacity)
+{
+
+	if (m == NULL || m->malloc == NULL || m->free == NULL)
+		return false;
+
+	if (capacity == 0 || capacity > CK_DEQUE_SIZE_MAX)
+		return false;
+
+	capacity = ck_internal_power_2(capacity);
+	deque->array = ck_deque_array_create(m, capacity);
+	if (deque->array == NULL)
+		return false;
+
+	deque->m = m;
+	deque->top = deque->bottom = 0;
+	return true;
+}
+
+void
+ck_deque_deinit(struct ck_deque *deque)
+{
+	struct ck_deque_array *array = deque->array;
+
+	deque->m->free(array, ck_deque_array_size(array->mask + 1), false);
+	deque->array = NULL;
+	return;
+}
+
+/*
+ * Doubles the capacity of the deque. Only the owner may grow the deque,
+ * while thieves may keep stealing from the array being replaced: its
+ * slots are never written to again.
+ */
+bool
+ck_deque_grow(struct ck_deque *deque)
+{
+	struct ck_deque_array *array, *update;
+	unsigned int capacity, top, bottom, i;
+
+	array = deque->array;
+	capacity = array->mask + 1;
+	if (capacity >= CK_DEQUE_SIZE_MAX)
+		return false;
+
+	update = ck_deque_array_create(deque->m, capacity << 1);
+	if (update == NULL)
+		return false;
+
+	/*
+	 * Thieves may only advance the top counter, so entries below it
+	 * need not be copied.
+	 */
+	top = ck_pr_load_uint(&deque->top);
+	bottom = deque->bottom;
+	for (i = top; i != bottom; i++)
+		update->slots[i & update->mask] = array->slots[i & array->mask];
+
+	/* The copy must be visible before the new array is published. */
+	ck_pr_fence_store();
+	ck_pr_store_ptr(&deque->array, update);
+	deque->m->free(array, ck_deque_array_size(capacity), true);
+	return true;
+}
@@ -137,7 +137,8 @@
 
 enum {
 	CK_EPOCH_STATE_USED = 0,
-	CK_EPOCH_STATE_FREE = 1
+	CK_EPOCH_STATE_FREE = 1,
+	CK_EPOCH_STATE_CPU = 2
 };
 
 CK_STACK_CONTAINER(struct ck_epoch_record, record_next,
@@ -147,6 +148,57 @@ CK_STACK_CONTAINER(struct ck_epoch_entry, stack_entry,
 
 #define CK_EPOCH_SENSE_MASK	(CK_EPOCH_SENSE - 1)
 
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+static unsigned int
+ck_epoch_stat_now(const struct ck_epoch *global)
+{
+
+	if (global->clock == NULL)
+		return 0;
+
+	return global->clock();
+}
+
+static void
+ck_epoch_stat_synchronize(struct ck_epoch *global, unsigned int start)
+{
+	unsigned int latency = ck_epoch_stat_now(global) - start;
+	unsigned int i = 0;
+
+	while ((latency >>= 1) != 0 && i < CK_EPOCH_STAT_BUCKETS - 1)
+		i++;
+
+	ck_pr_inc_uint(&global->synchronize[i]);
+	ck_pr_inc_uint(&global->n_synchronize);
+	return;
+}
+
+static void
+ck_epoch_stat_advance(struct ck_epoch *global, bool r)
+{
+
+	if (r == true)
+		ck_pr_inc_uint(&global->n_advance);
+
+	return;
+}
+
+static void
+ck_epoch_stat_poll(struct ck_epoch_record *record, unsigned int n)
+{
+
+	ck_pr_store_uint(&record->n_poll, record->n_poll + 1);
+	ck_pr_store_uint(&record->n_poll_dispatch,
+	    record->n_poll_dispatch + n);
+	return;
+}
+#else
+#define ck_epoch_stat_now(global)		0U
+#define ck_epoch_stat_synchronize(global, start)	((void)(start))
+#define ck_epoch_stat_advance(global, r)	((void)(r))
+#define ck_epoch_stat_poll(record, n)		((void)(n))
+#endif /* CK_MD_EPOCH_STAT_ENABLE */
+
 bool
 _ck_epoch_delref(struct ck_epoch_record *record,
     struct ck_epoch_section *section)
@@ -182,6 +234,40 @@ _ck_epoch_delref(struct ck_epoch_record *record,
 	return true;
 }
 
+#ifdef CK_MD_EPOCH_EC_ENABLE
+/*
+ * Returns true if the record may still hold references from an epoch
+ * older than the current global epoch.
+ */
+bool
+_ck_epoch_blocked(struct ck_epoch *global, struct ck_epoch_record *record)
+{
+	unsigned int epoch = ck_pr_load_uint(&global->epoch);
+	unsigned int state = ck_pr_load_uint(&record->state);
+
+	if (state == CK_EPOCH_STATE_FREE)
+		return false;
+
+	if (state == CK_EPOCH_STATE_CPU) {
+		return ck_pr_load_uint(&record->local.bucket[(epoch + 1) &
+		    CK_EPOCH_SENSE_MASK].count) != 0;
+	}
+
+	return ck_pr_load_uint(&record->active) != 0 &&
+	    ck_pr_load_uint(&record->epoch) != epoch;
+}
+
+void
+_ck_epoch_wake(struct ck_epoch *global)
+{
+
+	if (global->wake != NULL)
+		global->wake(global, global->wake_ct);
+
+	return;
+}
+#endif /* CK_MD_EPOCH_EC_ENABLE */
+
 void
 _ck_epoch_addref(struct ck_epoch_record *record,
     struct ck_epoch_section *section)
@@ -232,6 +318,17 @@ ck_epoch_init(struct ck_epoch *global)
 	ck_stack_init(&global->records);
 	global->epoch = 1;
 	global->n_free = 0;
+#ifdef CK_MD_EPOCH_EC_ENABLE
+	global->n_waiters = 0;
+	global->wake = NULL;
+	global->wake_ct = NULL;
+#endif
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+	global->clock = NULL;
+	global->n_advance = 0;
+	global->n_synchronize = 0;
+	memset(global->synchronize, 0, sizeof global->synchronize);
+#endif
 	ck_pr_fence_store();
 	return;
 }
@@ -270,14 +367,16 @@ ck_epoch_recycle(struct ck_epoch *global, void *ct)
 	return NULL;
 }
 
-void
-ck_epoch_register(struct ck_epoch *global, struct ck_epoch_record *record,
-    void *ct)
+static void
+ck_epoch_register_state(struct ck_epoch *global,
+    struct ck_epoch_record *record,
+    void *ct,
+    unsigned int state)
 {
 	size_t i;
 
 	record->global = global;
-	record->state = CK_EPOCH_STATE_USED;
+	record->state = state;
 	record->active = 0;
 	record->epoch = 0;
 	record->n_dispatch = 0;
@@ -285,6 +384,11 @@ ck_epoch_register(struct ck_epoch *global, struct ck_epoch_record *record,
 	record->n_pending = 0;
 	record->ct = ct;
 	memset(&record->local, 0, sizeof record->local);
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+	record->n_poll = 0;
+	record->n_poll_dispatch = 0;
+	record->section = 0;
+#endif
 
 	for (i = 0; i < CK_EPOCH_LENGTH; i++)
 		ck_stack_init(&record->pending[i]);
@@ -294,6 +398,24 @@ ck_epoch_register(struct ck_epoch *global, struct ck_epoch_record *record,
 	return;
 }
 
+void
+ck_epoch_register(struct ck_epoch *global, struct ck_epoch_record *record,
+    void *ct)
+{
+
+	ck_epoch_register_state(global, record, ct, CK_EPOCH_STATE_USED);
+	return;
+}
+
+void
+ck_epoch_register_cpu(struct ck_epoch *global, struct ck_epoch_record *record,
+    void *ct)
+{
+
+	ck_epoch_register_state(global, record, ct, CK_EPOCH_STATE_CPU);
+	return;
+}
+
 void
 ck_epoch_unregister(struct ck_epoch_record *record)
 {
@@ -306,6 +428,10 @@ ck_epoch_unregister(struct ck_epoch_record *record)
 	record->n_peak = 0;
 	record->n_pending = 0;
 	memset(&record->local, 0, sizeof record->local);
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+	record->n_poll = 0;
+	record->n_poll_dispatch = 0;
+#endif
 
 	for (i = 0; i < CK_EPOCH_LENGTH; i++)
 		ck_stack_init(&record->pending[i]);
@@ -344,6 +470,27 @@ ck_epoch_scan(struct ck_epoch *global,
 			continue;
 		}
 
+		/*
+		 * Readers of a per-CPU record are counted into the bucket
+		 * of the epoch they observed. The bucket of the previous
+		 * epoch also holds any reader of older epochs, which would
+		 * have prevented the epoch from advancing.
+		 */
+		if (state == CK_EPOCH_STATE_CPU) {
+			unsigned int current, previous;
+
+			current = ck_pr_load_uint(&cr->local.bucket[epoch &
+			    CK_EPOCH_SENSE_MASK].count);
+			previous = ck_pr_load_uint(&cr->local.bucket[(epoch +
+			    1) & CK_EPOCH_SENSE_MASK].count);
+			*af |= (current | previous) != 0;
+			if (previous != 0)
+				return cr;
+
+			cursor = CK_STACK_NEXT(cursor);
+			continue;
+		}
+
 		active = ck_pr_load_uint(&cr->active);
 		*af |= active;
 
@@ -369,14 +516,13 @@ ck_epoch_scan(struct ck_epoch *global,
 }
 
 static unsigned int
-ck_epoch_dispatch(struct ck_epoch_record *record, unsigned int e, ck_stack_t *deferred)
+ck_epoch_dispatch_list(struct ck_epoch_record *record, ck_stack_entry_t *head,
+    ck_stack_t *deferred)
 {
-	unsigned int epoch = e & (CK_EPOCH_LENGTH - 1);
-	ck_stack_entry_t *head, *next, *cursor;
+	ck_stack_entry_t *next, *cursor;
 	unsigned int n_pending, n_peak;
 	unsigned int i = 0;
 
-	head = ck_stack_batch_pop_upmc(&record->pending[epoch]);
 	for (cursor = head; cursor != NULL; cursor = next) {
 		struct ck_epoch_entry *entry =
 		    ck_epoch_entry_container(cursor);
@@ -399,12 +545,24 @@ ck_epoch_dispatch(struct ck_epoch_record *record, unsigned int e, ck_stack_t *de
 
 	if (i > 0) {
 		ck_pr_store_uint(&record->n_dispatch, record->n_dispatch + i);
-		ck_pr_store_uint(&record->n_pending, record->n_pending - i);
+
+		/* Callbacks may concurrently be handed off to the record. */
+		ck_pr_sub_uint(&record->n_pending, i);
 	}
 
 	return i;
 }
 
+static unsigned int
+ck_epoch_dispatch(struct ck_epoch_record *record, unsigned int e, ck_stack_t *deferred)
+{
+	unsigned int epoch = e & (CK_EPOCH_LENGTH - 1);
+	ck_stack_entry_t *head;
+
+	head = ck_stack_batch_pop_upmc(&record->pending[epoch]);
+	return ck_epoch_dispatch_list(record, head, deferred);
+}
+
 /*
  * Reclaim all objects associated with a record.
  */
@@ -440,6 +598,7 @@ ck_epoch_synchronize_wait(struct ck_epoch *global,
 	struct ck_epoch_record *cr;
 	unsigned int delta, epoch, goal, i;
 	bool active;
+	unsigned int start = ck_epoch_stat_now(global);
 
 	ck_pr_fence_memory();
 
@@ -519,6 +678,7 @@ ck_epoch_synchronize_wait(struct ck_epoch *global,
 
 		/* Order subsequent thread active checks. */
 		ck_pr_fence_atomic_load();
+		ck_epoch_stat_advance(global, r);
 
 		/*
 		 * If CAS has succeeded, then set delta to latest snapshot.
@@ -534,6 +694,7 @@ ck_epoch_synchronize_wait(struct ck_epoch *global,
 	 */
 leave:
 	ck_pr_fence_memory();
+	ck_epoch_stat_synchronize(global, start);
 	return;
 }
 
@@ -581,6 +742,7 @@ ck_epoch_poll_deferred(struct ck_epoch_record *record, ck_stack_t *deferred)
 	unsigned int epoch;
 	struct ck_epoch_record *cr = NULL;
 	struct ck_epoch *global = record->global;
+	unsigned int n = 0;
 
 	epoch = ck_pr_load_uint(&global->epoch);
 
@@ -609,6 +771,7 @@ ck_epoch_poll_deferred(struct ck_epoch_record *record, ck_stack_t *deferred)
 		 * to objects filed under slot epoch - 2, so nothing may
 		 * be dispatched.
 		 */
+		ck_epoch_stat_poll(record, 0);
 		return false;
 	}
 
@@ -617,8 +780,9 @@ ck_epoch_poll_deferred(struct ck_epoch_record *record, ck_stack_t *deferred)
 		ck_pr_store_uint(&record->epoch, epoch);
 
 		for (epoch = 0; epoch < CK_EPOCH_LENGTH; epoch++)
-			ck_epoch_dispatch(record, epoch, deferred);
+			n += ck_epoch_dispatch(record, epoch, deferred);
 
+		ck_epoch_stat_poll(record, n);
 		return true;
 	}
 
@@ -633,9 +797,11 @@ ck_epoch_poll_deferred(struct ck_epoch_record *record, ck_stack_t *deferred)
 	 * for that slot may therefore run now. We also attempt to
 	 * advance the epoch if it hasn't been already.
 	 */
-	(void)ck_pr_cas_uint(&global->epoch, epoch, epoch + 1);
+	ck_epoch_stat_advance(global,
+	    ck_pr_cas_uint(&global->epoch, epoch, epoch + 1));
 
-	ck_epoch_dispatch(record, epoch - 2, deferred);
+	n = ck_epoch_dispatch(record, epoch - 2, deferred);
+	ck_epoch_stat_poll(record, n);
 	return true;
 }
 
@@ -645,3 +811,201 @@ ck_epoch_poll(struct ck_epoch_record *record)
 
 	return ck_epoch_poll_deferred(record, NULL);
 }
+
+void
+ck_epoch_reclaimer_init(struct ck_epoch *global,
+    struct ck_epoch_reclaimer *reclaimer)
+{
+
+	reclaimer->n_handoff = 0;
+	ck_epoch_register(global, &reclaimer->record, reclaimer);
+	return;
+}
+
+/*
+ * Pushes a list of callbacks onto a pending stack that may concurrently
+ * be pushed to and popped from, and returns the length of the list.
+ */
+static unsigned int
+ck_epoch_splice(ck_stack_t *target, ck_stack_entry_t *head)
+{
+	ck_stack_entry_t *last, *update;
+	unsigned int n;
+
+	for (n = 1, last = head; last->next != NULL; n++)
+		last = last->next;
+
+	update = ck_pr_load_ptr(&target->head);
+	do {
+		last->next = update;
+		ck_pr_fence_store();
+	} while (ck_pr_cas_ptr_value(&target->head, update, head,
+	    &update) == false);
+
+	return n;
+}
+
+unsigned int
+ck_epoch_reclaimer_handoff(struct ck_epoch_reclaimer *reclaimer,
+    struct ck_epoch_record *record)
+{
+	ck_stack_entry_t *head;
+	unsigned int i, total = 0;
+
+	/*
+	 * A callback is filed under the slot of the epoch it was deferred
+	 * in, whatever the record, so slots are moved as they are.
+	 */
+	for (i = 0; i < CK_EPOCH_LENGTH; i++) {
+		head = ck_stack_batch_pop_upmc(&record->pending[i]);
+		if (head == NULL)
+			continue;
+
+		total += ck_epoch_splice(&reclaimer->record.pending[i], head);
+	}
+
+	if (total > 0) {
+		ck_pr_sub_uint(&record->n_pending, total);
+		ck_pr_add_uint(&reclaimer->record.n_pending, total);
+		ck_pr_add_uint(&reclaimer->n_handoff, total);
+	}
+
+	return total;
+}
+
+/*
+ * Unlike ck_epoch_poll, callbacks may be handed off to the record while
+ * it is polled. A callback handed off after the scan may protect an
+ * object still referenced by a thread that began its section after the
+ * scan, so only the callbacks that were pending before the scan are
+ * eligible for dispatch. The others are pushed back.
+ */
+unsigned int
+ck_epoch_reclaimer_poll(struct ck_epoch_reclaimer *reclaimer)
+{
+	struct ck_epoch_record *record = &reclaimer->record;
+	struct ck_epoch *global = record->global;
+	ck_stack_entry_t *snapshot[CK_EPOCH_LENGTH];
+	struct ck_epoch_record *cr;
+	unsigned int epoch, i, n = 0;
+	bool active;
+
+	epoch = ck_pr_load_uint(&global->epoch);
+	for (i = 0; i < CK_EPOCH_LENGTH; i++)
+		snapshot[i] = ck_stack_batch_pop_upmc(&record->pending[i]);
+
+	/*
+	 * The deletion of every object in the snapshot is visible before
+	 * any record is scanned, as for ck_epoch_poll.
+	 */
+	ck_pr_fence_memory();
+
+	cr = ck_epoch_scan(global, NULL, epoch, &active);
+	for (i = 0; i < CK_EPOCH_LENGTH; i++) {
+		if (snapshot[i] == NULL)
+			continue;
+
+		/* The same grace periods as in ck_epoch_poll_deferred. */
+		if (cr == NULL && (active == false ||
+		    i == ((epoch - 2) & (CK_EPOCH_LENGTH - 1)))) {
+			n += ck_epoch_dispatch_list(record, snapshot[i], NULL);
+		} else {
+			ck_epoch_splice(&record->pending[i], snapshot[i]);
+		}
+	}
+
+	if (cr == NULL && active == true)
+		ck_epoch_stat_advance(global,
+		    ck_pr_cas_uint(&global->epoch, epoch, epoch + 1));
+
+	ck_epoch_stat_poll(record, n);
+	return ck_pr_load_uint(&record->n_pending);
+}
+
+void
+ck_epoch_reclaimer_stat(struct ck_epoch_reclaimer *reclaimer,
+    struct ck_epoch_reclaimer_stat *st)
+{
+
+	st->n_pending = ck_pr_load_uint(&reclaimer->record.n_pending);
+	st->n_peak = ck_pr_load_uint(&reclaimer->record.n_peak);
+	st->n_dispatch = ck_pr_load_uint(&reclaimer->record.n_dispatch);
+	st->n_handoff = ck_pr_load_uint(&reclaimer->n_handoff);
+	return;
+}
+
+#ifdef CK_MD_EPOCH_STAT_ENABLE
+void
+ck_epoch_stat_clock(struct ck_epoch *global, ck_epoch_clock_t *clock)
+{
+
+	global->clock = clock;
+	ck_pr_fence_store();
+	return;
+}
+
+void
+ck_epoch_stat(struct ck_epoch *global, struct ck_epoch_stat *st)
+{
+	struct ck_epoch_record *cr;
+	ck_stack_entry_t *cursor;
+	unsigned int age, i, n_peak, state;
+
+	memset(st, 0, sizeof *st);
+	st->timestamp = ck_epoch_stat_now(global);
+	st->epoch = ck_pr_load_uint(&global->epoch);
+	st->n_advance = ck_pr_load_uint(&global->n_advance);
+	st->n_synchronize = ck_pr_load_uint(&global->n_synchronize);
+	for (i = 0; i < CK_EPOCH_STAT_BUCKETS; i++)
+		st->synchronize[i] = ck_pr_load_uint(&global->synchronize[i]);
+
+	CK_STACK_FOREACH(&global->records, cursor) {
+		cr = ck_epoch_record_container(cursor);
+
+		state = ck_pr_load_uint(&cr->state);
+		if (state == CK_EPOCH_STATE_FREE)
+			continue;
+
+		st->n_records++;
+		st->n_pending += ck_pr_load_uint(&cr->n_pending);
+		st->n_dispatch += ck_pr_load_uint(&cr->n_dispatch);
+		st->n_poll += ck_pr_load_uint(&cr->n_poll);
+		st->n_poll_dispatch += ck_pr_load_uint(&cr->n_poll_dispatch);
+
+		n_peak = ck_pr_load_uint(&cr->n_peak);
+		if (n_peak > st->n_peak)
+			st->n_peak = n_peak;
+
+		/* Sections of per-CPU records are not timed. */
+		if (state == CK_EPOCH_STATE_CPU) {
+			for (i = 0; i < CK_EPOCH_SENSE; i++) {
+				if (ck_pr_load_uint(
+				    &cr->local.bucket[i].count) != 0) {
+					st->n_active++;
+					break;
+				}
+			}
+
+			continue;
+		}
+
+		if (ck_pr_load_uint(&cr->active) == 0)
+			continue;
+
+		/*
+		 * The section may have ended and another begun since, in
+		 * which case the age is only underestimated.
+		 */
+		ck_pr_fence_load();
+		age = st->timestamp - ck_pr_load_uint(&cr->section);
+		if (st->oldest == NULL || age > st->oldest_age) {
+			st->oldest = cr;
+			st->oldest_age = age;
+		}
+
+		st->n_active++;
+	}
+
+	return;
+}
+#endif /* CK_MD_EPOCH_STAT_ENABLE */
@@ -58,7 +58,7 @@
 #include <ck_stack.h>
 #include <ck_stdbool.h>
 #include <ck_stddef.h>
-#include <ck_stdlib.h>
+#include <ck_stdint.h>
 #include <ck_string.h>
 
 CK_STACK_CONTAINER(struct ck_hp_record, global_entry, ck_hp_record_container)
@@ -150,25 +150,48 @@ ck_hp_register(struct ck_hp *state,
 	return;
 }
 
-static int
-hazard_compare(const void *a, const void *b)
+/*
+ * The cache of a record is used as an open-addressed set of pointers with
+ * linear probing, which is never filled beyond three quarters of its
+ * capacity.
+ */
+#if (CK_HP_CACHE & (CK_HP_CACHE - 1)) != 0
+#error "CK_HP_CACHE must be a power of 2"
+#endif
+
+#define CK_HP_CACHE_MASK	(CK_HP_CACHE - 1)
+#define CK_HP_CACHE_LIMIT	(CK_HP_CACHE - (CK_HP_CACHE >> 2))
+
+/* Marks a pending hazard as protected in the cache. */
+#define CK_HP_CACHE_PROTECTED	((uintptr_t)1)
+
+CK_CC_INLINE static unsigned int
+ck_hp_cache_hash(const void *pointer)
 {
-	void * const *x;
-	void * const *y;
+	uintptr_t h = (uintptr_t)pointer >> 3;
 
-	x = a;
-	y = b;
-	return ((*x > *y) - (*x < *y));
+	h ^= h >> 16;
+	h *= (uintptr_t)0x45d9f3b;
+	h ^= h >> 16;
+	return (unsigned int)h & CK_HP_CACHE_MASK;
 }
 
-CK_CC_INLINE static bool
-ck_hp_member_scan(ck_stack_entry_t *entry, unsigned int degree, void *pointer)
+/*
+ * Inserts every active hazard into the cache. Returns false if there are
+ * more unique hazards than the cache may hold.
+ */
+static bool
+ck_hp_cache_hazards(struct ck_hp *global, void **cache)
 {
 	struct ck_hp_record *record;
-	unsigned int i;
-	void *hazard;
+	ck_stack_entry_t *entry;
+	unsigned int hazards = 0;
+	unsigned int i, j;
+	void *pointer;
+
+	memset(cache, 0, sizeof(void *) * CK_HP_CACHE);
 
-	do {
+	CK_STACK_FOREACH(&global->subscribers, entry) {
 		record = ck_hp_record_container(entry);
 		if (ck_pr_load_int(&record->state) == CK_HP_FREE)
 			continue;
@@ -176,27 +199,55 @@ ck_hp_member_scan(ck_stack_entry_t *entry, unsigned int degree, void *pointer)
 		if (ck_pr_load_ptr(&record->pointers) == NULL)
 			continue;
 
-		for (i = 0; i < degree; i++) {
-			hazard = ck_pr_load_ptr(&record->pointers[i]);
-			if (hazard == pointer)
-				return (true);
+		for (i = 0; i < global->degree; i++) {
+			pointer = ck_pr_load_ptr(&record->pointers[i]);
+			if (pointer == NULL)
+				continue;
+
+			j = ck_hp_cache_hash(pointer);
+			while (cache[j] != NULL && cache[j] != pointer)
+				j = (j + 1) & CK_HP_CACHE_MASK;
+
+			if (cache[j] == NULL) {
+				if (hazards++ == CK_HP_CACHE_LIMIT)
+					return false;
+
+				cache[j] = pointer;
+			}
 		}
-	} while ((entry = CK_STACK_NEXT(entry)) != NULL);
+	}
+
+	return true;
+}
+
+CK_CC_INLINE static bool
+ck_hp_cache_member(void **cache, const void *pointer)
+{
+	unsigned int i = ck_hp_cache_hash(pointer);
+
+	while (cache[i] != NULL) {
+		if (cache[i] == pointer)
+			return true;
+
+		i = (i + 1) & CK_HP_CACHE_MASK;
+	}
 
-	return (false);
+	return false;
 }
 
 /*
- * This will cache as many pointers as possible in a supplied cache, where
- * the limit is statically defined as CK_HP_CACHE pointers.
+ * Marks every pending hazard in the cache that matches an active hazard
+ * as protected. Every hazard is looked up in the set of pending hazards,
+ * which keeps the cost of a pass linear in the number of hazards.
  */
-CK_CC_INLINE static void *
-ck_hp_member_cache(struct ck_hp *global, void **cache, unsigned int *n_hazards)
+static void
+ck_hp_cache_protect(struct ck_hp *global, void **cache)
 {
 	struct ck_hp_record *record;
+	struct ck_hp_hazard *hazard;
 	ck_stack_entry_t *entry;
-	unsigned int hazards = 0;
-	unsigned int i;
+	unsigned int i, j;
+	uintptr_t slot;
 	void *pointer;
 
 	CK_STACK_FOREACH(&global->subscribers, entry) {
@@ -208,22 +259,79 @@ ck_hp_member_cache(struct ck_hp *global, void **cache, unsigned int *n_hazards)
 			continue;
 
 		for (i = 0; i < global->degree; i++) {
-			/*
-			 * If our limit has been hit, return a cursor to the caller
-			 * for slow path linear walk.
-			 */
-			if (hazards >= CK_HP_CACHE)
-				goto leave;
-
 			pointer = ck_pr_load_ptr(&record->pointers[i]);
-			if (pointer != NULL)
-				cache[hazards++] = pointer;
+			if (pointer == NULL)
+				continue;
+
+			for (j = ck_hp_cache_hash(pointer); cache[j] != NULL;
+			    j = (j + 1) & CK_HP_CACHE_MASK) {
+				slot = (uintptr_t)cache[j];
+				hazard = (void *)(slot & ~CK_HP_CACHE_PROTECTED);
+				if (hazard->pointer == pointer) {
+					cache[j] = (void *)(slot |
+					    CK_HP_CACHE_PROTECTED);
+				}
+			}
 		}
 	}
 
-leave:
-	*n_hazards = hazards;
-	return (entry);
+	return;
+}
+
+/*
+ * Used if there are more hazards than fit in the cache. Pending hazards
+ * are instead inserted into the cache in batches, and every batch is
+ * matched against a single walk of the active hazards.
+ */
+static void
+ck_hp_reclaim_batch(struct ck_hp_record *thread)
+{
+	struct ck_hp *global = thread->global;
+	struct ck_hp_hazard *hazard;
+	ck_stack_entry_t *entry, *next;
+	void **cache = thread->cache;
+	unsigned int i, j, n;
+	uintptr_t slot;
+
+	next = CK_STACK_FIRST(&thread->pending);
+	CK_STACK_FIRST(&thread->pending) = NULL;
+
+	while (next != NULL) {
+		memset(cache, 0, sizeof(void *) * CK_HP_CACHE);
+
+		for (n = 0; next != NULL && n < CK_HP_CACHE_LIMIT; n++) {
+			entry = next;
+			next = CK_STACK_NEXT(entry);
+			hazard = ck_hp_hazard_container(entry);
+
+			j = ck_hp_cache_hash(hazard->pointer);
+			while (cache[j] != NULL)
+				j = (j + 1) & CK_HP_CACHE_MASK;
+
+			cache[j] = hazard;
+		}
+
+		ck_hp_cache_protect(global, cache);
+
+		for (i = 0; i < CK_HP_CACHE; i++) {
+			slot = (uintptr_t)cache[i];
+			if (slot == 0)
+				continue;
+
+			hazard = (void *)(slot & ~CK_HP_CACHE_PROTECTED);
+			if (slot & CK_HP_CACHE_PROTECTED) {
+				ck_stack_push_spnc(&thread->pending,
+				    &hazard->pending_entry);
+				continue;
+			}
+
+			thread->n_pending -= 1;
+			global->destroy(hazard->data);
+			thread->n_reclamations++;
+		}
+	}
+
+	return;
 }
 
 void
@@ -231,45 +339,23 @@ ck_hp_reclaim(struct ck_hp_record *thread)
 {
 	struct ck_hp_hazard *hazard;
 	struct ck_hp *global = thread->global;
-	unsigned int n_hazards;
-	void **cache, *marker, *match;
 	ck_stack_entry_t *previous, *entry, *next;
-
-	/* Store as many entries as possible in local array. */
-	cache = thread->cache;
-	marker = ck_hp_member_cache(global, cache, &n_hazards);
+	void **cache = thread->cache;
 
 	/*
-	 * In theory, there is an n such that (n * (log n) ** 2) < np.
+	 * Build a set of every active hazard, so that every pending hazard
+	 * is tested for membership in constant time.
 	 */
-	qsort(cache, n_hazards, sizeof(void *), hazard_compare);
+	if (ck_hp_cache_hazards(global, cache) == false) {
+		ck_hp_reclaim_batch(thread);
+		return;
+	}
 
 	previous = NULL;
-
-	/*
-	 * Search every potential hazard in the thread-local list across
-	 * all other records.
-	 */
 	CK_STACK_FOREACH_SAFE(&thread->pending, entry, next) {
 		hazard = ck_hp_hazard_container(entry);
 
-		/* First, we will search the local cache. */
-		match = bsearch(&hazard->pointer, cache, n_hazards,
-				  sizeof(void *), hazard_compare);
-		if (match != NULL) {
-			previous = entry;
-			continue;
-		}
-
-		/*
-		 * And then finally, if we were unable to store all hazards
-		 * in the cache, we will have to resort to the slow path of
-		 * scanning remaining records.
-		 *
-		 * It is fine that there may be duplicates from the cache.
-		 */
-		if (marker != NULL &&
-		    ck_hp_member_scan(marker, global->degree, hazard->pointer)) {
+		if (ck_hp_cache_member(cache, hazard->pointer) == true) {
 			previous = entry;
 			continue;
 		}
@@ -29,83 +29,218 @@
 #include <ck_limits.h>
 #include <ck_md.h>
 #include <ck_pr.h>
+#include <ck_spinlock.h>
 #include <ck_stdint.h>
 #include <ck_stdbool.h>
 #include <ck_string.h>
 
 #include "ck_internal.h"
 
-#ifndef CK_HS_PROBE_L1_SHIFT
-#define CK_HS_PROBE_L1_SHIFT 3ULL
-#endif /* CK_HS_PROBE_L1_SHIFT */
-
-#define CK_HS_PROBE_L1 (1 << CK_HS_PROBE_L1_SHIFT)
-#define CK_HS_PROBE_L1_MASK (CK_HS_PROBE_L1 - 1)
+#ifndef _CK_HS_WORD
+#error "ck_hs is not supported on your platform."
+#endif
 
 #ifndef CK_HS_PROBE_L1_DEFAULT
 #define CK_HS_PROBE_L1_DEFAULT CK_MD_CACHELINE
 #endif
 
-#define CK_HS_VMA_MASK ((uintptr_t)((1ULL << CK_MD_VMA_BITS) - 1))
-#define CK_HS_VMA(x)	\
-	((void *)((uintptr_t)(x) & CK_HS_VMA_MASK))
-
-#define CK_HS_EMPTY     NULL
-#define CK_HS_TOMBSTONE ((void *)~(uintptr_t)0)
-#define CK_HS_G		(2)
-#define CK_HS_G_MASK	(CK_HS_G - 1)
-
-#if defined(CK_F_PR_LOAD_8) && defined(CK_F_PR_STORE_8)
-#define CK_HS_WORD          uint8_t
-#define CK_HS_WORD_MAX	    UINT8_MAX
-#define CK_HS_STORE(x, y)   ck_pr_store_8(x, y)
-#define CK_HS_LOAD(x)       ck_pr_load_8(x)
-#elif defined(CK_F_PR_LOAD_16) && defined(CK_F_PR_STORE_16)
-#define CK_HS_WORD          uint16_t
-#define CK_HS_WORD_MAX	    UINT16_MAX
-#define CK_HS_STORE(x, y)   ck_pr_store_16(x, y)
-#define CK_HS_LOAD(x)       ck_pr_load_16(x)
-#elif defined(CK_F_PR_LOAD_32) && defined(CK_F_PR_STORE_32)
-#define CK_HS_WORD          uint32_t
-#define CK_HS_WORD_MAX	    UINT32_MAX
-#define CK_HS_STORE(x, y)   ck_pr_store_32(x, y)
-#define CK_HS_LOAD(x)       ck_pr_load_32(x)
+/*
+ * Upper bound on the number of write locks of a CK_HS_MODE_MPMC map.
+ * The number of locks of a map never exceeds its capacity.
+ */
+#ifndef CK_HS_LOCK_SHIFT
+#define CK_HS_LOCK_SHIFT 6
+#endif /* CK_HS_LOCK_SHIFT */
+
+#define CK_HS_LOCK (1UL << CK_HS_LOCK_SHIFT)
+
+/*
+ * Number of slots of a map being drained that are migrated by every
+ * write operation in CK_HS_MODE_INCREMENTAL.
+ */
+#ifndef CK_HS_MIGRATE
+#define CK_HS_MIGRATE 64
+#endif /* CK_HS_MIGRATE */
+
+/*
+ * Number of lookups ahead of the current one whose probe sequence is
+ * prefetched by ck_hs_get_batch.
+ */
+#ifndef CK_HS_PREFETCH
+#define CK_HS_PREFETCH 8
+#endif /* CK_HS_PREFETCH */
+
+struct ck_hs_lock {
+	ck_spinlock_t lock;
+	char pad[CK_MD_CACHELINE - sizeof(ck_spinlock_t)];
+};
+
+/*
+ * Tags are only ever updated after the entry they describe, so a reader
+ * that observes a tag observes a slot at least as recent. A tag that is
+ * stale only causes a slot to be loaded needlessly, or an entry that is
+ * not yet linearized to be missed.
+ */
+static inline void
+ck_hs_map_tag(struct ck_hs_map *map, const void **slot, unsigned int tag)
+{
+
+#ifdef _CK_HS_TAG
+	if (map->tags != NULL) {
+		ck_pr_fence_store();
+		ck_pr_store_8(&map->tags[slot - map->entries], tag);
+	}
 #else
-#error "ck_hs is not supported on your platform."
+	(void)map;
+	(void)slot;
+	(void)tag;
 #endif
+	return;
+}
 
 /*
- * The key offset is stored in the high bits of the mode field in
- * ck_hs_t.  This is binary compatible with all existing clients
- * across all architectures.
+ * In CK_HS_MODE_MPMC, a write lock is selected by the low-order bits of
+ * the hash value. All writers of a key, as well as all writers of the
+ * probe bound associated with a home slot, serialize on the same lock.
+ * Writers of different locks may still race for the same empty slot or
+ * tombstone, which is resolved by ck_hs_map_claim.
  */
-#define CK_HS_MODE_KEY_OFFSET_BITS 16
+static struct ck_hs_map *
+ck_hs_lock_mpmc(struct ck_hs *hs, unsigned long h)
+{
+	struct ck_hs_map *map;
+	ck_spinlock_t *lock;
 
-enum ck_hs_probe_behavior {
-	CK_HS_PROBE = 0,	/* Default behavior. */
-	CK_HS_PROBE_TOMBSTONE,	/* Short-circuit on tombstone. */
-	CK_HS_PROBE_INSERT	/* Short-circuit on probe bound if tombstone found. */
-};
+	for (;;) {
+		map = ck_pr_load_ptr(&hs->map);
+		lock = &map->locks[h & map->lock_mask].lock;
+		ck_spinlock_lock(lock);
 
-struct ck_hs_map {
-	unsigned int generation[CK_HS_G];
-	unsigned int probe_maximum;
-	unsigned long mask;
-	unsigned long step;
-	unsigned int probe_limit;
-	unsigned int tombstones;
-	unsigned long n_entries;
-	unsigned long capacity;
-	unsigned long size;
-	CK_HS_WORD *probe_bound;
-	const void **entries;
-};
+		/*
+		 * The map is only ever replaced with all of its locks
+		 * held, so it is stable once the lock is acquired.
+		 */
+		if (ck_pr_load_ptr(&hs->map) == map)
+			return map;
+
+		ck_spinlock_unlock(lock);
+	}
+}
+
+static inline struct ck_hs_map *
+ck_hs_lock(struct ck_hs *hs, unsigned long h)
+{
+
+	if ((hs->mode & CK_HS_MODE_MPMC) == 0)
+		return hs->map;
+
+	return ck_hs_lock_mpmc(hs, h);
+}
+
+static inline void
+ck_hs_unlock(struct ck_hs *hs, struct ck_hs_map *map, unsigned long h)
+{
+
+	if (hs->mode & CK_HS_MODE_MPMC)
+		ck_spinlock_unlock(&map->locks[h & map->lock_mask].lock);
+
+	return;
+}
+
+/*
+ * Excludes all writers from the map. This is deadlock-free because
+ * every lock is acquired here in ascending order, while a single-lock
+ * writer holds at most one lock and never takes a second one.
+ */
+static struct ck_hs_map *
+ck_hs_lock_all(struct ck_hs *hs)
+{
+	struct ck_hs_map *map;
+	unsigned long i;
+
+	if ((hs->mode & CK_HS_MODE_MPMC) == 0)
+		return hs->map;
+
+	for (;;) {
+		map = ck_pr_load_ptr(&hs->map);
+		for (i = 0; i <= map->lock_mask; i++)
+			ck_spinlock_lock(&map->locks[i].lock);
+
+		if (ck_pr_load_ptr(&hs->map) == map)
+			return map;
+
+		while (i-- > 0)
+			ck_spinlock_unlock(&map->locks[i].lock);
+	}
+}
+
+static void
+ck_hs_unlock_all(struct ck_hs *hs, struct ck_hs_map *map)
+{
+	unsigned long i;
+
+	if ((hs->mode & CK_HS_MODE_MPMC) == 0)
+		return;
+
+	for (i = 0; i <= map->lock_mask; i++)
+		ck_spinlock_unlock(&map->locks[i].lock);
+
+	return;
+}
+
+/*
+ * Stores an entry into a slot that was observed to be empty or a
+ * tombstone. Concurrent writers may claim the same slot in
+ * CK_HS_MODE_MPMC, in which case the loser must restart its probe.
+ */
+static inline bool
+ck_hs_map_claim(struct ck_hs *hs, struct ck_hs_map *map, const void **slot,
+    const void *previous, const void *insert, unsigned long h)
+{
+
+	if (hs->mode & CK_HS_MODE_MPMC) {
+		if (ck_pr_cas_ptr(slot, CK_CC_DECONST_PTR(previous),
+		    CK_CC_DECONST_PTR(insert)) == false)
+			return false;
+	} else {
+		ck_pr_store_ptr(slot, insert);
+	}
+
+	ck_hs_map_tag(map, slot, _ck_hs_tag(h));
+	return true;
+}
 
 static inline void
-ck_hs_map_signal(struct ck_hs_map *map, unsigned long h)
+ck_hs_map_tombstone(struct ck_hs_map *map, const void **slot)
 {
 
-	h &= CK_HS_G_MASK;
+	ck_pr_store_ptr(slot, _CK_HS_TOMBSTONE);
+	ck_hs_map_tag(map, slot, _CK_HS_TAG_TOMBSTONE);
+	return;
+}
+
+static inline void
+ck_hs_map_delete(struct ck_hs *hs, struct ck_hs_map *map, const void **slot)
+{
+
+	ck_hs_map_tombstone(map, slot);
+
+	if (hs->mode & CK_HS_MODE_MPMC) {
+		ck_pr_dec_ptr(&map->n_entries);
+		ck_pr_inc_uint(&map->tombstones);
+	} else {
+		map->n_entries--;
+		map->tombstones++;
+	}
+
+	return;
+}
+
+static inline void
+ck_hs_map_signal(struct ck_hs *hs, struct ck_hs_map *map, unsigned long h)
+{
+
+	h &= _CK_HS_G_MASK;
 
 	/*
 	 * The generation counter is the readers' signal to retry a probe
@@ -119,38 +254,51 @@ ck_hs_map_signal(struct ck_hs_map *map, unsigned long h)
 	 * re-validation, missing a present key.
 	 */
 	ck_pr_fence_store();
-	ck_pr_store_uint(&map->generation[h],
-	    map->generation[h] + 1);
+	if (hs->mode & CK_HS_MODE_MPMC) {
+		ck_pr_inc_uint(&map->generation[h]);
+	} else {
+		ck_pr_store_uint(&map->generation[h],
+		    map->generation[h] + 1);
+	}
 	ck_pr_fence_store();
 	return;
 }
 
-static bool 
+/*
+ * Offsets past the end of a map continue into the map it is draining,
+ * if any.
+ */
+static bool
 _ck_hs_next(struct ck_hs *hs, struct ck_hs_map *map,
     struct ck_hs_iterator *i, void **key)
 {
+	unsigned long base = 0;
 	void *value;
 
-	if (i->offset >= map->capacity)
-		return false;
+	for (;;) {
+		if (i->offset - base >= map->capacity) {
+			base += map->capacity;
+			map = ck_pr_load_ptr(&map->drain);
+			if (map == NULL)
+				return false;
+
+			continue;
+		}
 
-	do {
 		/* Load the slot once, writers may be concurrent. */
-		value = CK_CC_DECONST_PTR(ck_pr_load_ptr(&map->entries[i->offset]));
-		if (value != CK_HS_EMPTY && value != CK_HS_TOMBSTONE) {
+		value = CK_CC_DECONST_PTR(ck_pr_load_ptr(&map->entries[i->offset - base]));
+		i->offset++;
+		if (value != _CK_HS_EMPTY && value != _CK_HS_TOMBSTONE) {
 #ifdef CK_HS_PP
 			if (hs->mode & CK_HS_MODE_OBJECT)
-				value = CK_HS_VMA(value);
+				value = _CK_HS_VMA(value);
 #else
 			(void)hs; /* Avoid unused parameter warning. */
 #endif
-			i->offset++;
 			*key = value;
 			return true;
 		}
-	} while (++i->offset < map->capacity);
-
-	return false;
+	}
 }
 
 void
@@ -196,14 +344,27 @@ ck_hs_stat(struct ck_hs *hs, struct ck_hs_stat *st)
 	st->n_entries = map->n_entries;
 	st->tombstones = map->tombstones;
 	st->probe_maximum = map->probe_maximum;
+
+	map = map->drain;
+	if (map != NULL) {
+		st->n_entries += map->n_entries;
+		st->tombstones += map->tombstones;
+		if (map->probe_maximum > st->probe_maximum)
+			st->probe_maximum = map->probe_maximum;
+	}
+
 	return;
 }
 
 unsigned long
 ck_hs_count(struct ck_hs *hs)
 {
+	struct ck_hs_map *map = hs->map;
 
-	return hs->map->n_entries;
+	if (map->drain != NULL)
+		return map->n_entries + map->drain->n_entries;
+
+	return map->n_entries;
 }
 
 static void
@@ -214,11 +375,25 @@ ck_hs_map_destroy(struct ck_malloc *m, struct ck_hs_map *map, bool defer)
 	return;
 }
 
+/*
+ * Destroys a map along with the map it is draining, if any.
+ */
+static void
+ck_hs_map_release(struct ck_malloc *m, struct ck_hs_map *map, bool defer)
+{
+
+	if (map->drain != NULL)
+		ck_hs_map_destroy(m, map->drain, defer);
+
+	ck_hs_map_destroy(m, map, defer);
+	return;
+}
+
 void
 ck_hs_deinit(struct ck_hs *hs)
 {
 
-	ck_hs_map_destroy(hs->m, hs->map, false);
+	ck_hs_map_release(hs->m, hs->map, false);
 	return;
 }
 
@@ -234,19 +409,34 @@ static struct ck_hs_map *
 ck_hs_map_create(struct ck_hs *hs, unsigned long entries)
 {
 	struct ck_hs_map *map;
-	unsigned long size, n_entries, prefix, limit;
+	unsigned long size, n_entries, prefix, bound, limit, i, n_locks;
 
 	n_entries = ck_internal_power_2(entries);
-	if (n_entries < CK_HS_PROBE_L1)
-		n_entries = CK_HS_PROBE_L1;
+	if (n_entries < _CK_HS_PROBE_L1)
+		n_entries = _CK_HS_PROBE_L1;
 
 	size = sizeof(struct ck_hs_map) + (sizeof(void *) * n_entries + CK_MD_CACHELINE - 1);
 
 	if (hs->mode & CK_HS_MODE_DELETE) {
-		prefix = sizeof(CK_HS_WORD) * n_entries;
-		size += prefix;
+		bound = sizeof(_CK_HS_WORD) * n_entries;
+	} else {
+		bound = 0;
+	}
+
+	prefix = bound;
+#ifdef _CK_HS_TAG
+	/* Tags are loaded 64 bits at a time. */
+	if (hs->mode & CK_HS_MODE_TAG)
+		prefix += n_entries + sizeof(uint64_t) - 1;
+#endif
+
+	size += prefix;
+
+	if (hs->mode & CK_HS_MODE_MPMC) {
+		n_locks = n_entries < CK_HS_LOCK ? n_entries : CK_HS_LOCK;
+		size += sizeof(struct ck_hs_lock) * n_locks;
 	} else {
-		prefix = 0;
+		n_locks = 0;
 	}
 
 	map = hs->m->malloc(size);
@@ -256,7 +446,7 @@ ck_hs_map_create(struct ck_hs *hs, unsigned long entries)
 	map->size = size;
 
 	/* We should probably use a more intelligent heuristic for default probe length. */
-	limit = ck_internal_max(n_entries >> (CK_HS_PROBE_L1_SHIFT + 2), CK_HS_PROBE_L1_DEFAULT);
+	limit = ck_internal_max(n_entries >> (_CK_HS_PROBE_L1_SHIFT + 2), CK_HS_PROBE_L1_DEFAULT);
 	if (limit > UINT_MAX)
 		limit = UINT_MAX;
 
@@ -266,38 +456,80 @@ ck_hs_map_create(struct ck_hs *hs, unsigned long entries)
 	map->step = ck_cc_ffsl(n_entries);
 	map->mask = n_entries - 1;
 	map->n_entries = 0;
+	map->drain = NULL;
+	map->drained = 0;
 
 	/* Align map allocation to cache line. */
 	map->entries = (void *)(((uintptr_t)&map[1] + prefix +
 	    CK_MD_CACHELINE - 1) & ~(CK_MD_CACHELINE - 1));
 
+	if (n_locks > 0) {
+		map->locks = (struct ck_hs_lock *)map->entries;
+		map->lock_mask = n_locks - 1;
+		for (i = 0; i < n_locks; i++)
+			ck_spinlock_init(&map->locks[i].lock);
+
+		map->entries = (void *)&map->locks[n_locks];
+	} else {
+		map->locks = NULL;
+		map->lock_mask = 0;
+	}
+
 	memset(map->entries, 0, sizeof(void *) * n_entries);
 	memset(map->generation, 0, sizeof map->generation);
 
 	if (hs->mode & CK_HS_MODE_DELETE) {
-		map->probe_bound = (CK_HS_WORD *)&map[1];
-		memset(map->probe_bound, 0, prefix);
+		map->probe_bound = (_CK_HS_WORD *)&map[1];
+		memset(map->probe_bound, 0, bound);
 	} else {
 		map->probe_bound = NULL;
 	}
 
+	map->tags = NULL;
+#ifdef _CK_HS_TAG
+	if (hs->mode & CK_HS_MODE_TAG) {
+		map->tags = (uint8_t *)(((uintptr_t)&map[1] + bound +
+		    sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1));
+		memset(map->tags, _CK_HS_TAG_EMPTY, n_entries);
+	}
+#endif
+
 	/* Commit entries purge with respect to map publication. */
 	ck_pr_fence_store();
 	return map;
 }
 
+/*
+ * Publishes a replacement for a map from which all writers have been
+ * excluded. The previous map may still be referenced by concurrent
+ * readers, as well as by concurrent writers in CK_HS_MODE_MPMC, and so
+ * its destruction is deferred.
+ */
+static void
+ck_hs_map_publish(struct ck_hs *hs, struct ck_hs_map *previous,
+    struct ck_hs_map *map)
+{
+
+	ck_pr_fence_store();
+	ck_pr_store_ptr(&hs->map, map);
+	ck_hs_unlock_all(hs, previous);
+	ck_hs_map_release(hs->m, previous, true);
+	return;
+}
+
 bool
 ck_hs_reset_size(struct ck_hs *hs, unsigned long capacity)
 {
 	struct ck_hs_map *map, *previous;
 
-	previous = hs->map;
+	previous = ck_hs_lock_all(hs);
 	map = ck_hs_map_create(hs, capacity);
-	if (map == NULL)
+	if (map == NULL) {
+		ck_hs_unlock_all(hs, previous);
 		return false;
+	}
 
-	ck_pr_store_ptr(&hs->map, map);
-	ck_hs_map_destroy(hs->m, previous, true);
+	ck_hs_map_publish(hs, previous, map);
 	return true;
 }
 
@@ -310,149 +542,207 @@ ck_hs_reset(struct ck_hs *hs)
 	return ck_hs_reset_size(hs, previous->capacity);
 }
 
-static inline unsigned long
-ck_hs_map_probe_next(struct ck_hs_map *map,
-    unsigned long offset,
-    unsigned long h,
-    unsigned long level,
-    unsigned long probes)
-{
-	unsigned long r, stride;
-
-	r = (h >> map->step) >> level;
-	stride = (r & ~CK_HS_PROBE_L1_MASK) << 1 | (r & CK_HS_PROBE_L1_MASK);
-
-	return (offset + (probes >> CK_HS_PROBE_L1_SHIFT) +
-	    (stride | CK_HS_PROBE_L1)) & map->mask;
-}
-
 static inline void
-ck_hs_map_bound_set(struct ck_hs_map *m,
+ck_hs_map_bound_set(unsigned int mode,
+    struct ck_hs_map *m,
     unsigned long h,
     unsigned long n_probes)
 {
 	unsigned long offset = h & m->mask;
+	unsigned int maximum;
 
-	if (n_probes > m->probe_maximum)
+	if (mode & CK_HS_MODE_MPMC) {
+		/* The probe maximum is shared by all write locks. */
+		maximum = ck_pr_load_uint(&m->probe_maximum);
+		while (n_probes > maximum) {
+			if (ck_pr_cas_uint_value(&m->probe_maximum, maximum,
+			    n_probes, &maximum) == true)
+				break;
+		}
+	} else if (n_probes > m->probe_maximum) {
 		ck_pr_store_uint(&m->probe_maximum, n_probes);
+	}
 
 	if (m->probe_bound != NULL && m->probe_bound[offset] < n_probes) {
-		if (n_probes > CK_HS_WORD_MAX)
-			n_probes = CK_HS_WORD_MAX;
+		if (n_probes > _CK_HS_WORD_MAX)
+			n_probes = _CK_HS_WORD_MAX;
 
-		CK_HS_STORE(&m->probe_bound[offset], n_probes);
+		_CK_HS_STORE(&m->probe_bound[offset], n_probes);
 		ck_pr_fence_store();
 	}
 
 	return;
 }
 
-static inline unsigned int
-ck_hs_map_bound_get(struct ck_hs_map *m, unsigned long h)
+static inline unsigned long
+ck_hs_map_hash(struct ck_hs *hs, const void *entry)
 {
-	unsigned long offset = h & m->mask;
-	unsigned int r = CK_HS_WORD_MAX;
 
-	if (m->probe_bound != NULL) {
-		r = CK_HS_LOAD(&m->probe_bound[offset]);
-		if (r == CK_HS_WORD_MAX)
-			r = ck_pr_load_uint(&m->probe_maximum);
-	} else {
-		r = ck_pr_load_uint(&m->probe_maximum);
-	}
+#ifdef CK_HS_PP
+	if (hs->mode & CK_HS_MODE_OBJECT)
+		entry = _CK_HS_VMA(entry);
+#endif
 
-	return r;
+	return hs->hf(_ck_hs_apply_key_offset(hs, entry), hs->seed);
 }
 
-static inline const void *
-ck_hs_apply_key_offset(const struct ck_hs *hs, const void *obj)
+/*
+ * Stores an entry, known to be absent, into the first empty slot of its
+ * probe sequence. Returns false if the probe limit has been reached.
+ * The map must not be visible to other writers.
+ */
+static bool
+ck_hs_map_place(struct ck_hs_map *map, unsigned long h, const void *entry)
 {
-	unsigned int key_offset = hs->mode >> CK_HS_MODE_KEY_OFFSET_BITS;
-	return (const unsigned char *)obj + key_offset;
+	unsigned long i, j, offset, probes;
+	const void **bucket, **cursor;
+
+	offset = h & map->mask;
+	i = probes = 0;
+
+	for (;;) {
+		bucket = (const void **)((uintptr_t)&map->entries[offset] & ~(CK_MD_CACHELINE - 1));
+
+		for (j = 0; j < _CK_HS_PROBE_L1; j++) {
+			cursor = bucket + ((j + offset) & (_CK_HS_PROBE_L1 - 1));
+
+			if (probes++ == map->probe_limit)
+				return false;
+
+			if (CK_CC_LIKELY(*cursor == _CK_HS_EMPTY)) {
+				ck_pr_store_ptr(cursor, entry);
+				ck_hs_map_tag(map, cursor, _ck_hs_tag(h));
+				map->n_entries++;
+				ck_hs_map_bound_set(0, map, h, probes);
+				return true;
+			}
+		}
+
+		offset = _ck_hs_map_probe_next(map, offset, h, i++, probes);
+	}
 }
 
-bool
-ck_hs_grow(struct ck_hs *hs,
+/*
+ * Returns a copy of the map, including the map it is draining, with at
+ * least the specified capacity. The caller must have excluded all writers
+ * from the map.
+ */
+static struct ck_hs_map *
+ck_hs_map_rehash(struct ck_hs *hs,
+    struct ck_hs_map *map,
     unsigned long capacity)
 {
-	struct ck_hs_map *map, *update;
-	unsigned long k, i, j, offset, probes;
-	const void *previous, **bucket;
+	struct ck_hs_map *update, *source;
+	const void *previous;
+	unsigned long k;
 
 restart:
-	map = hs->map;
-	if (map->capacity > capacity)
-		return false;
-
 	update = ck_hs_map_create(hs, capacity);
 	if (update == NULL)
-		return false;
+		return NULL;
 
-	for (k = 0; k < map->capacity; k++) {
-		unsigned long h;
+	for (source = map; source != NULL; source = source->drain) {
+		for (k = 0; k < source->capacity; k++) {
+			previous = source->entries[k];
+			if (previous == _CK_HS_EMPTY || previous == _CK_HS_TOMBSTONE)
+				continue;
 
-		previous = map->entries[k];
-		if (previous == CK_HS_EMPTY || previous == CK_HS_TOMBSTONE)
-			continue;
+			if (ck_hs_map_place(update,
+			    ck_hs_map_hash(hs, previous), previous) == false) {
+				/*
+				 * We have hit the probe limit, map needs to be even larger.
+				 */
+				ck_hs_map_destroy(hs->m, update, false);
+				capacity <<= 1;
+				goto restart;
+			}
+		}
+	}
 
-#ifdef CK_HS_PP
-		if (hs->mode & CK_HS_MODE_OBJECT)
-			previous = CK_HS_VMA(previous);
-#endif
+	return update;
+}
 
-		h = hs->hf(ck_hs_apply_key_offset(hs, previous), hs->seed);
-		offset = h & update->mask;
-		i = probes = 0;
+bool
+ck_hs_grow(struct ck_hs *hs,
+    unsigned long capacity)
+{
+	struct ck_hs_map *map, *update;
 
-		for (;;) {
-			bucket = (const void **)((uintptr_t)&update->entries[offset] & ~(CK_MD_CACHELINE - 1));
+	map = ck_hs_lock_all(hs);
+	if (map->capacity > capacity) {
+		ck_hs_unlock_all(hs, map);
+		return false;
+	}
 
-			for (j = 0; j < CK_HS_PROBE_L1; j++) {
-				const void **cursor = bucket + ((j + offset) & (CK_HS_PROBE_L1 - 1));
+	update = ck_hs_map_rehash(hs, map, capacity);
+	if (update == NULL) {
+		ck_hs_unlock_all(hs, map);
+		return false;
+	}
 
-				if (probes++ == update->probe_limit)
-					break;
+	ck_hs_map_publish(hs, map, update);
+	return true;
+}
 
-				if (CK_CC_LIKELY(*cursor == CK_HS_EMPTY)) {
-					*cursor = map->entries[k];
-					update->n_entries++;
+/*
+ * Doubles the capacity of the map observed by a writer, which must not
+ * hold any write lock. In CK_HS_MODE_MPMC, the map may have already been
+ * replaced by a concurrent writer, in which case the caller only has to
+ * retry its operation against the new map.
+ *
+ * In CK_HS_MODE_INCREMENTAL, an empty map is published and the entries of
+ * the previous map are migrated by subsequent write operations. A map
+ * that must be expanded while it is still draining is rehashed at once.
+ */
+static bool
+ck_hs_map_expand(struct ck_hs *hs, struct ck_hs_map *map)
+{
+	struct ck_hs_map *current, *update;
 
-					ck_hs_map_bound_set(update, h, probes);
-					break;
-				}
-			}
+	current = ck_hs_lock_all(hs);
+	if (current != map) {
+		ck_hs_unlock_all(hs, current);
+		return true;
+	}
 
-			if (j < CK_HS_PROBE_L1)
-				break;
+	if ((hs->mode & CK_HS_MODE_INCREMENTAL) && map->drain == NULL) {
+		update = ck_hs_map_create(hs, map->capacity << 1);
+		if (update == NULL)
+			return false;
 
-			offset = ck_hs_map_probe_next(update, offset, h, i++, probes);
-		}
+		update->drain = map;
+		ck_pr_fence_store();
+		ck_pr_store_ptr(&hs->map, update);
+		return true;
+	}
 
-		if (probes > update->probe_limit) {
-			/*
-			 * We have hit the probe limit, map needs to be even larger.
-			 */
-			ck_hs_map_destroy(hs->m, update, false);
-			capacity <<= 1;
-			goto restart;
-		}
+	update = ck_hs_map_rehash(hs, map, map->capacity << 1);
+	if (update == NULL) {
+		ck_hs_unlock_all(hs, map);
+		return false;
 	}
 
-	ck_pr_fence_store();
-	ck_pr_store_ptr(&hs->map, update);
-	ck_hs_map_destroy(hs->m, map, true);
+	ck_hs_map_publish(hs, map, update);
 	return true;
 }
 
-static void
-ck_hs_map_postinsert(struct ck_hs *hs, struct ck_hs_map *map)
+/*
+ * Accounts for a new entry. This is called with the write lock held and
+ * returns true if the map must be expanded once the lock is released.
+ * A map is not expanded for load while it is draining another.
+ */
+static inline bool
+ck_hs_map_insert(struct ck_hs *hs, struct ck_hs_map *map)
 {
+	unsigned long n_entries;
 
-	map->n_entries++;
-	if ((map->n_entries << 1) > map->capacity)
-		ck_hs_grow(hs, map->capacity << 1);
+	if (hs->mode & CK_HS_MODE_MPMC) {
+		n_entries = (unsigned long)ck_pr_faa_ptr(&map->n_entries, 1) + 1;
+	} else {
+		n_entries = ++map->n_entries;
+	}
 
-	return;
+	return (n_entries << 1) > map->capacity && map->drain == NULL;
 }
 
 bool
@@ -471,106 +761,91 @@ ck_hs_map_probe(struct ck_hs *hs,
     const void *key,
     const void **object,
     unsigned long probe_limit,
-    enum ck_hs_probe_behavior behavior)
+    enum _ck_hs_probe_behavior behavior)
 {
-	const void **bucket, **cursor, *val, *val_key, *compare_key;
-	const void **pr = NULL;
-	unsigned long offset, j, i, probes, opl;
-
-#ifdef CK_HS_PP
-	/* If we are storing object pointers, then we may leverage pointer packing. */
-	unsigned long hv = 0;
-
-	if (hs->mode & CK_HS_MODE_OBJECT) {
-		hv = (h >> 25) & CK_HS_KEY_MASK;
-		compare_key = CK_HS_VMA(key);
-	} else {
-		compare_key = key;
-	}
-#else
-	compare_key = key;
-#endif
-
-	offset = h & map->mask;
-	*object = NULL;
-	i = probes = 0;
-
-	opl = probe_limit;
-	if (behavior == CK_HS_PROBE_INSERT)
-		probe_limit = ck_hs_map_bound_get(map, h);
 
-	for (;;) {
-		bucket = (const void **)((uintptr_t)&map->entries[offset] & ~(CK_MD_CACHELINE - 1));
-
-		for (j = 0; j < CK_HS_PROBE_L1; j++) {
-			cursor = bucket + ((j + offset) & (CK_HS_PROBE_L1 - 1));
-
-			if (probes++ == probe_limit) {
-				if (probe_limit == opl || pr != NULL) {
-					val = CK_HS_EMPTY;
-					goto leave;
-				}
-
-				/*
-				 * If no eligible slot has been found yet, continue probe
-				 * sequence with original probe limit.
-				 */
-				probe_limit = opl;
-			}
+	return _ck_hs_map_probe(hs, map, n_probes, priority, h, key, object,
+	    probe_limit, behavior, hs->compare);
+}
 
-			val = ck_pr_load_ptr(cursor);
-			if (val == CK_HS_EMPTY)
-				goto leave;
+/*
+ * Moves the entry of a slot of the map being drained into the map. The
+ * entry is visible in the map before it is removed from the drained map,
+ * and readers that may have missed both copies are signaled to retry.
+ */
+static bool
+ck_hs_map_migrate_slot(struct ck_hs *hs, struct ck_hs_map *map,
+    const void **slot)
+{
+	const void *entry = *slot;
+	unsigned long h;
 
-			if (val == CK_HS_TOMBSTONE) {
-				if (pr == NULL) {
-					pr = cursor;
-					*n_probes = probes;
+	h = ck_hs_map_hash(hs, entry);
+	if (ck_hs_map_place(map, h, entry) == false)
+		return false;
 
-					if (behavior == CK_HS_PROBE_TOMBSTONE) {
-						val = CK_HS_EMPTY;
-						goto leave;
-					}
-				}
+	ck_hs_map_signal(hs, map->drain, h);
+	ck_hs_map_delete(hs, map->drain, slot);
+	return true;
+}
 
-				continue;
-			}
+/*
+ * Migrates up to n slots of the map being drained. The drained map is
+ * destroyed once all of its slots have been migrated. Returns false if
+ * an entry could not be placed into the map.
+ */
+static bool
+ck_hs_map_migrate_step(struct ck_hs *hs, struct ck_hs_map *map,
+    unsigned long n)
+{
+	struct ck_hs_map *drain = map->drain;
+	const void **slot;
 
-#ifdef CK_HS_PP
-			if (hs->mode & CK_HS_MODE_OBJECT) {
-				if (((uintptr_t)val >> CK_MD_VMA_BITS) != hv)
-					continue;
+	for (; n > 0 && map->drained < drain->capacity; n--) {
+		slot = &drain->entries[map->drained];
+		if (*slot != _CK_HS_EMPTY && *slot != _CK_HS_TOMBSTONE &&
+		    ck_hs_map_migrate_slot(hs, map, slot) == false)
+			return false;
 
-				val = CK_HS_VMA(val);
-			}
-#endif
+		map->drained++;
+	}
 
-			val_key = ck_hs_apply_key_offset(hs, val);
-			if (val_key == compare_key)
-				goto leave;
+	if (map->drained == drain->capacity) {
+		ck_pr_store_ptr(&map->drain, NULL);
+		ck_hs_map_destroy(hs->m, drain, true);
+	}
 
-			if (hs->compare == NULL)
-				continue;
+	return true;
+}
 
-			if (hs->compare(val_key, key) == true)
-				goto leave;
-		}
+/*
+ * Prepares a write operation on a map that is draining another. The key
+ * is migrated first, so that the operation only has to consider the map,
+ * followed by the next CK_HS_MIGRATE slots. If an entry cannot be placed,
+ * the map is rehashed at once. Returns the map the operation applies to,
+ * or NULL on allocation failure.
+ */
+static struct ck_hs_map *
+ck_hs_map_migrate(struct ck_hs *hs,
+    struct ck_hs_map *map,
+    unsigned long h,
+    const void *key)
+{
+	struct ck_hs_map *drain = map->drain;
+	const void **slot, **first, *object;
+	unsigned long n_probes;
 
-		offset = ck_hs_map_probe_next(map, offset, h, i++, probes);
-	}
+	slot = ck_hs_map_probe(hs, drain, &n_probes, &first, h, key, &object,
+	    _ck_hs_map_bound_get(drain, h), _CK_HS_PROBE);
 
-leave:
-	if (probes > probe_limit) {
-		cursor = NULL;
-	} else {
-		*object = val;
-	}
+	if ((object == NULL || ck_hs_map_migrate_slot(hs, map, slot) == true) &&
+	    ck_hs_map_migrate_step(hs, map, CK_HS_MIGRATE) == true)
+		return map;
 
-	if (pr == NULL)
-		*n_probes = probes;
+	if (ck_hs_map_expand(hs, map) == false)
+		return NULL;
 
-	*priority = pr;
-	return cursor;
+	return hs->map;
 }
 
 static inline const void *
@@ -580,8 +855,8 @@ ck_hs_marshal(unsigned int mode, const void *val, unsigned long h)
 	const void *insert;
 
 	if (mode & CK_HS_MODE_OBJECT) {
-		insert = (void *)((uintptr_t)CK_HS_VMA(val) |
-		    ((h >> 25) << CK_MD_VMA_BITS));
+		insert = (void *)((uintptr_t)_CK_HS_VMA(val) |
+		    ((h >> 25) << CK_MD_HS_VMA_BITS));
 	} else {
 		insert = val;
 	}
@@ -600,15 +875,17 @@ ck_hs_gc(struct ck_hs *hs, unsigned long cycles, unsigned long seed)
 {
 	unsigned long size = 0;
 	unsigned long i;
-	struct ck_hs_map *map = hs->map;
+	struct ck_hs_map *map;
 	unsigned int maximum;
-	CK_HS_WORD *bounds = NULL;
+	_CK_HS_WORD *bounds = NULL;
 
+	map = ck_hs_lock_all(hs);
 	if (map->n_entries == 0) {
 		ck_pr_store_uint(&map->probe_maximum, 0);
 		if (map->probe_bound != NULL)
-			memset(map->probe_bound, 0, sizeof(CK_HS_WORD) * map->capacity);
+			memset(map->probe_bound, 0, sizeof(_CK_HS_WORD) * map->capacity);
 
+		ck_hs_unlock_all(hs, map);
 		return true;
 	}
 
@@ -616,10 +893,12 @@ ck_hs_gc(struct ck_hs *hs, unsigned long cycles, unsigned long seed)
 		maximum = 0;
 
 		if (map->probe_bound != NULL) {
-			size = sizeof(CK_HS_WORD) * map->capacity;
+			size = sizeof(_CK_HS_WORD) * map->capacity;
 			bounds = hs->m->malloc(size);
-			if (bounds == NULL)
+			if (bounds == NULL) {
+				ck_hs_unlock_all(hs, map);
 				return false;
+			}
 
 			memset(bounds, 0, size);
 		}
@@ -632,35 +911,35 @@ ck_hs_gc(struct ck_hs *hs, unsigned long cycles, unsigned long seed)
 		unsigned long n_probes, offset, h;
 
 		entry = map->entries[(i + seed) & map->mask];
-		if (entry == CK_HS_EMPTY || entry == CK_HS_TOMBSTONE)
+		if (entry == _CK_HS_EMPTY || entry == _CK_HS_TOMBSTONE)
 			continue;
 
 #ifdef CK_HS_PP
 		if (hs->mode & CK_HS_MODE_OBJECT)
-			entry = CK_HS_VMA(entry);
+			entry = _CK_HS_VMA(entry);
 #endif
 
-		entry_key = ck_hs_apply_key_offset(hs, entry);
+		entry_key = _ck_hs_apply_key_offset(hs, entry);
 		h = hs->hf(entry_key, hs->seed);
 		offset = h & map->mask;
 
 		slot = ck_hs_map_probe(hs, map, &n_probes, &first, h, entry_key, &object,
-		    ck_hs_map_bound_get(map, h), CK_HS_PROBE);
+		    _ck_hs_map_bound_get(map, h), _CK_HS_PROBE);
 
 		if (first != NULL) {
 			const void *insert = ck_hs_marshal(hs->mode, entry, h);
 
-			ck_pr_store_ptr(first, insert);
-			ck_hs_map_signal(map, h);
-			ck_pr_store_ptr(slot, CK_HS_TOMBSTONE);
+			ck_hs_map_claim(hs, map, first, _CK_HS_TOMBSTONE, insert, h);
+			ck_hs_map_signal(hs, map, h);
+			ck_hs_map_tombstone(map, slot);
 		}
 
 		if (cycles == 0) {
 			if (n_probes > maximum)
 				maximum = n_probes;
 
-			if (n_probes > CK_HS_WORD_MAX)
-				n_probes = CK_HS_WORD_MAX;
+			if (n_probes > _CK_HS_WORD_MAX)
+				n_probes = _CK_HS_WORD_MAX;
 
 			if (bounds != NULL && n_probes > bounds[offset])
 				bounds[offset] = n_probes;
@@ -677,11 +956,12 @@ ck_hs_gc(struct ck_hs *hs, unsigned long cycles, unsigned long seed)
 
 	if (bounds != NULL) {
 		for (i = 0; i < map->capacity; i++)
-			CK_HS_STORE(&map->probe_bound[i], bounds[i]);
+			_CK_HS_STORE(&map->probe_bound[i], bounds[i]);
 
 		hs->m->free(bounds, size, false);
 	}
 
+	ck_hs_unlock_all(hs, map);
 	return true;
 }
 
@@ -692,28 +972,43 @@ ck_hs_fas(struct ck_hs *hs,
     void **previous)
 {
 	const void **slot, **first, *object, *insert, *val_key;
-	struct ck_hs_map *map = hs->map;
+	struct ck_hs_map *map;
 	unsigned long n_probes;
 
 	*previous = NULL;
-	val_key = ck_hs_apply_key_offset(hs, val);
+	val_key = _ck_hs_apply_key_offset(hs, val);
+
+restart:
+	map = ck_hs_lock(hs, h);
+	if (CK_CC_UNLIKELY(map->drain != NULL)) {
+		map = ck_hs_map_migrate(hs, map, h, val_key);
+		if (map == NULL)
+			return false;
+	}
 	slot = ck_hs_map_probe(hs, map, &n_probes, &first, h, val_key, &object,
-	    ck_hs_map_bound_get(map, h), CK_HS_PROBE);
+	    _ck_hs_map_bound_get(map, h), _CK_HS_PROBE);
 
 	/* Replacement semantics presume existence. */
-	if (object == NULL)
+	if (object == NULL) {
+		ck_hs_unlock(hs, map, h);
 		return false;
+	}
 
 	insert = ck_hs_marshal(hs->mode, val, h);
 
 	if (first != NULL) {
-		ck_pr_store_ptr(first, insert);
-		ck_hs_map_signal(map, h);
-		ck_pr_store_ptr(slot, CK_HS_TOMBSTONE);
+		if (ck_hs_map_claim(hs, map, first, _CK_HS_TOMBSTONE, insert, h) == false) {
+			ck_hs_unlock(hs, map, h);
+			goto restart;
+		}
+
+		ck_hs_map_signal(hs, map, h);
+		ck_hs_map_tombstone(map, slot);
 	} else {
 		ck_pr_store_ptr(slot, insert);
 	}
 
+	ck_hs_unlock(hs, map, h);
 	*previous = CK_CC_DECONST_PTR(object);
 	return true;
 }
@@ -728,7 +1023,9 @@ ck_hs_fas(struct ck_hs *hs,
  * argument is non-NULL and the return pointer is different than that passed to
  * the apply function, then the pre-existing value is replaced. For
  * replacement, it is required that the value itself is identical to the
- * previous value.
+ * previous value. In CK_HS_MODE_MPMC, the apply function is called with the
+ * write lock of the key held and may be called more than once if the slot it
+ * was to be stored in is claimed by a concurrent writer.
  */
 bool
 ck_hs_apply(struct ck_hs *hs,
@@ -740,13 +1037,20 @@ ck_hs_apply(struct ck_hs *hs,
 	const void **slot, **first, *object, *delta, *insert;
 	unsigned long n_probes;
 	struct ck_hs_map *map;
+	bool expand;
 
 restart:
-	map = hs->map;
+	map = ck_hs_lock(hs, h);
+	if (CK_CC_UNLIKELY(map->drain != NULL)) {
+		map = ck_hs_map_migrate(hs, map, h, key);
+		if (map == NULL)
+			return false;
+	}
 
-	slot = ck_hs_map_probe(hs, map, &n_probes, &first, h, key, &object, map->probe_limit, CK_HS_PROBE_INSERT);
+	slot = ck_hs_map_probe(hs, map, &n_probes, &first, h, key, &object, map->probe_limit, _CK_HS_PROBE_INSERT);
 	if (slot == NULL && first == NULL) {
-		if (ck_hs_grow(hs, map->capacity << 1) == false)
+		ck_hs_unlock(hs, map, h);
+		if (ck_hs_map_expand(hs, map) == false)
 			return false;
 
 		goto restart;
@@ -758,22 +1062,25 @@ restart:
 		 * The apply function has requested deletion. If the object doesn't exist,
 		 * then exit early.
 		 */
-		if (CK_CC_UNLIKELY(object == NULL))
+		if (CK_CC_UNLIKELY(object == NULL)) {
+			ck_hs_unlock(hs, map, h);
 			return true;
+		}
 
 		/* Otherwise, mark slot as deleted. */
-		ck_pr_store_ptr(slot, CK_HS_TOMBSTONE);
-		map->n_entries--;
-		map->tombstones++;
+		ck_hs_map_delete(hs, map, slot);
+		ck_hs_unlock(hs, map, h);
 		return true;
 	}
 
 	/* The apply function has not requested hash set modification so exit early. */
-	if (delta == object)
+	if (delta == object) {
+		ck_hs_unlock(hs, map, h);
 		return true;
+	}
 
 	/* A modification or insertion has been requested. */
-	ck_hs_map_bound_set(map, h, n_probes);
+	ck_hs_map_bound_set(hs->mode, map, h, n_probes);
 
 	insert = ck_hs_marshal(hs->mode, delta, h);
 	if (first != NULL) {
@@ -781,11 +1088,20 @@ restart:
 		 * This follows the same semantics as ck_hs_set, please refer to that
 		 * function for documentation.
 		 */
-		ck_pr_store_ptr(first, insert);
+		if (ck_hs_map_claim(hs, map, first, _CK_HS_TOMBSTONE, insert, h) == false) {
+			ck_hs_unlock(hs, map, h);
+			goto restart;
+		}
 
 		if (object != NULL) {
-			ck_hs_map_signal(map, h);
-			ck_pr_store_ptr(slot, CK_HS_TOMBSTONE);
+			ck_hs_map_signal(hs, map, h);
+			ck_hs_map_tombstone(map, slot);
+		}
+	} else if (object == NULL) {
+		/* An empty slot was found. */
+		if (ck_hs_map_claim(hs, map, slot, _CK_HS_EMPTY, insert, h) == false) {
+			ck_hs_unlock(hs, map, h);
+			goto restart;
 		}
 	} else {
 		/*
@@ -795,8 +1111,11 @@ restart:
 		ck_pr_store_ptr(slot, insert);
 	}
 
-	if (object == NULL)
-		ck_hs_map_postinsert(hs, map);
+	expand = object == NULL && ck_hs_map_insert(hs, map);
+	ck_hs_unlock(hs, map, h);
+
+	if (expand == true)
+		ck_hs_map_expand(hs, map);
 
 	return true;
 }
@@ -810,27 +1129,37 @@ ck_hs_set(struct ck_hs *hs,
 	const void **slot, **first, *object, *insert, *val_key;
 	unsigned long n_probes;
 	struct ck_hs_map *map;
+	bool expand;
 
-	val_key = ck_hs_apply_key_offset(hs, val);
+	val_key = _ck_hs_apply_key_offset(hs, val);
 	*previous = NULL;
 
 restart:
-	map = hs->map;
+	map = ck_hs_lock(hs, h);
+	if (CK_CC_UNLIKELY(map->drain != NULL)) {
+		map = ck_hs_map_migrate(hs, map, h, val_key);
+		if (map == NULL)
+			return false;
+	}
 
-	slot = ck_hs_map_probe(hs, map, &n_probes, &first, h, val_key, &object, map->probe_limit, CK_HS_PROBE_INSERT);
+	slot = ck_hs_map_probe(hs, map, &n_probes, &first, h, val_key, &object, map->probe_limit, _CK_HS_PROBE_INSERT);
 	if (slot == NULL && first == NULL) {
-		if (ck_hs_grow(hs, map->capacity << 1) == false)
+		ck_hs_unlock(hs, map, h);
+		if (ck_hs_map_expand(hs, map) == false)
 			return false;
 
 		goto restart;
 	}
 
-	ck_hs_map_bound_set(map, h, n_probes);
+	ck_hs_map_bound_set(hs->mode, map, h, n_probes);
 	insert = ck_hs_marshal(hs->mode, val, h);
 
 	if (first != NULL) {
 		/* If an earlier bucket was found, then store entry there. */
-		ck_pr_store_ptr(first, insert);
+		if (ck_hs_map_claim(hs, map, first, _CK_HS_TOMBSTONE, insert, h) == false) {
+			ck_hs_unlock(hs, map, h);
+			goto restart;
+		}
 
 		/*
 		 * If a duplicate key was found, then delete it after
@@ -840,8 +1169,14 @@ restart:
 		 * duplicate key.
 		 */
 		if (object != NULL) {
-			ck_hs_map_signal(map, h);
-			ck_pr_store_ptr(slot, CK_HS_TOMBSTONE);
+			ck_hs_map_signal(hs, map, h);
+			ck_hs_map_tombstone(map, slot);
+		}
+	} else if (object == NULL) {
+		/* An empty slot was found. */
+		if (ck_hs_map_claim(hs, map, slot, _CK_HS_EMPTY, insert, h) == false) {
+			ck_hs_unlock(hs, map, h);
+			goto restart;
 		}
 	} else {
 		/*
@@ -851,53 +1186,76 @@ restart:
 		ck_pr_store_ptr(slot, insert);
 	}
 
-	if (object == NULL)
-		ck_hs_map_postinsert(hs, map);
+	expand = object == NULL && ck_hs_map_insert(hs, map);
+	ck_hs_unlock(hs, map, h);
+
+	if (expand == true)
+		ck_hs_map_expand(hs, map);
 
 	*previous = CK_CC_DECONST_PTR(object);
 	return true;
 }
 
-CK_CC_INLINE static bool
+static bool
 ck_hs_put_internal(struct ck_hs *hs,
     unsigned long h,
     const void *val,
-    enum ck_hs_probe_behavior behavior)
+    enum _ck_hs_probe_behavior behavior)
 {
 	const void **slot, **first, *object, *insert, *val_key;
 	unsigned long n_probes;
 	struct ck_hs_map *map;
+	bool expand;
 
-	val_key = ck_hs_apply_key_offset(hs, val);
+	val_key = _ck_hs_apply_key_offset(hs, val);
 restart:
-	map = hs->map;
+	map = ck_hs_lock(hs, h);
+	if (CK_CC_UNLIKELY(map->drain != NULL)) {
+		map = ck_hs_map_migrate(hs, map, h, val_key);
+		if (map == NULL)
+			return false;
+	}
 
 	slot = ck_hs_map_probe(hs, map, &n_probes, &first, h, val_key, &object,
 	    map->probe_limit, behavior);
 
 	if (slot == NULL && first == NULL) {
-		if (ck_hs_grow(hs, map->capacity << 1) == false)
+		ck_hs_unlock(hs, map, h);
+		if (ck_hs_map_expand(hs, map) == false)
 			return false;
 
 		goto restart;
 	}
 
 	/* Fail operation if a match was found. */
-	if (object != NULL)
+	if (object != NULL) {
+		ck_hs_unlock(hs, map, h);
 		return false;
+	}
 
-	ck_hs_map_bound_set(map, h, n_probes);
+	ck_hs_map_bound_set(hs->mode, map, h, n_probes);
 	insert = ck_hs_marshal(hs->mode, val, h);
 
 	if (first != NULL) {
 		/* Insert val into first bucket in probe sequence. */
-		ck_pr_store_ptr(first, insert);
+		if (ck_hs_map_claim(hs, map, first, _CK_HS_TOMBSTONE, insert, h) == false) {
+			ck_hs_unlock(hs, map, h);
+			goto restart;
+		}
 	} else {
 		/* An empty slot was found. */
-		ck_pr_store_ptr(slot, insert);
+		if (ck_hs_map_claim(hs, map, slot, _CK_HS_EMPTY, insert, h) == false) {
+			ck_hs_unlock(hs, map, h);
+			goto restart;
+		}
 	}
 
-	ck_hs_map_postinsert(hs, map);
+	expand = ck_hs_map_insert(hs, map);
+	ck_hs_unlock(hs, map, h);
+
+	if (expand == true)
+		ck_hs_map_expand(hs, map);
+
 	return true;
 }
 
@@ -907,7 +1265,7 @@ ck_hs_put(struct ck_hs *hs,
     const void *val)
 {
 
-	return ck_hs_put_internal(hs, h, val, CK_HS_PROBE_INSERT);
+	return ck_hs_put_internal(hs, h, val, _CK_HS_PROBE_INSERT);
 }
 
 bool
@@ -916,7 +1274,7 @@ ck_hs_put_unique(struct ck_hs *hs,
     const void *val)
 {
 
-	return ck_hs_put_internal(hs, h, val, CK_HS_PROBE_TOMBSTONE);
+	return ck_hs_put_internal(hs, h, val, _CK_HS_PROBE_TOMBSTONE);
 }
 
 void *
@@ -924,49 +1282,95 @@ ck_hs_get(struct ck_hs *hs,
     unsigned long h,
     const void *key)
 {
-	const void **first, *object;
-	struct ck_hs_map *map;
-	unsigned long n_probes;
-	unsigned int g, g_p, probe;
-	unsigned int *generation;
 
-	do {
-		map = ck_pr_load_ptr(&hs->map);
-		/*
-		 * We avoid a load fence here on and instead rely on the subsequent
-		 * ordered load (a stale value is benign and leads to a reprobe).
-		 */
-		generation = &map->generation[h & CK_HS_G_MASK];
-		g = ck_pr_load_uint(generation);
-		probe  = ck_hs_map_bound_get(map, h);
-		ck_pr_fence_load();
+	return _ck_hs_get(hs, h, key, hs->compare);
+}
+
+CK_CC_INLINE static void
+ck_hs_map_prefetch(struct ck_hs_map *map, unsigned long h)
+{
+	unsigned long offset = h & map->mask;
 
-		ck_hs_map_probe(hs, map, &n_probes, &first, h, key, &object, probe, CK_HS_PROBE);
+	CK_CC_PREFETCH(map->entries + offset);
+	if (map->probe_bound != NULL)
+		CK_CC_PREFETCH(map->probe_bound + offset);
 
-		ck_pr_fence_load();
-		g_p = ck_pr_load_uint(generation);
-	} while (g != g_p);
+	if (map->tags != NULL)
+		CK_CC_PREFETCH(map->tags + offset);
 
-	return CK_CC_DECONST_PTR(object);
+	return;
 }
 
-void *
-ck_hs_remove(struct ck_hs *hs,
+/*
+ * Looks up n keys, storing the entry matching keys[i] (or NULL) in out[i].
+ * The first cache lines of the probe sequence of a key are prefetched
+ * CK_HS_PREFETCH lookups before it is resolved, so that the cache misses
+ * of consecutive lookups overlap. A stale map is only a wasted prefetch.
+ */
+void
+ck_hs_get_batch(struct ck_hs *hs,
+    const unsigned long *h,
+    const void *const *keys,
+    void **out,
+    size_t n)
+{
+	struct ck_hs_map *map = ck_pr_load_ptr(&hs->map);
+	size_t i;
+
+	for (i = 0; i < n && i < CK_HS_PREFETCH; i++)
+		ck_hs_map_prefetch(map, h[i]);
+
+	for (i = 0; i < n; i++) {
+		if (i + CK_HS_PREFETCH < n)
+			ck_hs_map_prefetch(map, h[i + CK_HS_PREFETCH]);
+
+		out[i] = ck_hs_get(hs, h[i], keys[i]);
+	}
+
+	return;
+}
+
+static const void *
+ck_hs_map_remove(struct ck_hs *hs,
+    struct ck_hs_map *map,
     unsigned long h,
     const void *key)
 {
 	const void **slot, **first, *object;
-	struct ck_hs_map *map = hs->map;
 	unsigned long n_probes;
 
 	slot = ck_hs_map_probe(hs, map, &n_probes, &first, h, key, &object,
-	    ck_hs_map_bound_get(map, h), CK_HS_PROBE);
+	    _ck_hs_map_bound_get(map, h), _CK_HS_PROBE);
+	if (object != NULL)
+		ck_hs_map_delete(hs, map, slot);
+
+	return object;
+}
+
+void *
+ck_hs_remove(struct ck_hs *hs,
+    unsigned long h,
+    const void *key)
+{
+	struct ck_hs_map *map;
+	const void *object;
+
+	map = ck_hs_lock(hs, h);
+	object = NULL;
+
+	/*
+	 * A key does not have to be migrated in order to be removed. Failure
+	 * to migrate is left to the next insertion to resolve.
+	 */
+	if (CK_CC_UNLIKELY(map->drain != NULL)) {
+		object = ck_hs_map_remove(hs, map->drain, h, key);
+		ck_hs_map_migrate_step(hs, map, CK_HS_MIGRATE);
+	}
+
 	if (object == NULL)
-		return NULL;
+		object = ck_hs_map_remove(hs, map, h, key);
 
-	ck_pr_store_ptr(slot, CK_HS_TOMBSTONE);
-	map->n_entries--;
-	map->tombstones++;
+	ck_hs_unlock(hs, map, h);
 	return CK_CC_DECONST_PTR(object);
 }
 
@@ -1019,6 +1423,10 @@ ck_hs_init_from_options(struct ck_hs *hs,
 		return false;
 	if (opts.hash_function == NULL)
 		return false;
+	if ((opts.mode & CK_HS_MODE_SPMC) && (opts.mode & CK_HS_MODE_MPMC))
+		return false;
+	if ((opts.mode & CK_HS_MODE_INCREMENTAL) && (opts.mode & CK_HS_MODE_MPMC))
+		return false;
 	if (opts.mode & CK_HS_MODE_OBJECT) {
 		if (opts.key_offset >= 32768)
 			return false;
@@ -1032,7 +1440,7 @@ ck_hs_init_from_options(struct ck_hs *hs,
 
 	init.m = opts.allocator;
 	init.mode = opts.mode;
-	init.mode |= opts.key_offset << CK_HS_MODE_KEY_OFFSET_BITS;
+	init.mode |= opts.key_offset << _CK_HS_MODE_KEY_OFFSET_BITS;
 	init.seed = opts.seed;
 	init.hf = opts.hash_function;
 	init.compare = opts.compare;
@@ -1064,3 +1472,229 @@ ck_hs_init(struct ck_hs *hs,
 
 	return ck_hs_init_from_options(hs, &opts);
 }
+
+/*
+ * A snapshot is a position-independent image of a map: a header followed
+ * by the slots, probe bounds and tags of the map at cache line aligned
+ * offsets. Slots are copied verbatim, so object keys must themselves be
+ * position-independent (such as offsets resolved by the hash and compare
+ * callbacks) for an image to be used by another process.
+ */
+#define CK_HS_SNAPSHOT_MAGIC	0x70616e7373686b63ULL	/* "ckhssnap" */
+#define CK_HS_SNAPSHOT_VERSION	2
+
+#define CK_HS_SNAPSHOT_ALIGN(x)	\
+	(((x) + CK_MD_CACHELINE - 1) & ~(uint64_t)(CK_MD_CACHELINE - 1))
+
+#ifdef CK_HS_PP
+#define CK_HS_SNAPSHOT_PP	1
+#else
+#define CK_HS_SNAPSHOT_PP	0
+#endif
+
+/*
+ * Properties of the build that determine the interpretation of an image.
+ * An image is only usable by a build with an identical layout.
+ */
+#define CK_HS_SNAPSHOT_LAYOUT				\
+	((uint32_t)sizeof(void *) |			\
+	 ((uint32_t)sizeof(_CK_HS_WORD) << 8) |		\
+	 ((uint32_t)_CK_HS_PROBE_L1_SHIFT << 16) |	\
+	 ((uint32_t)CK_HS_SNAPSHOT_PP << 24))
+
+#define CK_HS_SNAPSHOT_MODE	(CK_HS_MODE_DIRECT | CK_HS_MODE_OBJECT | \
+				 CK_HS_MODE_DELETE | CK_HS_MODE_TAG)
+
+struct ck_hs_snapshot {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t layout;
+	uint32_t mode;
+	uint32_t probe_maximum;
+	uint32_t probe_limit;
+	uint32_t tombstones;
+	uint64_t seed;
+	uint64_t capacity;
+	uint64_t n_entries;
+	uint64_t size;
+	uint64_t entries;
+	uint64_t probe_bound;
+	uint64_t tags;
+};
+
+static uint64_t
+ck_hs_snapshot_layout(struct ck_hs_snapshot *s,
+    uint64_t capacity,
+    bool probe_bound,
+    bool tags)
+{
+	uint64_t offset;
+
+	offset = CK_HS_SNAPSHOT_ALIGN(sizeof(struct ck_hs_snapshot));
+	s->entries = offset;
+	offset += sizeof(void *) * capacity;
+
+	s->probe_bound = 0;
+	if (probe_bound == true) {
+		offset = CK_HS_SNAPSHOT_ALIGN(offset);
+		s->probe_bound = offset;
+		offset += sizeof(_CK_HS_WORD) * capacity;
+	}
+
+	s->tags = 0;
+	if (tags == true) {
+		offset = CK_HS_SNAPSHOT_ALIGN(offset);
+		s->tags = offset;
+		offset += capacity;
+	}
+
+	s->size = offset;
+	return offset;
+}
+
+size_t
+ck_hs_snapshot_size(struct ck_hs *hs)
+{
+	struct ck_hs_map *map = hs->map;
+	struct ck_hs_snapshot s;
+
+	return (size_t)ck_hs_snapshot_layout(&s, map->capacity,
+	    map->probe_bound != NULL, map->tags != NULL);
+}
+
+/*
+ * Serializes the map into the specified buffer, which must be at least
+ * ck_hs_snapshot_size bytes long. Writers are excluded for the duration
+ * of the copy. Sets with a migration in progress must first be rebuilt.
+ */
+bool
+ck_hs_snapshot(struct ck_hs *hs, void *buffer, size_t length)
+{
+	struct ck_hs_snapshot s;
+	struct ck_hs_map *map;
+	unsigned char *image = buffer;
+
+	map = ck_hs_lock_all(hs);
+	if (map->drain != NULL || ck_hs_snapshot_layout(&s, map->capacity,
+	    map->probe_bound != NULL, map->tags != NULL) > length) {
+		ck_hs_unlock_all(hs, map);
+		return false;
+	}
+
+	s.magic = CK_HS_SNAPSHOT_MAGIC;
+	s.version = CK_HS_SNAPSHOT_VERSION;
+	s.layout = CK_HS_SNAPSHOT_LAYOUT;
+	/* The key offset is preserved along with the layout-defining modes. */
+	s.mode = hs->mode & ~((1U << _CK_HS_MODE_KEY_OFFSET_BITS) - 1);
+	s.mode |= hs->mode & CK_HS_SNAPSHOT_MODE;
+	if (map->tags == NULL)
+		s.mode &= ~(unsigned int)CK_HS_MODE_TAG;
+
+	s.probe_maximum = ck_pr_load_uint(&map->probe_maximum);
+	s.probe_limit = map->probe_limit;
+	s.tombstones = map->tombstones;
+	s.seed = hs->seed;
+	s.capacity = map->capacity;
+	s.n_entries = map->n_entries;
+
+	memset(image, 0, (size_t)s.size);
+	memcpy(image, &s, sizeof(s));
+	memcpy(image + s.entries, map->entries, sizeof(void *) * map->capacity);
+	if (s.probe_bound != 0) {
+		memcpy(image + s.probe_bound, map->probe_bound,
+		    sizeof(_CK_HS_WORD) * map->capacity);
+	}
+
+	if (s.tags != 0)
+		memcpy(image + s.tags, map->tags, map->capacity);
+
+	ck_hs_unlock_all(hs, map);
+	return true;
+}
+
+/*
+ * Initializes a read-only hash set whose map is the specified image, which
+ * must be aligned to a cache line and remain valid until the set is
+ * destroyed. Only the map descriptor is allocated. The set must not be
+ * modified other than through ck_hs_grow, ck_hs_rebuild, ck_hs_reset or
+ * ck_hs_reset_size, which replace the image with a private map.
+ */
+bool
+ck_hs_init_snapshot(struct ck_hs *hs,
+    ck_hs_hash_cb_t *hf,
+    ck_hs_compare_cb_t *compare,
+    struct ck_malloc *m,
+    const void *buffer,
+    size_t length)
+{
+	const unsigned char *image = buffer;
+	struct ck_hs_snapshot s, t;
+	struct ck_hs_map *map;
+
+	if (m == NULL || m->malloc == NULL || m->free == NULL || hf == NULL)
+		return false;
+
+	if (((uintptr_t)image & (CK_MD_CACHELINE - 1)) != 0 ||
+	    length < sizeof(s))
+		return false;
+
+	memcpy(&s, image, sizeof(s));
+	if (s.magic != CK_HS_SNAPSHOT_MAGIC ||
+	    s.version != CK_HS_SNAPSHOT_VERSION ||
+	    s.layout != CK_HS_SNAPSHOT_LAYOUT ||
+	    s.capacity < _CK_HS_PROBE_L1 ||
+	    (s.capacity & (s.capacity - 1)) != 0 ||
+	    (unsigned long)s.capacity != s.capacity)
+		return false;
+
+	/*
+	 * Only the modes recorded by ck_hs_snapshot may be set, and the
+	 * probe bounds may not exceed the capacity.
+	 */
+	if ((s.mode & ((1U << _CK_HS_MODE_KEY_OFFSET_BITS) - 1) &
+	    ~(uint32_t)CK_HS_SNAPSHOT_MODE) != 0 ||
+	    s.probe_limit > s.capacity || s.probe_maximum > s.capacity)
+		return false;
+
+	/* The recorded offsets must match those implied by the mode. */
+	ck_hs_snapshot_layout(&t, s.capacity, (s.mode & CK_HS_MODE_DELETE) != 0,
+	    (s.mode & CK_HS_MODE_TAG) != 0);
+	if (t.size != s.size || t.entries != s.entries ||
+	    t.probe_bound != s.probe_bound || t.tags != s.tags ||
+	    s.size > length)
+		return false;
+
+	map = m->malloc(sizeof(struct ck_hs_map));
+	if (map == NULL)
+		return false;
+
+	memset(map, 0, sizeof(struct ck_hs_map));
+	map->size = sizeof(struct ck_hs_map);
+	map->probe_limit = s.probe_limit;
+	map->probe_maximum = s.probe_maximum;
+	map->tombstones = s.tombstones;
+	map->capacity = (unsigned long)s.capacity;
+	map->step = ck_cc_ffsl(map->capacity);
+	map->mask = map->capacity - 1;
+	map->n_entries = (uintptr_t)s.n_entries;
+	map->entries = CK_CC_DECONST_PTR(image + s.entries);
+	if (s.probe_bound != 0)
+		map->probe_bound = CK_CC_DECONST_PTR(image + s.probe_bound);
+
+	/* Tags are a hint, and are ignored by builds that do not support them. */
+#ifdef _CK_HS_TAG
+	if (s.tags != 0)
+		map->tags = CK_CC_DECONST_PTR(image + s.tags);
+#else
+	s.mode &= ~(uint32_t)CK_HS_MODE_TAG;
+#endif
+
+	hs->m = m;
+	hs->mode = s.mode | CK_HS_MODE_SPMC;
+	hs->seed = (unsigned long)s.seed;
+	hs->hf = hf;
+	hs->compare = compare;
+	ck_pr_fence_store();
+	ck_pr_store_ptr(&hs->map, map);
+	return true;
+}
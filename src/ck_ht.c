@@ -57,6 +57,14 @@
 #define CK_HT_PROBE_DEFAULT 64ULL
 #endif
 
+/*
+ * Number of lookups ahead of the current one whose probe sequence is
+ * prefetched by ck_ht_get_batch_spmc.
+ */
+#ifndef CK_HT_PREFETCH
+#define CK_HT_PREFETCH 8
+#endif
+
 #if defined(CK_F_PR_LOAD_8) && defined(CK_F_PR_STORE_8)
 #define CK_HT_WORD	    uint8_t
 #define CK_HT_WORD_MAX	    UINT8_MAX
@@ -815,6 +823,53 @@ restart:
 	return true;
 }
 
+CK_CC_INLINE static void
+ck_ht_map_prefetch(struct ck_ht_map *map, ck_ht_hash_t h)
+{
+	CK_HT_TYPE offset = h.value & map->mask;
+
+	CK_CC_PREFETCH(map->entries + offset);
+	if (map->probe_bound != NULL)
+		CK_CC_PREFETCH(map->probe_bound + offset);
+
+	return;
+}
+
+/*
+ * Looks up the keys of n entries. Entries whose key is found are replaced
+ * with a snapshot of the matching entry, others are reset so that
+ * ck_ht_entry_empty returns true. The first bucket of the probe sequence
+ * of a key is prefetched CK_HT_PREFETCH lookups before it is resolved, so
+ * that the cache misses of consecutive lookups overlap. Returns the number
+ * of keys found.
+ */
+size_t
+ck_ht_get_batch_spmc(struct ck_ht *table,
+    const ck_ht_hash_t *h,
+    ck_ht_entry_t *entries,
+    size_t n)
+{
+	struct ck_ht_map *map = ck_pr_load_ptr(&table->map);
+	size_t i, found = 0;
+
+	for (i = 0; i < n && i < CK_HT_PREFETCH; i++)
+		ck_ht_map_prefetch(map, h[i]);
+
+	for (i = 0; i < n; i++) {
+		if (i + CK_HT_PREFETCH < n)
+			ck_ht_map_prefetch(map, h[i + CK_HT_PREFETCH]);
+
+		if (ck_ht_get_spmc(table, h[i], &entries[i]) == true) {
+			found++;
+			continue;
+		}
+
+		entries[i].key = CK_HT_KEY_EMPTY;
+	}
+
+	return found;
+}
+
 bool
 ck_ht_set_spmc(struct ck_ht *table,
     ck_ht_hash_t h,
@@ -0,0 +1,362 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_cc.h>
+#include <ck_ibr.h>
+#include <ck_pr.h>
+#include <ck_stack.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+#include <ck_string.h>
+
+/*
+ * Upper bound on the number of disjoint reservations a reclamation pass
+ * tracks. Beyond it, reservations are coalesced, which may only delay the
+ * reclamation of objects.
+ */
+#ifndef CK_IBR_RESERVATIONS
+#define CK_IBR_RESERVATIONS 32
+#endif
+
+/*
+ * An interval of eras, expressed as ages relative to the era observed by
+ * a reclamation pass so that intervals may be ordered despite wrap-around.
+ */
+struct ck_ibr_interval {
+	unsigned int young;
+	unsigned int old;
+};
+
+enum {
+	CK_IBR_STATE_USED = 0,
+	CK_IBR_STATE_FREE = 1
+};
+
+CK_STACK_CONTAINER(struct ck_ibr_record, record_next,
+    ck_ibr_record_container)
+CK_STACK_CONTAINER(struct ck_ibr_entry, stack_entry,
+    ck_ibr_entry_container)
+
+void
+ck_ibr_init(struct ck_ibr *global)
+{
+
+	ck_stack_init(&global->records);
+	global->era = 1;
+	global->n_free = 0;
+	ck_pr_fence_store();
+	return;
+}
+
+struct ck_ibr_record *
+ck_ibr_recycle(struct ck_ibr *global, void *ct)
+{
+	struct ck_ibr_record *record;
+	ck_stack_entry_t *cursor;
+	unsigned int state;
+
+	if (ck_pr_load_uint(&global->n_free) == 0)
+		return NULL;
+
+	CK_STACK_FOREACH(&global->records, cursor) {
+		record = ck_ibr_record_container(cursor);
+
+		if (ck_pr_load_uint(&record->state) == CK_IBR_STATE_FREE) {
+			/* Serialize with respect to pending list clean-up. */
+			ck_pr_fence_load();
+			state = ck_pr_fas_uint(&record->state,
+			    CK_IBR_STATE_USED);
+			if (state == CK_IBR_STATE_FREE) {
+				ck_pr_dec_uint(&global->n_free);
+				ck_pr_store_ptr(&record->ct, ct);
+				return record;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+void
+ck_ibr_register(struct ck_ibr *global, struct ck_ibr_record *record, void *ct)
+{
+
+	record->global = global;
+	record->state = CK_IBR_STATE_USED;
+	record->active = 0;
+	record->lower = 0;
+	record->upper = 0;
+	record->n_retire = 0;
+	record->n_pending = 0;
+	record->n_peak = 0;
+	record->n_dispatch = 0;
+	record->ct = ct;
+	ck_stack_init(&record->pending);
+
+	ck_pr_fence_store();
+	ck_stack_push_upmc(&global->records, &record->record_next);
+	return;
+}
+
+/*
+ * The record must not have pending objects, which may be reclaimed with
+ * ck_ibr_barrier.
+ */
+void
+ck_ibr_unregister(struct ck_ibr_record *record)
+{
+	struct ck_ibr *global = record->global;
+
+	record->active = 0;
+	record->n_retire = 0;
+	record->n_pending = 0;
+	record->n_peak = 0;
+	record->n_dispatch = 0;
+	ck_stack_init(&record->pending);
+
+	ck_pr_store_ptr(&record->ct, NULL);
+	ck_pr_fence_store();
+	ck_pr_store_uint(&record->state, CK_IBR_STATE_FREE);
+	ck_pr_inc_uint(&global->n_free);
+	return;
+}
+
+/*
+ * Adds an interval to a set of disjoint intervals sorted by age, merging
+ * the intervals it overlaps. If the set is full, the nearest interval is
+ * widened to cover it instead. Returns the new size of the set.
+ */
+static unsigned int
+ck_ibr_interval_add(struct ck_ibr_interval *set, unsigned int n,
+    unsigned int young, unsigned int old)
+{
+	unsigned int i, j;
+
+	for (i = 0; i < n && set[i].old < young; i++);
+
+	for (j = i; j < n && set[j].young <= old; j++) {
+		if (set[j].young < young)
+			young = set[j].young;
+
+		if (set[j].old > old)
+			old = set[j].old;
+	}
+
+	if (j > i) {
+		set[i].young = young;
+		set[i].old = old;
+		memmove(&set[i + 1], &set[j], sizeof(*set) * (n - j));
+		return n - (j - i) + 1;
+	}
+
+	if (n == CK_IBR_RESERVATIONS) {
+		if (i == n) {
+			set[n - 1].old = old;
+		} else {
+			set[i].young = young;
+		}
+
+		return n;
+	}
+
+	memmove(&set[i + 1], &set[i], sizeof(*set) * (n - i));
+	set[i].young = young;
+	set[i].old = old;
+	return n + 1;
+}
+
+/*
+ * Returns true if the lifetime of the object, in ages, overlaps an
+ * interval of the set.
+ */
+static bool
+ck_ibr_interval_test(const struct ck_ibr_interval *set, unsigned int n,
+    unsigned int young, unsigned int old)
+{
+	unsigned int lo = 0, hi = n, mid;
+
+	/* Find the youngest interval that is not younger than the object. */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (set[mid].old < young) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo < n && set[lo].young <= old;
+}
+
+/*
+ * Snapshots the reservations of every active section as intervals of
+ * ages relative to era. Every pending object was retired no later than
+ * era, so a reservation beginning after it is ignored and one extending
+ * past it is truncated.
+ */
+static unsigned int
+ck_ibr_snapshot(struct ck_ibr *global, struct ck_ibr_interval *set,
+    unsigned int era)
+{
+	struct ck_ibr_record *cr;
+	ck_stack_entry_t *cursor;
+	unsigned int lower, upper, n = 0;
+
+	CK_STACK_FOREACH(&global->records, cursor) {
+		cr = ck_ibr_record_container(cursor);
+
+		if (ck_pr_load_uint(&cr->state) == CK_IBR_STATE_FREE ||
+		    ck_pr_load_uint(&cr->active) == 0)
+			continue;
+
+		/* The reservation is published before the active flag. */
+		ck_pr_fence_load();
+		lower = ck_pr_load_uint(&cr->lower);
+		upper = ck_pr_load_uint(&cr->upper);
+		if ((int)(lower - era) > 0)
+			continue;
+
+		if ((int)(upper - era) > 0)
+			upper = era;
+
+		n = ck_ibr_interval_add(set, n, era - upper, era - lower);
+	}
+
+	return n;
+}
+
+/*
+ * The reservations are snapshotted once per pass, so that a pass costs
+ * a single scan of the records rather than one per pending object.
+ */
+unsigned int
+ck_ibr_reclaim(struct ck_ibr_record *record)
+{
+	struct ck_ibr_interval set[CK_IBR_RESERVATIONS];
+	struct ck_ibr *global = record->global;
+	struct ck_ibr_entry *entry;
+	ck_stack_entry_t *head, *next, *cursor;
+	unsigned int era, n = 0, n_set;
+
+	/* Order the scan of reservations after prior retirements. */
+	ck_pr_fence_memory();
+	era = ck_pr_load_uint(&global->era);
+	n_set = ck_ibr_snapshot(global, set, era);
+
+	head = ck_stack_batch_pop_npsc(&record->pending);
+	for (cursor = head; cursor != NULL; cursor = next) {
+		entry = ck_ibr_entry_container(cursor);
+		next = CK_STACK_NEXT(cursor);
+
+		if (ck_ibr_interval_test(set, n_set, era - entry->retire,
+		    era - entry->birth) == true) {
+			ck_stack_push_spnc(&record->pending, cursor);
+			continue;
+		}
+
+		entry->function(entry);
+		n++;
+	}
+
+	if (record->n_pending > record->n_peak)
+		record->n_peak = record->n_pending;
+
+	record->n_pending -= n;
+	record->n_dispatch += n;
+	return n;
+}
+
+void
+ck_ibr_retire(struct ck_ibr_record *record,
+    struct ck_ibr_entry *entry,
+    ck_ibr_cb_t *function)
+{
+	struct ck_ibr *global = record->global;
+
+	/*
+	 * The object must be unreachable before its retirement era is
+	 * observed, so that any section that may still hold a reference
+	 * has a reservation reaching the retirement era.
+	 */
+	ck_pr_fence_memory();
+	entry->retire = ck_pr_load_uint(&global->era);
+	entry->function = function;
+	ck_stack_push_spnc(&record->pending, &entry->stack_entry);
+
+	if (++record->n_retire >= CK_IBR_FREQUENCY) {
+		record->n_retire = 0;
+		ck_pr_inc_uint(&global->era);
+	}
+
+	if (++record->n_pending >= CK_IBR_THRESHOLD)
+		ck_ibr_reclaim(record);
+
+	return;
+}
+
+void
+ck_ibr_synchronize(struct ck_ibr_record *record)
+{
+	struct ck_ibr *global = record->global;
+	struct ck_ibr_record *cr;
+	ck_stack_entry_t *cursor;
+	unsigned int era;
+
+	/*
+	 * Sections that begin after the era is advanced reserve the new
+	 * era, so only sections with an older lower bound are waited on.
+	 */
+	ck_pr_fence_memory();
+	era = ck_pr_faa_uint(&global->era, 1) + 1;
+	ck_pr_fence_atomic_load();
+
+	CK_STACK_FOREACH(&global->records, cursor) {
+		cr = ck_ibr_record_container(cursor);
+
+		if (ck_pr_load_uint(&cr->state) == CK_IBR_STATE_FREE)
+			continue;
+
+		while (ck_pr_load_uint(&cr->active) != 0) {
+			ck_pr_fence_load();
+			if ((int)(ck_pr_load_uint(&cr->lower) - era) >= 0)
+				break;
+
+			ck_pr_stall();
+		}
+	}
+
+	ck_pr_fence_memory();
+	return;
+}
+
+void
+ck_ibr_barrier(struct ck_ibr_record *record)
+{
+
+	ck_ibr_synchronize(record);
+	ck_ibr_reclaim(record);
+	return;
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_cc.h>
+#include <ck_epoch.h>
+#include <ck_malloc.h>
+#include <ck_md.h>
+#include <ck_pool.h>
+#include <ck_pr.h>
+#include <ck_stack.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+#include <ck_string.h>
+
+/*
+ * Deferred objects may still be read, so they are tracked by a separate
+ * node allocated from the cache rather than overlaid with an epoch entry.
+ */
+struct ck_pool_deferred {
+	ck_epoch_entry_t epoch_entry;
+	struct ck_pool *pool;
+	void *object;
+	size_t size;
+};
+CK_EPOCH_CONTAINER(struct ck_pool_deferred, epoch_entry,
+    ck_pool_deferred_container)
+
+/* Slabs are linked through a header padded to a cache line. */
+#define CK_POOL_SLAB_HEADER						\
+	((sizeof(ck_stack_entry_t) + CK_MD_CACHELINE - 1) &		\
+	    ~(size_t)(CK_MD_CACHELINE - 1))
+
+CK_CC_INLINE static size_t
+ck_pool_class_size(unsigned int c)
+{
+
+	return CK_POOL_CLASS_MIN << c;
+}
+
+bool
+ck_pool_init(struct ck_pool *pool, struct ck_malloc *m)
+{
+	unsigned int i;
+
+	if (m == NULL || m->malloc == NULL || m->free == NULL)
+		return false;
+
+	for (i = 0; i < CK_POOL_CLASSES; i++)
+		ck_stack_init(&pool->classes[i].free);
+
+	ck_stack_init(&pool->slabs);
+	pool->m = m;
+	return true;
+}
+
+/*
+ * Releases every slab of the pool. No objects of the pool may be in use,
+ * and caches must not be used afterwards.
+ */
+void
+ck_pool_deinit(struct ck_pool *pool)
+{
+	ck_stack_entry_t *slab, *next;
+	unsigned int i;
+
+	for (slab = ck_stack_batch_pop_npsc(&pool->slabs); slab != NULL;
+	    slab = next) {
+		next = slab->next;
+		pool->m->free(slab, CK_POOL_SLAB_SIZE, false);
+	}
+
+	for (i = 0; i < CK_POOL_CLASSES; i++)
+		ck_stack_init(&pool->classes[i].free);
+
+	return;
+}
+
+void
+ck_pool_cache_init(struct ck_pool_cache *cache,
+    struct ck_pool *pool,
+    ck_epoch_record_t *record)
+{
+	unsigned int i, limit;
+
+	cache->pool = pool;
+	cache->record = record;
+	for (i = 0; i < CK_POOL_CLASSES; i++) {
+		limit = CK_POOL_CACHE_SIZE / ck_pool_class_size(i);
+		cache->lists[i].head = NULL;
+		cache->lists[i].n_entries = 0;
+		cache->lists[i].limit = limit > 2 ? limit : 2;
+	}
+
+	return;
+}
+
+/*
+ * Pushes a chain of objects onto a shared free list with a single atomic
+ * operation. Shared free lists are only ever emptied by batch pops, so
+ * the head of the list is not subject to ABA.
+ */
+static void
+ck_pool_give(struct ck_pool *pool,
+    unsigned int c,
+    ck_stack_entry_t *first,
+    ck_stack_entry_t *last)
+{
+	ck_stack_t *target = &pool->classes[c].free;
+	ck_stack_entry_t *head;
+
+	head = ck_pr_load_ptr(&target->head);
+	last->next = head;
+	ck_pr_fence_store();
+
+	while (ck_pr_cas_ptr_value(&target->head, head, first,
+	    &head) == false) {
+		last->next = head;
+		ck_pr_fence_store();
+	}
+
+	return;
+}
+
+/* Returns every object held by the cache to the pool. */
+void
+ck_pool_cache_flush(struct ck_pool_cache *cache)
+{
+	struct ck_pool_list *list;
+	ck_stack_entry_t *last;
+	unsigned int i;
+
+	for (i = 0; i < CK_POOL_CLASSES; i++) {
+		list = &cache->lists[i];
+		if (list->head == NULL)
+			continue;
+
+		for (last = list->head; last->next != NULL; last = last->next);
+		ck_pool_give(cache->pool, i, list->head, last);
+		list->head = NULL;
+		list->n_entries = 0;
+	}
+
+	return;
+}
+
+/*
+ * Returns the least recently freed half of a size class of the cache to
+ * the pool, keeping the objects most likely to be in cache.
+ */
+void
+ck_pool_drain(struct ck_pool_cache *cache, unsigned int c)
+{
+	struct ck_pool_list *list = &cache->lists[c];
+	ck_stack_entry_t *cut, *last;
+	unsigned int i, keep = list->n_entries / 2;
+
+	cut = list->head;
+	for (i = 1; i < keep; i++)
+		cut = cut->next;
+
+	for (last = cut->next; last->next != NULL; last = last->next);
+	ck_pool_give(cache->pool, c, cut->next, last);
+	cut->next = NULL;
+	list->n_entries = keep;
+	return;
+}
+
+/* Carves a new slab into a list of objects of the specified class. */
+static ck_stack_entry_t *
+ck_pool_slab(struct ck_pool *pool, unsigned int c)
+{
+	size_t size = ck_pool_class_size(c);
+	ck_stack_entry_t *slab, *head = NULL, *object;
+	char *p;
+
+	slab = pool->m->malloc(CK_POOL_SLAB_SIZE);
+	if (slab == NULL)
+		return NULL;
+
+	ck_stack_push_upmc(&pool->slabs, slab);
+
+	/* Objects are linked in address order. */
+	p = (char *)slab + CK_POOL_SLAB_HEADER;
+	p += (CK_POOL_SLAB_SIZE - CK_POOL_SLAB_HEADER) / size * size;
+	while (p != (char *)slab + CK_POOL_SLAB_HEADER) {
+		p -= size;
+		object = (ck_stack_entry_t *)(void *)p;
+		object->next = head;
+		head = object;
+	}
+
+	return head;
+}
+
+/*
+ * Refills an empty size class of the cache, preferably with objects freed
+ * to the pool by other threads, and returns an object from it.
+ */
+void *
+ck_pool_refill(struct ck_pool_cache *cache, unsigned int c)
+{
+	struct ck_pool_list *list = &cache->lists[c];
+	ck_stack_entry_t *object, *cursor;
+	unsigned int n = 0;
+
+	object = ck_stack_batch_pop_upmc(&cache->pool->classes[c].free);
+	if (object == NULL) {
+		object = ck_pool_slab(cache->pool, c);
+		if (object == NULL)
+			return NULL;
+	}
+
+	/* Order with respect to next pointers published by ck_pool_give. */
+	ck_pr_fence_load();
+	for (cursor = object->next; cursor != NULL; cursor = cursor->next)
+		n++;
+
+	list->head = object->next;
+	list->n_entries = n;
+	return object;
+}
+
+void *
+ck_pool_malloc_large(struct ck_pool_cache *cache, size_t size)
+{
+
+	return cache->pool->m->malloc(size);
+}
+
+/*
+ * Returns an object to the shared free lists of the pool. This is used
+ * from epoch callbacks, which have no cache to free to.
+ */
+static void
+ck_pool_give_object(struct ck_pool *pool, void *p, size_t size)
+{
+	ck_stack_entry_t *object = p;
+
+	if (size > CK_POOL_CLASS_MAX) {
+		pool->m->free(p, size, false);
+		return;
+	}
+
+	ck_pool_give(pool, ck_pool_class(size), object, object);
+	return;
+}
+
+static void
+ck_pool_reclaim(ck_epoch_entry_t *entry)
+{
+	struct ck_pool_deferred *deferred = ck_pool_deferred_container(entry);
+	struct ck_pool *pool = deferred->pool;
+
+	ck_pool_give_object(pool, deferred->object, deferred->size);
+	ck_pool_give_object(pool, deferred, sizeof *deferred);
+	return;
+}
+
+void
+ck_pool_free_slow(struct ck_pool_cache *cache,
+    void *p,
+    size_t size,
+    bool defer)
+{
+	struct ck_pool_deferred *deferred;
+
+	if (defer == true && cache->record != NULL) {
+		deferred = ck_pool_malloc(cache, sizeof *deferred);
+		if (deferred != NULL) {
+			deferred->pool = cache->pool;
+			deferred->object = p;
+			deferred->size = size;
+			ck_epoch_call(cache->record, &deferred->epoch_entry,
+			    ck_pool_reclaim);
+			return;
+		}
+
+		/*
+		 * Out of memory, so wait out a grace period instead. The
+		 * record must not be in a read-side section.
+		 */
+		ck_epoch_synchronize(cache->record);
+		defer = false;
+	}
+
+	if (size > CK_POOL_CLASS_MAX) {
+		/* Without a record, the backing allocator may defer. */
+		cache->pool->m->free(p, size, defer);
+		return;
+	}
+
+	ck_pool_free(cache, p, size, false);
+	return;
+}
+
+void *
+ck_pool_realloc(struct ck_pool_cache *cache,
+    void *p,
+    size_t old_size,
+    size_t new_size,
+    bool defer)
+{
+	void *r;
+
+	if (p != NULL && old_size <= CK_POOL_CLASS_MAX &&
+	    new_size <= CK_POOL_CLASS_MAX &&
+	    ck_pool_class(old_size) == ck_pool_class(new_size))
+		return p;
+
+	r = ck_pool_malloc(cache, new_size);
+	if (r == NULL)
+		return NULL;
+
+	if (p != NULL) {
+		memcpy(r, p, old_size < new_size ? old_size : new_size);
+		ck_pool_free(cache, p, old_size, defer);
+	}
+
+	return r;
+}
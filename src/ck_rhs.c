@@ -52,6 +52,8 @@
 	((void *)((uintptr_t)(x) & CK_RHS_VMA_MASK))
 
 #define CK_RHS_EMPTY     NULL
+/* Marks a migrated slot, only found in a map being drained. */
+#define CK_RHS_TOMBSTONE ((void *)~(uintptr_t)0)
 #define CK_RHS_G		(1024)
 #define CK_RHS_G_MASK	(CK_RHS_G - 1)
 
@@ -76,6 +78,22 @@
 
 #define CK_RHS_MAX_WANTED	0xffff
 
+/*
+ * Number of slots of a map being drained that are migrated by every
+ * write operation in CK_RHS_MODE_INCREMENTAL.
+ */
+#ifndef CK_RHS_MIGRATE
+#define CK_RHS_MIGRATE 64
+#endif /* CK_RHS_MIGRATE */
+
+/*
+ * Number of lookups ahead of the current one whose probe sequence is
+ * prefetched by ck_rhs_get_batch.
+ */
+#ifndef CK_RHS_PREFETCH
+#define CK_RHS_PREFETCH 8
+#endif /* CK_RHS_PREFETCH */
+
 enum ck_rhs_probe_behavior {
 	CK_RHS_PROBE = 0,	/* Default behavior. */
 	CK_RHS_PROBE_RH,	/* Short-circuit if RH slot found. */
@@ -129,6 +147,8 @@ struct ck_rhs_map {
 	} entries;
 	bool read_mostly;
 	ck_rhs_probe_cb_t *probe_func;
+	struct ck_rhs_map *drain;
+	unsigned long drained;
 };
 
 static CK_CC_INLINE const void *
@@ -247,6 +267,10 @@ ck_rhs_unset_rh(struct ck_rhs_map *map, long offset)
 
 static ck_rhs_probe_cb_t ck_rhs_map_probe;
 static ck_rhs_probe_cb_t ck_rhs_map_probe_rm;
+static bool ck_rhs_put_internal(struct ck_rhs *, unsigned long,
+    const void *, enum ck_rhs_probe_behavior);
+static inline const void *ck_rhs_marshal(unsigned int, const void *,
+    unsigned long);
 
 bool
 ck_rhs_set_load_factor(struct ck_rhs *hs, unsigned int load_factor)
@@ -275,29 +299,38 @@ ck_rhs_iterator_init(struct ck_rhs_iterator *iterator)
 	return;
 }
 
+/*
+ * Offsets past the end of the map continue into the map it is draining,
+ * if any.
+ */
 bool
 ck_rhs_next(struct ck_rhs *hs, struct ck_rhs_iterator *i, void **key)
 {
 	struct ck_rhs_map *map = hs->map;
+	unsigned long base = 0;
 	void *value;
 
-	if (i->offset >= map->capacity)
-		return false;
+	for (;;) {
+		if (i->offset - base >= map->capacity) {
+			base += map->capacity;
+			map = map->drain;
+			if (map == NULL)
+				return false;
 
-	do {
-		value = CK_CC_DECONST_PTR(ck_rhs_entry(map, i->offset));
-		if (value != CK_RHS_EMPTY) {
+			continue;
+		}
+
+		value = CK_CC_DECONST_PTR(ck_rhs_entry(map, i->offset - base));
+		i->offset++;
+		if (value != CK_RHS_EMPTY && value != CK_RHS_TOMBSTONE) {
 #ifdef CK_RHS_PP
 			if (hs->mode & CK_RHS_MODE_OBJECT)
 				value = CK_RHS_VMA(value);
 #endif
-			i->offset++;
 			*key = value;
 			return true;
 		}
-	} while (++i->offset < map->capacity);
-
-	return false;
+	}
 }
 
 void
@@ -307,14 +340,26 @@ ck_rhs_stat(struct ck_rhs *hs, struct ck_rhs_stat *st)
 
 	st->n_entries = map->n_entries;
 	st->probe_maximum = map->probe_maximum;
+
+	map = map->drain;
+	if (map != NULL) {
+		st->n_entries += map->n_entries;
+		if (map->probe_maximum > st->probe_maximum)
+			st->probe_maximum = map->probe_maximum;
+	}
+
 	return;
 }
 
 unsigned long
 ck_rhs_count(struct ck_rhs *hs)
 {
+	struct ck_rhs_map *map = hs->map;
+
+	if (map->drain != NULL)
+		return map->n_entries + map->drain->n_entries;
 
-	return hs->map->n_entries;
+	return map->n_entries;
 }
 
 static void
@@ -325,11 +370,25 @@ ck_rhs_map_destroy(struct ck_malloc *m, struct ck_rhs_map *map, bool defer)
 	return;
 }
 
+/*
+ * Destroys a map along with the map it is draining, if any.
+ */
+static void
+ck_rhs_map_release(struct ck_malloc *m, struct ck_rhs_map *map, bool defer)
+{
+
+	if (map->drain != NULL)
+		ck_rhs_map_destroy(m, map->drain, defer);
+
+	ck_rhs_map_destroy(m, map, defer);
+	return;
+}
+
 void
 ck_rhs_destroy(struct ck_rhs *hs)
 {
 
-	ck_rhs_map_destroy(hs->m, hs->map, false);
+	ck_rhs_map_release(hs->m, hs->map, false);
 	return;
 }
 
@@ -382,6 +441,8 @@ ck_rhs_map_init(struct ck_rhs *hs, struct ck_rhs_map *map, unsigned long entries
 	map->step = ck_cc_ffsl(n_entries);
 	map->mask = n_entries - 1;
 	map->n_entries = 0;
+	map->drain = NULL;
+	map->drained = 0;
 
 	map->max_entries = (map->capacity * (unsigned long)hs->load_factor) / 100;
 	/* Align map allocation to cache line. */
@@ -436,7 +497,7 @@ ck_rhs_reset_size(struct ck_rhs *hs, unsigned long capacity)
 		return false;
 
 	ck_pr_store_ptr(&hs->map, map);
-	ck_rhs_map_destroy(hs->m, previous, true);
+	ck_rhs_map_release(hs->m, previous, true);
 	return true;
 }
 
@@ -461,7 +522,7 @@ ck_rhs_reset_preallocated(struct ck_rhs *hs,
 	ck_rhs_map_init(hs, map, capacity);
 
 	ck_pr_store_ptr(&hs->map, map);
-	ck_rhs_map_destroy(hs->m, previous, true);
+	ck_rhs_map_release(hs->m, previous, true);
 	return;
 }
 
@@ -534,13 +595,94 @@ ck_rhs_map_bound_get(struct ck_rhs_map *m, unsigned long h)
 	return r;
 }
 
+/*
+ * Inserts an entry into a map that has not yet been published, displacing
+ * entries as necessary. Returns false if the probe limit of the map has
+ * been reached, in which case the map is left in an inconsistent state.
+ */
+static bool
+ck_rhs_map_insert(struct ck_rhs *hs,
+    struct ck_rhs_map *map,
+    unsigned long h,
+    const void *insert)
+{
+	const void *previous;
+	unsigned long offset, probes;
+
+	offset = h & map->mask;
+	probes = 0;
+
+	for (;;) {
+		const void **cursor = ck_rhs_entry_addr(map, offset);
+
+		if (probes++ == map->probe_limit)
+			return false;
+
+		if (CK_CC_LIKELY(*cursor == CK_RHS_EMPTY)) {
+			*cursor = insert;
+			map->n_entries++;
+			ck_rhs_set_probes(map, offset, probes);
+			ck_rhs_map_bound_set(map, h, probes);
+			return true;
+		} else if (ck_rhs_probes(map, offset) < probes) {
+			const void *tmp = insert;
+			unsigned int old_probes;
+			insert = previous = *cursor;
+#ifdef CK_RHS_PP
+			if (hs->mode & CK_RHS_MODE_OBJECT)
+				previous = CK_RHS_VMA(previous);
+#endif
+			*cursor = tmp;
+			ck_rhs_map_bound_set(map, h, probes);
+			h = hs->hf(previous, hs->seed);
+			old_probes = ck_rhs_probes(map, offset);
+			ck_rhs_set_probes(map, offset, probes);
+			probes = old_probes - 1;
+			continue;
+		}
+		ck_rhs_wanted_inc(map, offset);
+		offset = ck_rhs_map_probe_next(map, offset,  probes);
+	}
+}
+
+/*
+ * Rehashes the entries of a map, along with those of the map it is
+ * draining, if any, into a map that has not yet been published.
+ */
+static bool
+ck_rhs_map_rehash(struct ck_rhs *hs,
+    struct ck_rhs_map *map,
+    struct ck_rhs_map *update)
+{
+	struct ck_rhs_map *source;
+	const void *previous, *prev_saved;
+	unsigned long k, h;
+
+	for (source = map; source != NULL; source = source->drain) {
+		for (k = 0; k < source->capacity; k++) {
+			prev_saved = previous = ck_rhs_entry(source, k);
+			if (previous == CK_RHS_EMPTY || previous == CK_RHS_TOMBSTONE)
+				continue;
+
+#ifdef CK_RHS_PP
+			if (hs->mode & CK_RHS_MODE_OBJECT)
+				previous = CK_RHS_VMA(previous);
+#endif
+
+			h = hs->hf(previous, hs->seed);
+			if (ck_rhs_map_insert(hs, update, h, prev_saved) == false)
+				return false;
+		}
+	}
+
+	return true;
+}
+
 bool
 ck_rhs_grow(struct ck_rhs *hs,
     unsigned long capacity)
 {
 	struct ck_rhs_map *map, *update;
-	const void *previous, *prev_saved;
-	unsigned long k, offset, probes;
 
 restart:
 	map = hs->map;
@@ -551,66 +693,106 @@ restart:
 	if (update == NULL)
 		return false;
 
-	for (k = 0; k < map->capacity; k++) {
-		unsigned long h;
+	if (ck_rhs_map_rehash(hs, map, update) == false) {
+		/*
+		 * We have hit the probe limit, map needs to be even larger.
+		 */
+		ck_rhs_map_destroy(hs->m, update, false);
+		capacity <<= 1;
+		goto restart;
+	}
 
-		prev_saved = previous = ck_rhs_entry(map, k);
-		if (previous == CK_RHS_EMPTY)
-			continue;
+	ck_pr_fence_store();
+	ck_pr_store_ptr(&hs->map, update);
+	ck_rhs_map_release(hs->m, map, true);
+	return true;
+}
 
-#ifdef CK_RHS_PP
-		if (hs->mode & CK_RHS_MODE_OBJECT)
-			previous = CK_RHS_VMA(previous);
-#endif
+struct ck_rhs_bulk_entry {
+	unsigned long h;
+	const void *insert;
+};
 
-		h = hs->hf(previous, hs->seed);
-		offset = h & update->mask;
-		probes = 0;
+/*
+ * Builds a map sized for the current entries and the n new keys in a single
+ * allocation, avoiding the repeated growth and concurrency overhead of
+ * individual insertions. The new keys are first scattered in order of the
+ * cache line of their home slot, so that the map is populated front to back.
+ */
+bool
+ck_rhs_put_bulk(struct ck_rhs *hs,
+    const unsigned long *hashes,
+    const void *const *keys,
+    size_t n)
+{
+	struct ck_rhs_map *map, *update;
+	struct ck_rhs_bulk_entry *sorted;
+	unsigned long capacity, groups, shift, g, i;
+	unsigned long *count;
+	bool r;
 
-		for (;;) {
-			const void **cursor = ck_rhs_entry_addr(update, offset);
+	map = hs->map;
+	capacity = ((ck_rhs_count(hs) + n) * 100) / hs->load_factor + 1;
+	if (capacity < map->capacity)
+		capacity = map->capacity;
 
-			if (probes++ == update->probe_limit) {
-				/*
-				 * We have hit the probe limit, map needs to be even larger.
-				 */
-				ck_rhs_map_destroy(hs->m, update, false);
-				capacity <<= 1;
-				goto restart;
-			}
+	sorted = hs->m->malloc(sizeof(struct ck_rhs_bulk_entry) * (n + 1));
+	if (sorted == NULL)
+		return false;
 
-			if (CK_CC_LIKELY(*cursor == CK_RHS_EMPTY)) {
-				*cursor = prev_saved;
-				update->n_entries++;
-				ck_rhs_set_probes(update, offset, probes);
-				ck_rhs_map_bound_set(update, h, probes);
-				break;
-			} else if (ck_rhs_probes(update, offset) < probes) {
-				const void *tmp = prev_saved;
-				unsigned int old_probes;
-				prev_saved = previous = *cursor;
-#ifdef CK_RHS_PP
-				if (hs->mode & CK_RHS_MODE_OBJECT)
-					previous = CK_RHS_VMA(previous);
-#endif
-				*cursor = tmp;
-				ck_rhs_map_bound_set(update, h, probes);
-				h = hs->hf(previous, hs->seed);
-				old_probes = ck_rhs_probes(update, offset);
-				ck_rhs_set_probes(update, offset, probes);
-				probes = old_probes - 1;
-				continue;
-			}
-			ck_rhs_wanted_inc(update, offset);
-			offset = ck_rhs_map_probe_next(update, offset,  probes);
-		}
+restart:
+	update = ck_rhs_map_create(hs, capacity);
+	if (update == NULL) {
+		r = false;
+		goto leave;
+	}
+
+	shift = ck_cc_ffsl((unsigned long)update->offset_mask + 1) - 1;
+	groups = update->capacity >> shift;
+	count = hs->m->malloc(sizeof(unsigned long) * (groups + 1));
+	if (count == NULL) {
+		ck_rhs_map_destroy(hs->m, update, false);
+		r = false;
+		goto leave;
+	}
+
+	memset(count, 0, sizeof(unsigned long) * (groups + 1));
+	for (i = 0; i < n; i++)
+		count[((hashes[i] & update->mask) >> shift) + 1]++;
 
+	for (g = 1; g < groups; g++)
+		count[g] += count[g - 1];
+
+	for (i = 0; i < n; i++) {
+		g = (hashes[i] & update->mask) >> shift;
+		sorted[count[g]].h = hashes[i];
+		sorted[count[g]].insert = ck_rhs_marshal(hs->mode, keys[i],
+		    hashes[i]);
+		count[g]++;
+	}
+
+	hs->m->free(count, sizeof(unsigned long) * (groups + 1), false);
+
+	r = ck_rhs_map_rehash(hs, map, update);
+	for (i = 0; r == true && i < n; i++)
+		r = ck_rhs_map_insert(hs, update, sorted[i].h, sorted[i].insert);
+
+	if (r == false) {
+		/*
+		 * We have hit the probe limit, map needs to be even larger.
+		 */
+		capacity = update->capacity << 1;
+		ck_rhs_map_destroy(hs->m, update, false);
+		goto restart;
 	}
 
 	ck_pr_fence_store();
 	ck_pr_store_ptr(&hs->map, update);
-	ck_rhs_map_destroy(hs->m, map, true);
-	return true;
+	ck_rhs_map_release(hs->m, map, true);
+
+leave:
+	hs->m->free(sorted, sizeof(struct ck_rhs_bulk_entry) * (n + 1), false);
+	return r;
 }
 
 bool
@@ -620,6 +802,35 @@ ck_rhs_rebuild(struct ck_rhs *hs)
 	return ck_rhs_grow(hs, hs->map->capacity);
 }
 
+/*
+ * Grows a map that has exceeded its load factor. In CK_RHS_MODE_INCREMENTAL,
+ * a map of twice the capacity is published immediately and the entries of
+ * the previous map are migrated by subsequent write operations. A map that
+ * is draining another is not grown for load.
+ */
+static void
+ck_rhs_map_expand(struct ck_rhs *hs, struct ck_rhs_map *map)
+{
+	struct ck_rhs_map *update;
+
+	if (map->n_entries <= map->max_entries || map->drain != NULL)
+		return;
+
+	if ((hs->mode & CK_RHS_MODE_INCREMENTAL) == 0) {
+		ck_rhs_grow(hs, map->capacity << 1);
+		return;
+	}
+
+	update = ck_rhs_map_create(hs, map->capacity << 1);
+	if (update == NULL)
+		return;
+
+	update->drain = map;
+	ck_pr_fence_store();
+	ck_pr_store_ptr(&hs->map, update);
+	return;
+}
+
 static long
 ck_rhs_map_probe_rm(struct ck_rhs *hs,
     struct ck_rhs_map *map,
@@ -677,6 +888,11 @@ ck_rhs_map_probe_rm(struct ck_rhs *hs,
 		if (k == CK_RHS_EMPTY)
 			goto leave;
 
+		if (CK_CC_UNLIKELY(k == CK_RHS_TOMBSTONE)) {
+			offset = ck_rhs_map_probe_next(map, offset, probes);
+			continue;
+		}
+
 		if (behavior != CK_RHS_PROBE_NO_RH) {
 			struct ck_rhs_entry_desc *desc = (void *)&map->entries.no_entries.descs[offset];
 
@@ -791,6 +1007,11 @@ ck_rhs_map_probe(struct ck_rhs *hs,
 		k = ck_pr_load_ptr(&map->entries.descs[offset].entry);
 		if (k == CK_RHS_EMPTY)
 			goto leave;
+
+		if (CK_CC_UNLIKELY(k == CK_RHS_TOMBSTONE)) {
+			offset = ck_rhs_map_probe_next(map, offset, probes);
+			continue;
+		}
 		if ((behavior != CK_RHS_PROBE_NO_RH)) {
 			struct ck_rhs_entry_desc *desc = &map->entries.descs[offset];
 
@@ -1119,6 +1340,101 @@ ck_rhs_do_backward_shift_delete(struct ck_rhs *hs, long slot)
 	desc->probes = 0;
 }
 
+/*
+ * Moves the entry in the specified slot of the map being drained into
+ * the map. The entry is visible in the map before concurrent probes of
+ * the drained map are signaled to restart and the slot is retired.
+ * A probe failure in the map rehashes both maps, in which case the
+ * entry has already been moved.
+ */
+static bool
+ck_rhs_migrate_slot(struct ck_rhs *hs, struct ck_rhs_map *map, long slot)
+{
+	struct ck_rhs_map *drain = map->drain;
+	const void *key;
+	unsigned long h;
+
+	key = ck_rhs_entry(drain, slot);
+#ifdef CK_RHS_PP
+	if (hs->mode & CK_RHS_MODE_OBJECT)
+		key = CK_RHS_VMA(key);
+#endif
+
+	h = hs->hf(key, hs->seed);
+	if (ck_rhs_put_internal(hs, h, key, CK_RHS_PROBE_INSERT) == false)
+		return hs->map != map;
+
+	ck_pr_fence_store();
+	ck_pr_inc_uint(&drain->generation[h & CK_RHS_G_MASK]);
+	ck_pr_fence_atomic_store();
+	ck_pr_store_ptr(ck_rhs_entry_addr(drain, slot), CK_RHS_TOMBSTONE);
+	drain->n_entries--;
+	return true;
+}
+
+/*
+ * Migrates up to n slots of the map being drained. Once every slot has
+ * been migrated, the drained map is retired.
+ */
+static bool
+ck_rhs_migrate_step(struct ck_rhs *hs, struct ck_rhs_map *map, unsigned long n)
+{
+	struct ck_rhs_map *drain = map->drain;
+	const void *entry;
+
+	for (; n > 0 && map->drained < drain->capacity; n--) {
+		entry = ck_rhs_entry(drain, map->drained);
+		if (entry != CK_RHS_EMPTY && entry != CK_RHS_TOMBSTONE) {
+			if (ck_rhs_migrate_slot(hs, map, map->drained) == false)
+				return false;
+
+			/* Both maps were rehashed. */
+			if (hs->map != map)
+				return true;
+		}
+
+		map->drained++;
+	}
+
+	if (map->drained == drain->capacity) {
+		ck_pr_store_ptr(&map->drain, NULL);
+		ck_rhs_map_destroy(hs->m, drain, true);
+	}
+
+	return true;
+}
+
+/*
+ * Write operations on a map that is draining another first migrate the
+ * key they operate on, so that it is found in a single map, then advance
+ * the migration by CK_RHS_MIGRATE slots. If migration fails, the maps
+ * are rehashed into one.
+ */
+static bool
+ck_rhs_migrate(struct ck_rhs *hs, unsigned long h, const void *key)
+{
+	struct ck_rhs_map *map = hs->map, *drain = map->drain;
+	const void *object;
+	unsigned long n_probes;
+	long slot, first;
+
+	slot = drain->probe_func(hs, drain, &n_probes, &first, h, key, &object,
+	    ck_rhs_map_bound_get(drain, h), CK_RHS_PROBE_NO_RH);
+	if (object != NULL) {
+		if (ck_rhs_migrate_slot(hs, map, slot) == false)
+			goto flatten;
+
+		if (hs->map != map)
+			return true;
+	}
+
+	if (ck_rhs_migrate_step(hs, map, CK_RHS_MIGRATE) == true)
+		return true;
+
+flatten:
+	return ck_rhs_grow(hs, map->capacity << 1);
+}
+
 bool
 ck_rhs_fas(struct ck_rhs *hs,
     unsigned long h,
@@ -1129,10 +1445,15 @@ ck_rhs_fas(struct ck_rhs *hs,
 	const void *object;
 	const void *insert;
 	unsigned long n_probes;
-	struct ck_rhs_map *map = hs->map;
+	struct ck_rhs_map *map;
 	struct ck_rhs_entry_desc *desc, *desc2;
 
 	*previous = NULL;
+	if (CK_CC_UNLIKELY(hs->map->drain != NULL) &&
+	    ck_rhs_migrate(hs, h, key) == false)
+		return false;
+
+	map = hs->map;
 restart:
 	slot = map->probe_func(hs, map, &n_probes, &first, h, key, &object,
 	    ck_rhs_map_bound_get(map, h), CK_RHS_PROBE);
@@ -1195,6 +1516,10 @@ ck_rhs_apply(struct ck_rhs *hs,
 	struct ck_rhs_map *map;
 	bool delta_set = false;
 
+	if (CK_CC_UNLIKELY(hs->map->drain != NULL) &&
+	    ck_rhs_migrate(hs, h, key) == false)
+		return false;
+
 restart:
 	map = hs->map;
 
@@ -1279,8 +1604,7 @@ restart:
 
 	if (object == NULL) {
 		map->n_entries++;
-		if ((map->n_entries ) > map->max_entries)
-			ck_rhs_grow(hs, map->capacity << 1);
+		ck_rhs_map_expand(hs, map);
 	}
 	return true;
 }
@@ -1298,6 +1622,9 @@ ck_rhs_set(struct ck_rhs *hs,
 	struct ck_rhs_map *map;
 
 	*previous = NULL;
+	if (CK_CC_UNLIKELY(hs->map->drain != NULL) &&
+	    ck_rhs_migrate(hs, h, key) == false)
+		return false;
 
 restart:
 	map = hs->map;
@@ -1357,8 +1684,7 @@ restart:
 
 	if (object == NULL) {
 		map->n_entries++;
-		if ((map->n_entries ) > map->max_entries)
-			ck_rhs_grow(hs, map->capacity << 1);
+		ck_rhs_map_expand(hs, map);
 	}
 
 	*previous = CK_CC_DECONST_PTR(object);
@@ -1416,8 +1742,7 @@ restart:
 	}
 
 	map->n_entries++;
-	if ((map->n_entries ) > map->max_entries)
-		ck_rhs_grow(hs, map->capacity << 1);
+	ck_rhs_map_expand(hs, map);
 	return true;
 }
 
@@ -1427,6 +1752,10 @@ ck_rhs_put(struct ck_rhs *hs,
     const void *key)
 {
 
+	if (CK_CC_UNLIKELY(hs->map->drain != NULL) &&
+	    ck_rhs_migrate(hs, h, key) == false)
+		return false;
+
 	return ck_rhs_put_internal(hs, h, key, CK_RHS_PROBE_INSERT);
 }
 
@@ -1436,6 +1765,10 @@ ck_rhs_put_unique(struct ck_rhs *hs,
     const void *key)
 {
 
+	if (CK_CC_UNLIKELY(hs->map->drain != NULL) &&
+	    ck_rhs_migrate(hs, h, key) == false)
+		return false;
+
 	return ck_rhs_put_internal(hs, h, key, CK_RHS_PROBE_RH);
 }
 
@@ -1446,13 +1779,29 @@ ck_rhs_get(struct ck_rhs *hs,
 {
 	long first;
 	const void *object;
-	struct ck_rhs_map *map;
+	struct ck_rhs_map *map, *drain;
 	unsigned long n_probes;
-	unsigned int g, g_p, probe;
-	unsigned int *generation;
-
+	unsigned int g, g_p, d, d_p, probe;
+	unsigned int *generation, *dg;
+
+	/*
+	 * If the map is draining another, a key that is not found in the
+	 * map is looked up in the drained map. Migration signals the
+	 * drained map once the entry and its probe bound are visible in
+	 * the map, so the generation of the drained map is read first and
+	 * a key that is missed in both maps is retried. A miss on a map
+	 * that has since been replaced is retried, as its entries may
+	 * already have been migrated.
+	 */
 	do {
 		map = ck_pr_load_ptr(&hs->map);
+		drain = ck_pr_load_ptr(&map->drain);
+		if (drain != NULL) {
+			dg = &drain->generation[h & CK_RHS_G_MASK];
+			d = ck_pr_load_uint(dg);
+			ck_pr_fence_load();
+		}
+
 		generation = &map->generation[h & CK_RHS_G_MASK];
 		g = ck_pr_load_uint(generation);
 		probe  = ck_rhs_map_bound_get(map, h);
@@ -1460,14 +1809,55 @@ ck_rhs_get(struct ck_rhs *hs,
 
 		first = -1;
 		map->probe_func(hs, map, &n_probes, &first, h, key, &object, probe, CK_RHS_PROBE_NO_RH);
+		if (object == NULL && drain != NULL) {
+			drain->probe_func(hs, drain, &n_probes, &first, h, key,
+			    &object, ck_rhs_map_bound_get(drain, h),
+			    CK_RHS_PROBE_NO_RH);
+		} else {
+			drain = NULL;
+		}
 
 		ck_pr_fence_load();
 		g_p = ck_pr_load_uint(generation);
-	} while (g != g_p);
+		if (drain != NULL)
+			d_p = ck_pr_load_uint(dg);
+	} while (g != g_p || (drain != NULL && d != d_p) ||
+	    (object == NULL && ck_pr_load_ptr(&hs->map) != map));
 
 	return CK_CC_DECONST_PTR(object);
 }
 
+/*
+ * Looks up n keys, storing the entry matching keys[i] (or NULL) in out[i].
+ * The first slot of the probe sequence of a key, along with its probe
+ * bound, is prefetched CK_RHS_PREFETCH lookups before it is resolved, so
+ * that the cache misses of consecutive lookups overlap.
+ */
+void
+ck_rhs_get_batch(struct ck_rhs *hs,
+    const unsigned long *h,
+    const void *const *keys,
+    void **out,
+    size_t n)
+{
+	struct ck_rhs_map *map = ck_pr_load_ptr(&hs->map);
+	size_t i;
+
+	for (i = 0; i < n && i < CK_RHS_PREFETCH; i++)
+		CK_CC_PREFETCH(ck_rhs_entry_addr(map, h[i] & map->mask));
+
+	for (i = 0; i < n; i++) {
+		if (i + CK_RHS_PREFETCH < n) {
+			CK_CC_PREFETCH(ck_rhs_entry_addr(map,
+			    h[i + CK_RHS_PREFETCH] & map->mask));
+		}
+
+		out[i] = ck_rhs_get(hs, h[i], keys[i]);
+	}
+
+	return;
+}
+
 void *
 ck_rhs_remove(struct ck_rhs *hs,
     unsigned long h,
@@ -1475,9 +1865,29 @@ ck_rhs_remove(struct ck_rhs *hs,
 {
 	long slot, first;
 	const void *object;
-	struct ck_rhs_map *map = hs->map;
+	struct ck_rhs_map *map = hs->map, *drain = map->drain;
 	unsigned long n_probes;
 
+	/*
+	 * A key need not be migrated to be removed. If migration fails,
+	 * it is retried by the next write operation.
+	 */
+	if (CK_CC_UNLIKELY(drain != NULL)) {
+		slot = drain->probe_func(hs, drain, &n_probes, &first, h, key,
+		    &object, ck_rhs_map_bound_get(drain, h), CK_RHS_PROBE_NO_RH);
+		if (object != NULL) {
+			ck_pr_store_ptr(ck_rhs_entry_addr(drain, slot),
+			    CK_RHS_TOMBSTONE);
+			drain->n_entries--;
+		}
+
+		ck_rhs_migrate_step(hs, map, CK_RHS_MIGRATE);
+		if (object != NULL)
+			return CK_CC_DECONST_PTR(object);
+
+		map = hs->map;
+	}
+
 	slot = map->probe_func(hs, map, &n_probes, &first, h, key, &object,
 	    ck_rhs_map_bound_get(map, h), CK_RHS_PROBE_NO_RH);
 	if (object == NULL)
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_pr.h>
+#include <ck_ring.h>
+#include <ck_ring_shm.h>
+#include <ck_stdbool.h>
+
+bool
+ck_ring_shm_valid(const struct ck_ring_shm *shm)
+{
+	const struct ck_ring *ring = &shm->ring;
+	unsigned int size, c_head, p_tail, snapshot;
+
+	if (ck_pr_load_uint(&shm->state) != CK_RING_SHM_MAGIC)
+		return false;
+
+	ck_pr_fence_load();
+	size = shm->size;
+	if (size == 0 || (size & (size - 1)) != 0)
+		return false;
+
+	if (ring->size != size || ring->mask != size - 1)
+		return false;
+
+	/*
+	 * The consumer may release entries and the producer refill them
+	 * between the loads of the two counters, so the counters are only
+	 * compared if the consumer counter did not move across the load of
+	 * the producer counter.
+	 */
+	c_head = ck_pr_load_uint(&ring->c_head);
+	do {
+		snapshot = c_head;
+		ck_pr_fence_load();
+		p_tail = ck_pr_load_uint(&ring->p_tail);
+		ck_pr_fence_load();
+		c_head = ck_pr_load_uint(&ring->c_head);
+	} while (c_head != snapshot);
+
+	/*
+	 * A byte ring can be filled to the last byte and is operated upon in
+	 * units of CK_RING_BYTES_ALIGN, while a ring of entries always keeps
+	 * one slot open.
+	 */
+	if (shm->entry_size == 0) {
+		if (size < CK_RING_BYTES_ALIGN * 2 || p_tail - c_head > size)
+			return false;
+
+		return ((c_head | p_tail) & (CK_RING_BYTES_ALIGN - 1)) == 0;
+	}
+
+	return p_tail - c_head < size;
+}
+
+static void
+ck_ring_shm_publish(struct ck_ring_shm *shm,
+    unsigned int size,
+    unsigned int entry_size)
+{
+
+	shm->size = size;
+	shm->entry_size = entry_size;
+	shm->endpoint[CK_RING_SHM_PRODUCER].owner = 0;
+	shm->endpoint[CK_RING_SHM_PRODUCER].heartbeat = 0;
+	shm->endpoint[CK_RING_SHM_CONSUMER].owner = 0;
+	shm->endpoint[CK_RING_SHM_CONSUMER].heartbeat = 0;
+	ck_ring_init(&shm->ring, size);
+
+	/* The ring must be visible before the segment is ready. */
+	ck_pr_fence_store();
+	ck_pr_store_uint(&shm->state, CK_RING_SHM_MAGIC);
+	return;
+}
+
+static bool
+ck_ring_shm_match(const struct ck_ring_shm *shm,
+    unsigned int size,
+    unsigned int entry_size)
+{
+
+	ck_pr_fence_load();
+	return shm->size == size && shm->entry_size == entry_size &&
+	    ck_ring_shm_valid(shm) == true;
+}
+
+bool
+ck_ring_shm_init(struct ck_ring_shm *shm,
+    unsigned int size,
+    unsigned int entry_size,
+    unsigned int owner)
+{
+	unsigned int i;
+
+	/* A token of 0 cannot be told apart from an unclaimed segment. */
+	if (owner == 0)
+		return false;
+
+	if (ck_pr_cas_uint(&shm->initializer, 0, owner) == true)
+		ck_ring_shm_publish(shm, size, entry_size);
+
+	/*
+	 * The wait is bounded so that a process that terminated while
+	 * initializing the segment does not hang every other process.
+	 */
+	for (i = 0; ck_pr_load_uint(&shm->state) != CK_RING_SHM_MAGIC; i++) {
+		if (i == CK_RING_SHM_INIT_SPIN)
+			return false;
+
+		ck_pr_stall();
+	}
+
+	return ck_ring_shm_match(shm, size, entry_size);
+}
+
+bool
+ck_ring_shm_init_recover(struct ck_ring_shm *shm,
+    unsigned int size,
+    unsigned int entry_size,
+    unsigned int dead,
+    unsigned int owner)
+{
+
+	if (owner == 0 ||
+	    ck_pr_cas_uint(&shm->initializer, dead, owner) == false)
+		return false;
+
+	/* The dead initializer may have published the ring already. */
+	ck_pr_fence_acquire();
+	if (ck_pr_load_uint(&shm->state) != CK_RING_SHM_MAGIC)
+		ck_ring_shm_publish(shm, size, entry_size);
+
+	return ck_ring_shm_match(shm, size, entry_size);
+}
+
+bool
+ck_ring_shm_recover(struct ck_ring_shm *shm,
+    enum ck_ring_shm_role role,
+    unsigned int dead,
+    unsigned int owner)
+{
+
+	if (owner == 0 ||
+	    ck_pr_cas_uint(&shm->endpoint[role].owner, dead, owner) == false)
+		return false;
+
+	ck_pr_fence_acquire();
+	if (role == CK_RING_SHM_PRODUCER)
+		shm->ring.p_head = shm->ring.p_tail;
+
+	return ck_ring_shm_valid(shm);
+}
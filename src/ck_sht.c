@@ -0,0 +1,290 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_cc.h>
+#include <ck_ht.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <ck_sht.h>
+#include <ck_spinlock.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+#include <ck_stdint.h>
+
+CK_CC_INLINE static struct ck_sht_shard *
+ck_sht_shard_get(struct ck_sht *sht, ck_ht_hash_t h)
+{
+
+	return sht->shards[ck_sht_shard(sht, h)];
+}
+
+void
+ck_sht_stat(struct ck_sht *sht, struct ck_ht_stat *st)
+{
+	struct ck_ht_stat shard;
+	unsigned int i;
+
+	st->n_entries = 0;
+	st->probe_maximum = 0;
+
+	for (i = 0; i <= sht->mask; i++) {
+		ck_ht_stat(&sht->shards[i]->table, &shard);
+		st->n_entries += shard.n_entries;
+		if (shard.probe_maximum > st->probe_maximum)
+			st->probe_maximum = shard.probe_maximum;
+	}
+
+	return;
+}
+
+CK_HT_TYPE
+ck_sht_count(struct ck_sht *sht)
+{
+	CK_HT_TYPE n = 0;
+	unsigned int i;
+
+	for (i = 0; i <= sht->mask; i++)
+		n += ck_ht_count(&sht->shards[i]->table);
+
+	return n;
+}
+
+/*
+ * Every shard shares the hash function and seed of the first, so a
+ * hash value selects both a shard and a slot within it.
+ */
+void
+ck_sht_hash(ck_ht_hash_t *h,
+    struct ck_sht *sht,
+    const void *key,
+    uint16_t key_length)
+{
+
+	ck_ht_hash(h, &sht->shards[0]->table, key, key_length);
+	return;
+}
+
+void
+ck_sht_hash_direct(ck_ht_hash_t *h,
+    struct ck_sht *sht,
+    uintptr_t key)
+{
+
+	ck_ht_hash_direct(h, &sht->shards[0]->table, key);
+	return;
+}
+
+static void
+ck_sht_shard_destroy(struct ck_sht_shard *shard)
+{
+
+	ck_ht_destroy(&shard->table);
+	shard->m->free(shard, sizeof(*shard), false);
+	return;
+}
+
+void
+ck_sht_destroy(struct ck_sht *sht)
+{
+	unsigned int i;
+
+	for (i = 0; i <= sht->mask; i++)
+		ck_sht_shard_destroy(sht->shards[i]);
+
+	sht->m->free(sht->shards, sizeof(struct ck_sht_shard *) *
+	    (sht->mask + 1), false);
+	return;
+}
+
+/*
+ * The number of shards must be a power of two. If allocators is not NULL,
+ * shard i and its maps are allocated by allocators[i], otherwise by m.
+ * The initial capacity is that of every shard.
+ */
+bool
+ck_sht_init(struct ck_sht *sht,
+    unsigned int mode,
+    ck_ht_hash_cb_t *h,
+    struct ck_malloc *m,
+    struct ck_malloc **allocators,
+    unsigned int n_shards,
+    CK_HT_TYPE entries,
+    uint64_t seed)
+{
+	struct ck_sht_shard *shard;
+	struct ck_malloc *sm;
+	unsigned int i;
+
+	if (m == NULL || m->malloc == NULL || m->free == NULL)
+		return false;
+
+	if (n_shards == 0 || n_shards > CK_SHT_SHARD_MAX ||
+	    (n_shards & (n_shards - 1)) != 0)
+		return false;
+
+	sht->m = m;
+	sht->mask = n_shards - 1;
+	sht->shards = m->malloc(sizeof(struct ck_sht_shard *) * n_shards);
+	if (sht->shards == NULL)
+		return false;
+
+	for (i = 0; i < n_shards; i++) {
+		sm = allocators != NULL ? allocators[i] : m;
+		if (sm == NULL || sm->malloc == NULL || sm->free == NULL)
+			goto error;
+
+		shard = sm->malloc(sizeof(*shard));
+		if (shard == NULL)
+			goto error;
+
+		shard->m = sm;
+		ck_spinlock_init(&shard->lock);
+		if (ck_ht_init(&shard->table, mode, h, sm, entries, seed) == false) {
+			sm->free(shard, sizeof(*shard), false);
+			goto error;
+		}
+
+		sht->shards[i] = shard;
+	}
+
+	return true;
+
+error:
+	while (i-- > 0)
+		ck_sht_shard_destroy(sht->shards[i]);
+
+	m->free(sht->shards, sizeof(struct ck_sht_shard *) * n_shards, false);
+	return false;
+}
+
+bool
+ck_sht_get(struct ck_sht *sht,
+    ck_ht_hash_t h,
+    ck_ht_entry_t *entry)
+{
+
+	return ck_ht_get_spmc(&ck_sht_shard_get(sht, h)->table, h, entry);
+}
+
+bool
+ck_sht_put(struct ck_sht *sht,
+    ck_ht_hash_t h,
+    ck_ht_entry_t *entry)
+{
+	struct ck_sht_shard *shard = ck_sht_shard_get(sht, h);
+	bool r;
+
+	ck_spinlock_lock(&shard->lock);
+	r = ck_ht_put_spmc(&shard->table, h, entry);
+	ck_spinlock_unlock(&shard->lock);
+	return r;
+}
+
+bool
+ck_sht_set(struct ck_sht *sht,
+    ck_ht_hash_t h,
+    ck_ht_entry_t *entry)
+{
+	struct ck_sht_shard *shard = ck_sht_shard_get(sht, h);
+	bool r;
+
+	ck_spinlock_lock(&shard->lock);
+	r = ck_ht_set_spmc(&shard->table, h, entry);
+	ck_spinlock_unlock(&shard->lock);
+	return r;
+}
+
+bool
+ck_sht_remove(struct ck_sht *sht,
+    ck_ht_hash_t h,
+    ck_ht_entry_t *entry)
+{
+	struct ck_sht_shard *shard = ck_sht_shard_get(sht, h);
+	bool r;
+
+	ck_spinlock_lock(&shard->lock);
+	r = ck_ht_remove_spmc(&shard->table, h, entry);
+	ck_spinlock_unlock(&shard->lock);
+	return r;
+}
+
+/*
+ * Shards are compacted one at a time, so writers of other shards are
+ * not blocked. Returns false if any shard failed to be compacted.
+ */
+bool
+ck_sht_gc(struct ck_sht *sht, unsigned long cycles, unsigned long seed)
+{
+	struct ck_sht_shard *shard;
+	unsigned int i;
+	bool r = true;
+
+	for (i = 0; i <= sht->mask; i++) {
+		shard = sht->shards[i];
+
+		ck_spinlock_lock(&shard->lock);
+		r &= ck_ht_gc(&shard->table, cycles, seed);
+		ck_spinlock_unlock(&shard->lock);
+	}
+
+	return r;
+}
+
+bool
+ck_sht_reset(struct ck_sht *sht)
+{
+	struct ck_sht_shard *shard;
+	unsigned int i;
+	bool r = true;
+
+	for (i = 0; i <= sht->mask; i++) {
+		shard = sht->shards[i];
+
+		ck_spinlock_lock(&shard->lock);
+		r &= ck_ht_reset_spmc(&shard->table);
+		ck_spinlock_unlock(&shard->lock);
+	}
+
+	return r;
+}
+
+bool
+ck_sht_next(struct ck_sht *sht,
+    struct ck_sht_iterator *i,
+    ck_ht_entry_t **entry)
+{
+
+	while (i->shard <= sht->mask) {
+		if (ck_ht_next(&sht->shards[i->shard]->table, &i->iterator,
+		    entry) == true)
+			return true;
+
+		ck_ht_iterator_init(&i->iterator);
+		i->shard++;
+	}
+
+	return false;
+}
@@ -0,0 +1,461 @@
+/*
+ * Copyright 2026 Samy Al Bahra.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <ck_cc.h>
+#include <ck_malloc.h>
+#include <ck_pr.h>
+#include <ck_sl.h>
+#include <ck_stdbool.h>
+#include <ck_stddef.h>
+#include <ck_stdint.h>
+
+/*
+ * The list follows the design of Fraser and of Herlihy and Shavit. A node
+ * is removed by marking the low bit of its next pointers, from the top
+ * level down. Its removal is linearized at the marking of the bottom
+ * level, after which writers traversing the list snip it out of every
+ * level it is linked into. Readers skip over marked nodes without
+ * unlinking them.
+ */
+struct ck_sl_node {
+	const void *object;
+	unsigned int height;
+
+	/*
+	 * A node is released once both its inserter has stopped linking it
+	 * into upper levels and its deleter has marked it. Whichever finishes
+	 * last is responsible for unlinking the node from every level.
+	 */
+	unsigned int pending;
+	struct ck_sl_node *next[];
+};
+
+#define CK_SL_MARK(n) ((struct ck_sl_node *)((uintptr_t)(n) | 1))
+
+CK_CC_INLINE static bool
+ck_sl_marked(const struct ck_sl_node *node)
+{
+
+	return ((uintptr_t)node & 1) != 0;
+}
+
+CK_CC_INLINE static struct ck_sl_node *
+ck_sl_unmark(const struct ck_sl_node *node)
+{
+
+	return (struct ck_sl_node *)((uintptr_t)node & ~(uintptr_t)1);
+}
+
+CK_CC_INLINE static struct ck_sl_node *
+ck_sl_load(struct ck_sl_node *node, unsigned int level)
+{
+
+	return ck_pr_load_ptr(&node->next[level]);
+}
+
+CK_CC_INLINE static size_t
+ck_sl_node_size(unsigned int height)
+{
+
+	return sizeof(struct ck_sl_node) + sizeof(struct ck_sl_node *) * height;
+}
+
+/*
+ * Levels are geometrically distributed with p = 1/4. The seed is shared
+ * by writers without synchronization, as collisions only affect the
+ * quality of the distribution.
+ */
+static unsigned int
+ck_sl_height(struct ck_sl *sl)
+{
+	unsigned int x = ck_pr_load_uint(&sl->seed);
+	unsigned int height = 1;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	ck_pr_store_uint(&sl->seed, x);
+
+	while ((x & 3) == 0 && height < CK_SL_HEIGHT) {
+		height++;
+		x >>= 2;
+	}
+
+	return height;
+}
+
+/*
+ * Stores in preds and succs, for every level, the last node with an
+ * object less than key and the node following it. Marked nodes
+ * encountered along the way are unlinked. Returns true if succs[0]
+ * holds an object equal to key.
+ */
+static bool
+ck_sl_find(struct ck_sl *sl,
+    const void *key,
+    struct ck_sl_node **preds,
+    struct ck_sl_node **succs)
+{
+	struct ck_sl_node *pred, *curr, *succ;
+	unsigned int level;
+
+retry:
+	pred = sl->head;
+	level = CK_SL_HEIGHT;
+	while (level-- > 0) {
+		curr = ck_sl_unmark(ck_sl_load(pred, level));
+		while (curr != NULL) {
+			succ = ck_sl_load(curr, level);
+			if (ck_sl_marked(succ) == true) {
+				if (ck_pr_cas_ptr(&pred->next[level], curr,
+				    ck_sl_unmark(succ)) == false)
+					goto retry;
+
+				curr = ck_sl_unmark(succ);
+				continue;
+			}
+
+			if (sl->compare(curr->object, key) >= 0)
+				break;
+
+			pred = curr;
+			curr = succ;
+		}
+
+		preds[level] = pred;
+		succs[level] = curr;
+	}
+
+	return succs[0] != NULL && sl->compare(succs[0]->object, key) == 0;
+}
+
+/*
+ * Unlinks a marked node from every level. Nodes that compare equal to it
+ * may be ordered differently across levels, so the descent only resumes
+ * from nodes that are strictly less than it. Levels above the node only
+ * serve to locate it.
+ */
+static void
+ck_sl_unlink(struct ck_sl *sl, struct ck_sl_node *node)
+{
+	struct ck_sl_node *start, *pred, *curr, *succ;
+	unsigned int level;
+	int r;
+
+retry:
+	start = sl->head;
+	level = CK_SL_HEIGHT;
+	while (level-- > 0) {
+		pred = start;
+		curr = ck_sl_unmark(ck_sl_load(pred, level));
+		while (curr != NULL) {
+			succ = ck_sl_load(curr, level);
+			if (ck_sl_marked(succ) == true) {
+				if (ck_pr_cas_ptr(&pred->next[level], curr,
+				    ck_sl_unmark(succ)) == false)
+					goto retry;
+
+				curr = ck_sl_unmark(succ);
+				continue;
+			}
+
+			r = sl->compare(curr->object, node->object);
+			if (r > 0)
+				break;
+
+			if (r < 0)
+				start = curr;
+
+			pred = curr;
+			curr = succ;
+		}
+	}
+
+	return;
+}
+
+static void
+ck_sl_release(struct ck_sl *sl, struct ck_sl_node *node)
+{
+	bool zero;
+
+	ck_pr_dec_uint_zero(&node->pending, &zero);
+	if (zero == false)
+		return;
+
+	ck_sl_unlink(sl, node);
+	sl->m->free(node, ck_sl_node_size(node->height), true);
+	return;
+}
+
+bool
+ck_sl_init(struct ck_sl *sl,
+    ck_sl_compare_cb_t *compare,
+    struct ck_malloc *m,
+    unsigned long seed)
+{
+	struct ck_sl_node *head;
+	unsigned int i;
+
+	if (m == NULL || m->malloc == NULL || m->free == NULL)
+		return false;
+
+	head = m->malloc(ck_sl_node_size(CK_SL_HEIGHT));
+	if (head == NULL)
+		return false;
+
+	head->object = NULL;
+	head->height = CK_SL_HEIGHT;
+	head->pending = 0;
+	for (i = 0; i < CK_SL_HEIGHT; i++)
+		head->next[i] = NULL;
+
+	sl->m = m;
+	sl->compare = compare;
+	sl->head = head;
+	sl->n_entries = 0;
+
+	/* The xorshift generator must not be seeded with zero. */
+	sl->seed = (unsigned int)seed | 1;
+	return true;
+}
+
+void
+ck_sl_deinit(struct ck_sl *sl)
+{
+	struct ck_sl_node *node, *next;
+
+	for (node = sl->head; node != NULL; node = next) {
+		next = ck_sl_unmark(node->next[0]);
+		sl->m->free(node, ck_sl_node_size(node->height), false);
+	}
+
+	sl->head = NULL;
+	return;
+}
+
+unsigned long
+ck_sl_count(struct ck_sl *sl)
+{
+
+	return ck_pr_load_uint(&sl->n_entries);
+}
+
+/*
+ * Returns the last node at the bottom level, unmarked when it was
+ * observed, that holds an object less than key.
+ */
+static struct ck_sl_node *
+ck_sl_lower(struct ck_sl *sl, const void *key, struct ck_sl_node **match)
+{
+	struct ck_sl_node *pred, *curr, *succ;
+	unsigned int level;
+
+	pred = sl->head;
+	curr = NULL;
+	level = CK_SL_HEIGHT;
+	while (level-- > 0) {
+		curr = ck_sl_unmark(ck_sl_load(pred, level));
+		while (curr != NULL) {
+			succ = ck_sl_load(curr, level);
+			if (ck_sl_marked(succ) == true) {
+				curr = ck_sl_unmark(succ);
+				continue;
+			}
+
+			if (sl->compare(curr->object, key) >= 0)
+				break;
+
+			pred = curr;
+			curr = succ;
+		}
+	}
+
+	*match = curr;
+	return pred;
+}
+
+void *
+ck_sl_get(struct ck_sl *sl, const void *key)
+{
+	struct ck_sl_node *node;
+
+	ck_sl_lower(sl, key, &node);
+	if (node == NULL || sl->compare(node->object, key) != 0)
+		return NULL;
+
+	return CK_CC_DECONST_PTR(node->object);
+}
+
+/*
+ * Returns false if an equal object is already present or if memory could
+ * not be allocated.
+ */
+bool
+ck_sl_put(struct ck_sl *sl, const void *object)
+{
+	struct ck_sl_node *preds[CK_SL_HEIGHT];
+	struct ck_sl_node *succs[CK_SL_HEIGHT];
+	struct ck_sl_node *node, *succ;
+	unsigned int height, level;
+
+	height = ck_sl_height(sl);
+	node = sl->m->malloc(ck_sl_node_size(height));
+	if (node == NULL)
+		return false;
+
+	node->object = object;
+	node->height = height;
+	node->pending = 2;
+
+	for (;;) {
+		if (ck_sl_find(sl, object, preds, succs) == true) {
+			sl->m->free(node, ck_sl_node_size(height), false);
+			return false;
+		}
+
+		for (level = 0; level < height; level++)
+			node->next[level] = succs[level];
+
+		/* The node must be initialized before it is reachable. */
+		ck_pr_fence_store();
+		if (ck_pr_cas_ptr(&preds[0]->next[0], succs[0], node) == true)
+			break;
+	}
+
+	ck_pr_inc_uint(&sl->n_entries);
+
+	/*
+	 * Link the upper levels, bottom up. The node is only reachable at
+	 * levels it is linked into, so its next pointers for the remaining
+	 * levels may only be modified by a deleter marking them.
+	 */
+	for (level = 1; level < height; level++) {
+		for (;;) {
+			succ = ck_sl_load(node, level);
+			if (ck_sl_marked(succ) == true)
+				goto leave;
+
+			if (succ != succs[level] &&
+			    ck_pr_cas_ptr(&node->next[level], succ,
+			    succs[level]) == false)
+				goto leave;
+
+			if (ck_pr_cas_ptr(&preds[level]->next[level],
+			    succs[level], node) == true)
+				break;
+
+			ck_sl_find(sl, object, preds, succs);
+			if (succs[0] != node)
+				goto leave;
+		}
+	}
+
+leave:
+	ck_sl_release(sl, node);
+	return true;
+}
+
+/*
+ * Returns the removed object, or NULL if no object equal to key was
+ * present.
+ */
+void *
+ck_sl_remove(struct ck_sl *sl, const void *key)
+{
+	struct ck_sl_node *preds[CK_SL_HEIGHT];
+	struct ck_sl_node *succs[CK_SL_HEIGHT];
+	struct ck_sl_node *node, *succ;
+	const void *object;
+	unsigned int level;
+
+	if (ck_sl_find(sl, key, preds, succs) == false)
+		return NULL;
+
+	node = succs[0];
+	for (level = node->height - 1; level > 0; level--) {
+		succ = ck_sl_load(node, level);
+		while (ck_sl_marked(succ) == false) {
+			if (ck_pr_cas_ptr_value(&node->next[level], succ,
+			    CK_SL_MARK(succ), &succ) == true)
+				break;
+		}
+	}
+
+	succ = ck_sl_load(node, 0);
+	while (ck_sl_marked(succ) == false) {
+		if (ck_pr_cas_ptr_value(&node->next[0], succ,
+		    CK_SL_MARK(succ), &succ) == true) {
+			ck_pr_dec_uint(&sl->n_entries);
+
+			/* The node may be destroyed once it is released. */
+			object = node->object;
+			ck_sl_release(sl, node);
+			return CK_CC_DECONST_PTR(object);
+		}
+	}
+
+	/* A concurrent deleter won the race. */
+	return NULL;
+}
+
+/*
+ * Positions the iterator so that the next call to ck_sl_next returns the
+ * first object greater than or equal to key.
+ */
+void
+ck_sl_seek(struct ck_sl *sl, struct ck_sl_iterator *i, const void *key)
+{
+	struct ck_sl_node *match;
+
+	i->cursor = ck_sl_lower(sl, key, &match);
+	return;
+}
+
+bool
+ck_sl_next(struct ck_sl *sl, struct ck_sl_iterator *i, void **object)
+{
+	struct ck_sl_node *curr, *succ;
+
+	if (i->cursor == NULL)
+		i->cursor = sl->head;
+
+	curr = ck_sl_unmark(ck_sl_load(i->cursor, 0));
+	while (curr != NULL) {
+		succ = ck_sl_load(curr, 0);
+		if (ck_sl_marked(succ) == false)
+			break;
+
+		curr = ck_sl_unmark(succ);
+	}
+
+	if (curr == NULL)
+		return false;
+
+	i->cursor = curr;
+	*object = CK_CC_DECONST_PTR(curr->object);
+	return true;
+}